@@ -0,0 +1,166 @@
+#include "assetCache.h"
+#include <iostream>
+
+AssetCache::AssetCache()
+{
+	this->loading = false;
+}
+
+AssetCache::~AssetCache()
+{
+}
+
+std::shared_ptr<Mesh> AssetCache::LoadMesh(std::string objPath, ThreadPool* pool)
+{
+	std::string key = AssetPath::Canonical(objPath);
+	std::lock_guard<std::mutex> lock(mutex);
+
+	bool created = false;
+	std::shared_ptr<Mesh> mesh = meshes.Find(key, created);
+	if (!created)
+	{
+		return mesh;
+	}
+	StartLoading();
+
+	//the mtl file name is in the obj file, so the texture is queued once the mesh is read
+	PendingMesh pending;
+	pending.mesh = mesh;
+	pending.loaded = pool->Submit([this, mesh, objPath, pool]()
+	{
+		//a mesh that can not be read has no material, its objects are not created
+		if (mesh->LoadData(objPath))
+		{
+			mesh->SetMaterial(LoadTexture(mesh->GetMaterialPath(), pool));
+		}
+	}).share();
+	pendingMeshes.push_back(pending);
+
+	return mesh;
+}
+
+std::shared_ptr<Texture> AssetCache::LoadTexture(std::string mtlPath, ThreadPool* pool)
+{
+	std::string key = AssetPath::Canonical(mtlPath);
+	std::lock_guard<std::mutex> lock(mutex);
+
+	bool created = false;
+	std::shared_ptr<Texture> texture = textures.Find(key, created);
+	if (!created)
+	{
+		return texture;
+	}
+	StartLoading();
+
+	PendingTexture pending;
+	pending.texture = texture;
+	pending.loaded = pool->Submit([texture, mtlPath]()
+	{
+		texture->LoadMaterialData(mtlPath);
+	}).share();
+	pendingTextures.push_back(pending);
+
+	return texture;
+}
+
+void AssetCache::FinishLoading(ID3D12Device5* device, DescriptorHeap* heap, UploadRing* ring, TextureHeaps* textureHeaps,
+	ResourceStateTracker* stateTracker, GeometryPool* geometry, GeometryUploader* uploader, ThreadPool* pool)
+{
+	double waitTime = 0.0;
+	double createTime = 0.0;
+
+	while (true)
+	{
+		std::vector<PendingMesh> meshJobs;
+		std::vector<PendingTexture> textureJobs;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			meshJobs.swap(pendingMeshes);
+			textureJobs.swap(pendingTextures);
+		}
+
+		if (meshJobs.empty() && textureJobs.empty())
+		{
+			break;
+		}
+
+		//the device is only used from this thread, one asset at a time as soon as it is read.
+		//finished meshes can queue more textures, they are picked up in the next round
+		for (size_t i = 0; i < meshJobs.size(); i++)
+		{
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			pool->Wait(meshJobs[i].loaded);
+			std::chrono::high_resolution_clock::time_point loaded = std::chrono::high_resolution_clock::now();
+			meshJobs[i].mesh->CreateBuffers(geometry, uploader);
+
+			waitTime += std::chrono::duration<double, std::milli>(loaded - start).count();
+			createTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - loaded).count();
+		}
+
+		for (size_t i = 0; i < textureJobs.size(); i++)
+		{
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			pool->Wait(textureJobs[i].loaded);
+			std::chrono::high_resolution_clock::time_point loaded = std::chrono::high_resolution_clock::now();
+			textureJobs[i].texture->CreateResources(device, heap, ring, textureHeaps, stateTracker);
+			textureJobs[i].texture->UploadFrames(pool);
+
+			waitTime += std::chrono::duration<double, std::milli>(loaded - start).count();
+			createTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - loaded).count();
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (loading)
+	{
+		std::chrono::duration<double, std::milli> total = std::chrono::high_resolution_clock::now() - loadStart;
+		std::cout << "Loading on " << pool->GetNrOfThreads() << " threads took " << total.count() << " ms ("
+			<< waitTime << " ms waiting for workers, " << createTime << " ms creating and filling resources)" << std::endl;
+		loading = false;
+	}
+}
+
+unsigned int AssetCache::GetMeshHits()
+{
+	return this->meshes.GetHits();
+}
+
+unsigned int AssetCache::GetMeshMisses()
+{
+	return this->meshes.GetMisses();
+}
+
+unsigned int AssetCache::GetTextureHits()
+{
+	return this->textures.GetHits();
+}
+
+unsigned int AssetCache::GetTextureMisses()
+{
+	return this->textures.GetMisses();
+}
+
+unsigned int AssetCache::GetMeshIdEnd()
+{
+	return this->meshes.GetIds()->GetEnd();
+}
+
+unsigned int AssetCache::GetTextureIdEnd()
+{
+	return this->textures.GetIds()->GetEnd();
+}
+
+void AssetCache::PrintStats()
+{
+	std::cout << "Meshes: " << meshes.GetMisses() << " loaded, " << meshes.GetHits() << " shared" << std::endl;
+	std::cout << "Textures: " << textures.GetMisses() << " loaded, " << textures.GetHits() << " shared" << std::endl;
+}
+
+void AssetCache::StartLoading()
+{
+	if (!loading)
+	{
+		loadStart = std::chrono::high_resolution_clock::now();
+		loading = true;
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <future>
+#include <chrono>
+#include "mesh.h"
+#include "texture.h"
+#include "threadPool.h"
+#include "assetRegistry.h"
+
+// Registry of loaded meshes and textures keyed by their canonical path. Objects hold
+// shared references, so an asset is loaded once and released when no object uses it.
+// Files are read on the thread pool, the gpu resources are created afterwards on the
+// thread that calls FinishLoading. Texture frames are decoded on the pool straight into
+// the upload heaps once these exist. The live meshes and textures have small ids for the
+// draw sort keys, the ids of released assets are reused.
+class AssetCache
+{
+public:
+	AssetCache();
+	~AssetCache();
+
+	// both return right away, the returned asset can be used once FinishLoading has returned.
+	// The texture of the mtl file that a mesh refers to is loaded together with the mesh.
+	std::shared_ptr<Mesh> LoadMesh(std::string objPath, ThreadPool* pool);
+	std::shared_ptr<Texture> LoadTexture(std::string mtlPath, ThreadPool* pool);
+
+	// waits for every queued load, creates the gpu resources of the loaded assets and
+	// stages the texture frames for the upload. The srvs of the textures are allocated from heap,
+	// the frames are staged in ring as long as they fit and the textures are registered with stateTracker.
+	// The meshes get ranges of geometry that are filled by uploader, its copies are not flushed.
+	void FinishLoading(ID3D12Device5* device, DescriptorHeap* heap, UploadRing* ring, TextureHeaps* textureHeaps,
+		ResourceStateTracker* stateTracker, GeometryPool* geometry, GeometryUploader* uploader, ThreadPool* pool);
+
+	unsigned int GetMeshHits();
+	unsigned int GetMeshMisses();
+	unsigned int GetTextureHits();
+	unsigned int GetTextureMisses();
+	// one more than the largest mesh or texture id so far
+	unsigned int GetMeshIdEnd();
+	unsigned int GetTextureIdEnd();
+	void PrintStats();
+
+private:
+	struct PendingMesh
+	{
+		std::shared_ptr<Mesh> mesh;
+		std::shared_future<void> loaded;
+	};
+
+	struct PendingTexture
+	{
+		std::shared_ptr<Texture> texture;
+		std::shared_future<void> loaded;
+	};
+
+	void StartLoading();
+
+	// loads are queued from the worker threads as well
+	std::mutex mutex;
+	std::vector<PendingMesh> pendingMeshes;
+	std::vector<PendingTexture> pendingTextures;
+	std::chrono::high_resolution_clock::time_point loadStart;
+	bool loading;
+
+	AssetRegistry<Mesh> meshes;
+	AssetRegistry<Texture> textures;
+};
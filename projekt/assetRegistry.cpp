@@ -0,0 +1,67 @@
+#include "assetRegistry.h"
+#include <stdlib.h>
+#include <ctype.h>
+
+IdPool::IdPool()
+{
+	end = 0;
+}
+
+unsigned int IdPool::Allocate()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	//the most recently freed id first
+	if (!freeIds.empty())
+	{
+		unsigned int id = freeIds.back();
+		freeIds.pop_back();
+		return id;
+	}
+	return end++;
+}
+
+void IdPool::Free(unsigned int id)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	freeIds.push_back(id);
+}
+
+unsigned int IdPool::GetNrOfUsed()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return end - (unsigned int)freeIds.size();
+}
+
+unsigned int IdPool::GetEnd()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return this->end;
+}
+
+std::string AssetPath::Canonical(std::string path)
+{
+	std::string canonical = path;
+
+#ifdef _WIN32
+	char fullPath[_MAX_PATH];
+	if (_fullpath(fullPath, path.c_str(), _MAX_PATH) != nullptr)
+	{
+		canonical = fullPath;
+	}
+
+	// windows paths are not case sensitive and may use either slash
+	for (size_t i = 0; i < canonical.size(); i++)
+	{
+		canonical[i] = canonical[i] == '\\' ? '/' : (char)tolower((unsigned char)canonical[i]);
+	}
+#else
+	char* resolved = realpath(path.c_str(), nullptr);
+	if (resolved != nullptr)
+	{
+		canonical = resolved;
+		free(resolved);
+	}
+#endif
+
+	return canonical;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Paths of the asset files
+class AssetPath
+{
+public:
+	// the absolute path without . and .. so every way to write it is the same, on windows in lower
+	// case and with forward slashes. The path as it is if the file does not exist.
+	static std::string Canonical(std::string path);
+};
+
+// Small ids that are given back and reused, so the ids of the live assets stay below the number
+// of assets that are alive at the same time. Safe to use from any thread.
+class IdPool
+{
+public:
+	IdPool();
+
+	unsigned int Allocate();
+	void Free(unsigned int id);
+	// ids handed out and not given back
+	unsigned int GetNrOfUsed();
+	// one more than the largest id handed out so far
+	unsigned int GetEnd();
+
+private:
+	std::mutex mutex;
+	std::vector<unsigned int> freeIds;
+	unsigned int end;
+};
+
+// The live assets of one kind keyed by their canonical path. Only weak references are kept, so an
+// asset is released once no object uses it and a later Find of its path makes a new one. Every
+// asset gets an id of the pool with SetId, the id is given back when the asset is destroyed.
+// T needs SetId(unsigned int) and GetId(). Not thread safe, the AssetCache locks around it.
+template<class T>
+class AssetRegistry
+{
+public:
+	AssetRegistry()
+	{
+		ids = std::make_shared<IdPool>();
+		hits = 0;
+		misses = 0;
+	}
+
+	// the live asset of key, or a new one which the caller has to load, then created is true
+	std::shared_ptr<T> Find(const std::string& key, bool& created)
+	{
+		std::shared_ptr<T> asset = assets[key].lock();
+		created = !asset;
+		if (asset)
+		{
+			hits++;
+			return asset;
+		}
+
+		misses++;
+		ForgetReleased();
+
+		//the pool is shared with the deleter, an asset may outlive the registry
+		std::shared_ptr<IdPool> pool = ids;
+		asset = std::shared_ptr<T>(new T(), [pool](T* released)
+		{
+			pool->Free(released->GetId());
+			delete released;
+		});
+		asset->SetId(pool->Allocate());
+		assets[key] = asset;
+		return asset;
+	}
+
+	unsigned int GetHits()
+	{
+		return this->hits;
+	}
+
+	unsigned int GetMisses()
+	{
+		return this->misses;
+	}
+
+	IdPool* GetIds()
+	{
+		return this->ids.get();
+	}
+
+private:
+	// drops the paths of released assets once they are most of the map, so loading many different
+	// files does not grow it forever
+	void ForgetReleased()
+	{
+		if (assets.size() < 2 * (size_t)ids->GetNrOfUsed() + 16)
+		{
+			return;
+		}
+		for (typename std::map<std::string, std::weak_ptr<T>>::iterator i = assets.begin(); i != assets.end();)
+		{
+			i = i->second.expired() ? assets.erase(i) : std::next(i);
+		}
+	}
+
+	std::map<std::string, std::weak_ptr<T>> assets;
+	std::shared_ptr<IdPool> ids;
+	unsigned int hits;
+	unsigned int misses;
+};
@@ -0,0 +1,292 @@
+#include "commandRecorder.h"
+#include <string.h>
+
+RecordingCommandRecorder::RecordingCommandRecorder()
+{
+	Reset();
+}
+
+void RecordingCommandRecorder::ResourceBarrier(UINT nrOfBarriers, const D3D12_RESOURCE_BARRIER* barriers)
+{
+	Add(Barrier, 0, nrOfBarriers, 0, this->barriers.size());
+	this->barriers.insert(this->barriers.end(), barriers, barriers + nrOfBarriers);
+}
+
+void RecordingCommandRecorder::SetDescriptorHeaps(UINT nrOfHeaps, ID3D12DescriptorHeap* const* heaps)
+{
+	// a command list has one heap per type, the first one is enough to tell heap switches apart
+	Add(DescriptorHeaps, 0, nrOfHeaps, nrOfHeaps > 0 ? (UINT64)heaps[0] : 0);
+}
+
+void RecordingCommandRecorder::SetGraphicsRootSignature(ID3D12RootSignature* rootSignature)
+{
+	Add(RootSignature, 0, 0, (UINT64)rootSignature);
+}
+
+void RecordingCommandRecorder::SetPipelineState(ID3D12PipelineState* pipelineState)
+{
+	Add(PipelineState, 0, 0, (UINT64)pipelineState);
+}
+
+void RecordingCommandRecorder::SetGraphicsRootDescriptorTable(UINT rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE table)
+{
+	Add(RootDescriptorTable, rootIndex, 0, table.ptr);
+}
+
+void RecordingCommandRecorder::SetGraphicsRootShaderResourceView(UINT rootIndex, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+	Add(RootShaderResourceView, rootIndex, 0, address);
+}
+
+void RecordingCommandRecorder::SetGraphicsRoot32BitConstants(UINT rootIndex, UINT nrOfValues, const void* data, UINT offset)
+{
+	Add(RootConstants, rootIndex, nrOfValues, offset, constants.size());
+	constants.insert(constants.end(), (const UINT*)data, (const UINT*)data + nrOfValues);
+}
+
+void RecordingCommandRecorder::IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)
+{
+	Add(PrimitiveTopology, 0, 0, (UINT64)topology);
+}
+
+void RecordingCommandRecorder::IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view)
+{
+	Add(IndexBuffer, 0, view->SizeInBytes, view->BufferLocation);
+}
+
+void RecordingCommandRecorder::DrawIndexedInstanced(UINT indicesPerInstance, UINT nrOfInstances, UINT startIndex, INT baseVertex, UINT startInstance)
+{
+	Add(Draw, 0, indicesPerInstance, nrOfInstances, constants.size());
+	constants.push_back(startIndex);
+	constants.push_back((UINT)baseVertex);
+	constants.push_back(startInstance);
+}
+
+const std::vector<RecordingCommandRecorder::Command>& RecordingCommandRecorder::GetCommands()
+{
+	return this->commands;
+}
+
+const std::vector<D3D12_RESOURCE_BARRIER>& RecordingCommandRecorder::GetBarriers()
+{
+	return this->barriers;
+}
+
+const std::vector<UINT>& RecordingCommandRecorder::GetConstants()
+{
+	return this->constants;
+}
+
+unsigned int RecordingCommandRecorder::GetCount(CommandType type)
+{
+	return this->counts[type];
+}
+
+const char* RecordingCommandRecorder::GetName(CommandType type)
+{
+	static const char* names[COMMAND_TYPE_SIZE] = {
+		"barriers", "descriptor heaps", "root signatures", "pipeline states", "descriptor tables",
+		"root srvs", "root constants", "topologies", "index buffers", "draws" };
+	return names[type];
+}
+
+void RecordingCommandRecorder::Reset()
+{
+	commands.clear();
+	barriers.clear();
+	constants.clear();
+	for (int i = 0; i < COMMAND_TYPE_SIZE; i++)
+	{
+		counts[i] = 0;
+	}
+}
+
+void RecordingCommandRecorder::Add(CommandType type, UINT rootIndex, UINT count, UINT64 value, size_t firstValue)
+{
+	Command command;
+	command.type = type;
+	command.rootIndex = rootIndex;
+	command.count = count;
+	command.value = value;
+	command.firstValue = firstValue;
+	commands.push_back(command);
+	counts[type]++;
+}
+
+namespace
+{
+	// nothing is bound, no real address or handle has this value
+	const UINT64 UNSET = ~0ull;
+}
+
+StateChangeCounts::StateChangeCounts()
+{
+	pipelineStates = 0;
+	descriptorHeaps = 0;
+	rootShaderResourceViews = 0;
+	redundant = 0;
+}
+
+void StateChangeCounts::Add(const StateChangeCounts& counts)
+{
+	pipelineStates += counts.pipelineStates;
+	descriptorHeaps += counts.descriptorHeaps;
+	rootShaderResourceViews += counts.rootShaderResourceViews;
+	redundant += counts.redundant;
+}
+
+StateFilterCommandRecorder::StateFilterCommandRecorder(CommandRecorder* target)
+{
+	this->target = target;
+	Reset();
+}
+
+void StateFilterCommandRecorder::ResourceBarrier(UINT nrOfBarriers, const D3D12_RESOURCE_BARRIER* barriers)
+{
+	target->ResourceBarrier(nrOfBarriers, barriers);
+}
+
+void StateFilterCommandRecorder::SetDescriptorHeaps(UINT nrOfHeaps, ID3D12DescriptorHeap* const* heaps)
+{
+	if (nrOfHeaps == this->nrOfHeaps && nrOfHeaps <= 2 && memcmp(heaps, this->heaps, nrOfHeaps * sizeof(heaps[0])) == 0)
+	{
+		counts.redundant++;
+		return;
+	}
+
+	// the tables point into the heaps, they have to be set again after the heaps change
+	this->nrOfHeaps = nrOfHeaps <= 2 ? nrOfHeaps : 0;
+	memcpy(this->heaps, heaps, this->nrOfHeaps * sizeof(heaps[0]));
+	for (UINT i = 0; i < MAX_ROOT_PARAMETERS; i++)
+	{
+		tables[i] = UNSET;
+	}
+
+	counts.descriptorHeaps++;
+	target->SetDescriptorHeaps(nrOfHeaps, heaps);
+}
+
+void StateFilterCommandRecorder::SetGraphicsRootSignature(ID3D12RootSignature* rootSignature)
+{
+	if (rootSignature == this->rootSignature)
+	{
+		counts.redundant++;
+		return;
+	}
+
+	this->rootSignature = rootSignature;
+	ForgetRootArguments();
+	target->SetGraphicsRootSignature(rootSignature);
+}
+
+void StateFilterCommandRecorder::SetPipelineState(ID3D12PipelineState* pipelineState)
+{
+	if (pipelineState == this->pipelineState)
+	{
+		counts.redundant++;
+		return;
+	}
+
+	this->pipelineState = pipelineState;
+	counts.pipelineStates++;
+	target->SetPipelineState(pipelineState);
+}
+
+void StateFilterCommandRecorder::SetGraphicsRootDescriptorTable(UINT rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE table)
+{
+	if (rootIndex < MAX_ROOT_PARAMETERS)
+	{
+		if (tables[rootIndex] == table.ptr)
+		{
+			counts.redundant++;
+			return;
+		}
+		tables[rootIndex] = table.ptr;
+	}
+
+	target->SetGraphicsRootDescriptorTable(rootIndex, table);
+}
+
+void StateFilterCommandRecorder::SetGraphicsRootShaderResourceView(UINT rootIndex, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+	if (rootIndex < MAX_ROOT_PARAMETERS)
+	{
+		if (views[rootIndex] == address)
+		{
+			counts.redundant++;
+			return;
+		}
+		views[rootIndex] = address;
+	}
+
+	counts.rootShaderResourceViews++;
+	target->SetGraphicsRootShaderResourceView(rootIndex, address);
+}
+
+void StateFilterCommandRecorder::SetGraphicsRoot32BitConstants(UINT rootIndex, UINT nrOfValues, const void* data, UINT offset)
+{
+	target->SetGraphicsRoot32BitConstants(rootIndex, nrOfValues, data, offset);
+}
+
+void StateFilterCommandRecorder::IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)
+{
+	if (topology == this->topology)
+	{
+		counts.redundant++;
+		return;
+	}
+
+	this->topology = topology;
+	target->IASetPrimitiveTopology(topology);
+}
+
+void StateFilterCommandRecorder::IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view)
+{
+	if (view != nullptr && memcmp(view, &indexBuffer, sizeof(indexBuffer)) == 0)
+	{
+		counts.redundant++;
+		return;
+	}
+
+	if (view != nullptr)
+	{
+		indexBuffer = *view;
+	}
+	else
+	{
+		memset(&indexBuffer, 0xFF, sizeof(indexBuffer));
+	}
+	target->IASetIndexBuffer(view);
+}
+
+void StateFilterCommandRecorder::DrawIndexedInstanced(UINT indicesPerInstance, UINT nrOfInstances, UINT startIndex, INT baseVertex, UINT startInstance)
+{
+	target->DrawIndexedInstanced(indicesPerInstance, nrOfInstances, startIndex, baseVertex, startInstance);
+}
+
+const StateChangeCounts& StateFilterCommandRecorder::GetCounts()
+{
+	return this->counts;
+}
+
+void StateFilterCommandRecorder::Reset()
+{
+	counts = StateChangeCounts();
+	rootSignature = nullptr;
+	pipelineState = nullptr;
+	nrOfHeaps = UINT_MAX;
+	heaps[0] = nullptr;
+	heaps[1] = nullptr;
+	topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+	memset(&indexBuffer, 0xFF, sizeof(indexBuffer));
+	ForgetRootArguments();
+}
+
+void StateFilterCommandRecorder::ForgetRootArguments()
+{
+	for (UINT i = 0; i < MAX_ROOT_PARAMETERS; i++)
+	{
+		tables[i] = UNSET;
+		views[i] = UNSET;
+	}
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <d3d12.h>
+#include <vector>
+
+// The commands Renderer::Frame records per object. The D3D12 recorder writes them to a command
+// list, the recording one keeps them in a list that can be inspected, so the cpu side of a frame
+// can be measured and counted without submitting anything to the gpu.
+class CommandRecorder
+{
+public:
+	virtual ~CommandRecorder() {}
+
+	virtual void ResourceBarrier(UINT nrOfBarriers, const D3D12_RESOURCE_BARRIER* barriers) = 0;
+	virtual void SetDescriptorHeaps(UINT nrOfHeaps, ID3D12DescriptorHeap* const* heaps) = 0;
+	virtual void SetGraphicsRootSignature(ID3D12RootSignature* rootSignature) = 0;
+	virtual void SetPipelineState(ID3D12PipelineState* pipelineState) = 0;
+	virtual void SetGraphicsRootDescriptorTable(UINT rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE table) = 0;
+	virtual void SetGraphicsRootShaderResourceView(UINT rootIndex, D3D12_GPU_VIRTUAL_ADDRESS address) = 0;
+	virtual void SetGraphicsRoot32BitConstants(UINT rootIndex, UINT nrOfValues, const void* data, UINT offset) = 0;
+	virtual void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology) = 0;
+	virtual void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view) = 0;
+	virtual void DrawIndexedInstanced(UINT indicesPerInstance, UINT nrOfInstances, UINT startIndex, INT baseVertex, UINT startInstance) = 0;
+};
+
+// Keeps every command with its arguments instead of recording it
+class RecordingCommandRecorder : public CommandRecorder
+{
+public:
+	enum CommandType
+	{
+		Barrier,
+		DescriptorHeaps,
+		RootSignature,
+		PipelineState,
+		RootDescriptorTable,
+		RootShaderResourceView,
+		RootConstants,
+		PrimitiveTopology,
+		IndexBuffer,
+		Draw,
+		COMMAND_TYPE_SIZE
+	};
+
+	struct Command
+	{
+		CommandType type;
+		UINT rootIndex;		// root parameter of the root commands
+		UINT count;			// barriers, heaps, constants or indices per instance
+		UINT64 value;		// the object, gpu address or handle that is set, the instance count of a draw
+		size_t firstValue;	// where the barriers or constants are in GetBarriers and GetConstants, the start
+							// index, base vertex and start instance of a draw are in GetConstants as well
+	};
+
+	RecordingCommandRecorder();
+
+	void ResourceBarrier(UINT nrOfBarriers, const D3D12_RESOURCE_BARRIER* barriers);
+	void SetDescriptorHeaps(UINT nrOfHeaps, ID3D12DescriptorHeap* const* heaps);
+	void SetGraphicsRootSignature(ID3D12RootSignature* rootSignature);
+	void SetPipelineState(ID3D12PipelineState* pipelineState);
+	void SetGraphicsRootDescriptorTable(UINT rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE table);
+	void SetGraphicsRootShaderResourceView(UINT rootIndex, D3D12_GPU_VIRTUAL_ADDRESS address);
+	void SetGraphicsRoot32BitConstants(UINT rootIndex, UINT nrOfValues, const void* data, UINT offset);
+	void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology);
+	void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view);
+	void DrawIndexedInstanced(UINT indicesPerInstance, UINT nrOfInstances, UINT startIndex, INT baseVertex, UINT startInstance);
+
+	const std::vector<Command>& GetCommands();
+	const std::vector<D3D12_RESOURCE_BARRIER>& GetBarriers();
+	const std::vector<UINT>& GetConstants();
+	// commands of one type, a barrier command with several barriers counts once
+	unsigned int GetCount(CommandType type);
+	static const char* GetName(CommandType type);
+
+	// forgets the recorded commands but keeps the memory, like resetting a command list
+	void Reset();
+
+private:
+	void Add(CommandType type, UINT rootIndex, UINT count, UINT64 value, size_t firstValue = 0);
+
+	std::vector<Command> commands;
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	std::vector<UINT> constants;
+	unsigned int counts[COMMAND_TYPE_SIZE];
+};
+
+// state changes a StateFilterCommandRecorder passed on and the redundant ones it dropped
+struct StateChangeCounts
+{
+	unsigned int pipelineStates;
+	unsigned int descriptorHeaps;
+	unsigned int rootShaderResourceViews;
+	unsigned int redundant;
+
+	StateChangeCounts();
+	void Add(const StateChangeCounts& counts);
+};
+
+// Passes the commands on to another recorder but drops state that is already set, e.g. the
+// same pipeline state twice in a row. It starts without any state, like a new command list.
+class StateFilterCommandRecorder : public CommandRecorder
+{
+public:
+	StateFilterCommandRecorder(CommandRecorder* target);
+
+	void ResourceBarrier(UINT nrOfBarriers, const D3D12_RESOURCE_BARRIER* barriers);
+	void SetDescriptorHeaps(UINT nrOfHeaps, ID3D12DescriptorHeap* const* heaps);
+	void SetGraphicsRootSignature(ID3D12RootSignature* rootSignature);
+	void SetPipelineState(ID3D12PipelineState* pipelineState);
+	void SetGraphicsRootDescriptorTable(UINT rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE table);
+	void SetGraphicsRootShaderResourceView(UINT rootIndex, D3D12_GPU_VIRTUAL_ADDRESS address);
+	void SetGraphicsRoot32BitConstants(UINT rootIndex, UINT nrOfValues, const void* data, UINT offset);
+	void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology);
+	void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view);
+	void DrawIndexedInstanced(UINT indicesPerInstance, UINT nrOfInstances, UINT startIndex, INT baseVertex, UINT startInstance);
+
+	const StateChangeCounts& GetCounts();
+	// forgets the state and the counts, for the next command list
+	void Reset();
+
+	static const UINT MAX_ROOT_PARAMETERS = 8;
+
+private:
+	// the root arguments are undefined after a new root signature
+	void ForgetRootArguments();
+
+	CommandRecorder* target;
+	StateChangeCounts counts;
+
+	ID3D12RootSignature* rootSignature;
+	ID3D12PipelineState* pipelineState;
+	ID3D12DescriptorHeap* heaps[2];
+	UINT nrOfHeaps;
+	UINT64 tables[MAX_ROOT_PARAMETERS];
+	UINT64 views[MAX_ROOT_PARAMETERS];
+	D3D12_PRIMITIVE_TOPOLOGY topology;
+	D3D12_INDEX_BUFFER_VIEW indexBuffer;
+};
@@ -5,16 +5,6 @@
 
 using namespace DirectX;
 
-static enum types
-{
-	Positions,
-	UV,
-	WVP,
-	TextureDT,
-	TextureIndex,
-	TYPE_SIZE
-};
-
 class ConstantBuffer
 {
 public:
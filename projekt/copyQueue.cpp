@@ -0,0 +1,197 @@
+#include "copyQueue.h"
+
+D3D12CopyQueue::D3D12CopyQueue()
+{
+	device = nullptr;
+	queue = nullptr;
+	commandList = nullptr;
+	openAllocator = nullptr;
+	fence = nullptr;
+	fenceValue = 0;
+	eventHandle = nullptr;
+	staging = nullptr;
+	mappedStaging = nullptr;
+	stagingSize = 0;
+}
+
+D3D12CopyQueue::~D3D12CopyQueue()
+{
+	//the queue may still read from the staging buffer
+	if (fence != nullptr)
+	{
+		Wait(fenceValue);
+		fence->Release();
+	}
+	if (eventHandle != nullptr)
+	{
+		CloseHandle(eventHandle);
+	}
+
+	for (size_t i = 0; i < allocators.size(); i++)
+	{
+		allocators[i]->Release();
+	}
+	if (commandList != nullptr)
+	{
+		commandList->Release();
+	}
+	if (queue != nullptr)
+	{
+		queue->Release();
+	}
+	if (staging != nullptr)
+	{
+		staging->Unmap(0, nullptr);
+		staging->Release();
+	}
+}
+
+bool D3D12CopyQueue::Create(ID3D12Device5* device, UINT64 stagingSize)
+{
+	this->device = device;
+
+	D3D12_COMMAND_QUEUE_DESC cqd = {};
+	cqd.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+	if (!SUCCEEDED(device->CreateCommandQueue(&cqd, IID_PPV_ARGS(&queue))))
+	{
+		OutputDebugStringA("ERROR: Could not create the copy queue!\n");
+		queue = nullptr;
+		return false;
+	}
+	queue->SetName(L"copy queue");
+
+	if (!SUCCEEDED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+	{
+		OutputDebugStringA("ERROR: Could not create the copy fence!\n");
+		fence = nullptr;
+		return false;
+	}
+	eventHandle = CreateEvent(0, false, false, 0);
+
+	D3D12_HEAP_PROPERTIES hp = {};
+	hp.Type = D3D12_HEAP_TYPE_UPLOAD;
+	hp.CreationNodeMask = 1;
+	hp.VisibleNodeMask = 1;
+
+	D3D12_RESOURCE_DESC rd = {};
+	rd.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	rd.Width = stagingSize;
+	rd.Height = 1;
+	rd.DepthOrArraySize = 1;
+	rd.MipLevels = 1;
+	rd.SampleDesc.Count = 1;
+	rd.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	if (!SUCCEEDED(device->CreateCommittedResource(
+		&hp,
+		D3D12_HEAP_FLAG_NONE,
+		&rd,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&staging))))
+	{
+		OutputDebugStringA("ERROR: Could not create the geometry staging buffer!\n");
+		staging = nullptr;
+		return false;
+	}
+	staging->SetName(L"geometry staging");
+
+	//We do not intend to read this resource on the CPU.
+	D3D12_RANGE range = { 0, 0 };
+	staging->Map(0, &range, (void**)&mappedStaging);
+	this->stagingSize = stagingSize;
+
+	return true;
+}
+
+unsigned char* D3D12CopyQueue::GetStaging()
+{
+	return this->mappedStaging;
+}
+
+unsigned long long D3D12CopyQueue::GetStagingSize()
+{
+	return this->stagingSize;
+}
+
+void D3D12CopyQueue::Copy(void* destination, unsigned long long destinationOffset, unsigned long long stagingOffset, unsigned long long size)
+{
+	if (openAllocator == nullptr)
+	{
+		//the oldest allocator is reused once its copies are done, otherwise there is one more
+		if (!submittedAllocators.empty() && submittedAllocators.front().fenceValue <= fence->GetCompletedValue())
+		{
+			openAllocator = submittedAllocators.front().allocator;
+			submittedAllocators.pop_front();
+			openAllocator->Reset();
+		}
+		else
+		{
+			if (!SUCCEEDED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&openAllocator))))
+			{
+				OutputDebugStringA("ERROR: Could not create a copy command allocator!\n");
+				openAllocator = nullptr;
+				return;
+			}
+			allocators.push_back(openAllocator);
+		}
+
+		if (commandList == nullptr)
+		{
+			if (!SUCCEEDED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, openAllocator, nullptr, IID_PPV_ARGS(&commandList))))
+			{
+				OutputDebugStringA("ERROR: Could not create the copy command list!\n");
+				commandList = nullptr;
+				return;
+			}
+			commandList->SetName(L"copy list");
+		}
+		else
+		{
+			commandList->Reset(openAllocator, nullptr);
+		}
+	}
+
+	commandList->CopyBufferRegion((ID3D12Resource*)destination, destinationOffset, staging, stagingOffset, size);
+}
+
+unsigned long long D3D12CopyQueue::Submit()
+{
+	if (openAllocator == nullptr)
+	{
+		return fenceValue;
+	}
+
+	if (!SUCCEEDED(commandList->Close()))
+	{
+		OutputDebugStringA("ERROR: Could not close the copy command list!\n");
+	}
+	ID3D12CommandList* listsToExecute[] = { commandList };
+	queue->ExecuteCommandLists(ARRAYSIZE(listsToExecute), listsToExecute);
+	queue->Signal(fence, ++fenceValue);
+
+	SubmittedAllocator submitted = { openAllocator, fenceValue };
+	submittedAllocators.push_back(submitted);
+	openAllocator = nullptr;
+
+	return fenceValue;
+}
+
+unsigned long long D3D12CopyQueue::GetCompletedValue()
+{
+	return fence->GetCompletedValue();
+}
+
+void D3D12CopyQueue::Wait(unsigned long long fenceValue)
+{
+	if (fence->GetCompletedValue() < fenceValue)
+	{
+		fence->SetEventOnCompletion(fenceValue, eventHandle);
+		WaitForSingleObject(eventHandle, INFINITE);
+	}
+}
+
+ID3D12Fence1* D3D12CopyQueue::GetFence()
+{
+	return this->fence;
+}
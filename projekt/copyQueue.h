@@ -0,0 +1,54 @@
+#pragma once
+#include <d3d12.h>
+#include <deque>
+#include <vector>
+#include "geometryUploader.h"
+
+// A d3d copy queue with its own fence and one persistently mapped staging buffer. The
+// destinations of Copy are ID3D12Resource buffers, they are used in the common state so the
+// copy queue and the direct queue promote them on their own.
+class D3D12CopyQueue : public CopyQueue
+{
+public:
+	D3D12CopyQueue();
+	~D3D12CopyQueue();
+
+	bool Create(ID3D12Device5* device, UINT64 stagingSize);
+
+	unsigned char* GetStaging();
+	unsigned long long GetStagingSize();
+
+	void Copy(void* destination, unsigned long long destinationOffset, unsigned long long stagingOffset, unsigned long long size);
+	unsigned long long Submit();
+	unsigned long long GetCompletedValue();
+	void Wait(unsigned long long fenceValue);
+
+	// other queues wait on this for the copies to be done
+	ID3D12Fence1* GetFence();
+
+private:
+	D3D12CopyQueue(const D3D12CopyQueue&) = delete;
+	D3D12CopyQueue& operator=(const D3D12CopyQueue&) = delete;
+
+	// an allocator can be reset once the fence value of the batch it recorded has been reached
+	struct SubmittedAllocator
+	{
+		ID3D12CommandAllocator* allocator;
+		UINT64 fenceValue;
+	};
+
+	ID3D12Device5* device;
+	ID3D12CommandQueue* queue;
+	ID3D12GraphicsCommandList* commandList;
+	ID3D12CommandAllocator* openAllocator;	// the one the list records into, nullptr while it is closed
+	std::deque<SubmittedAllocator> submittedAllocators;
+	std::vector<ID3D12CommandAllocator*> allocators;
+
+	ID3D12Fence1* fence;
+	UINT64 fenceValue;
+	HANDLE eventHandle;
+
+	ID3D12Resource* staging;
+	unsigned char* mappedStaging;
+	UINT64 stagingSize;
+};
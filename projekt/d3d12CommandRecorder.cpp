@@ -0,0 +1,69 @@
+#include "d3d12CommandRecorder.h"
+
+D3D12CommandRecorder::D3D12CommandRecorder(ID3D12GraphicsCommandList* commandList, D3D12::D3D12Timer* timer, UINT firstTimer)
+{
+	this->commandList = commandList;
+	this->timer = timer;
+	this->nextTimer = firstTimer;
+}
+
+void D3D12CommandRecorder::ResourceBarrier(UINT nrOfBarriers, const D3D12_RESOURCE_BARRIER* barriers)
+{
+	commandList->ResourceBarrier(nrOfBarriers, barriers);
+}
+
+void D3D12CommandRecorder::SetDescriptorHeaps(UINT nrOfHeaps, ID3D12DescriptorHeap* const* heaps)
+{
+	commandList->SetDescriptorHeaps(nrOfHeaps, heaps);
+}
+
+void D3D12CommandRecorder::SetGraphicsRootSignature(ID3D12RootSignature* rootSignature)
+{
+	commandList->SetGraphicsRootSignature(rootSignature);
+}
+
+void D3D12CommandRecorder::SetPipelineState(ID3D12PipelineState* pipelineState)
+{
+	commandList->SetPipelineState(pipelineState);
+}
+
+void D3D12CommandRecorder::SetGraphicsRootDescriptorTable(UINT rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE table)
+{
+	commandList->SetGraphicsRootDescriptorTable(rootIndex, table);
+}
+
+void D3D12CommandRecorder::SetGraphicsRootShaderResourceView(UINT rootIndex, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+	commandList->SetGraphicsRootShaderResourceView(rootIndex, address);
+}
+
+void D3D12CommandRecorder::SetGraphicsRoot32BitConstants(UINT rootIndex, UINT nrOfValues, const void* data, UINT offset)
+{
+	commandList->SetGraphicsRoot32BitConstants(rootIndex, nrOfValues, data, offset);
+}
+
+void D3D12CommandRecorder::IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)
+{
+	commandList->IASetPrimitiveTopology(topology);
+}
+
+void D3D12CommandRecorder::IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view)
+{
+	commandList->IASetIndexBuffer(view);
+}
+
+void D3D12CommandRecorder::DrawIndexedInstanced(UINT indicesPerInstance, UINT nrOfInstances, UINT startIndex, INT baseVertex, UINT startInstance)
+{
+	if (timer != nullptr)
+	{
+		timer->start(commandList, nextTimer);
+	}
+
+	commandList->DrawIndexedInstanced(indicesPerInstance, nrOfInstances, startIndex, baseVertex, startInstance);
+
+	if (timer != nullptr)
+	{
+		timer->stop(commandList, nextTimer);
+		nextTimer++;
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "commandRecorder.h"
+#include "D3D12Timer.h"
+
+// Records into a command list. With a timer every draw is timed, the first draw uses timer firstTimer.
+class D3D12CommandRecorder : public CommandRecorder
+{
+public:
+	D3D12CommandRecorder(ID3D12GraphicsCommandList* commandList, D3D12::D3D12Timer* timer = nullptr, UINT firstTimer = 0);
+
+	void ResourceBarrier(UINT nrOfBarriers, const D3D12_RESOURCE_BARRIER* barriers);
+	void SetDescriptorHeaps(UINT nrOfHeaps, ID3D12DescriptorHeap* const* heaps);
+	void SetGraphicsRootSignature(ID3D12RootSignature* rootSignature);
+	void SetPipelineState(ID3D12PipelineState* pipelineState);
+	void SetGraphicsRootDescriptorTable(UINT rootIndex, D3D12_GPU_DESCRIPTOR_HANDLE table);
+	void SetGraphicsRootShaderResourceView(UINT rootIndex, D3D12_GPU_VIRTUAL_ADDRESS address);
+	void SetGraphicsRoot32BitConstants(UINT rootIndex, UINT nrOfValues, const void* data, UINT offset);
+	void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology);
+	void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view);
+	void DrawIndexedInstanced(UINT indicesPerInstance, UINT nrOfInstances, UINT startIndex, INT baseVertex, UINT startInstance);
+
+private:
+	ID3D12GraphicsCommandList* commandList;
+	D3D12::D3D12Timer* timer;
+	UINT nextTimer;
+};
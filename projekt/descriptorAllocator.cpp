@@ -0,0 +1,104 @@
+#include "descriptorAllocator.h"
+
+DescriptorAllocator::DescriptorAllocator()
+{
+	Reset(0);
+}
+
+DescriptorAllocator::~DescriptorAllocator()
+{
+}
+
+void DescriptorAllocator::Reset(unsigned int capacity)
+{
+	this->capacity = capacity;
+	this->used = 0;
+	this->nrOfAllocations = 0;
+
+	freeBlocks.clear();
+	if (capacity > 0)
+	{
+		freeBlocks[0] = capacity;
+	}
+}
+
+unsigned int DescriptorAllocator::Allocate(unsigned int count)
+{
+	if (count == 0)
+	{
+		return INVALID;
+	}
+
+	for (std::map<unsigned int, unsigned int>::iterator it = freeBlocks.begin(); it != freeBlocks.end(); ++it)
+	{
+		if (it->second < count)
+		{
+			continue;
+		}
+
+		// the allocation is taken from the start of the block, the rest stays free
+		unsigned int first = it->first;
+		unsigned int rest = it->second - count;
+		freeBlocks.erase(it);
+		if (rest > 0)
+		{
+			freeBlocks[first + count] = rest;
+		}
+
+		used += count;
+		nrOfAllocations++;
+		return first;
+	}
+
+	return INVALID;
+}
+
+void DescriptorAllocator::Free(unsigned int first, unsigned int count)
+{
+	if (first == INVALID || count == 0)
+	{
+		return;
+	}
+
+	used -= count;
+	nrOfAllocations--;
+
+	// merge with the free block after the range and with the one before it
+	std::map<unsigned int, unsigned int>::iterator next = freeBlocks.lower_bound(first);
+	if (next != freeBlocks.end() && first + count == next->first)
+	{
+		count += next->second;
+		next = freeBlocks.erase(next);
+	}
+
+	if (next != freeBlocks.begin())
+	{
+		std::map<unsigned int, unsigned int>::iterator previous = next;
+		--previous;
+		if (previous->first + previous->second == first)
+		{
+			previous->second += count;
+			return;
+		}
+	}
+
+	freeBlocks[first] = count;
+}
+
+DescriptorAllocatorStats DescriptorAllocator::GetStats()
+{
+	DescriptorAllocatorStats stats;
+	stats.capacity = capacity;
+	stats.used = used;
+	stats.nrOfAllocations = nrOfAllocations;
+	stats.nrOfFreeBlocks = (unsigned int)freeBlocks.size();
+	stats.largestFreeBlock = 0;
+	for (std::map<unsigned int, unsigned int>::iterator it = freeBlocks.begin(); it != freeBlocks.end(); ++it)
+	{
+		stats.largestFreeBlock = it->second > stats.largestFreeBlock ? it->second : stats.largestFreeBlock;
+	}
+
+	unsigned int free = capacity - used;
+	stats.fragmentation = free > 0 ? 1.0 - (double)stats.largestFreeBlock / free : 0.0;
+	return stats;
+}
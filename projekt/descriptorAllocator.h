@@ -0,0 +1,43 @@
+#pragma once
+#include <map>
+
+// how full the allocator is and how its free space is split up
+struct DescriptorAllocatorStats
+{
+	unsigned int capacity;
+	unsigned int used;
+	unsigned int nrOfAllocations;
+	unsigned int nrOfFreeBlocks;
+	unsigned int largestFreeBlock;
+	// 0 when all free space is one block, close to 1 when it is split into many small ones
+	double fragmentation;
+};
+
+// Hands out ranges of descriptor slots 0..capacity-1. The free ranges are kept sorted by their
+// first slot, an allocation takes the first one that is big enough and a freed range is merged
+// with the free ranges next to it. Knows nothing about d3d, so it can be tested on its own.
+class DescriptorAllocator
+{
+public:
+	static const unsigned int INVALID = 0xFFFFFFFF;
+
+	DescriptorAllocator();
+	~DescriptorAllocator();
+
+	// forgets all allocations
+	void Reset(unsigned int capacity);
+
+	// returns the first slot of count slots in a row, INVALID if there is no such range
+	unsigned int Allocate(unsigned int count);
+	// the slot and count of an earlier allocation
+	void Free(unsigned int first, unsigned int count);
+
+	DescriptorAllocatorStats GetStats();
+
+private:
+	// first slot -> number of slots
+	std::map<unsigned int, unsigned int> freeBlocks;
+	unsigned int capacity;
+	unsigned int used;
+	unsigned int nrOfAllocations;
+};
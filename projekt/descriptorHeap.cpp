@@ -0,0 +1,81 @@
+#include "descriptorHeap.h"
+
+DescriptorHeap::DescriptorHeap()
+{
+	heap = nullptr;
+	descriptorSize = 0;
+	cpuStart.ptr = 0;
+	gpuStart.ptr = 0;
+}
+
+DescriptorHeap::~DescriptorHeap()
+{
+	if (heap != nullptr)
+	{
+		heap->Release();
+	}
+}
+
+bool DescriptorHeap::Create(ID3D12Device5* device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT capacity, bool shaderVisible)
+{
+	D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+	desc.NumDescriptors = capacity;
+	desc.Type = type;
+	desc.Flags = shaderVisible ? D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE : D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+	if (!SUCCEEDED(device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&heap))))
+	{
+		OutputDebugStringA("ERROR: Could not create Descriptor Heap");
+		heap = nullptr;
+		return false;
+	}
+	heap->SetName(L"Global Descriptor Heap");
+
+	descriptorSize = device->GetDescriptorHandleIncrementSize(type);
+	cpuStart = heap->GetCPUDescriptorHandleForHeapStart();
+	if (shaderVisible)
+	{
+		gpuStart = heap->GetGPUDescriptorHandleForHeapStart();
+	}
+	allocator.Reset(capacity);
+
+	return true;
+}
+
+UINT DescriptorHeap::Allocate(UINT count)
+{
+	UINT first = allocator.Allocate(count);
+	if (first == DescriptorAllocator::INVALID)
+	{
+		OutputDebugStringA("ERROR: The descriptor heap is full!\n");
+	}
+	return first;
+}
+
+void DescriptorHeap::Free(UINT first, UINT count)
+{
+	allocator.Free(first, count);
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE DescriptorHeap::GetCpuHandle(UINT index)
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE handle = cpuStart;
+	handle.ptr += (SIZE_T)index * descriptorSize;
+	return handle;
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE DescriptorHeap::GetGpuHandle(UINT index)
+{
+	D3D12_GPU_DESCRIPTOR_HANDLE handle = gpuStart;
+	handle.ptr += (UINT64)index * descriptorSize;
+	return handle;
+}
+
+ID3D12DescriptorHeap* DescriptorHeap::GetHeap()
+{
+	return this->heap;
+}
+
+DescriptorAllocatorStats DescriptorHeap::GetStats()
+{
+	return allocator.GetStats();
+}
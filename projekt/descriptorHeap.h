@@ -0,0 +1,33 @@
+#pragma once
+#include <d3d12.h>
+#include "descriptorAllocator.h"
+
+// One descriptor heap that the descriptors of many resources are allocated from, so a command
+// list only has to set it once. Allocations are made from the thread that loads the assets.
+class DescriptorHeap
+{
+public:
+	DescriptorHeap();
+	~DescriptorHeap();
+
+	bool Create(ID3D12Device5* device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT capacity, bool shaderVisible);
+
+	// returns the index of the first of count descriptors in a row, DescriptorAllocator::INVALID if the heap is full
+	UINT Allocate(UINT count);
+	void Free(UINT first, UINT count);
+
+	D3D12_CPU_DESCRIPTOR_HANDLE GetCpuHandle(UINT index);
+	D3D12_GPU_DESCRIPTOR_HANDLE GetGpuHandle(UINT index);
+	ID3D12DescriptorHeap* GetHeap();
+	DescriptorAllocatorStats GetStats();
+
+private:
+	DescriptorHeap(const DescriptorHeap&) = delete;
+	DescriptorHeap& operator=(const DescriptorHeap&) = delete;
+
+	ID3D12DescriptorHeap* heap;
+	UINT descriptorSize;
+	D3D12_CPU_DESCRIPTOR_HANDLE cpuStart;
+	D3D12_GPU_DESCRIPTOR_HANDLE gpuStart;
+	DescriptorAllocator allocator;
+};
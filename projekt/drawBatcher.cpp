@@ -0,0 +1,133 @@
+#include "drawBatcher.h"
+#include <string.h>
+#include <assert.h>
+
+UINT64 DrawBatcher::MakeSortKey(UINT pipeline, UINT texture, UINT mesh, float depth)
+{
+	//an id that does not fit would share its key with another mesh or texture
+	assert(pipeline < (1u << SORT_PIPELINE_BITS));
+	assert(texture < (1u << SORT_TEXTURE_BITS));
+	assert(mesh < (1u << SORT_MESH_BITS));
+
+	//positive floats sort like their bits, the sign bit is 0 so the top bits are enough
+	UINT depthBits = 0;
+	if (depth > 0.0f)
+	{
+		memcpy(&depthBits, &depth, sizeof(depthBits));
+		depthBits >>= 32 - SORT_DEPTH_BITS;
+	}
+
+	UINT64 key = pipeline & ((1u << SORT_PIPELINE_BITS) - 1);
+	key = (key << SORT_TEXTURE_BITS) | (texture & ((1u << SORT_TEXTURE_BITS) - 1));
+	key = (key << SORT_MESH_BITS) | (mesh & ((1u << SORT_MESH_BITS) - 1));
+	key = (key << SORT_DEPTH_BITS) | depthBits;
+	return key;
+}
+
+void DrawBatcher::Build(const std::vector<DrawState>& states, std::vector<int>& visibleObjects, const std::vector<float>& depths)
+{
+	//the depth is the distance along the view direction. An object whose texture could not be
+	//loaded has no srvs to bind, it is left out instead of drawn with an empty table
+	sortItems.clear();
+	for (size_t i = 0; i < visibleObjects.size(); i++)
+	{
+		const DrawState& state = states[visibleObjects[i]];
+		if (state.textureTable.ptr == 0)
+		{
+			continue;
+		}
+
+		SortItem item;
+		item.key = state.key | MakeSortKey(0, 0, 0, depths[i]);
+		item.value = visibleObjects[i];
+		sortItems.push_back(item);
+	}
+	RadixSort::Sort(sortItems, sortScratch);
+
+	//a batch is a run of keys that only differ in the depth
+	visibleObjects.resize(sortItems.size());
+	batches.clear();
+	for (size_t i = 0; i < sortItems.size(); i++)
+	{
+		visibleObjects[i] = sortItems[i].value;
+		if (!batches.empty() && (sortItems[i].key >> SORT_DEPTH_BITS) == (sortItems[i - 1].key >> SORT_DEPTH_BITS))
+		{
+			batches.back().nrOfInstances++;
+			continue;
+		}
+
+		DrawBatch batch;
+		batch.object = visibleObjects[i];
+		batch.firstInstance = (int)i;
+		batch.nrOfInstances = 1;
+		batches.push_back(batch);
+	}
+}
+
+const std::vector<DrawBatch>& DrawBatcher::GetBatches()
+{
+	return this->batches;
+}
+
+void DrawBatcher::Clear()
+{
+	batches.clear();
+}
+
+void DrawBatcher::Record(CommandRecorder* recorder, const std::vector<DrawState>& states, const DrawBindings& bindings, int first, int last)
+{
+	//Set root signature
+	recorder->SetGraphicsRootSignature(bindings.rootSignature);
+
+	//every texture has its srvs in the shader visible heap, the draws only move the table
+	ID3D12DescriptorHeap* descriptorHeaps[] = { bindings.descriptorHeap };
+	recorder->SetDescriptorHeaps(1, descriptorHeaps);
+
+	//all meshes are in the geometry pool, the draws only pick their range
+	recorder->SetGraphicsRootShaderResourceView(Positions, bindings.positions);
+	recorder->SetGraphicsRootShaderResourceView(UV, bindings.uvs);
+
+	for (int i = first; i < last; i++)
+	{
+		const DrawBatch& batch = batches[i];
+		const DrawState& state = states[batch.object];
+
+		recorder->SetPipelineState(state.pipelineState);
+
+		recorder->SetGraphicsRootDescriptorTable(TextureDT, state.textureTable);
+
+		recorder->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+		recorder->IASetIndexBuffer(state.indexBuffer);
+		recorder->SetGraphicsRoot32BitConstants(BaseVertex, 1, &state.firstVertex, 0);
+
+		// SV_InstanceID starts at 0 in every draw, so the view starts at the first instance of the batch
+		recorder->SetGraphicsRootShaderResourceView(Instances, bindings.instances + (UINT64)bindings.instanceSize * batch.firstInstance);
+
+		recorder->DrawIndexedInstanced(state.nrOfIndices, batch.nrOfInstances, state.firstIndex, state.firstVertex, 0);
+	}
+}
+
+std::vector<ObjectRange> DrawBatcher::Split(int nrOfDraws, int maxChunks, int minPerChunk)
+{
+	int nrOfChunks = minPerChunk > 0 ? nrOfDraws / minPerChunk : nrOfDraws;
+	nrOfChunks = nrOfChunks < 1 ? 1 : (nrOfChunks > maxChunks ? maxChunks : nrOfChunks);
+
+	std::vector<ObjectRange> chunks;
+	if (nrOfDraws <= 0)
+	{
+		return chunks;
+	}
+
+	int first = 0;
+	for (int i = 0; i < nrOfChunks; i++)
+	{
+		ObjectRange chunk;
+		chunk.first = first;
+		chunk.last = (int)((long long)nrOfDraws * (i + 1) / nrOfChunks);
+		chunks.push_back(chunk);
+		first = chunk.last;
+	}
+
+	return chunks;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <d3d12.h>
+#include <vector>
+#include "commandRecorder.h"
+#include "radixSort.h"
+
+// the root parameters of the root signature, Renderer::CreateRootSignature makes it
+enum types
+{
+	Positions,
+	UV,
+	Instances,
+	TextureDT,
+	BaseVertex,
+	TYPE_SIZE
+};
+
+// bits of the draw sort key, from the most significant: pipeline state, texture (its descriptor
+// table), mesh and the depth. The depth is last so the objects of a batch are drawn front to back.
+const int SORT_PIPELINE_BITS = 12;
+const int SORT_TEXTURE_BITS = 16;
+const int SORT_MESH_BITS = 16;
+const int SORT_DEPTH_BITS = 20;
+
+// what the draw of an object sets, the same in every frame
+struct DrawState
+{
+	UINT64 key;		// pipeline state, texture and mesh part of the sort key, see DrawBatcher::MakeSortKey
+	ID3D12PipelineState* pipelineState;
+	D3D12_GPU_DESCRIPTOR_HANDLE textureTable;	// the srvs of the texture, 0 if it could not be loaded
+	const D3D12_INDEX_BUFFER_VIEW* indexBuffer;
+	UINT nrOfIndices;
+	UINT firstIndex;
+	UINT firstVertex;
+};
+
+// what every draw of a frame reads, bound once per command list
+struct DrawBindings
+{
+	ID3D12RootSignature* rootSignature;
+	ID3D12DescriptorHeap* descriptorHeap;
+	D3D12_GPU_VIRTUAL_ADDRESS positions;
+	D3D12_GPU_VIRTUAL_ADDRESS uvs;
+	D3D12_GPU_VIRTUAL_ADDRESS instances;	// the frame's per instance data, in draw order
+	UINT instanceSize;
+};
+
+// instances firstInstance.. of the visible objects, they all share the DrawState of object
+struct DrawBatch
+{
+	int object;
+	int firstInstance;
+	int nrOfInstances;
+};
+
+// objects or draws first..last-1
+struct ObjectRange
+{
+	int first;
+	int last;
+};
+
+// Sorts the visible objects by their sort keys so the objects that share a mesh, texture and
+// pipeline state follow each other, and records every run of them as one instanced draw. Only
+// knows the DrawState of the objects, so it is tested with a RecordingCommandRecorder.
+class DrawBatcher
+{
+public:
+	// the ids have to fit their bits, the mesh and texture ids are the ones of the AssetCache
+	static UINT64 MakeSortKey(UINT pipeline, UINT texture, UINT mesh, float depth);
+
+	// sorts visibleObjects, indices into states, by their keys and depths (one per visible object)
+	// and makes the batches. The objects are in draw order afterwards, without the ones that have
+	// no texture table.
+	void Build(const std::vector<DrawState>& states, std::vector<int>& visibleObjects, const std::vector<float>& depths);
+	const std::vector<DrawBatch>& GetBatches();
+	void Clear();
+
+	// records the batches first..last-1 and binds what they read first. Called from several threads
+	// at the same time, one range each, every command is set for every draw so the recorder should
+	// drop the redundant ones.
+	void Record(CommandRecorder* recorder, const std::vector<DrawState>& states, const DrawBindings& bindings, int first, int last);
+
+	// as few chunks as possible, at most maxChunks, while every one gets at least minPerChunk of the
+	// nrOfDraws, spread evenly over them
+	static std::vector<ObjectRange> Split(int nrOfDraws, int maxChunks, int minPerChunk);
+
+private:
+	std::vector<SortItem> sortItems;
+	std::vector<SortItem> sortScratch;
+	std::vector<DrawBatch> batches;
+};
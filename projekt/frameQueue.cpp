@@ -0,0 +1,60 @@
+#include "frameQueue.h"
+
+D3D12FrameQueue::D3D12FrameQueue()
+{
+	queue = nullptr;
+	fence = nullptr;
+	fenceValue = 0;
+	eventHandle = nullptr;
+}
+
+D3D12FrameQueue::~D3D12FrameQueue()
+{
+	if (fence != nullptr)
+	{
+		fence->Release();
+	}
+	if (eventHandle != nullptr)
+	{
+		CloseHandle(eventHandle);
+	}
+}
+
+bool D3D12FrameQueue::Create(ID3D12Device5* device, ID3D12CommandQueue* queue)
+{
+	this->queue = queue;
+	if (!SUCCEEDED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+	{
+		OutputDebugStringA("ERROR: Could not create Fence!\n");
+		fence = nullptr;
+		return false;
+	}
+	fenceValue = 0;
+
+	//Create an event handle to use for GPU synchronization.
+	eventHandle = CreateEvent(0, false, false, 0);
+	return true;
+}
+
+unsigned long long D3D12FrameQueue::Signal()
+{
+	//Signal and increment the fence value.
+	fenceValue++;
+	queue->Signal(fence, fenceValue);
+	return fenceValue;
+}
+
+unsigned long long D3D12FrameQueue::GetCompletedValue()
+{
+	return fence->GetCompletedValue();
+}
+
+void D3D12FrameQueue::Wait(unsigned long long fenceValue)
+{
+	//Wait until command queue is done.
+	if (fence->GetCompletedValue() < fenceValue)
+	{
+		fence->SetEventOnCompletion(fenceValue, eventHandle);
+		WaitForSingleObject(eventHandle, INFINITE);
+	}
+}
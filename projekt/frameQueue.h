@@ -0,0 +1,26 @@
+#pragma once
+#include <d3d12.h>
+#include "frameScheduler.h"
+
+// The fence of the direct queue the frames are executed on
+class D3D12FrameQueue : public FrameQueue
+{
+public:
+	D3D12FrameQueue();
+	~D3D12FrameQueue();
+
+	bool Create(ID3D12Device5* device, ID3D12CommandQueue* queue);
+
+	unsigned long long Signal();
+	unsigned long long GetCompletedValue();
+	void Wait(unsigned long long fenceValue);
+
+private:
+	D3D12FrameQueue(const D3D12FrameQueue&) = delete;
+	D3D12FrameQueue& operator=(const D3D12FrameQueue&) = delete;
+
+	ID3D12CommandQueue* queue;
+	ID3D12Fence1* fence;
+	UINT64 fenceValue;	// last value the queue signals
+	HANDLE eventHandle;
+};
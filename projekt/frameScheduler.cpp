@@ -0,0 +1,153 @@
+#include "frameScheduler.h"
+#include <chrono>
+
+FrameScheduler::FrameScheduler()
+{
+	queue = nullptr;
+	ring = nullptr;
+	latency = 1;
+	frameCount = 0;
+	waitTime = 0.0;
+}
+
+FrameScheduler::~FrameScheduler()
+{
+	for (size_t i = 0; i < contexts.size(); i++)
+	{
+		for (size_t j = 0; j < contexts[i].uploadHeaps.size(); j++)
+		{
+			contexts[i].uploadHeaps[j]->Release();
+		}
+	}
+	for (size_t i = 0; i < openUploadHeaps.size(); i++)
+	{
+		openUploadHeaps[i]->Release();
+	}
+}
+
+void FrameScheduler::Reset(FrameQueue* queue, RingAllocator* ring, unsigned int nrOfContexts)
+{
+	this->queue = queue;
+	this->ring = ring;
+	contexts.resize(nrOfContexts < 1 ? 1 : nrOfContexts);
+	for (size_t i = 0; i < contexts.size(); i++)
+	{
+		contexts[i].fenceValue = 0;
+	}
+	latency = (unsigned int)contexts.size();
+	frameCount = 0;
+	waitTime = 0.0;
+}
+
+void FrameScheduler::SetLatency(unsigned int frames)
+{
+	this->latency = frames < 1 ? 1 : (frames > contexts.size() ? (unsigned int)contexts.size() : frames);
+}
+
+unsigned int FrameScheduler::GetLatency()
+{
+	return this->latency;
+}
+
+unsigned int FrameScheduler::BeginFrame()
+{
+	//the frame latency frames ago has to be done. The frames in between use the other contexts,
+	//so the fence value of its context is still the one of that frame
+	if (frameCount >= latency)
+	{
+		WaitForFenceValue(contexts[(frameCount - latency) % contexts.size()].fenceValue);
+	}
+
+	//the context is reused once the gpu is done with the frame that used it last
+	unsigned int context = (unsigned int)(frameCount % contexts.size());
+	WaitForFenceValue(contexts[context].fenceValue);
+	Retire();
+	return context;
+}
+
+void FrameScheduler::ReleaseAfterFrame(ID3D12Resource* uploadHeap)
+{
+	openUploadHeaps.push_back(uploadHeap);
+}
+
+unsigned long long FrameScheduler::EndFrame()
+{
+	Context& context = contexts[frameCount % contexts.size()];
+	context.fenceValue = queue->Signal();
+	context.uploadHeaps.insert(context.uploadHeaps.end(), openUploadHeaps.begin(), openUploadHeaps.end());
+	openUploadHeaps.clear();
+	if (ring != nullptr)
+	{
+		ring->FinishFrame(context.fenceValue);
+	}
+	frameCount++;
+	return context.fenceValue;
+}
+
+bool FrameScheduler::WaitForOldestFrame()
+{
+	unsigned long long oldest = ring != nullptr ? ring->GetOldestFenceValue() : 0;
+	if (oldest == 0)
+	{
+		return false;
+	}
+
+	WaitForFenceValue(oldest);
+	Retire();
+	return true;
+}
+
+void FrameScheduler::WaitForIdle()
+{
+	WaitForFenceValue(queue->Signal());
+	Retire();
+}
+
+unsigned long long FrameScheduler::GetFrameCount()
+{
+	return this->frameCount;
+}
+
+unsigned long long FrameScheduler::GetFenceValue(unsigned int context)
+{
+	return this->contexts[context].fenceValue;
+}
+
+double FrameScheduler::GetWaitTime()
+{
+	return this->waitTime;
+}
+
+void FrameScheduler::WaitForFenceValue(unsigned long long fenceValue)
+{
+	if (queue->GetCompletedValue() >= fenceValue)
+	{
+		return;
+	}
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	queue->Wait(fenceValue);
+	waitTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void FrameScheduler::Retire()
+{
+	unsigned long long completed = queue->GetCompletedValue();
+	if (ring != nullptr)
+	{
+		ring->Retire(completed);
+	}
+
+	//the heaps given to the frame that is recorded are not in a context yet, so they are never released here
+	for (size_t i = 0; i < contexts.size(); i++)
+	{
+		if (contexts[i].fenceValue <= completed)
+		{
+			for (size_t j = 0; j < contexts[i].uploadHeaps.size(); j++)
+			{
+				contexts[i].uploadHeaps[j]->Release();
+			}
+			contexts[i].uploadHeaps.clear();
+		}
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <d3d12.h>
+#include <vector>
+#include "ringAllocator.h"
+
+// Where the frames are executed. D3D12FrameQueue signals a fence on the direct queue, the stand-in
+// in tests/frameSchedulerTest.cpp finishes the frames only when the test lets it.
+class FrameQueue
+{
+public:
+	virtual ~FrameQueue() {}
+
+	// the returned fence value is reached once everything submitted so far has been executed
+	virtual unsigned long long Signal() = 0;
+	virtual unsigned long long GetCompletedValue() = 0;
+	// blocks until the fence value has been reached
+	virtual void Wait(unsigned long long fenceValue) = 0;
+};
+
+// The bookkeeping of the frames the cpu records while the gpu still executes earlier ones. The frames
+// use the contexts in turn, a context is only used again once the gpu is done with the frame that used
+// it last, and the cpu is at most latency frames ahead of the gpu. The frames of the ring and the
+// upload heaps given to a frame are kept until the gpu has executed it. Used from the thread that
+// records the frames.
+class FrameScheduler
+{
+public:
+	FrameScheduler();
+	// releases the upload heaps that are left, the gpu has to be done with them (see WaitForIdle)
+	~FrameScheduler();
+
+	// ring holds the per frame data, it is retired as the frames finish. The latency is nrOfContexts.
+	void Reset(FrameQueue* queue, RingAllocator* ring, unsigned int nrOfContexts);
+	// 1..nrOfContexts, 1 waits for the gpu before every frame
+	void SetLatency(unsigned int frames);
+	unsigned int GetLatency();
+
+	// waits until the next frame may be recorded and returns the index of its context. What the
+	// frames the gpu is done with kept is released.
+	unsigned int BeginFrame();
+	// the upload heap is released once the gpu has executed the frame that is recorded
+	void ReleaseAfterFrame(ID3D12Resource* uploadHeap);
+	// the recorded frame has been submitted, returns the fence value the gpu reaches after it
+	unsigned long long EndFrame();
+
+	// waits for the oldest frame that still holds a part of the ring, false if there is none
+	bool WaitForOldestFrame();
+	// waits until the gpu has executed everything and releases what the frames kept
+	void WaitForIdle();
+
+	unsigned long long GetFrameCount();
+	// fence value of the last frame that used the context, 0 before its first frame
+	unsigned long long GetFenceValue(unsigned int context);
+	// ms the cpu waited for the gpu, in all frames together
+	double GetWaitTime();
+
+private:
+	FrameScheduler(const FrameScheduler&) = delete;
+	FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+	void WaitForFenceValue(unsigned long long fenceValue);
+	// retires the ring and releases the upload heaps of the frames the gpu is done with
+	void Retire();
+
+	struct Context
+	{
+		unsigned long long fenceValue;
+		std::vector<ID3D12Resource*> uploadHeaps;
+	};
+
+	FrameQueue* queue;
+	RingAllocator* ring;
+	std::vector<Context> contexts;
+	// given to the frame that is recorded, they move to its context once it has a fence value
+	std::vector<ID3D12Resource*> openUploadHeaps;
+	unsigned int latency;
+	unsigned long long frameCount;
+	double waitTime;
+};
@@ -0,0 +1,141 @@
+#include "geometryPool.h"
+
+GeometryPool::GeometryPool()
+{
+	positions = nullptr;
+	uvs = nullptr;
+	indices = nullptr;
+	indexBufferViews[0] = {};
+	indexBufferViews[1] = {};
+}
+
+GeometryPool::~GeometryPool()
+{
+	if (positions != nullptr)
+	{
+		positions->Release();
+	}
+	if (uvs != nullptr)
+	{
+		uvs->Release();
+	}
+	if (indices != nullptr)
+	{
+		indices->Release();
+	}
+}
+
+void GeometryPool::Create(ID3D12Device5* device, UINT maxVertices, UINT indexBufferSize)
+{
+	positions = CreateBuffer(device, sizeof(float) * 3 * (UINT64)maxVertices, L"geometry pool positions");
+	uvs = CreateBuffer(device, sizeof(float) * 2 * (UINT64)maxVertices, L"geometry pool uvs");
+	indices = CreateBuffer(device, indexBufferSize, L"geometry pool indices");
+
+	vertexAllocator.Reset(positions != nullptr && uvs != nullptr ? maxVertices : 0);
+	indexAllocator.Reset(indices != nullptr ? indexBufferSize / INDEX_UNIT : 0);
+
+	//the start index of a draw picks the mesh, the views always cover the whole buffer
+	if (indices != nullptr)
+	{
+		indexBufferViews[0].BufferLocation = indices->GetGPUVirtualAddress();
+		indexBufferViews[0].SizeInBytes = indexBufferSize;
+		indexBufferViews[0].Format = DXGI_FORMAT_R16_UINT;
+		indexBufferViews[1] = indexBufferViews[0];
+		indexBufferViews[1].Format = DXGI_FORMAT_R32_UINT;
+	}
+}
+
+bool GeometryPool::Add(GeometryUploader* uploader, const float* positions, const float* uvs, UINT nrOfVertices,
+	const void* indices, UINT indexSize, UINT nrOfIndices, MeshRange& range)
+{
+	UINT indexUnits = (UINT)(((UINT64)indexSize * nrOfIndices + INDEX_UNIT - 1) / INDEX_UNIT);
+
+	range.firstVertex = vertexAllocator.Allocate(nrOfVertices);
+	range.indexOffset = indexAllocator.Allocate(indexUnits);
+	if (range.firstVertex == TlsfAllocator::INVALID || range.indexOffset == TlsfAllocator::INVALID)
+	{
+		OutputDebugStringA("ERROR: The geometry pool is full!\n");
+		vertexAllocator.Free(range.firstVertex);
+		indexAllocator.Free(range.indexOffset);
+		range = {};
+		range.firstVertex = TlsfAllocator::INVALID;
+		range.indexOffset = TlsfAllocator::INVALID;
+		return false;
+	}
+
+	range.nrOfVertices = nrOfVertices;
+	range.nrOfIndices = nrOfIndices;
+	range.indexFormat = indexSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+	range.firstIndex = range.indexOffset * INDEX_UNIT / indexSize;
+
+	//the streams stay separate, the vertex shader reads them as structured buffers
+	uploader->Upload(this->positions, sizeof(float) * 3 * (UINT64)range.firstVertex, positions, sizeof(float) * 3 * (UINT64)nrOfVertices);
+	uploader->Upload(this->uvs, sizeof(float) * 2 * (UINT64)range.firstVertex, uvs, sizeof(float) * 2 * (UINT64)nrOfVertices);
+	uploader->Upload(this->indices, (UINT64)range.indexOffset * INDEX_UNIT, indices, (UINT64)indexSize * nrOfIndices);
+	return true;
+}
+
+void GeometryPool::Remove(const MeshRange& range)
+{
+	vertexAllocator.Free(range.firstVertex);
+	indexAllocator.Free(range.indexOffset);
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS GeometryPool::GetPositions()
+{
+	return this->positions->GetGPUVirtualAddress();
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS GeometryPool::GetUVs()
+{
+	return this->uvs->GetGPUVirtualAddress();
+}
+
+const D3D12_INDEX_BUFFER_VIEW* GeometryPool::GetIndexBufferView(DXGI_FORMAT format)
+{
+	return &this->indexBufferViews[format == DXGI_FORMAT_R16_UINT ? 0 : 1];
+}
+
+TlsfAllocatorStats GeometryPool::GetVertexStats()
+{
+	return this->vertexAllocator.GetStats();
+}
+
+TlsfAllocatorStats GeometryPool::GetIndexStats()
+{
+	return this->indexAllocator.GetStats();
+}
+
+ID3D12Resource1* GeometryPool::CreateBuffer(ID3D12Device5* device, UINT64 size, LPCWSTR name)
+{
+	D3D12_HEAP_PROPERTIES hp = {};
+	hp.Type = D3D12_HEAP_TYPE_DEFAULT;
+	hp.CreationNodeMask = 1;
+	hp.VisibleNodeMask = 1;
+
+	D3D12_RESOURCE_DESC rd = {};
+	rd.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	rd.Width = size;
+	rd.Height = 1;
+	rd.DepthOrArraySize = 1;
+	rd.MipLevels = 1;
+	rd.SampleDesc.Count = 1;
+	rd.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	//created in COMMON so the copy queue and the direct queue both promote it on their own
+	ID3D12Resource1* buffer = nullptr;
+	if (!SUCCEEDED(device->CreateCommittedResource(
+		&hp,
+		D3D12_HEAP_FLAG_NONE,
+		&rd,
+		D3D12_RESOURCE_STATE_COMMON,
+		nullptr,
+		IID_PPV_ARGS(&buffer))))
+	{
+		OutputDebugStringA("ERROR: Could not create the geometry pool buffer!\n");
+		return nullptr;
+	}
+
+	buffer->SetName(name);
+	return buffer;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <d3d12.h>
+#include "tlsfAllocator.h"
+#include "geometryUploader.h"
+
+// where the vertices and indices of a mesh are in the GeometryPool
+struct MeshRange
+{
+	UINT firstVertex;		// the base vertex of the draw
+	UINT nrOfVertices;
+	UINT firstIndex;		// the start index of the draw, counted in indices of indexFormat
+	UINT nrOfIndices;
+	DXGI_FORMAT indexFormat;
+	UINT indexOffset;		// what the index allocator handed out, in INDEX_UNIT bytes
+};
+
+// One default heap buffer for the positions, one for the uvs and one for the indices of every
+// mesh. The meshes get ranges of them from TlsfAllocators, so a draw only needs its base vertex
+// and start index and the buffers are bound once per command list. 16 and 32-bit indices share
+// the index buffer, there is a view of the whole buffer for each format.
+class GeometryPool
+{
+public:
+	// index ranges are allocated in units of 4 bytes, so 32-bit indices are always aligned
+	static const UINT INDEX_UNIT = 4;
+
+	GeometryPool();
+	~GeometryPool();
+
+	void Create(ID3D12Device5* device, UINT maxVertices, UINT indexBufferSize);
+
+	// allocates the ranges of a mesh and copies its data into them with the uploader, false
+	// if the pool is too full. indexSize is 2 or 4.
+	bool Add(GeometryUploader* uploader, const float* positions, const float* uvs, UINT nrOfVertices,
+		const void* indices, UINT indexSize, UINT nrOfIndices, MeshRange& range);
+	// the gpu must be done with the range
+	void Remove(const MeshRange& range);
+
+	// float3 and float2 per vertex, for the Positions and UV root srvs
+	D3D12_GPU_VIRTUAL_ADDRESS GetPositions();
+	D3D12_GPU_VIRTUAL_ADDRESS GetUVs();
+	const D3D12_INDEX_BUFFER_VIEW* GetIndexBufferView(DXGI_FORMAT format);
+
+	TlsfAllocatorStats GetVertexStats();
+	TlsfAllocatorStats GetIndexStats();
+
+private:
+	GeometryPool(const GeometryPool&) = delete;
+	GeometryPool& operator=(const GeometryPool&) = delete;
+
+	ID3D12Resource1* CreateBuffer(ID3D12Device5* device, UINT64 size, LPCWSTR name);
+
+	ID3D12Resource1* positions;
+	ID3D12Resource1* uvs;
+	ID3D12Resource1* indices;
+	D3D12_INDEX_BUFFER_VIEW indexBufferViews[2];	// 16 and 32-bit
+
+	TlsfAllocator vertexAllocator;
+	TlsfAllocator indexAllocator;
+};
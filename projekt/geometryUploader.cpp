@@ -0,0 +1,90 @@
+#include "geometryUploader.h"
+#include <string.h>
+
+// the staging offsets only need to be aligned for the memcpy
+const unsigned long long STAGING_ALIGNMENT = 16;
+
+GeometryUploader::GeometryUploader()
+{
+	queue = nullptr;
+	batchSize = 0;
+	batchBytes = 0;
+	lastFenceValue = 0;
+	stats = {};
+}
+
+GeometryUploader::~GeometryUploader()
+{
+}
+
+void GeometryUploader::Initialize(CopyQueue* queue, unsigned long long batchSize)
+{
+	this->queue = queue;
+	this->batchSize = batchSize;
+	this->batchBytes = 0;
+	this->lastFenceValue = 0;
+	staging.Reset(queue->GetStagingSize());
+}
+
+void GeometryUploader::Upload(void* destination, unsigned long long destinationOffset, const void* data, unsigned long long size)
+{
+	stats.uploads++;
+
+	unsigned long long done = 0;
+	while (done < size)
+	{
+		staging.Retire(queue->GetCompletedValue());
+
+		unsigned long long piece = size - done < queue->GetStagingSize() ? size - done : queue->GetStagingSize();
+		unsigned long long offset = staging.Allocate(piece, STAGING_ALIGNMENT);
+		if (offset == RingAllocator::INVALID)
+		{
+			// the open batch is only freed once it has been submitted, after that the oldest one is waited for
+			if (batchBytes > 0)
+			{
+				Submit();
+			}
+			else
+			{
+				queue->Wait(staging.GetOldestFenceValue());
+				stats.stalls++;
+			}
+			continue;
+		}
+
+		memcpy(queue->GetStaging() + offset, (const unsigned char*)data + done, (size_t)piece);
+		queue->Copy(destination, destinationOffset + done, offset, piece);
+		stats.copies++;
+		stats.bytes += piece;
+
+		done += piece;
+		batchBytes += piece;
+		if (batchBytes >= batchSize)
+		{
+			Submit();
+		}
+	}
+}
+
+unsigned long long GeometryUploader::Flush()
+{
+	if (batchBytes > 0)
+	{
+		Submit();
+	}
+	return lastFenceValue;
+}
+
+unsigned long long GeometryUploader::Submit()
+{
+	lastFenceValue = queue->Submit();
+	staging.FinishFrame(lastFenceValue);
+	batchBytes = 0;
+	stats.submissions++;
+	return lastFenceValue;
+}
+
+GeometryUploadStats GeometryUploader::GetStats()
+{
+	return this->stats;
+}
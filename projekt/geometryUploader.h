@@ -0,0 +1,62 @@
+#pragma once
+#include "ringAllocator.h"
+
+// Where the copies of GeometryUploader are executed. D3D12CopyQueue records them on a d3d copy
+// queue, the stand-in in tests/geometryUploaderTest.cpp executes them on the cpu.
+class CopyQueue
+{
+public:
+	virtual ~CopyQueue() {}
+
+	// the staging buffer the copies read from, written by the cpu
+	virtual unsigned char* GetStaging() = 0;
+	virtual unsigned long long GetStagingSize() = 0;
+
+	// copies size bytes at stagingOffset of the staging buffer to destinationOffset of destination
+	virtual void Copy(void* destination, unsigned long long destinationOffset, unsigned long long stagingOffset, unsigned long long size) = 0;
+	// executes the copies recorded since the last call, they are done once the returned fence value is reached
+	virtual unsigned long long Submit() = 0;
+	virtual unsigned long long GetCompletedValue() = 0;
+	virtual void Wait(unsigned long long fenceValue) = 0;
+};
+
+struct GeometryUploadStats
+{
+	unsigned long long bytes;
+	unsigned int uploads;
+	unsigned int copies;		// more than uploads if a buffer did not fit into the staging buffer in one piece
+	unsigned int submissions;
+	unsigned int stalls;		// waits for the queue because the staging buffer was full
+};
+
+// Stages buffer data and copies it into gpu buffers on a copy queue. Copies are collected into
+// batches, a batch is submitted once it holds batchSize bytes or when Flush is called, so many
+// small meshes are one submission. The staging space of a batch is reused once its fence value
+// has been reached, bigger buffers are copied in pieces. Used from the thread that loads the assets.
+class GeometryUploader
+{
+public:
+	GeometryUploader();
+	~GeometryUploader();
+
+	void Initialize(CopyQueue* queue, unsigned long long batchSize);
+
+	// copies to destinationOffset.. of destination, which must not be used before the fence value
+	// that Flush returns has been reached
+	void Upload(void* destination, unsigned long long destinationOffset, const void* data, unsigned long long size);
+	// submits the copies that are not submitted yet and returns the fence value of the last batch
+	unsigned long long Flush();
+
+	GeometryUploadStats GetStats();
+
+private:
+	unsigned long long Submit();
+
+	CopyQueue* queue;
+	RingAllocator staging;
+	unsigned long long batchSize;
+	unsigned long long batchBytes;
+	unsigned long long lastFenceValue;
+
+	GeometryUploadStats stats;
+};
@@ -0,0 +1,226 @@
+#include "heapAllocator.h"
+
+namespace
+{
+	unsigned long long RoundUp(unsigned long long size, unsigned long long alignment)
+	{
+		return (size + alignment - 1) / alignment * alignment;
+	}
+
+	unsigned long long PageKey(unsigned int heap, unsigned int block)
+	{
+		return ((unsigned long long)heap << 32) | block;
+	}
+
+	bool IsSmall(unsigned long long size, unsigned long long alignment)
+	{
+		return alignment <= HeapAllocator::SMALL_ALIGNMENT && size <= HeapAllocator::LARGE_ALIGNMENT;
+	}
+}
+
+HeapAllocator::HeapAllocator()
+{
+	Reset(0);
+}
+
+HeapAllocator::~HeapAllocator()
+{
+}
+
+void HeapAllocator::Reset(unsigned long long heapSize)
+{
+	this->heapSize = RoundUp(heapSize, LARGE_ALIGNMENT);
+	heaps.clear();
+	pages.clear();
+}
+
+bool HeapAllocator::Allocate(unsigned long long size, unsigned long long alignment, HeapPlacement& placement)
+{
+	if (size == 0 || alignment > LARGE_ALIGNMENT)
+	{
+		return false;
+	}
+
+	placement.size = size;
+	placement.alignment = alignment;
+
+	// a small resource takes slots of a page instead of blocks of its own
+	if (IsSmall(size, alignment))
+	{
+		return AllocateSlots((unsigned int)((size + SMALL_ALIGNMENT - 1) / SMALL_ALIGNMENT), placement);
+	}
+
+	unsigned int nrOfBlocks = (unsigned int)((size + LARGE_ALIGNMENT - 1) / LARGE_ALIGNMENT);
+	unsigned int heap, block;
+	if (!AllocateBlocks(nrOfBlocks, heap, block))
+	{
+		return false;
+	}
+
+	placement.heap = heap;
+	placement.offset = block * LARGE_ALIGNMENT;
+	heaps[heap].requested += size;
+	heaps[heap].allocated += nrOfBlocks * LARGE_ALIGNMENT;
+	heaps[heap].nrOfResources++;
+	return true;
+}
+
+void HeapAllocator::Free(const HeapPlacement& placement)
+{
+	if (placement.heap >= heaps.size())
+	{
+		return;
+	}
+
+	Heap& heap = heaps[placement.heap];
+	unsigned int block = (unsigned int)(placement.offset / LARGE_ALIGNMENT);
+	if (IsSmall(placement.size, placement.alignment))
+	{
+		std::map<unsigned long long, Page>::iterator page = pages.find(PageKey(placement.heap, block));
+		if (page == pages.end())
+		{
+			return;
+		}
+
+		unsigned int nrOfSlots = (unsigned int)((placement.size + SMALL_ALIGNMENT - 1) / SMALL_ALIGNMENT);
+		unsigned int firstSlot = (unsigned int)(placement.offset % LARGE_ALIGNMENT / SMALL_ALIGNMENT);
+		page->second.usedSlots &= ~(((1u << nrOfSlots) - 1) << firstSlot);
+		heap.allocated -= nrOfSlots * SMALL_ALIGNMENT;
+
+		// the empty page goes back to the heap
+		if (page->second.usedSlots == 0)
+		{
+			heap.blocks.Free(block);
+			pages.erase(page);
+		}
+	}
+	else
+	{
+		heap.blocks.Free(block);
+		heap.allocated -= RoundUp(placement.size, LARGE_ALIGNMENT);
+	}
+
+	heap.requested -= placement.size;
+	heap.nrOfResources--;
+
+	// a heap of its own is only kept for the resource that it was made for
+	if (heap.nrOfResources == 0 && heap.size > heapSize)
+	{
+		heap.size = 0;
+		heap.blocks.Reset(0);
+	}
+}
+
+unsigned int HeapAllocator::GetNrOfHeaps()
+{
+	return (unsigned int)this->heaps.size();
+}
+
+unsigned long long HeapAllocator::GetHeapSize(unsigned int heap)
+{
+	return this->heaps.at(heap).size;
+}
+
+HeapStats HeapAllocator::GetHeapStats(unsigned int heap)
+{
+	Heap& used = heaps.at(heap);
+	TlsfAllocatorStats blocks = used.blocks.GetStats();
+
+	HeapStats stats;
+	stats.size = used.size;
+	stats.requested = used.requested;
+	stats.allocated = used.allocated;
+	stats.free = (unsigned long long)(blocks.capacity - blocks.used) * LARGE_ALIGNMENT;
+	stats.largestFreeBlock = (unsigned long long)blocks.largestFreeBlock * LARGE_ALIGNMENT;
+	stats.nrOfResources = used.nrOfResources;
+	stats.fragmentation = blocks.fragmentation;
+
+	stats.pageSlack = 0;
+	for (std::map<unsigned long long, Page>::iterator it = pages.lower_bound(PageKey(heap, 0)); it != pages.end() && it->second.heap == heap; ++it)
+	{
+		unsigned int usedSlots = 0;
+		for (unsigned int i = 0; i < SLOTS_PER_PAGE; i++)
+		{
+			usedSlots += (it->second.usedSlots >> i) & 1;
+		}
+		stats.pageSlack += (SLOTS_PER_PAGE - usedSlots) * SMALL_ALIGNMENT;
+	}
+	return stats;
+}
+
+bool HeapAllocator::AllocateBlocks(unsigned int nrOfBlocks, unsigned int& heap, unsigned int& block)
+{
+	for (unsigned int i = 0; i < heaps.size(); i++)
+	{
+		block = heaps[i].blocks.Allocate(nrOfBlocks);
+		if (block != TlsfAllocator::INVALID)
+		{
+			heap = i;
+			return true;
+		}
+	}
+
+	// none of the heaps has room, a resource that is bigger than heapSize gets a heap of its size.
+	// It takes the place of a dropped heap if there is one.
+	heap = (unsigned int)heaps.size();
+	for (unsigned int i = 0; i < heaps.size() && heap == heaps.size(); i++)
+	{
+		heap = heaps[i].size == 0 ? i : heap;
+	}
+	if (heap == heaps.size())
+	{
+		heaps.push_back(Heap());
+	}
+
+	Heap& added = heaps[heap];
+	added.size = (unsigned long long)nrOfBlocks * LARGE_ALIGNMENT > heapSize ? (unsigned long long)nrOfBlocks * LARGE_ALIGNMENT : heapSize;
+	added.blocks.Reset((unsigned int)(added.size / LARGE_ALIGNMENT));
+	added.requested = 0;
+	added.allocated = 0;
+	added.nrOfResources = 0;
+
+	block = added.blocks.Allocate(nrOfBlocks);
+	return block != TlsfAllocator::INVALID;
+}
+
+bool HeapAllocator::AllocateSlots(unsigned int nrOfSlots, HeapPlacement& placement)
+{
+	// the first page with enough free slots in a row
+	unsigned int run = (1u << nrOfSlots) - 1;
+	std::map<unsigned long long, Page>::iterator page = pages.end();
+	unsigned int firstSlot = 0;
+	for (std::map<unsigned long long, Page>::iterator it = pages.begin(); it != pages.end() && page == pages.end(); ++it)
+	{
+		for (unsigned int slot = 0; slot + nrOfSlots <= SLOTS_PER_PAGE; slot++)
+		{
+			if ((it->second.usedSlots & (run << slot)) == 0)
+			{
+				page = it;
+				firstSlot = slot;
+				break;
+			}
+		}
+	}
+
+	if (page == pages.end())
+	{
+		Page added;
+		if (!AllocateBlocks(1, added.heap, added.block))
+		{
+			return false;
+		}
+		added.usedSlots = 0;
+		page = pages.insert(std::make_pair(PageKey(added.heap, added.block), added)).first;
+		firstSlot = 0;
+	}
+
+	page->second.usedSlots |= run << firstSlot;
+
+	Heap& heap = heaps[page->second.heap];
+	placement.heap = page->second.heap;
+	placement.offset = page->second.block * LARGE_ALIGNMENT + firstSlot * SMALL_ALIGNMENT;
+	heap.requested += placement.size;
+	heap.allocated += nrOfSlots * SMALL_ALIGNMENT;
+	heap.nrOfResources++;
+	return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <vector>
+#include <map>
+#include "tlsfAllocator.h"
+
+// where a resource was placed, needed to free it again
+struct HeapPlacement
+{
+	unsigned int heap;
+	unsigned long long offset;
+	unsigned long long size;	// what the resource asked for
+	unsigned long long alignment;
+};
+
+// how one heap is used
+struct HeapStats
+{
+	unsigned long long size;
+	unsigned long long requested;	// the sizes the resources asked for
+	unsigned long long allocated;	// what they got after rounding to their alignment
+	unsigned long long pageSlack;	// free 4KB slots in pages of small resources, taken from the heap but unused
+	unsigned long long free;
+	unsigned long long largestFreeBlock;
+	unsigned int nrOfResources;
+	double fragmentation;
+};
+
+// Places resources in heaps of heapSize bytes. The heaps are split into 64KB blocks by a
+// TlsfAllocator. Small resources with 4KB alignment share 64KB pages, a page has 16 slots of
+// 4KB. A resource that is bigger than heapSize gets a heap of its own, which is dropped again
+// with the resource. Knows nothing about d3d, the caller creates a heap whenever a placement
+// lands in one it has not created yet and releases the ones whose size went back to 0.
+class HeapAllocator
+{
+public:
+	static const unsigned long long SMALL_ALIGNMENT = 4 * 1024;
+	static const unsigned long long LARGE_ALIGNMENT = 64 * 1024;
+
+	HeapAllocator();
+	~HeapAllocator();
+
+	// forgets all heaps and placements
+	void Reset(unsigned long long heapSize);
+
+	// size and alignment like GetResourceAllocationInfo returns them, alignments above 64KB
+	// are not supported. Takes a new heap if none of the others has room.
+	bool Allocate(unsigned long long size, unsigned long long alignment, HeapPlacement& placement);
+	void Free(const HeapPlacement& placement);
+
+	// heaps that were dropped are still counted, with a size of 0
+	unsigned int GetNrOfHeaps();
+	unsigned long long GetHeapSize(unsigned int heap);
+	HeapStats GetHeapStats(unsigned int heap);
+
+private:
+	static const unsigned int SLOTS_PER_PAGE = (unsigned int)(LARGE_ALIGNMENT / SMALL_ALIGNMENT);
+
+	struct Heap
+	{
+		unsigned long long size;
+		TlsfAllocator blocks;	// in units of LARGE_ALIGNMENT
+		unsigned long long requested;
+		unsigned long long allocated;
+		unsigned int nrOfResources;
+	};
+
+	// a block of a heap that is split into 4KB slots, bit i is slot i
+	struct Page
+	{
+		unsigned int heap;
+		unsigned int block;
+		unsigned int usedSlots;
+	};
+
+	bool AllocateBlocks(unsigned int nrOfBlocks, unsigned int& heap, unsigned int& block);
+	bool AllocateSlots(unsigned int nrOfSlots, HeapPlacement& placement);
+
+	unsigned long long heapSize;
+	std::vector<Heap> heaps;
+	// heap and block -> page, pages are freed once their last slot is
+	std::map<unsigned long long, Page> pages;
+};
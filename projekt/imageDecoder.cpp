@@ -0,0 +1,95 @@
+#include "imageDecoder.h"
+#include "mappedFile.h"
+#include "pngDecoder.h"
+#include "jpegDecoder.h"
+#ifdef _WIN32
+#include "wicDecoder.h"
+#endif
+#include <stdio.h>
+
+DecodedImage::DecodedImage()
+{
+	width = 0;
+	height = 0;
+}
+
+void DecodedImage::Clear()
+{
+	width = 0;
+	height = 0;
+	pixels.clear();
+}
+
+size_t DecodedImage::GetRowPitch() const
+{
+	return (size_t)width * 4;
+}
+
+ImageLoader::ImageLoader()
+{
+}
+
+ImageLoader::~ImageLoader()
+{
+	for (size_t i = 0; i < decoders.size(); i++)
+	{
+		delete decoders[i];
+	}
+}
+
+void ImageLoader::AddDecoder(ImageDecoder* decoder)
+{
+	decoders.push_back(decoder);
+}
+
+bool ImageLoader::Load(const std::string& path, DecodedImage& image) const
+{
+	MappedFile file;
+	if (!file.Open(path))
+	{
+		printf("ERROR! Could not open the image %s\n", path.c_str());
+		return false;
+	}
+
+	if (!Decode((const unsigned char*)file.GetData(), file.GetSize(), image))
+	{
+		printf("ERROR! Could not decode the image %s\n", path.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool ImageLoader::Decode(const unsigned char* data, size_t size, DecodedImage& image) const
+{
+	// a decoder that recognizes the file but can not decode it (e.g. a progressive jpeg)
+	// leaves it to the decoders after it
+	for (size_t i = 0; i < decoders.size(); i++)
+	{
+		if (decoders[i]->CanDecode(data, size) && decoders[i]->Decode(data, size, image))
+		{
+			return true;
+		}
+	}
+
+	image.Clear();
+	return false;
+}
+
+const ImageLoader& ImageLoader::GetDefault()
+{
+	struct DefaultLoader : public ImageLoader
+	{
+		DefaultLoader()
+		{
+			AddDecoder(new PngDecoder());
+			AddDecoder(new JpegDecoder());
+#ifdef _WIN32
+			AddDecoder(new WicDecoder());
+#endif
+		}
+	};
+
+	static const DefaultLoader loader;
+	return loader;
+}
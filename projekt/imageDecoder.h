@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <stddef.h>
+
+// pixels of a decoded image, always 8-bit RGBA with tightly packed rows
+struct DecodedImage
+{
+	unsigned int width;
+	unsigned int height;
+	std::vector<unsigned char> pixels;
+
+	DecodedImage();
+	void Clear();
+	size_t GetRowPitch() const;
+};
+
+// one image format. Decode may be called from several threads at the same time.
+class ImageDecoder
+{
+public:
+	virtual ~ImageDecoder() {}
+
+	virtual const char* GetName() const = 0;
+
+	// checks the signature at the start of the file
+	virtual bool CanDecode(const unsigned char* data, size_t size) const = 0;
+	virtual bool Decode(const unsigned char* data, size_t size, DecodedImage& image) const = 0;
+};
+
+// Tries the decoders in the order they were added, until one of them decodes the image
+class ImageLoader
+{
+public:
+	ImageLoader();
+	~ImageLoader();
+
+	// the loader takes ownership of the decoder
+	void AddDecoder(ImageDecoder* decoder);
+
+	bool Load(const std::string& path, DecodedImage& image) const;
+	bool Decode(const unsigned char* data, size_t size, DecodedImage& image) const;
+
+	// png and baseline jpeg, on windows WIC as well for everything else
+	static const ImageLoader& GetDefault();
+
+private:
+	ImageLoader(const ImageLoader&) = delete;
+	ImageLoader& operator=(const ImageLoader&) = delete;
+
+	std::vector<ImageDecoder*> decoders;
+};
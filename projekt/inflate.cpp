@@ -0,0 +1,442 @@
+#include "inflate.h"
+#include <string.h>
+
+namespace
+{
+	const int MAX_BITS = 15;
+	const int FAST_BITS = 9;
+
+	// canonical huffman code, codes up to FAST_BITS long are decoded with one table lookup
+	struct Huffman
+	{
+		unsigned short fast[1 << FAST_BITS];	// (length << 9) | symbol, 0 if the code is longer
+		unsigned short counts[MAX_BITS + 1];	// number of codes of each length
+		unsigned short symbols[288];			// symbols ordered by their code
+	};
+
+	const unsigned short LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const unsigned char LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const unsigned short DIST_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const unsigned char DIST_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	const unsigned char CODE_LENGTH_ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	// reads the stream least significant bit first
+	class BitReader
+	{
+	public:
+		BitReader(const unsigned char* data, size_t size)
+		{
+			this->data = data;
+			this->end = data + size;
+			this->buffer = 0;
+			this->count = 0;
+			this->padding = 0;
+		}
+
+		// fills the buffer to at least 56 bits, past the end of the data zeros are read
+		inline void Refill()
+		{
+			while (count <= 56)
+			{
+				if (data < end)
+				{
+					buffer |= (unsigned long long)*data++ << count;
+				}
+				else
+				{
+					padding += 8;
+				}
+				count += 8;
+			}
+		}
+
+		inline unsigned int Peek(int n)
+		{
+			return (unsigned int)(buffer & ((1ull << n) - 1));
+		}
+
+		inline void Consume(int n)
+		{
+			buffer >>= n;
+			count -= n;
+		}
+
+		inline unsigned int Bits(int n)
+		{
+			if (count < n)
+			{
+				Refill();
+			}
+			unsigned int value = Peek(n);
+			Consume(n);
+			return value;
+		}
+
+		inline void AlignToByte()
+		{
+			Consume(count & 7);
+		}
+
+		inline int GetCount()
+		{
+			return count;
+		}
+
+		// true once bits past the end of the data have been used
+		inline bool IsOverrun()
+		{
+			return count < padding;
+		}
+
+	private:
+		const unsigned char* data;
+		const unsigned char* end;
+		unsigned long long buffer;
+		int count;
+		int padding;
+	};
+
+	unsigned int ReverseBits(unsigned int code, int length)
+	{
+		unsigned int reversed = 0;
+		for (int i = 0; i < length; i++)
+		{
+			reversed = (reversed << 1) | ((code >> i) & 1);
+		}
+		return reversed;
+	}
+
+	bool BuildHuffman(Huffman& huffman, const unsigned char* lengths, int nrOfSymbols)
+	{
+		memset(huffman.fast, 0, sizeof(huffman.fast));
+		memset(huffman.counts, 0, sizeof(huffman.counts));
+
+		for (int i = 0; i < nrOfSymbols; i++)
+		{
+			huffman.counts[lengths[i]]++;
+		}
+		huffman.counts[0] = 0;
+
+		// over-subscribed codes are invalid, incomplete ones are allowed
+		int left = 1;
+		for (int length = 1; length <= MAX_BITS; length++)
+		{
+			left <<= 1;
+			left -= huffman.counts[length];
+			if (left < 0)
+			{
+				return false;
+			}
+		}
+
+		unsigned short offsets[MAX_BITS + 2];
+		offsets[1] = 0;
+		for (int length = 1; length <= MAX_BITS; length++)
+		{
+			offsets[length + 1] = offsets[length] + huffman.counts[length];
+		}
+		for (int i = 0; i < nrOfSymbols; i++)
+		{
+			if (lengths[i] != 0)
+			{
+				huffman.symbols[offsets[lengths[i]]++] = (unsigned short)i;
+			}
+		}
+
+		// the codes are stored most significant bit first, so the table is indexed by the reversed code
+		unsigned int code = 0;
+		int index = 0;
+		for (int length = 1; length <= FAST_BITS; length++)
+		{
+			for (int i = 0; i < huffman.counts[length]; i++)
+			{
+				unsigned short entry = (unsigned short)((length << 9) | huffman.symbols[index++]);
+				for (unsigned int r = ReverseBits(code++, length); r < (1u << FAST_BITS); r += 1u << length)
+				{
+					huffman.fast[r] = entry;
+				}
+			}
+			code <<= 1;
+		}
+
+		return true;
+	}
+
+	inline int DecodeSymbol(BitReader& bits, const Huffman& huffman)
+	{
+		if (bits.GetCount() < MAX_BITS)
+		{
+			bits.Refill();
+		}
+
+		unsigned short entry = huffman.fast[bits.Peek(FAST_BITS)];
+		if (entry != 0)
+		{
+			bits.Consume(entry >> 9);
+			return entry & 511;
+		}
+
+		// longer code, walk the canonical code one bit at a time
+		unsigned int peeked = bits.Peek(MAX_BITS);
+		int code = 0;
+		int first = 0;
+		int index = 0;
+		for (int length = 1; length <= MAX_BITS; length++)
+		{
+			code |= (peeked >> (length - 1)) & 1;
+			int count = huffman.counts[length];
+			if (code - first < count)
+			{
+				bits.Consume(length);
+				return huffman.symbols[index + code - first];
+			}
+			index += count;
+			first += count;
+			first <<= 1;
+			code <<= 1;
+		}
+
+		return -1;
+	}
+
+	struct FixedCodes
+	{
+		Huffman literals;
+		Huffman distances;
+
+		FixedCodes()
+		{
+			unsigned char lengths[288];
+			memset(lengths, 8, 144);
+			memset(lengths + 144, 9, 112);
+			memset(lengths + 256, 7, 24);
+			memset(lengths + 280, 8, 8);
+			BuildHuffman(literals, lengths, 288);
+
+			memset(lengths, 5, 30);
+			BuildHuffman(distances, lengths, 30);
+		}
+	};
+
+	bool ReadDynamicCodes(BitReader& bits, Huffman& literals, Huffman& distances)
+	{
+		int nrOfLiterals = bits.Bits(5) + 257;
+		int nrOfDistances = bits.Bits(5) + 1;
+		int nrOfCodeLengths = bits.Bits(4) + 4;
+		if (nrOfLiterals > 286 || nrOfDistances > 30)
+		{
+			return false;
+		}
+
+		unsigned char lengths[286 + 30];
+		memset(lengths, 0, 19);
+		for (int i = 0; i < nrOfCodeLengths; i++)
+		{
+			lengths[CODE_LENGTH_ORDER[i]] = (unsigned char)bits.Bits(3);
+		}
+
+		Huffman codeLengths;
+		if (!BuildHuffman(codeLengths, lengths, 19))
+		{
+			return false;
+		}
+
+		// the literal and distance lengths are one sequence, repeats may cross from one to the other
+		int index = 0;
+		while (index < nrOfLiterals + nrOfDistances)
+		{
+			int symbol = DecodeSymbol(bits, codeLengths);
+			if (symbol < 0)
+			{
+				return false;
+			}
+
+			if (symbol < 16)
+			{
+				lengths[index++] = (unsigned char)symbol;
+				continue;
+			}
+
+			unsigned char repeated = 0;
+			int repeat = 0;
+			if (symbol == 16)
+			{
+				if (index == 0)
+				{
+					return false;
+				}
+				repeated = lengths[index - 1];
+				repeat = 3 + bits.Bits(2);
+			}
+			else if (symbol == 17)
+			{
+				repeat = 3 + bits.Bits(3);
+			}
+			else
+			{
+				repeat = 11 + bits.Bits(7);
+			}
+
+			if (index + repeat > nrOfLiterals + nrOfDistances)
+			{
+				return false;
+			}
+			memset(lengths + index, repeated, repeat);
+			index += repeat;
+		}
+
+		// without an end of block code the block could never end
+		if (lengths[256] == 0)
+		{
+			return false;
+		}
+
+		return BuildHuffman(literals, lengths, nrOfLiterals) && BuildHuffman(distances, lengths + nrOfLiterals, nrOfDistances);
+	}
+}
+
+bool Inflate::DecompressZlib(const unsigned char* data, size_t size, std::vector<unsigned char>& out)
+{
+	if (size < 2)
+	{
+		return false;
+	}
+
+	// deflate compression, valid header check and no preset dictionary
+	const unsigned int cmf = data[0];
+	const unsigned int flg = data[1];
+	if ((cmf & 0x0F) != 8 || (cmf * 256 + flg) % 31 != 0 || (flg & 0x20) != 0)
+	{
+		return false;
+	}
+
+	// the adler-32 at the end is not checked, a broken stream is found by the decoder anyway
+	return Decompress(data + 2, size - 2, out);
+}
+
+bool Inflate::Decompress(const unsigned char* data, size_t size, std::vector<unsigned char>& out)
+{
+	static const FixedCodes fixedCodes;
+
+	BitReader bits(data, size);
+	Huffman dynamicLiterals;
+	Huffman dynamicDistances;
+
+	// the output grows in steps instead of per byte, a caller that knows the size can reserve it
+	const size_t start = out.size();
+	size_t pos = start;
+	out.resize(out.capacity() > start + 258 ? out.capacity() : start + size * 4 + 258);
+
+	bool last = false;
+	while (!last)
+	{
+		last = bits.Bits(1) == 1;
+		unsigned int type = bits.Bits(2);
+
+		if (type == 0)
+		{
+			// stored block
+			bits.AlignToByte();
+			unsigned int length = bits.Bits(16);
+			unsigned int inverted = bits.Bits(16);
+			if ((length ^ 0xFFFF) != inverted)
+			{
+				return false;
+			}
+
+			if (pos + length > out.size())
+			{
+				out.resize(out.size() * 2 + length);
+			}
+			for (unsigned int i = 0; i < length; i++)
+			{
+				out[pos++] = (unsigned char)bits.Bits(8);
+			}
+		}
+		else if (type == 1 || type == 2)
+		{
+			const Huffman* literals = &fixedCodes.literals;
+			const Huffman* distances = &fixedCodes.distances;
+			if (type == 2)
+			{
+				if (!ReadDynamicCodes(bits, dynamicLiterals, dynamicDistances))
+				{
+					return false;
+				}
+				literals = &dynamicLiterals;
+				distances = &dynamicDistances;
+			}
+
+			while (true)
+			{
+				// a truncated stream only reads zeros, which could go on forever
+				int symbol = DecodeSymbol(bits, *literals);
+				if (symbol < 0 || bits.IsOverrun())
+				{
+					return false;
+				}
+
+				if (pos + 258 > out.size())
+				{
+					out.resize(out.size() * 2);
+				}
+
+				if (symbol < 256)
+				{
+					out[pos++] = (unsigned char)symbol;
+					continue;
+				}
+				if (symbol == 256)
+				{
+					break;
+				}
+
+				symbol -= 257;
+				if (symbol >= 29)
+				{
+					return false;
+				}
+				unsigned int length = LENGTH_BASE[symbol] + bits.Bits(LENGTH_EXTRA[symbol]);
+
+				int distanceSymbol = DecodeSymbol(bits, *distances);
+				if (distanceSymbol < 0 || distanceSymbol >= 30)
+				{
+					return false;
+				}
+				size_t distance = DIST_BASE[distanceSymbol] + bits.Bits(DIST_EXTRA[distanceSymbol]);
+				if (distance > pos - start)
+				{
+					return false;
+				}
+
+				// the copy may overlap itself, e.g. a distance of 1 repeats the last byte
+				unsigned char* dst = out.data() + pos;
+				const unsigned char* src = dst - distance;
+				if (distance >= length)
+				{
+					memcpy(dst, src, length);
+				}
+				else
+				{
+					for (unsigned int i = 0; i < length; i++)
+					{
+						dst[i] = src[i];
+					}
+				}
+				pos += length;
+			}
+		}
+		else
+		{
+			return false;
+		}
+
+		if (bits.IsOverrun())
+		{
+			return false;
+		}
+	}
+
+	out.resize(pos);
+	return true;
+}
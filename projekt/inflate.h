@@ -0,0 +1,14 @@
+#pragma once
+#include <vector>
+#include <stddef.h>
+
+// Decompressor for deflate data (RFC 1951), used by the png decoder
+class Inflate
+{
+public:
+	// decompresses a zlib stream (RFC 1950), the output is appended to out
+	static bool DecompressZlib(const unsigned char* data, size_t size, std::vector<unsigned char>& out);
+
+	// decompresses raw deflate data, the output is appended to out
+	static bool Decompress(const unsigned char* data, size_t size, std::vector<unsigned char>& out);
+};
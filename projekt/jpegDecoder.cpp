@@ -0,0 +1,850 @@
+#include "jpegDecoder.h"
+#include <string.h>
+#include <math.h>
+#include <memory>
+
+namespace
+{
+	// position of the n:th coefficient of a block in zigzag order
+	const unsigned char ZIGZAG[64 + 16] =
+	{
+		0, 1, 8, 16, 9, 2, 3, 10,
+		17, 24, 32, 25, 18, 11, 4, 5,
+		12, 19, 26, 33, 40, 48, 41, 34,
+		27, 20, 13, 6, 7, 14, 21, 28,
+		35, 42, 49, 56, 57, 50, 43, 36,
+		29, 22, 15, 23, 30, 37, 44, 51,
+		58, 59, 52, 45, 38, 31, 39, 46,
+		53, 60, 61, 54, 47, 55, 62, 63,
+		// a broken run length can point past the last coefficient, it ends up here
+		63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63
+	};
+
+	const int FAST_BITS = 9;
+
+	struct HuffmanTable
+	{
+		unsigned short fast[1 << FAST_BITS];	// (length << 8) | value, 0 if the code is longer
+		unsigned char values[256];
+		int maxCode[17];						// largest code of each length, -1 if there is none
+		int valueOffset[17];					// index in values minus the first code of each length
+		bool defined;
+	};
+
+	struct Component
+	{
+		int id;
+		int h;
+		int v;
+		int quantTable;
+		int dcTable;
+		int acTable;
+		int dcPrediction;
+
+		// the decoded samples, padded to whole MCUs
+		int blocksPerLine;
+		int blocksPerColumn;
+		std::vector<unsigned char> samples;
+	};
+
+	struct JpegState
+	{
+		HuffmanTable dcTables[4];
+		HuffmanTable acTables[4];
+		unsigned short quantTables[4][64];		// natural order
+		bool quantDefined[4];
+
+		int width;
+		int height;
+		int nrOfComponents;
+		Component components[4];
+		int maxH;
+		int maxV;
+		int mcusPerLine;
+		int mcusPerColumn;
+		int restartInterval;
+
+		bool hasFrame;
+		bool adobe;
+		int adobeTransform;
+	};
+
+	inline unsigned int ReadU16(const unsigned char* data)
+	{
+		return ((unsigned int)data[0] << 8) | data[1];
+	}
+
+	bool BuildHuffmanTable(HuffmanTable& table, const unsigned char* counts, const unsigned char* values, int nrOfValues)
+	{
+		memset(table.fast, 0, sizeof(table.fast));
+		memcpy(table.values, values, nrOfValues);
+
+		int code = 0;
+		int index = 0;
+		for (int length = 1; length <= 16; length++)
+		{
+			// more codes than fit in this length, checked before they are written to the fast table
+			if (code + counts[length - 1] > (1 << length))
+			{
+				return false;
+			}
+
+			table.valueOffset[length] = index - code;
+			for (int i = 0; i < counts[length - 1]; i++, code++, index++)
+			{
+				if (length <= FAST_BITS)
+				{
+					// every index that starts with this code
+					const int first = code << (FAST_BITS - length);
+					const int last = first + (1 << (FAST_BITS - length));
+					for (int k = first; k < last; k++)
+					{
+						table.fast[k] = (unsigned short)((length << 8) | values[index]);
+					}
+				}
+			}
+			table.maxCode[length] = counts[length - 1] > 0 ? code - 1 : -1;
+			code <<= 1;
+		}
+
+		table.defined = true;
+		return true;
+	}
+
+	// reads the entropy coded data most significant bit first and skips the stuffed zero
+	// after every 0xFF. At a marker it stops and only returns zeros.
+	class BitReader
+	{
+	public:
+		BitReader(const unsigned char* data, const unsigned char* end)
+		{
+			this->data = data;
+			this->end = end;
+			this->buffer = 0;
+			this->count = 0;
+			this->hitMarker = false;
+		}
+
+		inline void Fill()
+		{
+			while (count <= 24)
+			{
+				unsigned int byte = 0;
+				if (!hitMarker && data < end)
+				{
+					byte = *data;
+					if (byte == 0xFF)
+					{
+						unsigned int next = data + 1 < end ? data[1] : 0xD9;
+						if (next == 0x00)
+						{
+							data += 2;
+						}
+						else
+						{
+							hitMarker = true;
+							byte = 0;
+						}
+					}
+					else
+					{
+						data++;
+					}
+				}
+				buffer |= byte << (24 - count);
+				count += 8;
+			}
+		}
+
+		inline unsigned int Peek(int n)
+		{
+			return buffer >> (32 - n);
+		}
+
+		inline void Consume(int n)
+		{
+			buffer <<= n;
+			count -= n;
+		}
+
+		inline int Decode(const HuffmanTable& table)
+		{
+			if (count < 16)
+			{
+				Fill();
+			}
+
+			unsigned short entry = table.fast[Peek(FAST_BITS)];
+			if (entry != 0)
+			{
+				Consume(entry >> 8);
+				return entry & 255;
+			}
+
+			unsigned int code = Peek(16);
+			for (int length = FAST_BITS + 1; length <= 16; length++)
+			{
+				int prefix = (int)(code >> (16 - length));
+				if (prefix <= table.maxCode[length])
+				{
+					Consume(length);
+					return table.values[(prefix + table.valueOffset[length]) & 255];
+				}
+			}
+
+			// not a valid code, skip a bit so that a broken file still ends
+			Consume(1);
+			return 0;
+		}
+
+		// reads a value of the given size and extends its sign
+		inline int Receive(int size)
+		{
+			if (size == 0)
+			{
+				return 0;
+			}
+			if (count < size)
+			{
+				Fill();
+			}
+
+			int value = (int)Peek(size);
+			Consume(size);
+			return value < (1 << (size - 1)) ? value - (1 << size) + 1 : value;
+		}
+
+		// skips to the data after the next restart marker
+		void Restart()
+		{
+			buffer = 0;
+			count = 0;
+			hitMarker = false;
+
+			while (data + 1 < end && !(data[0] == 0xFF && data[1] >= 0xD0 && data[1] <= 0xD7))
+			{
+				data++;
+			}
+			if (data + 1 < end)
+			{
+				data += 2;
+			}
+		}
+
+		// position of the marker that ends the entropy coded data
+		const unsigned char* FindMarker()
+		{
+			const unsigned char* pos = data;
+			while (pos + 1 < end && !(pos[0] == 0xFF && pos[1] != 0x00 && !(pos[1] >= 0xD0 && pos[1] <= 0xD7)))
+			{
+				pos++;
+			}
+			return pos;
+		}
+
+	private:
+		const unsigned char* data;
+		const unsigned char* end;
+		unsigned int buffer;
+		int count;
+		bool hitMarker;
+	};
+
+	struct IdctTable
+	{
+		// dequantization and the scale factors of the AAN idct in one multiplier, in natural order
+		float multipliers[64];
+	};
+
+	void BuildIdctTable(IdctTable& table, const unsigned short* quant)
+	{
+		static const double PI = 3.14159265358979323846;
+		double scale[8];
+		scale[0] = 1.0;
+		for (int k = 1; k < 8; k++)
+		{
+			scale[k] = cos(k * PI / 16.0) * sqrt(2.0);
+		}
+
+		// the division by 8 of the idct is folded in as well
+		for (int row = 0; row < 8; row++)
+		{
+			for (int col = 0; col < 8; col++)
+			{
+				table.multipliers[row * 8 + col] = (float)(quant[row * 8 + col] * scale[row] * scale[col] / 8.0);
+			}
+		}
+	}
+
+	inline unsigned char ClampToByte(float value)
+	{
+		int rounded = (int)(value + 128.5f);
+		return (unsigned char)(rounded < 0 ? 0 : (rounded > 255 ? 255 : rounded));
+	}
+
+	// separable float idct (Arai, Agui and Nakajima), the same one as jidctflt in libjpeg
+	void InverseDct(const short* coefficients, const IdctTable& table, unsigned char* out, int stride)
+	{
+		float workspace[64];
+
+		// columns
+		for (int col = 0; col < 8; col++)
+		{
+			const short* in = coefficients + col;
+			const float* q = table.multipliers + col;
+			float* ws = workspace + col;
+
+			if (in[8] == 0 && in[16] == 0 && in[24] == 0 && in[32] == 0 && in[40] == 0 && in[48] == 0 && in[56] == 0)
+			{
+				// only a dc term, the column is flat
+				float dc = in[0] * q[0];
+				for (int row = 0; row < 8; row++)
+				{
+					ws[row * 8] = dc;
+				}
+				continue;
+			}
+
+			// even part
+			float tmp0 = in[0] * q[0];
+			float tmp1 = in[16] * q[16];
+			float tmp2 = in[32] * q[32];
+			float tmp3 = in[48] * q[48];
+
+			float tmp10 = tmp0 + tmp2;
+			float tmp11 = tmp0 - tmp2;
+			float tmp13 = tmp1 + tmp3;
+			float tmp12 = (tmp1 - tmp3) * 1.414213562f - tmp13;
+
+			tmp0 = tmp10 + tmp13;
+			tmp3 = tmp10 - tmp13;
+			tmp1 = tmp11 + tmp12;
+			tmp2 = tmp11 - tmp12;
+
+			// odd part
+			float tmp4 = in[8] * q[8];
+			float tmp5 = in[24] * q[24];
+			float tmp6 = in[40] * q[40];
+			float tmp7 = in[56] * q[56];
+
+			float z13 = tmp6 + tmp5;
+			float z10 = tmp6 - tmp5;
+			float z11 = tmp4 + tmp7;
+			float z12 = tmp4 - tmp7;
+
+			tmp7 = z11 + z13;
+			tmp11 = (z11 - z13) * 1.414213562f;
+
+			float z5 = (z10 + z12) * 1.847759065f;
+			tmp10 = 1.082392200f * z12 - z5;
+			tmp12 = -2.613125930f * z10 + z5;
+
+			tmp6 = tmp12 - tmp7;
+			tmp5 = tmp11 - tmp6;
+			tmp4 = tmp10 + tmp5;
+
+			ws[0] = tmp0 + tmp7;
+			ws[56] = tmp0 - tmp7;
+			ws[8] = tmp1 + tmp6;
+			ws[48] = tmp1 - tmp6;
+			ws[16] = tmp2 + tmp5;
+			ws[40] = tmp2 - tmp5;
+			ws[32] = tmp3 + tmp4;
+			ws[24] = tmp3 - tmp4;
+		}
+
+		// rows
+		for (int row = 0; row < 8; row++)
+		{
+			const float* ws = workspace + row * 8;
+			unsigned char* dst = out + row * stride;
+
+			float tmp10 = ws[0] + ws[4];
+			float tmp11 = ws[0] - ws[4];
+			float tmp13 = ws[2] + ws[6];
+			float tmp12 = (ws[2] - ws[6]) * 1.414213562f - tmp13;
+
+			float tmp0 = tmp10 + tmp13;
+			float tmp3 = tmp10 - tmp13;
+			float tmp1 = tmp11 + tmp12;
+			float tmp2 = tmp11 - tmp12;
+
+			float z13 = ws[5] + ws[3];
+			float z10 = ws[5] - ws[3];
+			float z11 = ws[1] + ws[7];
+			float z12 = ws[1] - ws[7];
+
+			float tmp7 = z11 + z13;
+			tmp11 = (z11 - z13) * 1.414213562f;
+
+			float z5 = (z10 + z12) * 1.847759065f;
+			tmp10 = 1.082392200f * z12 - z5;
+			tmp12 = -2.613125930f * z10 + z5;
+
+			float tmp6 = tmp12 - tmp7;
+			float tmp5 = tmp11 - tmp6;
+			float tmp4 = tmp10 + tmp5;
+
+			dst[0] = ClampToByte(tmp0 + tmp7);
+			dst[7] = ClampToByte(tmp0 - tmp7);
+			dst[1] = ClampToByte(tmp1 + tmp6);
+			dst[6] = ClampToByte(tmp1 - tmp6);
+			dst[2] = ClampToByte(tmp2 + tmp5);
+			dst[5] = ClampToByte(tmp2 - tmp5);
+			dst[4] = ClampToByte(tmp3 + tmp4);
+			dst[3] = ClampToByte(tmp3 - tmp4);
+		}
+	}
+
+	bool ReadQuantTables(JpegState& state, const unsigned char* data, unsigned int length)
+	{
+		unsigned int pos = 0;
+		while (pos < length)
+		{
+			const unsigned int precision = data[pos] >> 4;
+			const unsigned int id = data[pos] & 15;
+			pos++;
+
+			const unsigned int tableSize = precision == 0 ? 64 : 128;
+			if (id > 3 || precision > 1 || pos + tableSize > length)
+			{
+				return false;
+			}
+
+			for (int k = 0; k < 64; k++)
+			{
+				state.quantTables[id][ZIGZAG[k]] = (unsigned short)(precision == 0 ? data[pos + k] : ReadU16(data + pos + k * 2));
+			}
+			state.quantDefined[id] = true;
+			pos += tableSize;
+		}
+
+		return true;
+	}
+
+	bool ReadHuffmanTables(JpegState& state, const unsigned char* data, unsigned int length)
+	{
+		unsigned int pos = 0;
+		while (pos + 17 <= length)
+		{
+			const unsigned int tableClass = data[pos] >> 4;
+			const unsigned int id = data[pos] & 15;
+			const unsigned char* counts = data + pos + 1;
+			pos += 17;
+
+			int nrOfValues = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				nrOfValues += counts[i];
+			}
+			if (tableClass > 1 || id > 3 || nrOfValues > 256 || pos + nrOfValues > length)
+			{
+				return false;
+			}
+
+			HuffmanTable& table = tableClass == 0 ? state.dcTables[id] : state.acTables[id];
+			if (!BuildHuffmanTable(table, counts, data + pos, nrOfValues))
+			{
+				return false;
+			}
+			pos += nrOfValues;
+		}
+
+		return pos == length;
+	}
+
+	// fileSize limits the number of blocks, each one takes at least two bits of the file
+	bool ReadFrame(JpegState& state, const unsigned char* data, unsigned int length, size_t fileSize)
+	{
+		if (length < 6 || state.hasFrame)
+		{
+			return false;
+		}
+
+		// 8-bit samples only, 12-bit baseline does not exist in practice
+		const unsigned int precision = data[0];
+		state.height = (int)ReadU16(data + 1);
+		state.width = (int)ReadU16(data + 3);
+		state.nrOfComponents = data[5];
+		if (precision != 8 || state.width == 0 || state.height == 0 ||
+			(state.nrOfComponents != 1 && state.nrOfComponents != 3) || length < 6u + state.nrOfComponents * 3u)
+		{
+			return false;
+		}
+
+		state.maxH = 1;
+		state.maxV = 1;
+		for (int i = 0; i < state.nrOfComponents; i++)
+		{
+			Component& component = state.components[i];
+			component.id = data[6 + i * 3];
+			component.h = data[7 + i * 3] >> 4;
+			component.v = data[7 + i * 3] & 15;
+			component.quantTable = data[8 + i * 3];
+			if (component.h < 1 || component.h > 4 || component.v < 1 || component.v > 4 || component.quantTable > 3)
+			{
+				return false;
+			}
+			state.maxH = component.h > state.maxH ? component.h : state.maxH;
+			state.maxV = component.v > state.maxV ? component.v : state.maxV;
+		}
+
+		state.mcusPerLine = (state.width + state.maxH * 8 - 1) / (state.maxH * 8);
+		state.mcusPerColumn = (state.height + state.maxV * 8 - 1) / (state.maxV * 8);
+
+		// a broken size would allocate gigabytes of samples before the scan finds out
+		unsigned long long nrOfBlocks = 0;
+		for (int i = 0; i < state.nrOfComponents; i++)
+		{
+			nrOfBlocks += (unsigned long long)state.mcusPerLine * state.components[i].h * state.mcusPerColumn * state.components[i].v;
+		}
+		if (nrOfBlocks > (unsigned long long)fileSize * 4)
+		{
+			return false;
+		}
+
+		for (int i = 0; i < state.nrOfComponents; i++)
+		{
+			Component& component = state.components[i];
+			component.blocksPerLine = state.mcusPerLine * component.h;
+			component.blocksPerColumn = state.mcusPerColumn * component.v;
+			component.samples.assign((size_t)component.blocksPerLine * component.blocksPerColumn * 64, 0);
+		}
+
+		state.hasFrame = true;
+		return true;
+	}
+
+	void DecodeBlock(BitReader& bits, const JpegState& state, Component& component, const IdctTable& idct, int blockX, int blockY)
+	{
+		short coefficients[64];
+		memset(coefficients, 0, sizeof(coefficients));
+
+		// the dc coefficient is the difference to the one of the last block
+		int size = bits.Decode(state.dcTables[component.dcTable]);
+		component.dcPrediction += bits.Receive(size > 16 ? 16 : size);
+		coefficients[0] = (short)component.dcPrediction;
+
+		const HuffmanTable& ac = state.acTables[component.acTable];
+		for (int k = 1; k < 64; )
+		{
+			int symbol = bits.Decode(ac);
+			int run = symbol >> 4;
+			size = symbol & 15;
+
+			if (size == 0)
+			{
+				if (run != 15)
+				{
+					break;	// end of block
+				}
+				k += 16;
+				continue;
+			}
+
+			k += run;
+			coefficients[ZIGZAG[k > 63 ? 64 : k]] = (short)bits.Receive(size);
+			k++;
+		}
+
+		const int stride = component.blocksPerLine * 8;
+		InverseDct(coefficients, idct, component.samples.data() + (size_t)blockY * 8 * stride + blockX * 8, stride);
+	}
+
+	bool DecodeScan(JpegState& state, const unsigned char* header, unsigned int length, const unsigned char* data,
+		const unsigned char* end, const unsigned char*& scanEnd)
+	{
+		if (!state.hasFrame || length < 1)
+		{
+			return false;
+		}
+
+		const int nrOfScanComponents = header[0];
+		if (nrOfScanComponents < 1 || nrOfScanComponents > state.nrOfComponents || length < 4u + nrOfScanComponents * 2u)
+		{
+			return false;
+		}
+
+		Component* scanComponents[4];
+		IdctTable idct[4];
+		for (int i = 0; i < nrOfScanComponents; i++)
+		{
+			const int id = header[1 + i * 2];
+			const int tables = header[2 + i * 2];
+
+			scanComponents[i] = nullptr;
+			for (int c = 0; c < state.nrOfComponents; c++)
+			{
+				if (state.components[c].id == id)
+				{
+					scanComponents[i] = &state.components[c];
+				}
+			}
+
+			Component* component = scanComponents[i];
+			if (component == nullptr || (tables >> 4) > 3 || (tables & 15) > 3)
+			{
+				return false;
+			}
+			component->dcTable = tables >> 4;
+			component->acTable = tables & 15;
+			component->dcPrediction = 0;
+
+			if (!state.dcTables[component->dcTable].defined || !state.acTables[component->acTable].defined ||
+				!state.quantDefined[component->quantTable])
+			{
+				return false;
+			}
+			BuildIdctTable(idct[i], state.quantTables[component->quantTable]);
+		}
+
+		// spectral selection and successive approximation are only used by progressive files
+		const unsigned char* selection = header + 1 + nrOfScanComponents * 2;
+		if (selection[0] != 0 || selection[1] != 63 || selection[2] != 0)
+		{
+			return false;
+		}
+
+		BitReader bits(data, end);
+
+		// a scan with one component is not interleaved, it only covers the blocks inside of the image
+		int mcusPerLine = state.mcusPerLine;
+		int mcusPerColumn = state.mcusPerColumn;
+		if (nrOfScanComponents == 1)
+		{
+			const Component* component = scanComponents[0];
+			mcusPerLine = ((state.width * component->h + state.maxH - 1) / state.maxH + 7) / 8;
+			mcusPerColumn = ((state.height * component->v + state.maxV - 1) / state.maxV + 7) / 8;
+		}
+
+		const int nrOfMcus = mcusPerLine * mcusPerColumn;
+		for (int mcu = 0; mcu < nrOfMcus; mcu++)
+		{
+			if (state.restartInterval > 0 && mcu > 0 && mcu % state.restartInterval == 0)
+			{
+				bits.Restart();
+				for (int i = 0; i < nrOfScanComponents; i++)
+				{
+					scanComponents[i]->dcPrediction = 0;
+				}
+			}
+
+			const int mcuX = mcu % mcusPerLine;
+			const int mcuY = mcu / mcusPerLine;
+
+			if (nrOfScanComponents == 1)
+			{
+				DecodeBlock(bits, state, *scanComponents[0], idct[0], mcuX, mcuY);
+				continue;
+			}
+
+			for (int i = 0; i < nrOfScanComponents; i++)
+			{
+				Component& component = *scanComponents[i];
+				for (int y = 0; y < component.v; y++)
+				{
+					for (int x = 0; x < component.h; x++)
+					{
+						DecodeBlock(bits, state, component, idct[i], mcuX * component.h + x, mcuY * component.v + y);
+					}
+				}
+			}
+		}
+
+		// the entropy coded data ends with a marker, without one the file was cut off
+		scanEnd = bits.FindMarker();
+		return scanEnd + 1 < end;
+	}
+
+	void ConvertToRgba(const JpegState& state, DecodedImage& image)
+	{
+		image.width = (unsigned int)state.width;
+		image.height = (unsigned int)state.height;
+		image.pixels.resize(image.GetRowPitch() * image.height);
+
+		// subsampled components are upsampled by repeating their samples
+		std::vector<int> columns[4];
+		for (int c = 0; c < state.nrOfComponents; c++)
+		{
+			columns[c].resize(state.width);
+			for (int x = 0; x < state.width; x++)
+			{
+				columns[c][x] = x * state.components[c].h / state.maxH;
+			}
+		}
+
+		const bool ycbcr = state.nrOfComponents == 3 && !(state.adobe && state.adobeTransform == 0);
+
+		// fixed point YCbCr to RGB with 16 fractional bits
+		const int CR_TO_R = 91881;	// 1.402
+		const int CB_TO_G = 22554;	// 0.34414
+		const int CR_TO_G = 46802;	// 0.71414
+		const int CB_TO_B = 116130;	// 1.772
+
+		for (int y = 0; y < state.height; y++)
+		{
+			const unsigned char* rows[4];
+			for (int c = 0; c < state.nrOfComponents; c++)
+			{
+				const Component& component = state.components[c];
+				rows[c] = component.samples.data() + (size_t)(y * component.v / state.maxV) * component.blocksPerLine * 8;
+			}
+
+			unsigned char* out = image.pixels.data() + (size_t)y * image.GetRowPitch();
+			for (int x = 0; x < state.width; x++, out += 4)
+			{
+				if (state.nrOfComponents == 1)
+				{
+					const unsigned char gray = rows[0][x];
+					out[0] = gray;
+					out[1] = gray;
+					out[2] = gray;
+					out[3] = 255;
+					continue;
+				}
+
+				int samples[3];
+				for (int c = 0; c < 3; c++)
+				{
+					samples[c] = rows[c][columns[c][x]];
+				}
+
+				if (ycbcr)
+				{
+					const int luma = samples[0] << 16;
+					const int cb = samples[1] - 128;
+					const int cr = samples[2] - 128;
+					const int r = (luma + CR_TO_R * cr + 32768) >> 16;
+					const int g = (luma - CB_TO_G * cb - CR_TO_G * cr + 32768) >> 16;
+					const int b = (luma + CB_TO_B * cb + 32768) >> 16;
+					out[0] = (unsigned char)(r < 0 ? 0 : (r > 255 ? 255 : r));
+					out[1] = (unsigned char)(g < 0 ? 0 : (g > 255 ? 255 : g));
+					out[2] = (unsigned char)(b < 0 ? 0 : (b > 255 ? 255 : b));
+				}
+				else
+				{
+					out[0] = (unsigned char)samples[0];
+					out[1] = (unsigned char)samples[1];
+					out[2] = (unsigned char)samples[2];
+				}
+				out[3] = 255;
+			}
+		}
+	}
+}
+
+const char* JpegDecoder::GetName() const
+{
+	return "jpeg";
+}
+
+bool JpegDecoder::CanDecode(const unsigned char* data, size_t size) const
+{
+	return size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF;
+}
+
+bool JpegDecoder::Decode(const unsigned char* data, size_t size, DecodedImage& image) const
+{
+	if (!CanDecode(data, size))
+	{
+		return false;
+	}
+
+	// the state holds the decoded samples, so it is allocated per image
+	std::unique_ptr<JpegState> state(new JpegState());
+	bool hasScan = false;
+
+	size_t pos = 2;
+	while (pos + 4 <= size)
+	{
+		if (data[pos] != 0xFF)
+		{
+			return false;
+		}
+
+		const unsigned int marker = data[pos + 1];
+		pos += 2;
+
+		// fill bytes, and markers without a segment
+		if (marker == 0xFF)
+		{
+			pos--;
+			continue;
+		}
+		if (marker == 0xD9)
+		{
+			break;
+		}
+		if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8))
+		{
+			continue;
+		}
+
+		const unsigned int length = ReadU16(data + pos);
+		if (length < 2 || pos + length > size)
+		{
+			return false;
+		}
+		const unsigned char* segment = data + pos + 2;
+		const unsigned int segmentLength = length - 2;
+
+		bool result = true;
+		switch (marker)
+		{
+		case 0xC0:	// baseline
+		case 0xC1:	// extended sequential, huffman coded
+			result = ReadFrame(*state, segment, segmentLength, size);
+			break;
+		case 0xC4:
+			result = ReadHuffmanTables(*state, segment, segmentLength);
+			break;
+		case 0xDB:
+			result = ReadQuantTables(*state, segment, segmentLength);
+			break;
+		case 0xDD:
+			result = segmentLength >= 2;
+			state->restartInterval = result ? (int)ReadU16(segment) : 0;
+			break;
+		case 0xEE:
+			// Adobe APP14, tells if three components are YCbCr or RGB
+			if (segmentLength >= 12 && memcmp(segment, "Adobe", 5) == 0)
+			{
+				state->adobe = true;
+				state->adobeTransform = segment[11];
+			}
+			break;
+		case 0xDA:
+		{
+			const unsigned char* scanEnd = nullptr;
+			if (!DecodeScan(*state, segment, segmentLength, data + pos + length, data + size, scanEnd))
+			{
+				return false;
+			}
+			hasScan = true;
+			pos = scanEnd - data;
+			continue;
+		}
+		default:
+			// progressive, lossless, arithmetic coding and hierarchical frames
+			if ((marker >= 0xC2 && marker <= 0xCB) || (marker >= 0xCD && marker <= 0xCF))
+			{
+				return false;
+			}
+			break;
+		}
+
+		if (!result)
+		{
+			return false;
+		}
+		pos += length;
+	}
+
+	if (!hasScan)
+	{
+		return false;
+	}
+
+	ConvertToRgba(*state, image);
+	return true;
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include "imageDecoder.h"
+
+// Portable decoder for baseline (sequential huffman) jpeg files with one (gray) or three
+// (YCbCr or Adobe RGB) components and any chroma subsampling. Progressive and arithmetic
+// coded files are not decoded, on windows the WIC decoder takes those.
+class JpegDecoder : public ImageDecoder
+{
+public:
+	const char* GetName() const;
+	bool CanDecode(const unsigned char* data, size_t size) const;
+	bool Decode(const unsigned char* data, size_t size, DecodedImage& image) const;
+};
@@ -4,6 +4,9 @@
 #define WIDTH 1920
 #define HEIGHT 1080
 
+// frames the cpu may record ahead of the gpu, 1 waits for the gpu after every frame
+#define FRAMES_IN_FLIGHT 3
+
 void run();
 void updateScene();
 void renderScene();
@@ -15,6 +18,7 @@ int main()
 	//----------------Initialization--------------------//
 	renderer.GetWindow()->Initialize(WIDTH, HEIGHT);
 	renderer.Initialize();
+	renderer.SetFrameLatency(FRAMES_IN_FLIGHT);
 	renderer.SetClearColor(0.0, 0.0, 0.25, 1.0);
 
 	XMFLOAT4 pos = XMFLOAT4(0.0, 0.0, 0.0, 0.0);
@@ -28,7 +32,7 @@ int main()
 	scale[1] = 10;
 	scale[2] = 10;
 	path = "../objects/box.obj";
-	renderer.CreateObject(false, pos, scale, path);
+	renderer.CreateObjectAsync(false, pos, scale, path);
 	/*--------------------------------------------------*/
 
 	/*-------- small boxes with dynamic texture --------*/
@@ -37,10 +41,10 @@ int main()
 	scale[1] = 1;
 	scale[2] = 1;
 	path = "../objects/box.obj";
-	renderer.CreateObject(false, pos, scale, path);
+	renderer.CreateObjectAsync(false, pos, scale, path);
 
 	pos = XMFLOAT4(-2, 0, 0, 0);
-	renderer.CreateObject(false, pos, scale, path);
+	renderer.CreateObjectAsync(false, pos, scale, path);
 	/*--------------------------------------------------*/
 
 	/*-------- big piedmon with dynamic texture --------*/
@@ -49,7 +53,7 @@ int main()
 	scale[1] = 1;
 	scale[2] = 1;
 	path = "../objects/piedmonGif.obj";
-	renderer.CreateObject(false, pos, scale, path);
+	renderer.CreateObjectAsync(false, pos, scale, path);
 	/*--------------------------------------------------*/
 
 	/*------- two piedmons standing on the boxes -------*/
@@ -58,18 +62,24 @@ int main()
 	scale[1] = 0.5;
 	scale[2] = 0.5;
 	path = "../objects/piedmon.obj";
-	renderer.CreateObject(false, pos, scale, path);
+	renderer.CreateObjectAsync(false, pos, scale, path);
 
 	pos = XMFLOAT4(-2, 1, 0, 0);
-	renderer.CreateObject(false, pos, scale, path);
+	renderer.CreateObjectAsync(false, pos, scale, path);
 	/*--------------------------------------------------*/
 
+	//everything above is loaded at the same time on the thread pool
+	renderer.FinishLoading();
+	renderer.GetAssetCache()->PrintStats();
+	renderer.GetPipelineCache()->PrintStats();
+
 	renderer.SetTimer();
 	run();
 
 	//print benchmarks in console after window closes
 	renderer.BenchmarkObjects();	// per object
 	renderer.BenchmarkFrame();		// whole frame
+	renderer.PrintResourceStats();
 
 	return 0;
 }
@@ -102,6 +112,8 @@ void run()
 			// Stop clock
 			renderer.GetCamera()->EndFrame();
 			std::string time = renderer.GetCamera()->GetFPS();
+			time += " drawn: " + std::to_string(renderer.GetNrOfDrawn()) + " culled: " + std::to_string(renderer.GetNrOfCulled())
+				+ " draws: " + std::to_string(renderer.GetNrOfDrawCalls());
 			renderer.GetWindow()->SetTitle(time);
 		}
 	}
@@ -112,39 +124,9 @@ void updateScene()
 	renderer.GetCamera()->MouseMovement();
 	renderer.GetCamera()->KeyMovement();
 
-	// loop per object
-	for (int i = 0; i < renderer.GetNumObjects(); i++)
-	{
-		// update app logic, such as moving the camera or figuring out what objects are in view
-
-		// create rotation matrices
-		XMMATRIX rotXMat = XMMatrixRotationX(0.0000f);
-		XMMATRIX rotYMat = XMMatrixRotationY(0.0000f);
-		XMMATRIX rotZMat = XMMatrixRotationZ(0.0000f);
-
-		// add rotation to objects rotation matrix and store it
-		XMMATRIX rotMat = XMLoadFloat4x4(renderer.GetObj(i)->GetRotMatrix()) * rotXMat * rotYMat * rotZMat;
-		renderer.GetObj(i)->SetRotMatrix(rotMat);
-
-		// create translation matrix for object from its position vector
-		XMMATRIX translationMat = XMMatrixTranslationFromVector(XMLoadFloat4(renderer.GetObj(i)->GetPosition()));
-
-		XMMATRIX scale = XMMatrixScaling(renderer.GetObj(i)->GetScale()[0], renderer.GetObj(i)->GetScale()[1], renderer.GetObj(i)->GetScale()[2]);
-
-		// create world matrix by first rotating the object, then positioning the rotated cube
-		XMMATRIX worldMat = scale * rotMat * translationMat;
-
-		// store world matrix
-		renderer.GetObj(i)->SetWorldMatrix(worldMat);
-
-		// update constant buffer
-		// create the wvp matrix and store in constant buffer
-		XMMATRIX viewMat = XMLoadFloat4x4(renderer.GetCamera()->GetCamViewMat()); // load view matrix
-		XMMATRIX projMat = XMLoadFloat4x4(renderer.GetCamera()->GetCamProjMat()); // load projection matrix
-		XMMATRIX wvpMat = XMLoadFloat4x4(renderer.GetObj(i)->GetWorldMatrix()) * viewMat * projMat; // create wvp matrix
-		XMMATRIX transposed = XMMatrixTranspose(wvpMat); // must transpose wvp matrix for the gpu
-		renderer.GetObj(i)->GetConstantBuffer()->SetWvpMat(transposed);
-	}
+	// the objects that moved get new world matrices, all of them get new wvp matrices if the camera moved,
+	// and the objects outside the frustum are culled. Large scenes are updated in parallel on the renderer's thread pool.
+	renderer.GetTransforms()->Update(*renderer.GetCamera()->GetCamViewMat(), *renderer.GetCamera()->GetCamProjMat(), renderer.GetThreadPool());
 }
 
 void renderScene()
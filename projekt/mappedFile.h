@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <stddef.h>
+
+// Read-only memory mapping of a whole file. Works on both Windows and POSIX so the
+// loaders built on top of it can run outside of the renderer.
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool Open(const std::string& path);
+	void Close();
+
+	const char* GetData() const;
+	size_t GetSize() const;
+	bool IsOpen() const;
+
+private:
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const char* data;
+	size_t size;
+	bool open;
+
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#else
+	int fileDescriptor;
+#endif
+};
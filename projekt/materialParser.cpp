@@ -0,0 +1,80 @@
+#include "materialParser.h"
+#include "mappedFile.h"
+#include <string.h>
+
+namespace
+{
+	inline bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t';
+	}
+
+	inline bool IsLineEnd(char c)
+	{
+		return c == '\n' || c == '\r';
+	}
+}
+
+bool MaterialParser::Parse(const std::string& mtlPath, std::vector<std::string>& textures)
+{
+	MappedFile file;
+	if (!file.Open(mtlPath))
+	{
+		textures.clear();
+		return false;
+	}
+	return ParseBuffer(mtlPath, file.GetData(), file.GetSize(), textures);
+}
+
+bool MaterialParser::ParseBuffer(const std::string& mtlPath, const char* data, size_t size, std::vector<std::string>& textures)
+{
+	textures.clear();
+	const char* cursor = data;
+	const char* end = data + size;
+	while (cursor < end)
+	{
+		while (cursor < end && (IsSpace(*cursor) || IsLineEnd(*cursor)))
+		{
+			cursor++;
+		}
+		const char* lineEnd = cursor;
+		while (lineEnd < end && !IsLineEnd(*lineEnd))
+		{
+			lineEnd++;
+		}
+
+		//the rest of the line is the name, it may contain spaces
+		if (lineEnd - cursor > 6 && strncmp(cursor, "map_Kd", 6) == 0 && IsSpace(cursor[6]))
+		{
+			const char* name = cursor + 6;
+			const char* nameEnd = lineEnd;
+			while (name < nameEnd && IsSpace(*name))
+			{
+				name++;
+			}
+			while (nameEnd > name && IsSpace(nameEnd[-1]))
+			{
+				nameEnd--;
+			}
+			if (nameEnd > name)
+			{
+				textures.push_back(ResolvePath(mtlPath, std::string(name, nameEnd)));
+			}
+		}
+		cursor = lineEnd;
+	}
+	return true;
+}
+
+std::string MaterialParser::ResolvePath(const std::string& mtlPath, const std::string& name)
+{
+	if (name.size() >= 2 && name[1] == ':')
+	{
+		return name;
+	}
+
+	size_t slash = mtlPath.find_last_of("/\\");
+	std::string directory = slash == std::string::npos ? "" : mtlPath.substr(0, slash + 1);
+	size_t first = name.find_first_not_of("/\\");
+	return directory + (first == std::string::npos ? "" : name.substr(first));
+}
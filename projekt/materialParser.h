@@ -0,0 +1,18 @@
+#pragma once
+#include <vector>
+#include <string>
+
+// Reads the textures of an MTL file, the map_Kd lines in the order they are in the file. Has no
+// Windows dependencies, like the ObjParser.
+class MaterialParser
+{
+public:
+	// false if the file can not be read. The paths are relative to the directory of the mtl file
+	// like the mtllib of an obj file, see ResolvePath.
+	static bool Parse(const std::string& mtlPath, std::vector<std::string>& textures);
+	static bool ParseBuffer(const std::string& mtlPath, const char* data, size_t size, std::vector<std::string>& textures);
+
+	// name in the directory of the mtl file. A leading slash is part of the relative name, that is
+	// how the mtl files of the objects folder write it, only a name with a drive letter is used as it is.
+	static std::string ResolvePath(const std::string& mtlPath, const std::string& name);
+};
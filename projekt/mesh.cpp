@@ -0,0 +1,204 @@
+#include "mesh.h"
+#include "objParser.h"
+#include "vertexCacheOptimizer.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+Mesh::Mesh()
+{
+	pool = nullptr;
+	range = {};
+	id = 0;
+	loaded = false;
+	nrOfVertices = 0;
+	nrOfIndices = 0;
+	for (int k = 0; k < 3; k++)
+	{
+		boundsMin[k] = 0.0f;
+		boundsMax[k] = 0.0f;
+	}
+}
+
+Mesh::~Mesh()
+{
+	if (pool != nullptr)
+	{
+		pool->Remove(range);
+	}
+}
+
+bool Mesh::LoadData(std::string objPath)
+{
+	// the mtl file and the textures are looked up next to the obj file
+	size_t slash = objPath.find_last_of("/\\");
+	this->directory = slash == std::string::npos ? "" : objPath.substr(0, slash + 1);
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	//the cooked mesh stays mapped until it is uploaded, it is never copied anywhere else
+	if (MeshCache::Load(objPath, cooked))
+	{
+		this->materialLib = cooked.GetMaterials()[0].materialLib;
+		memcpy(this->boundsMin, cooked.GetHeader()->boundsMin, sizeof(this->boundsMin));
+		memcpy(this->boundsMax, cooked.GetHeader()->boundsMax, sizeof(this->boundsMax));
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+		printf("Loaded %s from cooked mesh in %.2f ms\n", objPath.c_str(), elapsed.count());
+
+		this->loaded = cooked.GetNrOfIndices() > 0;
+		return this->loaded;
+	}
+
+	//no up to date cooked mesh, parse the text file and cook it for the next start.
+	//A file that could not be parsed is not cooked, it would be loaded from the cooked file from then on
+	if (!LoadObjText(objPath, parsed, this->materialLib))
+	{
+		parsed = IndexedMesh();
+		return false;
+	}
+	MeshCache::Cook(objPath, parsed, this->materialLib);
+	parsed.GetBounds(this->boundsMin, this->boundsMax);
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	printf("Loaded %s from text in %.2f ms\n", objPath.c_str(), elapsed.count());
+
+	this->loaded = true;
+	return true;
+}
+
+void Mesh::CreateBuffers(GeometryPool* pool, GeometryUploader* uploader)
+{
+	if (!loaded)
+	{
+		cooked.Close();
+		return;
+	}
+
+	if (cooked.GetHeader() != nullptr)
+	{
+		CreateMeshBuffers(pool, uploader, cooked.GetPositions(), cooked.GetUVs(), cooked.GetNrOfVertices(),
+			cooked.GetIndices(), cooked.GetIndexSize(), cooked.GetNrOfIndices());
+		cooked.Close();
+	}
+	else if (parsed.CanUse16BitIndices())
+	{
+		std::vector<unsigned short> indices16;
+		parsed.GetIndices16(indices16);
+		CreateMeshBuffers(pool, uploader, parsed.positions.data(), parsed.uvs.data(), parsed.GetNrOfVertices(),
+			indices16.data(), sizeof(unsigned short), indices16.size());
+	}
+	else
+	{
+		CreateMeshBuffers(pool, uploader, parsed.positions.data(), parsed.uvs.data(), parsed.GetNrOfVertices(),
+			parsed.indices.data(), sizeof(unsigned int), parsed.indices.size());
+	}
+
+	// the data is in the staging buffer now
+	parsed = IndexedMesh();
+}
+
+bool Mesh::IsLoaded()
+{
+	return this->loaded;
+}
+
+bool Mesh::LoadObjText(std::string objPath, IndexedMesh& mesh, std::string& materialLib)
+{
+	ObjParser parser;
+	ObjMeshData obj;
+
+	if (!parser.Parse(objPath, obj) || obj.GetNrOfTriangles() == 0)
+	{
+		printf("ERROR! %s can not be read by the parser!\n", objPath.c_str());
+		return false;
+	}
+
+	printf("Parsed %s: %zu bytes in %.2f ms (%.1f MB/s)\n", objPath.c_str(), parser.GetBytesParsed(),
+		parser.GetParseTimeMs(), parser.GetBytesPerSecond() / (1024.0 * 1024.0));
+
+	materialLib = obj.materialLib;
+
+	//every v/vt/vn triple that is used by more than one triangle is only stored once
+	MeshBuilder::BuildIndexedMesh(obj, mesh);
+
+	printf("Indexed %s: %zu corners -> %zu vertices, %zu indices (%s)\n", objPath.c_str(), obj.corners.size(),
+		mesh.GetNrOfVertices(), mesh.GetNrOfIndices(), mesh.CanUse16BitIndices() ? "16-bit" : "32-bit");
+
+	//reorder the triangles and vertices for the post-transform cache before uploading them,
+	//the cache misses are measured with a 16 entry FIFO cache
+	const unsigned int simulatedCacheSize = 16;
+	VertexCacheStats before = VertexCacheOptimizer::SimulateFifoCache(mesh.indices, mesh.GetNrOfVertices(), simulatedCacheSize);
+	VertexCacheOptimizer::Optimize(mesh);
+	VertexCacheStats after = VertexCacheOptimizer::SimulateFifoCache(mesh.indices, mesh.GetNrOfVertices(), simulatedCacheSize);
+
+	printf("Optimized %s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", objPath.c_str(), before.acmr, after.acmr, before.atvr, after.atvr);
+
+	return true;
+}
+
+void Mesh::CreateMeshBuffers(GeometryPool* pool, GeometryUploader* uploader, const float* positions, const float* uvs, size_t nrOfVertices,
+	const void* indices, unsigned int indexSize, size_t nrOfIndices)
+{
+	// 16-bit indices whenever the mesh is small enough, it halves the index fetch.
+	// A mesh that does not fit into the pool is not drawn.
+	if (!pool->Add(uploader, positions, uvs, (UINT)nrOfVertices, indices, indexSize, (UINT)nrOfIndices, this->range))
+	{
+		printf("ERROR! The mesh does not fit into the geometry pool!\n");
+		return;
+	}
+
+	this->pool = pool;
+	this->nrOfVertices = (int)nrOfVertices;
+	this->nrOfIndices = (int)nrOfIndices;
+}
+
+const MeshRange& Mesh::GetRange()
+{
+	return this->range;
+}
+
+int Mesh::GetNrOfVertices()
+{
+	return this->nrOfVertices;
+}
+
+int Mesh::GetNrOfIndices()
+{
+	return this->nrOfIndices;
+}
+
+const float* Mesh::GetBoundsMin()
+{
+	return this->boundsMin;
+}
+
+const float* Mesh::GetBoundsMax()
+{
+	return this->boundsMax;
+}
+
+std::string Mesh::GetMaterialPath()
+{
+	return this->directory + this->materialLib;
+}
+
+std::shared_ptr<Texture> Mesh::GetMaterial()
+{
+	return this->material;
+}
+
+void Mesh::SetMaterial(std::shared_ptr<Texture> material)
+{
+	this->material = material;
+}
+
+unsigned int Mesh::GetId()
+{
+	return this->id;
+}
+
+void Mesh::SetId(unsigned int id)
+{
+	this->id = id;
+}
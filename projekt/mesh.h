@@ -0,0 +1,72 @@
+#pragma once
+#include "geometryPool.h"
+#include "meshBuilder.h"
+#include "meshCache.h"
+#include "texture.h"
+#include <vector>
+#include <string>
+#include <memory>
+
+// Geometry of one loaded OBJ file, shared by every object that uses the file. The vertices and
+// indices are a range of the GeometryPool that is given back when the mesh is destroyed.
+class Mesh
+{
+public:
+	Mesh();
+	~Mesh();
+
+	// cpu part of the loading, maps the cooked mesh or parses and cooks the obj file.
+	// Safe to call from any thread. False if the file could not be read, nothing is cooked then.
+	bool LoadData(std::string objPath);
+	// gpu part of the loading, uploads what LoadData read into the pool and frees it. The range
+	// can be drawn once the uploader's copies are done.
+	void CreateBuffers(GeometryPool* pool, GeometryUploader* uploader);
+	// LoadData succeeded, a mesh that failed has no geometry and no material
+	bool IsLoaded();
+
+	bool LoadObjText(std::string objPath, IndexedMesh& mesh, std::string& materialLib);
+
+	void CreateMeshBuffers(GeometryPool* pool, GeometryUploader* uploader, const float* positions, const float* uvs, size_t nrOfVertices,
+		const void* indices, unsigned int indexSize, size_t nrOfIndices);
+
+	// base vertex, start index and index format of the draws
+	const MeshRange& GetRange();
+	int GetNrOfVertices();
+	int GetNrOfIndices();
+	// bounding box of the positions in object space, known after LoadData
+	const float* GetBoundsMin();
+	const float* GetBoundsMax();
+
+	// path of the mtl file that the obj file refers to
+	std::string GetMaterialPath();
+
+	// texture of the mtl file, loaded together with the mesh
+	std::shared_ptr<Texture> GetMaterial();
+	void SetMaterial(std::shared_ptr<Texture> material);
+
+	// small id of the live mesh for the draw sort keys, given by the AssetCache
+	unsigned int GetId();
+	void SetId(unsigned int id);
+
+private:
+	Mesh(const Mesh&) = delete;
+	Mesh& operator=(const Mesh&) = delete;
+
+	GeometryPool* pool;
+	MeshRange range;
+	unsigned int id;
+
+	bool loaded;
+	int nrOfVertices;
+	int nrOfIndices;
+	float boundsMin[3];
+	float boundsMax[3];
+
+	std::string directory;
+	std::string materialLib;
+	std::shared_ptr<Texture> material;
+
+	// data from LoadData that is waiting for CreateBuffers, either mapped or parsed
+	CookedMesh cooked;
+	IndexedMesh parsed;
+};
@@ -0,0 +1,150 @@
+#include "meshBuilder.h"
+
+namespace
+{
+	const unsigned int EMPTY_SLOT = 0xFFFFFFFF;
+
+	inline size_t HashCorner(const ObjCorner& corner)
+	{
+		// the indices are small, so mixing them with large odd constants spreads them well
+		size_t hash = (size_t)(unsigned int)corner.position * 73856093u;
+		hash ^= (size_t)(unsigned int)corner.uv * 19349663u;
+		hash ^= (size_t)(unsigned int)corner.normal * 83492791u;
+		return hash;
+	}
+
+	inline bool SameCorner(const ObjCorner& a, const ObjCorner& b)
+	{
+		return a.position == b.position && a.uv == b.uv && a.normal == b.normal;
+	}
+}
+
+void IndexedMesh::Clear()
+{
+	positions.clear();
+	uvs.clear();
+	normals.clear();
+	indices.clear();
+}
+
+size_t IndexedMesh::GetNrOfVertices() const
+{
+	return positions.size() / 3;
+}
+
+size_t IndexedMesh::GetNrOfIndices() const
+{
+	return indices.size();
+}
+
+bool IndexedMesh::CanUse16BitIndices() const
+{
+	return GetNrOfVertices() <= 0xFFFF;
+}
+
+void IndexedMesh::GetIndices16(std::vector<unsigned short>& indices16) const
+{
+	indices16.resize(indices.size());
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		indices16[i] = (unsigned short)indices[i];
+	}
+}
+
+void IndexedMesh::GetBounds(float* boundsMin, float* boundsMax) const
+{
+	for (int k = 0; k < 3; k++)
+	{
+		boundsMin[k] = GetNrOfVertices() > 0 ? positions[k] : 0.0f;
+		boundsMax[k] = boundsMin[k];
+	}
+	for (size_t v = 0; v < GetNrOfVertices(); v++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			const float p = positions[v * 3 + k];
+			boundsMin[k] = p < boundsMin[k] ? p : boundsMin[k];
+			boundsMax[k] = p > boundsMax[k] ? p : boundsMax[k];
+		}
+	}
+}
+
+void MeshBuilder::BuildIndexedMesh(const ObjMeshData& obj, IndexedMesh& mesh)
+{
+	mesh.Clear();
+
+	const size_t nrOfCorners = obj.corners.size();
+	mesh.indices.resize(nrOfCorners);
+
+	// open addressing table that maps a corner to its vertex, kept at most half full
+	size_t tableSize = 16;
+	while (tableSize < nrOfCorners * 2)
+	{
+		tableSize <<= 1;
+	}
+	const size_t mask = tableSize - 1;
+	std::vector<unsigned int> table(tableSize, EMPTY_SLOT);
+
+	// the first corner that created each vertex, used to compare against in the table
+	std::vector<ObjCorner> uniqueCorners;
+	uniqueCorners.reserve(nrOfCorners);
+
+	for (size_t i = 0; i < nrOfCorners; i++)
+	{
+		const ObjCorner& corner = obj.corners[i];
+
+		size_t slot = HashCorner(corner) & mask;
+		while (table[slot] != EMPTY_SLOT && !SameCorner(uniqueCorners[table[slot]], corner))
+		{
+			slot = (slot + 1) & mask;
+		}
+
+		if (table[slot] == EMPTY_SLOT)
+		{
+			table[slot] = (unsigned int)uniqueCorners.size();
+			uniqueCorners.push_back(corner);
+		}
+
+		mesh.indices[i] = table[slot];
+	}
+
+	// write the vertex streams for the unique corners
+	const size_t nrOfVertices = uniqueCorners.size();
+	mesh.positions.resize(nrOfVertices * 3);
+	mesh.uvs.resize(nrOfVertices * 2);
+	mesh.normals.resize(nrOfVertices * 3);
+
+	for (size_t i = 0; i < nrOfVertices; i++)
+	{
+		const ObjCorner& corner = uniqueCorners[i];
+
+		mesh.positions[i * 3 + 0] = obj.positions[corner.position * 3 + 0];
+		mesh.positions[i * 3 + 1] = obj.positions[corner.position * 3 + 1];
+		mesh.positions[i * 3 + 2] = obj.positions[corner.position * 3 + 2];
+
+		//corners without a texture coordinate or normal get zeroes
+		if (corner.uv >= 0)
+		{
+			mesh.uvs[i * 2 + 0] = obj.uvs[corner.uv * 2 + 0];
+			mesh.uvs[i * 2 + 1] = obj.uvs[corner.uv * 2 + 1];
+		}
+		else
+		{
+			mesh.uvs[i * 2 + 0] = 0.0f;
+			mesh.uvs[i * 2 + 1] = 0.0f;
+		}
+
+		if (corner.normal >= 0)
+		{
+			mesh.normals[i * 3 + 0] = obj.normals[corner.normal * 3 + 0];
+			mesh.normals[i * 3 + 1] = obj.normals[corner.normal * 3 + 1];
+			mesh.normals[i * 3 + 2] = obj.normals[corner.normal * 3 + 2];
+		}
+		else
+		{
+			mesh.normals[i * 3 + 0] = 0.0f;
+			mesh.normals[i * 3 + 1] = 0.0f;
+			mesh.normals[i * 3 + 2] = 0.0f;
+		}
+	}
+}
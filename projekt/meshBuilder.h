@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+#include <stddef.h>
+#include "objParser.h"
+
+// mesh with one entry per unique (v, vt, vn) combination and an index list
+// that describes the triangles
+struct IndexedMesh
+{
+	std::vector<float> positions;		// x, y, z per vertex
+	std::vector<float> uvs;				// u, v per vertex
+	std::vector<float> normals;			// x, y, z per vertex
+	std::vector<unsigned int> indices;	// three per triangle
+
+	void Clear();
+	size_t GetNrOfVertices() const;
+	size_t GetNrOfIndices() const;
+
+	// 16-bit indices can be used as long as every vertex can be addressed
+	bool CanUse16BitIndices() const;
+	void GetIndices16(std::vector<unsigned short>& indices16) const;
+
+	// bounding box of the positions, zero for an empty mesh
+	void GetBounds(float* boundsMin, float* boundsMax) const;
+};
+
+class MeshBuilder
+{
+public:
+	// merges all corners that reference the same (v, vt, vn) triple into one vertex
+	static void BuildIndexedMesh(const ObjMeshData& obj, IndexedMesh& mesh);
+};
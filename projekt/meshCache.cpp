@@ -0,0 +1,355 @@
+#include "meshCache.h"
+#include <string.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _MSC_VER
+#pragma warning (disable: 4996)
+#endif
+
+namespace
+{
+	const char COOKED_MESH_MAGIC[4] = { 'M', 'E', 'S', 'H' };
+
+	inline unsigned long long AlignSection(unsigned long long offset)
+	{
+		return (offset + 15) & ~15ull;
+	}
+
+	// a section has to start on its boundary and end inside of the file, written so that
+	// a broken offset or count can not wrap around
+	bool SectionFits(unsigned long long offset, unsigned long long count, unsigned long long elementSize, unsigned long long fileSize)
+	{
+		return AlignSection(offset) == offset && offset <= fileSize && count * elementSize <= fileSize - offset;
+	}
+
+	template<typename Index>
+	bool IndicesInRange(const void* indices, unsigned int nrOfIndices, unsigned int nrOfVertices)
+	{
+		const Index* index = (const Index*)indices;
+		for (unsigned int i = 0; i < nrOfIndices; i++)
+		{
+			if (index[i] >= nrOfVertices)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool WriteAt(FILE* file, unsigned long long offset, const void* data, size_t size)
+	{
+		if (size == 0)
+		{
+			return true;
+		}
+		// a long is 32 bits on windows, the offset is not
+#ifdef _WIN32
+		if (_fseeki64(file, (long long)offset, SEEK_SET) != 0)
+#else
+		if (fseeko(file, (off_t)offset, SEEK_SET) != 0)
+#endif
+		{
+			return false;
+		}
+		return fwrite(data, 1, size, file) == size;
+	}
+
+	// writes a new modification time of the source into the header of a cooked file that is not open
+	bool WriteSourceModified(const std::string& cookedPath, long long sourceModified)
+	{
+		FILE* file = fopen(cookedPath.c_str(), "r+b");
+		if (file == NULL)
+		{
+			return false;
+		}
+
+		bool result = WriteAt(file, offsetof(CookedMeshHeader, sourceModified), &sourceModified, sizeof(sourceModified));
+		fclose(file);
+		return result;
+	}
+}
+
+CookedMesh::CookedMesh()
+{
+	header = nullptr;
+}
+
+CookedMesh::~CookedMesh()
+{
+}
+
+bool CookedMesh::Open(const std::string& cookedPath)
+{
+	Close();
+
+	if (!file.Open(cookedPath) || file.GetSize() < sizeof(CookedMeshHeader))
+	{
+		Close();
+		return false;
+	}
+
+	const CookedMeshHeader* fileHeader = (const CookedMeshHeader*)file.GetData();
+	if (memcmp(fileHeader->magic, COOKED_MESH_MAGIC, sizeof(COOKED_MESH_MAGIC)) != 0 ||
+		fileHeader->version != COOKED_MESH_VERSION ||
+		fileHeader->cookerVersion != MESH_COOKER_VERSION ||
+		fileHeader->fileSize != file.GetSize() ||
+		(fileHeader->indexSize != 2 && fileHeader->indexSize != 4) ||
+		fileHeader->nrOfMaterials < 1)
+	{
+		Close();
+		return false;
+	}
+
+	// make sure that every section lies inside of the file and is aligned, they are read through float and index pointers
+	const unsigned long long vertices = fileHeader->nrOfVertices;
+	if (!SectionFits(fileHeader->positionsOffset, vertices, 3 * sizeof(float), file.GetSize()) ||
+		!SectionFits(fileHeader->uvsOffset, vertices, 2 * sizeof(float), file.GetSize()) ||
+		!SectionFits(fileHeader->normalsOffset, vertices, 3 * sizeof(float), file.GetSize()) ||
+		!SectionFits(fileHeader->indicesOffset, fileHeader->nrOfIndices, fileHeader->indexSize, file.GetSize()) ||
+		!SectionFits(fileHeader->materialsOffset, fileHeader->nrOfMaterials, sizeof(CookedMaterial), file.GetSize()))
+	{
+		Close();
+		return false;
+	}
+
+	// an index past the vertices would make the gpu read outside of the mesh
+	const void* indices = file.GetData() + fileHeader->indicesOffset;
+	if (fileHeader->indexSize == 2 ? !IndicesInRange<unsigned short>(indices, fileHeader->nrOfIndices, fileHeader->nrOfVertices) :
+		!IndicesInRange<unsigned int>(indices, fileHeader->nrOfIndices, fileHeader->nrOfVertices))
+	{
+		Close();
+		return false;
+	}
+
+	// the names are used as c strings
+	const CookedMaterial* materials = (const CookedMaterial*)(file.GetData() + fileHeader->materialsOffset);
+	for (unsigned int i = 0; i < fileHeader->nrOfMaterials; i++)
+	{
+		if (memchr(materials[i].materialLib, '\0', sizeof(materials[i].materialLib)) == nullptr)
+		{
+			Close();
+			return false;
+		}
+	}
+
+	header = fileHeader;
+	return true;
+}
+
+void CookedMesh::Close()
+{
+	file.Close();
+	header = nullptr;
+}
+
+const CookedMeshHeader* CookedMesh::GetHeader() const
+{
+	return this->header;
+}
+
+const float* CookedMesh::GetPositions() const
+{
+	return (const float*)(file.GetData() + header->positionsOffset);
+}
+
+const float* CookedMesh::GetUVs() const
+{
+	return (const float*)(file.GetData() + header->uvsOffset);
+}
+
+const float* CookedMesh::GetNormals() const
+{
+	return (const float*)(file.GetData() + header->normalsOffset);
+}
+
+const void* CookedMesh::GetIndices() const
+{
+	return file.GetData() + header->indicesOffset;
+}
+
+const CookedMaterial* CookedMesh::GetMaterials() const
+{
+	return (const CookedMaterial*)(file.GetData() + header->materialsOffset);
+}
+
+unsigned int CookedMesh::GetNrOfVertices() const
+{
+	return header->nrOfVertices;
+}
+
+unsigned int CookedMesh::GetNrOfIndices() const
+{
+	return header->nrOfIndices;
+}
+
+unsigned int CookedMesh::GetIndexSize() const
+{
+	return header->indexSize;
+}
+
+std::string MeshCache::GetCookedPath(const std::string& sourcePath)
+{
+	return sourcePath + ".mesh";
+}
+
+bool MeshCache::Cook(const std::string& sourcePath, const IndexedMesh& mesh, const std::string& materialLib)
+{
+	// the padding is written to the file as well
+	CookedMeshHeader header;
+	memset(&header, 0, sizeof(header));
+	header.version = COOKED_MESH_VERSION;
+	header.cookerVersion = MESH_COOKER_VERSION;
+
+	if (!GetFileInfo(sourcePath, header.sourceSize, header.sourceModified))
+	{
+		return false;
+	}
+	header.sourceHash = HashFile(sourcePath);
+
+	header.nrOfVertices = (unsigned int)mesh.GetNrOfVertices();
+	header.nrOfIndices = (unsigned int)mesh.GetNrOfIndices();
+	header.indexSize = mesh.CanUse16BitIndices() ? 2 : 4;
+	header.nrOfMaterials = 1;
+
+	// bounding box of the positions
+	mesh.GetBounds(header.boundsMin, header.boundsMax);
+
+	header.positionsOffset = AlignSection(sizeof(CookedMeshHeader));
+	header.uvsOffset = AlignSection(header.positionsOffset + mesh.positions.size() * sizeof(float));
+	header.normalsOffset = AlignSection(header.uvsOffset + mesh.uvs.size() * sizeof(float));
+	header.indicesOffset = AlignSection(header.normalsOffset + mesh.normals.size() * sizeof(float));
+	header.materialsOffset = AlignSection(header.indicesOffset + (unsigned long long)header.nrOfIndices * header.indexSize);
+	header.fileSize = header.materialsOffset + header.nrOfMaterials * sizeof(CookedMaterial);
+
+	CookedMaterial material = {};
+	strncpy(material.materialLib, materialLib.c_str(), sizeof(material.materialLib) - 1);
+
+	std::string cookedPath = GetCookedPath(sourcePath);
+	FILE* file = fopen(cookedPath.c_str(), "wb");
+	if (file == NULL)
+	{
+		printf("ERROR! Could not write the cooked mesh %s\n", cookedPath.c_str());
+		return false;
+	}
+
+	// the header is written without its magic first, so that a file that is only
+	// partly written is never accepted by CookedMesh::Open
+	bool result = WriteAt(file, 0, &header, sizeof(header));
+	result = result && WriteAt(file, header.positionsOffset, mesh.positions.data(), mesh.positions.size() * sizeof(float));
+	result = result && WriteAt(file, header.uvsOffset, mesh.uvs.data(), mesh.uvs.size() * sizeof(float));
+	result = result && WriteAt(file, header.normalsOffset, mesh.normals.data(), mesh.normals.size() * sizeof(float));
+	if (header.indexSize == 2)
+	{
+		std::vector<unsigned short> indices16;
+		mesh.GetIndices16(indices16);
+		result = result && WriteAt(file, header.indicesOffset, indices16.data(), indices16.size() * sizeof(unsigned short));
+	}
+	else
+	{
+		result = result && WriteAt(file, header.indicesOffset, mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int));
+	}
+	result = result && WriteAt(file, header.materialsOffset, &material, sizeof(material));
+
+	fflush(file);
+	memcpy(header.magic, COOKED_MESH_MAGIC, sizeof(COOKED_MESH_MAGIC));
+	result = result && WriteAt(file, 0, &header, sizeof(header));
+
+	fclose(file);
+
+	if (!result)
+	{
+		printf("ERROR! Could not write the cooked mesh %s\n", cookedPath.c_str());
+		remove(cookedPath.c_str());
+	}
+
+	return result;
+}
+
+bool MeshCache::Load(const std::string& sourcePath, CookedMesh& cooked)
+{
+	if (!cooked.Open(GetCookedPath(sourcePath)))
+	{
+		return false;
+	}
+
+	unsigned long long sourceSize = 0;
+	long long sourceModified = 0;
+	if (!GetFileInfo(sourcePath, sourceSize, sourceModified))
+	{
+		// the source is gone, the cooked file is all there is
+		return true;
+	}
+
+	const CookedMeshHeader* header = cooked.GetHeader();
+	if (header->sourceSize != sourceSize)
+	{
+		cooked.Close();
+		return false;
+	}
+
+	// a new modification time does not have to mean new content (e.g. a fresh checkout),
+	// in that case the hash decides
+	if (header->sourceModified != sourceModified)
+	{
+		if (header->sourceHash != HashFile(sourcePath))
+		{
+			cooked.Close();
+			return false;
+		}
+
+		// the same content, the new time is stored so the source is not hashed again on the next start
+		cooked.Close();
+		std::string cookedPath = GetCookedPath(sourcePath);
+		if (!WriteSourceModified(cookedPath, sourceModified))
+		{
+			printf("ERROR! Could not update the cooked mesh %s\n", cookedPath.c_str());
+		}
+		return cooked.Open(cookedPath);
+	}
+
+	return true;
+}
+
+bool MeshCache::GetFileInfo(const std::string& path, unsigned long long& size, long long& modified)
+{
+#ifdef _WIN32
+	struct _stat64 fileStat;
+	if (_stat64(path.c_str(), &fileStat) != 0)
+	{
+		return false;
+	}
+#else
+	struct stat fileStat;
+	if (stat(path.c_str(), &fileStat) != 0)
+	{
+		return false;
+	}
+#endif
+
+	size = (unsigned long long)fileStat.st_size;
+	modified = (long long)fileStat.st_mtime;
+	return true;
+}
+
+unsigned long long MeshCache::HashFile(const std::string& path)
+{
+	MappedFile file;
+	if (!file.Open(path))
+	{
+		return 0;
+	}
+
+	// 64-bit FNV-1a
+	unsigned long long hash = 14695981039346656037ull;
+	const unsigned char* data = (const unsigned char*)file.GetData();
+	for (size_t i = 0; i < file.GetSize(); i++)
+	{
+		hash ^= data[i];
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <string>
+#include "mappedFile.h"
+#include "meshBuilder.h"
+
+// Layout of a cooked mesh file, all sections start on a 16 byte boundary:
+//   CookedMeshHeader
+//   positions	float[3 * nrOfVertices]
+//   uvs		float[2 * nrOfVertices]
+//   normals	float[3 * nrOfVertices]
+//   indices	uint16 or uint32 [nrOfIndices]
+//   materials	CookedMaterial[nrOfMaterials]
+const unsigned int COOKED_MESH_VERSION = 2;
+// version of what the parser, the mesh builder and the vertex cache optimizer make of an obj file.
+// Has to be increased whenever one of them changes its output, the old cooked files are made again then
+const unsigned int MESH_COOKER_VERSION = 1;
+
+struct CookedMeshHeader
+{
+	char magic[4];						// "MESH", only written once the rest of the file is complete
+	unsigned int version;
+
+	// the source file that was cooked, used to see if the cooked file is out of date
+	unsigned long long sourceSize;
+	long long sourceModified;
+	unsigned long long sourceHash;
+
+	unsigned int nrOfVertices;
+	unsigned int nrOfIndices;
+	unsigned int indexSize;				// 2 or 4 bytes
+	unsigned int nrOfMaterials;
+	unsigned int cookerVersion;
+
+	float boundsMin[3];
+	float boundsMax[3];
+
+	unsigned long long positionsOffset;
+	unsigned long long uvsOffset;
+	unsigned long long normalsOffset;
+	unsigned long long indicesOffset;
+	unsigned long long materialsOffset;
+	unsigned long long fileSize;
+};
+
+struct CookedMaterial
+{
+	char materialLib[64];
+};
+
+// A cooked mesh that is mapped into memory. The pointers point straight into the mapping
+// and stay valid until the CookedMesh is closed or destroyed.
+class CookedMesh
+{
+public:
+	CookedMesh();
+	~CookedMesh();
+
+	bool Open(const std::string& cookedPath);
+	void Close();
+
+	const CookedMeshHeader* GetHeader() const;
+	const float* GetPositions() const;
+	const float* GetUVs() const;
+	const float* GetNormals() const;
+	const void* GetIndices() const;
+	const CookedMaterial* GetMaterials() const;
+
+	unsigned int GetNrOfVertices() const;
+	unsigned int GetNrOfIndices() const;
+	unsigned int GetIndexSize() const;
+
+private:
+	MappedFile file;
+	const CookedMeshHeader* header;
+};
+
+class MeshCache
+{
+public:
+	// the cooked file is stored next to the source, e.g. box.obj -> box.obj.mesh
+	static std::string GetCookedPath(const std::string& sourcePath);
+
+	// writes the mesh as a cooked file for the given source
+	static bool Cook(const std::string& sourcePath, const IndexedMesh& mesh, const std::string& materialLib);
+
+	// maps the cooked file of the source, fails if there is none or if it is out of date
+	static bool Load(const std::string& sourcePath, CookedMesh& cooked);
+
+	static bool GetFileInfo(const std::string& path, unsigned long long& size, long long& modified);
+	static unsigned long long HashFile(const std::string& path);
+};
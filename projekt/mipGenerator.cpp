@@ -0,0 +1,123 @@
+#include "mipGenerator.h"
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define MIP_GENERATOR_SSE2
+#endif
+
+namespace
+{
+	// the source columns or rows of a pixel of the next level, a third one for the last pixel of an odd size
+	unsigned int GetTaps(unsigned int size, unsigned int position, unsigned int taps[3])
+	{
+		taps[0] = 2 * position;
+		taps[1] = size > 1 ? 2 * position + 1 : 0;
+		if (size > 1 && size % 2 == 1 && position == size / 2 - 1)
+		{
+			taps[2] = 2 * position + 2;
+			return 3;
+		}
+		return 2;
+	}
+
+	// the rounded average of the taps, 4 to 9 pixels
+	void AveragePixel(const unsigned char* source, size_t sourcePitch, const unsigned int* rows, unsigned int nrOfRows,
+		const unsigned int* columns, unsigned int nrOfColumns, unsigned char* destination)
+	{
+		unsigned int count = nrOfRows * nrOfColumns;
+		for (int channel = 0; channel < 4; channel++)
+		{
+			unsigned int sum = 0;
+			for (unsigned int r = 0; r < nrOfRows; r++)
+			{
+				for (unsigned int c = 0; c < nrOfColumns; c++)
+				{
+					sum += source[rows[r] * sourcePitch + columns[c] * 4 + channel];
+				}
+			}
+			destination[channel] = (unsigned char)((sum + count / 2) / count);
+		}
+	}
+
+	void DownsampleRow(const unsigned char* source, unsigned int width, size_t sourcePitch, const unsigned int* rows,
+		unsigned int nrOfRows, unsigned int firstColumn, unsigned char* destination)
+	{
+		unsigned int mipWidth = MipGenerator::GetMipSize(width, 1);
+		for (unsigned int x = firstColumn; x < mipWidth; x++)
+		{
+			unsigned int columns[3];
+			unsigned int nrOfColumns = GetTaps(width, x, columns);
+			AveragePixel(source, sourcePitch, rows, nrOfRows, columns, nrOfColumns, destination + x * 4);
+		}
+	}
+}
+
+unsigned int MipGenerator::GetNrOfMips(unsigned int width, unsigned int height)
+{
+	unsigned int size = width > height ? width : height;
+	unsigned int mips = 1;
+	while (size > 1)
+	{
+		size /= 2;
+		mips++;
+	}
+	return mips;
+}
+
+unsigned int MipGenerator::GetMipSize(unsigned int size, unsigned int mip)
+{
+	size >>= mip;
+	return size > 0 ? size : 1;
+}
+
+void MipGenerator::Downsample(const unsigned char* source, unsigned int width, unsigned int height, size_t sourcePitch,
+	unsigned char* destination, size_t destinationPitch)
+{
+	unsigned int mipHeight = GetMipSize(height, 1);
+	// the columns with two taps, the last one of an odd width has three
+	unsigned int pairs = width / 2;
+	if (width > 1 && width % 2 == 1)
+	{
+		pairs--;
+	}
+
+	for (unsigned int y = 0; y < mipHeight; y++)
+	{
+		unsigned int rows[3];
+		unsigned int nrOfRows = GetTaps(height, y, rows);
+		unsigned char* row = destination + y * destinationPitch;
+		unsigned int x = 0;
+
+#ifdef MIP_GENERATOR_SSE2
+		// four pixels of the next level from eight pixels of two rows, summed in 16 bits
+		if (nrOfRows == 2)
+		{
+			const unsigned char* top = source + rows[0] * sourcePitch;
+			const unsigned char* bottom = source + rows[1] * sourcePitch;
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i two = _mm_set1_epi16(2);
+			for (; x + 4 <= pairs; x += 4)
+			{
+				__m128i top0 = _mm_loadu_si128((const __m128i*)(top + x * 8));
+				__m128i top1 = _mm_loadu_si128((const __m128i*)(top + x * 8 + 16));
+				__m128i bottom0 = _mm_loadu_si128((const __m128i*)(bottom + x * 8));
+				__m128i bottom1 = _mm_loadu_si128((const __m128i*)(bottom + x * 8 + 16));
+
+				// the columns summed, two source pixels per register
+				__m128i sum01 = _mm_add_epi16(_mm_unpacklo_epi8(top0, zero), _mm_unpacklo_epi8(bottom0, zero));
+				__m128i sum23 = _mm_add_epi16(_mm_unpackhi_epi8(top0, zero), _mm_unpackhi_epi8(bottom0, zero));
+				__m128i sum45 = _mm_add_epi16(_mm_unpacklo_epi8(top1, zero), _mm_unpacklo_epi8(bottom1, zero));
+				__m128i sum67 = _mm_add_epi16(_mm_unpackhi_epi8(top1, zero), _mm_unpackhi_epi8(bottom1, zero));
+
+				// the even and the odd columns summed, then rounded like AveragePixel
+				__m128i left = _mm_add_epi16(_mm_unpacklo_epi64(sum01, sum23), _mm_unpackhi_epi64(sum01, sum23));
+				__m128i right = _mm_add_epi16(_mm_unpacklo_epi64(sum45, sum67), _mm_unpackhi_epi64(sum45, sum67));
+				left = _mm_srli_epi16(_mm_add_epi16(left, two), 2);
+				right = _mm_srli_epi16(_mm_add_epi16(right, two), 2);
+				_mm_storeu_si128((__m128i*)(row + x * 4), _mm_packus_epi16(left, right));
+			}
+		}
+#endif
+
+		DownsampleRow(source, width, sourcePitch, rows, nrOfRows, x, row);
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <stddef.h>
+
+// Makes the mip chain of an 8-bit RGBA image on the cpu, a level at a time. Every level is half
+// the size of the one before it, rounded down and never less than 1, like d3d sizes its mips.
+// The 2x2 box filter is done with sse2 where there is sse2. An odd row or column at the end of
+// a level is not dropped, it is averaged into the last pixel of the next level.
+class MipGenerator
+{
+public:
+	// every level down to 1x1
+	static unsigned int GetNrOfMips(unsigned int width, unsigned int height);
+	// width or height of a level
+	static unsigned int GetMipSize(unsigned int size, unsigned int mip);
+
+	// makes the next level of source into destination, which has to hold
+	// GetMipSize(height, 1) rows of GetMipSize(width, 1) pixels. The pitches are in bytes.
+	static void Downsample(const unsigned char* source, unsigned int width, unsigned int height, size_t sourcePitch,
+		unsigned char* destination, size_t destinationPitch);
+};
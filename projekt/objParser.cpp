@@ -0,0 +1,467 @@
+#include "objParser.h"
+#include "mappedFile.h"
+#include <chrono>
+#include <string.h>
+#include <stdio.h>
+
+namespace
+{
+	enum LineType
+	{
+		LINE_POSITION,
+		LINE_UV,
+		LINE_NORMAL,
+		LINE_FACE,
+		LINE_MTLLIB,
+		LINE_OTHER
+	};
+
+	// exact powers of ten that a double can represent
+	const double powersOfTen[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+		1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	inline bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t';
+	}
+
+	inline bool IsDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	inline void SkipSpaces(const char*& cursor, const char* end)
+	{
+		while (cursor < end && IsSpace(*cursor))
+		{
+			cursor++;
+		}
+	}
+
+	inline const char* NextLine(const char* cursor, const char* end)
+	{
+		const char* newLine = (const char*)memchr(cursor, '\n', end - cursor);
+		return newLine ? newLine + 1 : end;
+	}
+
+	inline bool KeywordEnds(const char* cursor, const char* end)
+	{
+		return cursor == end || IsSpace(*cursor) || *cursor == '\r' || *cursor == '\n';
+	}
+
+	// looks at the keyword at the start of a line and moves the cursor past it
+	LineType ClassifyLine(const char*& cursor, const char* end)
+	{
+		SkipSpaces(cursor, end);
+		if (cursor == end)
+		{
+			return LINE_OTHER;
+		}
+
+		if (cursor[0] == 'v')
+		{
+			if (KeywordEnds(cursor + 1, end))
+			{
+				cursor += 1;
+				return LINE_POSITION;
+			}
+			if (end - cursor >= 2 && KeywordEnds(cursor + 2, end))
+			{
+				if (cursor[1] == 't')
+				{
+					cursor += 2;
+					return LINE_UV;
+				}
+				if (cursor[1] == 'n')
+				{
+					cursor += 2;
+					return LINE_NORMAL;
+				}
+			}
+		}
+		else if (cursor[0] == 'f' && KeywordEnds(cursor + 1, end))
+		{
+			cursor += 1;
+			return LINE_FACE;
+		}
+		else if (end - cursor >= 6 && strncmp(cursor, "mtllib", 6) == 0 && KeywordEnds(cursor + 6, end))
+		{
+			cursor += 6;
+			return LINE_MTLLIB;
+		}
+
+		return LINE_OTHER;
+	}
+
+	// OBJ indices are one-based, negative indices are relative to the end of the list
+	inline int ResolveIndex(int index, size_t count)
+	{
+		if (index > 0)
+		{
+			return index - 1;
+		}
+		if (index < 0)
+		{
+			return (int)count + index;
+		}
+		return -1;
+	}
+}
+
+void ObjMeshData::Clear()
+{
+	positions.clear();
+	uvs.clear();
+	normals.clear();
+	corners.clear();
+	materialLib.clear();
+}
+
+size_t ObjMeshData::GetNrOfTriangles() const
+{
+	return corners.size() / 3;
+}
+
+ObjParser::ObjParser()
+{
+	this->bytesParsed = 0;
+	this->parseTimeMs = 0.0;
+}
+
+ObjParser::~ObjParser()
+{
+}
+
+bool ObjParser::Parse(const std::string& path, ObjMeshData& mesh)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	MappedFile file;
+	if (!file.Open(path))
+	{
+		printf("ERROR LOADING OBJECT! Could not open %s\n", path.c_str());
+		return false;
+	}
+
+	bool result = ParseBuffer(file.GetData(), file.GetSize(), mesh);
+
+	// include the time it took to map the file
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	this->parseTimeMs = elapsed.count();
+
+	return result;
+}
+
+bool ObjParser::ParseBuffer(const char* data, size_t size, ObjMeshData& mesh)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	mesh.Clear();
+	this->bytesParsed = size;
+
+	const char* end = data + size;
+
+	// count the elements first so the attribute arrays can be allocated once and
+	// written in place, this only looks at the keyword of every line
+	size_t nrOfPositions = 0, nrOfUVs = 0, nrOfNormals = 0, nrOfFaces = 0;
+	for (const char* line = data; line < end; line = NextLine(line, end))
+	{
+		const char* cursor = line;
+		switch (ClassifyLine(cursor, end))
+		{
+		case LINE_POSITION: nrOfPositions++; break;
+		case LINE_UV: nrOfUVs++; break;
+		case LINE_NORMAL: nrOfNormals++; break;
+		case LINE_FACE: nrOfFaces++; break;
+		default: break;
+		}
+	}
+
+	mesh.positions.resize(nrOfPositions * 3);
+	mesh.uvs.resize(nrOfUVs * 2);
+	mesh.normals.resize(nrOfNormals * 3);
+	mesh.corners.reserve(nrOfFaces * 3);
+
+	float* position = mesh.positions.data();
+	float* uv = mesh.uvs.data();
+	float* normal = mesh.normals.data();
+	size_t positionsRead = 0, uvsRead = 0, normalsRead = 0;
+
+	const char* cursor = data;
+	while (cursor < end)
+	{
+		const char* lineEnd = (const char*)memchr(cursor, '\n', end - cursor);
+		if (lineEnd == nullptr)
+		{
+			lineEnd = end;
+		}
+
+		switch (ClassifyLine(cursor, lineEnd))
+		{
+		case LINE_POSITION:
+			position[0] = ParseFloat(cursor, lineEnd);
+			position[1] = ParseFloat(cursor, lineEnd);
+			position[2] = ParseFloat(cursor, lineEnd);
+			position += 3;
+			positionsRead++;
+			break;
+		case LINE_UV:
+			uv[0] = ParseFloat(cursor, lineEnd);
+			//have to flip the y-coordinates because openGl starts at the bottom
+			uv[1] = 1.0f - ParseFloat(cursor, lineEnd);
+			uv += 2;
+			uvsRead++;
+			break;
+		case LINE_NORMAL:
+			normal[0] = ParseFloat(cursor, lineEnd);
+			normal[1] = ParseFloat(cursor, lineEnd);
+			normal[2] = ParseFloat(cursor, lineEnd);
+			normal += 3;
+			normalsRead++;
+			break;
+		case LINE_FACE:
+			if (!ParseFace(cursor, lineEnd, mesh, positionsRead, uvsRead, normalsRead))
+			{
+				// the rest of the file is not read, a mesh with holes in it is never used
+				mesh.Clear();
+				return false;
+			}
+			break;
+		case LINE_MTLLIB:
+		{
+			SkipSpaces(cursor, lineEnd);
+			const char* nameEnd = lineEnd;
+			while (nameEnd > cursor && (IsSpace(nameEnd[-1]) || nameEnd[-1] == '\r'))
+			{
+				nameEnd--;
+			}
+			mesh.materialLib.assign(cursor, nameEnd);
+			break;
+		}
+		default:
+			break;
+		}
+
+		cursor = lineEnd + 1;
+	}
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	this->parseTimeMs = elapsed.count();
+
+	return true;
+}
+
+size_t ObjParser::GetBytesParsed() const
+{
+	return this->bytesParsed;
+}
+
+double ObjParser::GetParseTimeMs() const
+{
+	return this->parseTimeMs;
+}
+
+double ObjParser::GetBytesPerSecond() const
+{
+	if (this->parseTimeMs <= 0.0)
+	{
+		return 0.0;
+	}
+	return this->bytesParsed / (this->parseTimeMs / 1000.0);
+}
+
+float ObjParser::ParseFloat(const char*& cursor, const char* end)
+{
+	SkipSpaces(cursor, end);
+
+	bool negative = false;
+	if (cursor < end && (*cursor == '-' || *cursor == '+'))
+	{
+		negative = *cursor == '-';
+		cursor++;
+	}
+
+	// collect up to 19 significant digits, which always fits in 64 bits
+	unsigned long long mantissa = 0;
+	int significantDigits = 0;
+	int exponent = 0;
+
+	while (cursor < end && IsDigit(*cursor))
+	{
+		if (significantDigits < 19)
+		{
+			mantissa = mantissa * 10 + (*cursor - '0');
+			if (mantissa != 0)
+			{
+				significantDigits++;
+			}
+		}
+		else
+		{
+			exponent++;
+		}
+		cursor++;
+	}
+
+	if (cursor < end && *cursor == '.')
+	{
+		cursor++;
+		while (cursor < end && IsDigit(*cursor))
+		{
+			if (significantDigits < 19)
+			{
+				mantissa = mantissa * 10 + (*cursor - '0');
+				if (mantissa != 0)
+				{
+					significantDigits++;
+				}
+				exponent--;
+			}
+			cursor++;
+		}
+	}
+
+	if (cursor < end && (*cursor == 'e' || *cursor == 'E'))
+	{
+		cursor++;
+		bool negativeExponent = false;
+		if (cursor < end && (*cursor == '-' || *cursor == '+'))
+		{
+			negativeExponent = *cursor == '-';
+			cursor++;
+		}
+
+		int value = 0;
+		while (cursor < end && IsDigit(*cursor))
+		{
+			if (value < 10000)
+			{
+				value = value * 10 + (*cursor - '0');
+			}
+			cursor++;
+		}
+		exponent += negativeExponent ? -value : value;
+	}
+
+	double result = (double)mantissa;
+	while (exponent > 22)
+	{
+		result *= powersOfTen[22];
+		exponent -= 22;
+	}
+	while (exponent < -22)
+	{
+		result /= powersOfTen[22];
+		exponent += 22;
+	}
+	if (exponent > 0)
+	{
+		result *= powersOfTen[exponent];
+	}
+	else if (exponent < 0)
+	{
+		result /= powersOfTen[-exponent];
+	}
+
+	return (float)(negative ? -result : result);
+}
+
+bool ObjParser::ParseInt(const char*& cursor, const char* end, int& value)
+{
+	bool negative = false;
+	if (cursor < end && (*cursor == '-' || *cursor == '+'))
+	{
+		negative = *cursor == '-';
+		cursor++;
+	}
+
+	if (cursor == end || !IsDigit(*cursor))
+	{
+		return false;
+	}
+
+	int result = 0;
+	while (cursor < end && IsDigit(*cursor))
+	{
+		result = result * 10 + (*cursor - '0');
+		cursor++;
+	}
+
+	value = negative ? -result : result;
+	return true;
+}
+
+bool ObjParser::ParseFace(const char*& cursor, const char* end, ObjMeshData& mesh, size_t nrOfPositions, size_t nrOfUVs, size_t nrOfNormals)
+{
+	ObjCorner first = { -1, -1, -1 };
+	ObjCorner previous = { -1, -1, -1 };
+	int nrOfCorners = 0;
+
+	while (true)
+	{
+		SkipSpaces(cursor, end);
+		if (cursor == end || *cursor == '\r')
+		{
+			break;
+		}
+
+		// every corner is v, v/vt, v//vn or v/vt/vn
+		ObjCorner corner = { -1, -1, -1 };
+		int value = 0;
+		if (!ParseInt(cursor, end, value))
+		{
+			printf("ERROR! The object can not be read by the parser!\n");
+			return false;
+		}
+		corner.position = ResolveIndex(value, nrOfPositions);
+
+		if (cursor < end && *cursor == '/')
+		{
+			cursor++;
+			if (ParseInt(cursor, end, value))
+			{
+				corner.uv = ResolveIndex(value, nrOfUVs);
+			}
+			if (cursor < end && *cursor == '/')
+			{
+				cursor++;
+				if (ParseInt(cursor, end, value))
+				{
+					corner.normal = ResolveIndex(value, nrOfNormals);
+				}
+			}
+		}
+
+		if (corner.position < 0 || corner.position >= (int)nrOfPositions ||
+			corner.uv < -1 || corner.uv >= (int)nrOfUVs ||
+			corner.normal < -1 || corner.normal >= (int)nrOfNormals)
+		{
+			printf("ERROR! The object references a vertex that does not exist!\n");
+			return false;
+		}
+
+		// polygons with more than three corners are split into a triangle fan
+		if (nrOfCorners == 0)
+		{
+			first = corner;
+		}
+		else if (nrOfCorners >= 2)
+		{
+			mesh.corners.push_back(first);
+			mesh.corners.push_back(previous);
+			mesh.corners.push_back(corner);
+		}
+
+		previous = corner;
+		nrOfCorners++;
+	}
+
+	if (nrOfCorners < 3)
+	{
+		printf("ERROR! The object contains a face with less than three corners!\n");
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <stddef.h>
+
+// one corner of a triangle. The indices are zero-based and point into the attribute
+// arrays of ObjMeshData, -1 means that the corner did not reference that attribute
+struct ObjCorner
+{
+	int position;
+	int uv;
+	int normal;
+};
+
+struct ObjMeshData
+{
+	std::vector<float> positions;	// x, y, z per "v" line
+	std::vector<float> uvs;			// u, v per "vt" line (v is flipped for d3d)
+	std::vector<float> normals;		// x, y, z per "vn" line
+	std::vector<ObjCorner> corners;	// three per triangle, polygons are triangulated as fans
+	std::string materialLib;
+
+	void Clear();
+	size_t GetNrOfTriangles() const;
+};
+
+// Single pass OBJ parser working on a memory mapped file. It does not use FILE* or any
+// locale dependent conversion and has no Windows dependencies.
+class ObjParser
+{
+public:
+	ObjParser();
+	~ObjParser();
+
+	// false if the file can not be read or has a broken face, the mesh is empty then
+	bool Parse(const std::string& path, ObjMeshData& mesh);
+	bool ParseBuffer(const char* data, size_t size, ObjMeshData& mesh);
+
+	// statistics from the last call to Parse/ParseBuffer
+	size_t GetBytesParsed() const;
+	double GetParseTimeMs() const;
+	double GetBytesPerSecond() const;
+
+	static float ParseFloat(const char*& cursor, const char* end);
+	static bool ParseInt(const char*& cursor, const char* end, int& value);
+
+private:
+	bool ParseFace(const char*& cursor, const char* end, ObjMeshData& mesh, size_t nrOfPositions, size_t nrOfUVs, size_t nrOfNormals);
+
+	size_t bytesParsed;
+	double parseTimeMs;
+};
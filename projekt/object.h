@@ -1,10 +1,12 @@
 #pragma once
 #include "constantBuffer.h"
-#include "vertexbuffer.h"
+#include "mesh.h"
 #include <vector>
 #include <string>
+#include <memory>
 #include <D3Dcompiler.h>
 #include "texture.h"
+#include "pipelineCache.h"
 
 #define MATRIXSIZE 16
 
@@ -14,58 +16,42 @@ public:
 	Object();
 	~Object();
 
-	void InitializeMatrices();
-
 	void CreateConstantBuffer();
-	void CreateVertexBuffer(ID3D12Device5* device, float* data, size_t size);
-	void CreateMaterials(ID3D12Device5* device, bool wireframe, ID3D12RootSignature* rootSignature);
-	bool CreateShaders();
-	bool CreatePSO(ID3D12Device5* device, bool wireframe, ID3D12RootSignature* rootSignature);
+	// the shaders and the pipeline state come from the cache and are shared with the other objects
+	void CreateMaterials(ID3D12Device5* device, bool wireframe, ID3D12RootSignature* rootSignature, PipelineCache* cache);
+	bool CreateShaders(PipelineCache* cache);
+	bool CreatePSO(ID3D12Device5* device, bool wireframe, ID3D12RootSignature* rootSignature, PipelineCache* cache);
 
 	ConstantBuffer* GetConstantBuffer();
-	VertexBuffer* GetVertexBuffer(int index);
+	const MeshRange& GetMeshRange();
 
 	ID3D12PipelineState* GetPipeLineState();
 
-	XMFLOAT4* GetPosition();
-	float* GetScale();
-	XMFLOAT4X4* GetRotMatrix();
-	XMFLOAT4X4* GetWorldMatrix();
+	// index of the object's transform in the renderer's TransformSystem
+	int GetTransform();
 	int GetNrOfVertices();
+	int GetNrOfIndices();
+	Mesh* GetMesh();
 	Texture* GetTexture();
+	bool IsWireframe();
 
-	void SetScale(float* scale);
-	void SetPosition(XMFLOAT4 pos);
-	void SetRotMatrix(XMMATRIX rotMat);
-	void SetWorldMatrix(XMMATRIX worldMat);
-
-	void LoadObj(std::string path, ID3D12Device5* device);
-	void LoadMtl(const char* mtlPath);
+	void SetTransform(int transform);
+	void SetMesh(std::shared_ptr<Mesh> mesh);
+	void SetTexture(std::shared_ptr<Texture> texture);
 
 private:
-	XMFLOAT4 position;
-	float scale[3];
-
-	XMFLOAT4X4 worldMat;
-	XMFLOAT4X4 rotMat; 
-	XMVECTOR posVec;
+	int transform;
+	bool wireframe;
 
 	ConstantBuffer* constantBuffer;
-	std::vector<VertexBuffer*> vertexBuffers;
 
+	// shared with every other object that was created from the same files
+	std::shared_ptr<Mesh> mesh;
+	std::shared_ptr<Texture> texture;
+
+	// owned by the PipelineCache
 	ID3DBlob* VSshader;
 	ID3DBlob* PSshader;
 
 	ID3D12PipelineState* pipeLineState;
-
-	std::vector<XMFLOAT3> out_vertices;
-	std::vector<float> dataVector;
-
-	char material[50];
-	char textureName[50];
-	std::vector<XMFLOAT2> out_UVs;
-	std::vector<float> uvVector;
-
-	Texture* texture;
-	std::vector<std::string>textureVec;
 };
\ No newline at end of file
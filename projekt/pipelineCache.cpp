@@ -0,0 +1,272 @@
+#include "pipelineCache.h"
+#include "mappedFile.h"
+#include <iostream>
+#include <string.h>
+
+// release builds get optimized shaders, debug builds keep them debuggable
+#ifdef _DEBUG
+const UINT SHADER_COMPILE_FLAGS = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION | D3DCOMPILE_ENABLE_UNBOUNDED_DESCRIPTOR_TABLES;
+#else
+const UINT SHADER_COMPILE_FLAGS = D3DCOMPILE_OPTIMIZATION_LEVEL3 | D3DCOMPILE_ENABLE_UNBOUNDED_DESCRIPTOR_TABLES;
+#endif
+
+namespace
+{
+	// The bytes of a cache key. Large data such as the shader source or bytecode is added as its
+	// 64-bit FNV-1a hash, everything else as it is, so two keys are only equal if all their small
+	// fields are and their large data has the same hash.
+	class KeyWriter
+	{
+	public:
+		void Add(const void* data, size_t size)
+		{
+			key.append((const char*)data, size);
+		}
+
+		// the terminating zero is added as well, so "ab","c" and "a","bc" differ
+		void Add(const char* text)
+		{
+			Add(text, text != nullptr ? strlen(text) + 1 : 0);
+		}
+
+		// only for values without padding, the padding bytes of a struct are not always zero
+		template<typename T>
+		void Add(const T& value)
+		{
+			Add(&value, sizeof(value));
+		}
+
+		void AddHash(const void* data, size_t size)
+		{
+			unsigned long long hash = 14695981039346656037ull;
+			const unsigned char* bytes = (const unsigned char*)data;
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= 1099511628211ull;
+			}
+			Add(size);
+			Add(hash);
+		}
+
+		void Add(const D3D12_SHADER_BYTECODE& shader)
+		{
+			AddHash(shader.pShaderBytecode, shader.pShaderBytecode != nullptr ? shader.BytecodeLength : 0);
+		}
+
+		const std::string& Get()
+		{
+			return key;
+		}
+
+	private:
+		std::string key;
+	};
+}
+
+PipelineCache::PipelineCache()
+{
+	shaderHits = 0;
+	shaderMisses = 0;
+	pipelineStateHits = 0;
+	pipelineStateMisses = 0;
+}
+
+PipelineCache::~PipelineCache()
+{
+	for (auto it = shaders.begin(); it != shaders.end(); it++)
+	{
+		it->second->Release();
+	}
+	for (auto it = pipelineStates.begin(); it != pipelineStates.end(); it++)
+	{
+		it->second.pipelineState->Release();
+		if (it->second.rootSignature != nullptr)
+		{
+			it->second.rootSignature->Release();
+		}
+	}
+}
+
+ID3DBlob* PipelineCache::GetShader(const std::string& path, const D3D_SHADER_MACRO* defines, const char* entry, const char* target)
+{
+	// the file is read once for the key and compiled from memory
+	MappedFile file;
+	if (!file.Open(path))
+	{
+		OutputDebugStringA(("ERROR: Could not open the shader " + path + "\n").c_str());
+		return nullptr;
+	}
+
+	KeyWriter key;
+	key.AddHash(file.GetData(), file.GetSize());
+	for (const D3D_SHADER_MACRO* define = defines; define != nullptr && define->Name != nullptr; define++)
+	{
+		key.Add(define->Name);
+		key.Add(define->Definition != nullptr ? define->Definition : "");
+	}
+	// the end of the defines, so they can not run into the entry point
+	key.Add("");
+	key.Add(entry);
+	key.Add(target);
+	key.Add(SHADER_COMPILE_FLAGS);
+
+	auto found = shaders.find(key.Get());
+	if (found != shaders.end())
+	{
+		shaderHits++;
+		return found->second;
+	}
+
+	ID3DBlob* shader = nullptr;
+	ID3DBlob* errorBuff = nullptr;
+	HRESULT hr = D3DCompile(file.GetData(),
+		file.GetSize(),
+		path.c_str(),
+		defines,
+		nullptr,
+		entry,
+		target,
+		SHADER_COMPILE_FLAGS,
+		0,
+		&shader,
+		&errorBuff);
+
+	if (FAILED(hr))
+	{
+		if (errorBuff != nullptr)
+		{
+			OutputDebugStringA((char*)errorBuff->GetBufferPointer());
+			errorBuff->Release();
+		}
+		return nullptr;
+	}
+	if (errorBuff != nullptr)
+	{
+		errorBuff->Release();
+	}
+
+	shaderMisses++;
+	shaders[key.Get()] = shader;
+	return shader;
+}
+
+ID3D12PipelineState* PipelineCache::GetPipelineState(ID3D12Device5* device, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+{
+	// field by field, the blend and depth stencil descs have padding
+	KeyWriter key;
+	key.Add(desc.pRootSignature);
+	key.Add(desc.VS);
+	key.Add(desc.PS);
+	key.Add(desc.DS);
+	key.Add(desc.HS);
+	key.Add(desc.GS);
+
+	key.Add(desc.BlendState.AlphaToCoverageEnable);
+	key.Add(desc.BlendState.IndependentBlendEnable);
+	for (UINT i = 0; i < D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT; i++)
+	{
+		const D3D12_RENDER_TARGET_BLEND_DESC& blend = desc.BlendState.RenderTarget[i];
+		key.Add(blend.BlendEnable);
+		key.Add(blend.LogicOpEnable);
+		key.Add(blend.SrcBlend);
+		key.Add(blend.DestBlend);
+		key.Add(blend.BlendOp);
+		key.Add(blend.SrcBlendAlpha);
+		key.Add(blend.DestBlendAlpha);
+		key.Add(blend.BlendOpAlpha);
+		key.Add(blend.LogicOp);
+		key.Add(blend.RenderTargetWriteMask);
+	}
+	key.Add(desc.SampleMask);
+
+	// only 4 byte members, no padding
+	key.Add(desc.RasterizerState);
+
+	const D3D12_DEPTH_STENCIL_DESC& depth = desc.DepthStencilState;
+	key.Add(depth.DepthEnable);
+	key.Add(depth.DepthWriteMask);
+	key.Add(depth.DepthFunc);
+	key.Add(depth.StencilEnable);
+	key.Add(depth.StencilReadMask);
+	key.Add(depth.StencilWriteMask);
+	key.Add(depth.FrontFace);
+	key.Add(depth.BackFace);
+
+	for (UINT i = 0; i < desc.InputLayout.NumElements; i++)
+	{
+		const D3D12_INPUT_ELEMENT_DESC& element = desc.InputLayout.pInputElementDescs[i];
+		key.Add(element.SemanticName);
+		key.Add(element.SemanticIndex);
+		key.Add(element.Format);
+		key.Add(element.InputSlot);
+		key.Add(element.AlignedByteOffset);
+		key.Add(element.InputSlotClass);
+		key.Add(element.InstanceDataStepRate);
+	}
+
+	key.Add(desc.IBStripCutValue);
+	key.Add(desc.PrimitiveTopologyType);
+	key.Add(desc.NumRenderTargets);
+	for (UINT i = 0; i < desc.NumRenderTargets; i++)
+	{
+		key.Add(desc.RTVFormats[i]);
+	}
+	key.Add(desc.DSVFormat);
+	key.Add(desc.SampleDesc);
+	key.Add(desc.NodeMask);
+	key.Add(desc.Flags);
+
+	auto found = pipelineStates.find(key.Get());
+	if (found != pipelineStates.end())
+	{
+		pipelineStateHits++;
+		return found->second.pipelineState;
+	}
+
+	ID3D12PipelineState* pipelineState = nullptr;
+	if (!SUCCEEDED(device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pipelineState))))
+	{
+		OutputDebugStringA("ERROR: Could not create the pipeline state!\n");
+		return nullptr;
+	}
+
+	// the key holds the address of the root signature, it must not be released and another one
+	// created there while the pipeline state is cached
+	if (desc.pRootSignature != nullptr)
+	{
+		desc.pRootSignature->AddRef();
+	}
+	CachedPipelineState cached;
+	cached.pipelineState = pipelineState;
+	cached.rootSignature = desc.pRootSignature;
+	pipelineStateMisses++;
+	pipelineStates[key.Get()] = cached;
+	return pipelineState;
+}
+
+unsigned int PipelineCache::GetShaderHits()
+{
+	return this->shaderHits;
+}
+
+unsigned int PipelineCache::GetShaderMisses()
+{
+	return this->shaderMisses;
+}
+
+unsigned int PipelineCache::GetPipelineStateHits()
+{
+	return this->pipelineStateHits;
+}
+
+unsigned int PipelineCache::GetPipelineStateMisses()
+{
+	return this->pipelineStateMisses;
+}
+
+void PipelineCache::PrintStats()
+{
+	std::cout << "Shaders: " << shaderMisses << " compiled, " << shaderHits << " shared" << std::endl;
+	std::cout << "Pipeline states: " << pipelineStateMisses << " created, " << pipelineStateHits << " shared" << std::endl;
+}
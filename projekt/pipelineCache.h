@@ -0,0 +1,50 @@
+#pragma once
+#include <d3d12.h>
+#include <D3Dcompiler.h>
+#include <map>
+#include <string>
+
+// Compiled shaders and pipeline states shared by every object. A shader is compiled once per
+// source text, defines, entry point and target, a pipeline state is created once per shaders
+// and fixed function state. Owns everything it hands out, used from the thread that creates
+// the objects.
+class PipelineCache
+{
+public:
+	PipelineCache();
+	~PipelineCache();
+
+	// nullptr if the file can not be read or does not compile, the errors go to the debug output.
+	// The key is the hash of the file and the defines, entry point, target and compile flags,
+	// files it includes are not part of it.
+	ID3DBlob* GetShader(const std::string& path, const D3D_SHADER_MACRO* defines, const char* entry, const char* target);
+	// the key is the root signature, the hashes of the shader bytecode and the fixed function state
+	// of desc, stream output and cached blobs are not part of it. The root signature is referenced
+	// until the cache is destroyed.
+	ID3D12PipelineState* GetPipelineState(ID3D12Device5* device, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+
+	unsigned int GetShaderHits();
+	unsigned int GetShaderMisses();
+	unsigned int GetPipelineStateHits();
+	unsigned int GetPipelineStateMisses();
+	void PrintStats();
+
+private:
+	PipelineCache(const PipelineCache&) = delete;
+	PipelineCache& operator=(const PipelineCache&) = delete;
+
+	struct CachedPipelineState
+	{
+		ID3D12PipelineState* pipelineState;
+		ID3D12RootSignature* rootSignature;
+	};
+
+	// keyed by all the fields of the key, so a hit is only an equal key and never a collision
+	std::map<std::string, ID3DBlob*> shaders;
+	std::map<std::string, CachedPipelineState> pipelineStates;
+
+	unsigned int shaderHits;
+	unsigned int shaderMisses;
+	unsigned int pipelineStateHits;
+	unsigned int pipelineStateMisses;
+};
@@ -0,0 +1,435 @@
+#include "pngDecoder.h"
+#include "inflate.h"
+#include <string.h>
+
+namespace
+{
+	const unsigned char PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+
+	enum PngColorType
+	{
+		GRAY = 0,
+		RGB = 2,
+		PALETTE = 3,
+		GRAY_ALPHA = 4,
+		RGBA = 6
+	};
+
+	struct PngInfo
+	{
+		unsigned int width;
+		unsigned int height;
+		unsigned int bitDepth;
+		unsigned int colorType;
+		unsigned int channels;
+		bool interlaced;
+
+		unsigned char palette[256][4];
+		unsigned int paletteSize;
+
+		// tRNS color key of gray and rgb images, in the bit depth of the image
+		bool hasColorKey;
+		unsigned int colorKey[3];
+	};
+
+	inline unsigned int ReadU32(const unsigned char* data)
+	{
+		return ((unsigned int)data[0] << 24) | ((unsigned int)data[1] << 16) | ((unsigned int)data[2] << 8) | data[3];
+	}
+
+	inline unsigned int ReadU16(const unsigned char* data)
+	{
+		return ((unsigned int)data[0] << 8) | data[1];
+	}
+
+	bool ReadHeader(const unsigned char* data, unsigned int length, PngInfo& info)
+	{
+		if (length != 13)
+		{
+			return false;
+		}
+
+		info.width = ReadU32(data);
+		info.height = ReadU32(data + 4);
+		info.bitDepth = data[8];
+		info.colorType = data[9];
+		info.interlaced = data[12] == 1;
+
+		// only deflate compression and adaptive filtering exist
+		if (data[10] != 0 || data[11] != 0 || data[12] > 1)
+		{
+			return false;
+		}
+		if (info.width == 0 || info.height == 0 || info.width > (1 << 24) || info.height > (1 << 24) ||
+			(unsigned long long)info.width * info.height > (1ull << 28))
+		{
+			return false;
+		}
+
+		const unsigned int depth = info.bitDepth;
+		switch (info.colorType)
+		{
+		case GRAY:
+			info.channels = 1;
+			return depth == 1 || depth == 2 || depth == 4 || depth == 8 || depth == 16;
+		case PALETTE:
+			info.channels = 1;
+			return depth == 1 || depth == 2 || depth == 4 || depth == 8;
+		case RGB:
+			info.channels = 3;
+			return depth == 8 || depth == 16;
+		case GRAY_ALPHA:
+			info.channels = 2;
+			return depth == 8 || depth == 16;
+		case RGBA:
+			info.channels = 4;
+			return depth == 8 || depth == 16;
+		default:
+			return false;
+		}
+	}
+
+	inline unsigned char Paeth(int a, int b, int c)
+	{
+		int p = a + b - c;
+		int pa = p > a ? p - a : a - p;
+		int pb = p > b ? p - b : b - p;
+		int pc = p > c ? p - c : c - p;
+		if (pa <= pb && pa <= pc)
+		{
+			return (unsigned char)a;
+		}
+		return (unsigned char)(pb <= pc ? b : c);
+	}
+
+	// undoes the filter of a row in place, previous is the unfiltered row above or null
+	bool Unfilter(unsigned int filter, unsigned char* row, const unsigned char* previous, size_t rowBytes, size_t pixelBytes)
+	{
+		switch (filter)
+		{
+		case 0:
+			break;
+		case 1:
+			for (size_t i = pixelBytes; i < rowBytes; i++)
+			{
+				row[i] = (unsigned char)(row[i] + row[i - pixelBytes]);
+			}
+			break;
+		case 2:
+			if (previous != nullptr)
+			{
+				for (size_t i = 0; i < rowBytes; i++)
+				{
+					row[i] = (unsigned char)(row[i] + previous[i]);
+				}
+			}
+			break;
+		case 3:
+			for (size_t i = 0; i < rowBytes; i++)
+			{
+				int left = i >= pixelBytes ? row[i - pixelBytes] : 0;
+				int up = previous != nullptr ? previous[i] : 0;
+				row[i] = (unsigned char)(row[i] + ((left + up) >> 1));
+			}
+			break;
+		case 4:
+			for (size_t i = 0; i < rowBytes; i++)
+			{
+				int left = i >= pixelBytes ? row[i - pixelBytes] : 0;
+				int up = previous != nullptr ? previous[i] : 0;
+				int upLeft = i >= pixelBytes && previous != nullptr ? previous[i - pixelBytes] : 0;
+				row[i] = (unsigned char)(row[i] + Paeth(left, up, upLeft));
+			}
+			break;
+		default:
+			return false;
+		}
+
+		return true;
+	}
+
+	inline unsigned int ReadSample(const unsigned char* row, unsigned int index, unsigned int bitDepth)
+	{
+		if (bitDepth == 8)
+		{
+			return row[index];
+		}
+		if (bitDepth == 16)
+		{
+			return ReadU16(row + index * 2);
+		}
+
+		// packed samples, the leftmost pixel is in the high bits
+		const unsigned int bit = index * bitDepth;
+		return (row[bit >> 3] >> (8 - bitDepth - (bit & 7))) & ((1u << bitDepth) - 1);
+	}
+
+	// converts one unfiltered row to RGBA, pixelStep is the distance between two output pixels
+	void ConvertRow(const unsigned char* row, unsigned int width, const PngInfo& info, unsigned char* out, size_t pixelStep)
+	{
+		const unsigned int depth = info.bitDepth;
+
+		// the common cases without any conversion per sample
+		if (depth == 8 && info.colorType == RGBA && pixelStep == 4)
+		{
+			memcpy(out, row, (size_t)width * 4);
+			return;
+		}
+		if (depth == 8 && info.colorType == RGB && !info.hasColorKey)
+		{
+			for (unsigned int x = 0; x < width; x++, out += pixelStep, row += 3)
+			{
+				out[0] = row[0];
+				out[1] = row[1];
+				out[2] = row[2];
+				out[3] = 255;
+			}
+			return;
+		}
+
+		// 16-bit samples keep their upper byte, smaller gray samples are scaled up to 255
+		const unsigned int shift = depth == 16 ? 8 : 0;
+		const unsigned int maxValue = (1u << depth) - 1;
+
+		for (unsigned int x = 0; x < width; x++, out += pixelStep)
+		{
+			switch (info.colorType)
+			{
+			case GRAY:
+			{
+				unsigned int gray = ReadSample(row, x, depth);
+				unsigned char value = (unsigned char)(depth >= 8 ? gray >> shift : gray * 255 / maxValue);
+				out[0] = value;
+				out[1] = value;
+				out[2] = value;
+				out[3] = info.hasColorKey && gray == info.colorKey[0] ? 0 : 255;
+				break;
+			}
+			case RGB:
+			{
+				unsigned int r = ReadSample(row, x * 3, depth);
+				unsigned int g = ReadSample(row, x * 3 + 1, depth);
+				unsigned int b = ReadSample(row, x * 3 + 2, depth);
+				out[0] = (unsigned char)(r >> shift);
+				out[1] = (unsigned char)(g >> shift);
+				out[2] = (unsigned char)(b >> shift);
+				out[3] = info.hasColorKey && r == info.colorKey[0] && g == info.colorKey[1] && b == info.colorKey[2] ? 0 : 255;
+				break;
+			}
+			case PALETTE:
+			{
+				unsigned int index = ReadSample(row, x, depth);
+				static const unsigned char missing[4] = { 0, 0, 0, 255 };
+				memcpy(out, index < info.paletteSize ? info.palette[index] : missing, 4);
+				break;
+			}
+			case GRAY_ALPHA:
+			{
+				unsigned char value = (unsigned char)(ReadSample(row, x * 2, depth) >> shift);
+				out[0] = value;
+				out[1] = value;
+				out[2] = value;
+				out[3] = (unsigned char)(ReadSample(row, x * 2 + 1, depth) >> shift);
+				break;
+			}
+			case RGBA:
+			{
+				for (unsigned int c = 0; c < 4; c++)
+				{
+					out[c] = (unsigned char)(ReadSample(row, x * 4 + c, depth) >> shift);
+				}
+				break;
+			}
+			}
+		}
+	}
+
+	inline size_t GetRowBytes(const PngInfo& info, unsigned int width)
+	{
+		return ((size_t)width * info.channels * info.bitDepth + 7) / 8;
+	}
+
+	// unfilters and converts one (sub)image, an interlaced image has seven of them
+	bool DecodePass(unsigned char*& raw, const unsigned char* rawEnd, const PngInfo& info,
+		unsigned int x0, unsigned int y0, unsigned int dx, unsigned int dy, DecodedImage& image)
+	{
+		const unsigned int width = info.width > x0 ? (info.width - x0 + dx - 1) / dx : 0;
+		const unsigned int height = info.height > y0 ? (info.height - y0 + dy - 1) / dy : 0;
+		if (width == 0 || height == 0)
+		{
+			return true;
+		}
+
+		const size_t rowBytes = GetRowBytes(info, width);
+		const size_t pixelBytes = info.channels * info.bitDepth >= 8 ? info.channels * info.bitDepth / 8 : 1;
+		if ((size_t)(rawEnd - raw) < (rowBytes + 1) * height)
+		{
+			return false;
+		}
+
+		const unsigned char* previous = nullptr;
+		for (unsigned int y = 0; y < height; y++)
+		{
+			unsigned char* row = raw + 1;
+			if (!Unfilter(raw[0], row, previous, rowBytes, pixelBytes))
+			{
+				return false;
+			}
+
+			unsigned char* out = image.pixels.data() + (((size_t)(y0 + y * dy)) * info.width + x0) * 4;
+			ConvertRow(row, width, info, out, (size_t)dx * 4);
+
+			previous = row;
+			raw += rowBytes + 1;
+		}
+
+		return true;
+	}
+}
+
+const char* PngDecoder::GetName() const
+{
+	return "png";
+}
+
+bool PngDecoder::CanDecode(const unsigned char* data, size_t size) const
+{
+	return size >= sizeof(PNG_SIGNATURE) && memcmp(data, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) == 0;
+}
+
+bool PngDecoder::Decode(const unsigned char* data, size_t size, DecodedImage& image) const
+{
+	if (!CanDecode(data, size))
+	{
+		return false;
+	}
+
+	PngInfo info = {};
+	bool hasHeader = false;
+	std::vector<unsigned char> compressed;
+
+	// chunks: length, type, data, crc. The crc is not checked, inflate finds broken data
+	size_t pos = sizeof(PNG_SIGNATURE);
+	while (pos + 12 <= size)
+	{
+		const unsigned int length = ReadU32(data + pos);
+		const unsigned char* type = data + pos + 4;
+		const unsigned char* chunk = data + pos + 8;
+		if (length > size - pos - 12)
+		{
+			return false;
+		}
+		pos += (size_t)length + 12;
+
+		if (memcmp(type, "IHDR", 4) == 0)
+		{
+			if (!ReadHeader(chunk, length, info))
+			{
+				return false;
+			}
+			hasHeader = true;
+		}
+		else if (!hasHeader)
+		{
+			return false;
+		}
+		else if (memcmp(type, "PLTE", 4) == 0)
+		{
+			if (length % 3 != 0 || length / 3 > 256)
+			{
+				return false;
+			}
+			info.paletteSize = length / 3;
+			for (unsigned int i = 0; i < info.paletteSize; i++)
+			{
+				info.palette[i][0] = chunk[i * 3];
+				info.palette[i][1] = chunk[i * 3 + 1];
+				info.palette[i][2] = chunk[i * 3 + 2];
+				info.palette[i][3] = 255;
+			}
+		}
+		else if (memcmp(type, "tRNS", 4) == 0)
+		{
+			if (info.colorType == PALETTE)
+			{
+				for (unsigned int i = 0; i < length && i < 256; i++)
+				{
+					info.palette[i][3] = chunk[i];
+				}
+			}
+			else if (info.colorType == GRAY && length >= 2)
+			{
+				info.hasColorKey = true;
+				info.colorKey[0] = ReadU16(chunk);
+			}
+			else if (info.colorType == RGB && length >= 6)
+			{
+				info.hasColorKey = true;
+				info.colorKey[0] = ReadU16(chunk);
+				info.colorKey[1] = ReadU16(chunk + 2);
+				info.colorKey[2] = ReadU16(chunk + 4);
+			}
+		}
+		else if (memcmp(type, "IDAT", 4) == 0)
+		{
+			compressed.insert(compressed.end(), chunk, chunk + length);
+		}
+		else if (memcmp(type, "IEND", 4) == 0)
+		{
+			break;
+		}
+	}
+
+	if (!hasHeader || compressed.empty() || (info.colorType == PALETTE && info.paletteSize == 0))
+	{
+		return false;
+	}
+
+	// the size of the filtered data is known up front, every row starts with its filter type
+	static const unsigned int ADAM7[7][4] =
+	{
+		// x0, y0, dx, dy
+		{ 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 }, { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 }
+	};
+	static const unsigned int SINGLE_PASS[1][4] = { { 0, 0, 1, 1 } };
+	const unsigned int(*passes)[4] = info.interlaced ? ADAM7 : SINGLE_PASS;
+	const int nrOfPasses = info.interlaced ? 7 : 1;
+
+	size_t rawSize = 0;
+	for (int p = 0; p < nrOfPasses; p++)
+	{
+		unsigned int x0 = passes[p][0], y0 = passes[p][1], dx = passes[p][2], dy = passes[p][3];
+		unsigned int width = info.width > x0 ? (info.width - x0 + dx - 1) / dx : 0;
+		unsigned int height = info.height > y0 ? (info.height - y0 + dy - 1) / dy : 0;
+		if (width > 0 && height > 0)
+		{
+			rawSize += (GetRowBytes(info, width) + 1) * height;
+		}
+	}
+
+	std::vector<unsigned char> raw;
+	// deflate makes at most 1032 bytes of a byte, a broken size in the header can not reserve more than that
+	const size_t maxInflated = compressed.size() * 1032;
+	raw.reserve(rawSize < maxInflated ? rawSize : maxInflated);
+	if (!Inflate::DecompressZlib(compressed.data(), compressed.size(), raw) || raw.size() < rawSize)
+	{
+		return false;
+	}
+
+	image.width = info.width;
+	image.height = info.height;
+	image.pixels.resize(image.GetRowPitch() * info.height);
+
+	unsigned char* rawPos = raw.data();
+	const unsigned char* rawEnd = raw.data() + raw.size();
+	for (int p = 0; p < nrOfPasses; p++)
+	{
+		if (!DecodePass(rawPos, rawEnd, info, passes[p][0], passes[p][1], passes[p][2], passes[p][3], image))
+		{
+			image.Clear();
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include "imageDecoder.h"
+
+// Portable png decoder for every color type and bit depth, interlaced images included.
+// The pixels are converted to 8-bit RGBA the same way the WIC path converts them:
+// gray, gray alpha, rgb and palette images are expanded to RGBA (transparency from the
+// tRNS chunk), 16-bit channels keep their upper 8 bits.
+class PngDecoder : public ImageDecoder
+{
+public:
+	const char* GetName() const;
+	bool CanDecode(const unsigned char* data, size_t size) const;
+	bool Decode(const unsigned char* data, size_t size, DecodedImage& image) const;
+};
@@ -0,0 +1,59 @@
+#include "radixSort.h"
+#include <string.h>
+
+void RadixSort::Sort(std::vector<SortItem>& items, std::vector<SortItem>& scratch)
+{
+	const size_t size = items.size();
+	if (size < 2)
+	{
+		return;
+	}
+	scratch.resize(size);
+
+	size_t counts[8][256];
+	memset(counts, 0, sizeof(counts));
+	for (size_t i = 0; i < size; i++)
+	{
+		unsigned long long key = items[i].key;
+		for (int pass = 0; pass < 8; pass++)
+		{
+			counts[pass][(key >> (pass * 8)) & 0xFF]++;
+		}
+	}
+
+	SortItem* source = items.data();
+	SortItem* destination = scratch.data();
+	for (int pass = 0; pass < 8; pass++)
+	{
+		const int shift = pass * 8;
+		size_t* passCounts = counts[pass];
+		if (passCounts[(source[0].key >> shift) & 0xFF] == size)
+		{
+			continue;
+		}
+
+		// the counts become the position of the first item with the byte
+		size_t offset = 0;
+		for (int b = 0; b < 256; b++)
+		{
+			size_t count = passCounts[b];
+			passCounts[b] = offset;
+			offset += count;
+		}
+
+		for (size_t i = 0; i < size; i++)
+		{
+			destination[passCounts[(source[i].key >> shift) & 0xFF]++] = source[i];
+		}
+
+		SortItem* swap = source;
+		source = destination;
+		destination = swap;
+	}
+
+	// an odd number of passes leaves the result in scratch
+	if (source != items.data())
+	{
+		items.swap(scratch);
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <vector>
+
+// a key and the index of what it belongs to
+struct SortItem
+{
+	unsigned long long key;
+	int value;
+};
+
+// LSD radix sort of 64-bit keys, 8 bits per pass. The counts of all passes are made in one
+// walk over the keys and passes in which every key has the same byte are skipped, so keys that
+// only use a few of their bits are cheap. Items with the same key keep their order.
+class RadixSort
+{
+public:
+	// scratch is the second buffer of the passes, it is resized to the size of items
+	static void Sort(std::vector<SortItem>& items, std::vector<SortItem>& scratch);
+};
@@ -3,10 +3,16 @@
 Renderer::Renderer()
 {
 	this->herz = 60;
+	this->commandQueue = nullptr;
 }
 
 Renderer::~Renderer()
 {
+	//frames may still be in flight, the gpu has to be done with them before anything is released
+	if (commandQueue != nullptr)
+	{
+		WaitForGpu();
+	}
 }
 
 void Renderer::Initialize()
@@ -15,7 +21,11 @@ void Renderer::Initialize()
 	CreateCommandInterfacesAndSwapChain();
 	CreateFenceAndEventHandle();
 	CreateRenderTargets();
-	CreateConstantBufferResources();
+	CreateShaderVisibleHeap();
+	CreateUploadRing();
+	CreateCopyQueue();
+	CreateGeometryPool();
+	CreateTextureHeaps();
 	CreateDepthStencil();
 	this->window.CreateViewportAndScissorRect();
 	CreateRootSignature(this->device);
@@ -82,27 +92,61 @@ void Renderer::CreateCommandInterfacesAndSwapChain()
 		OutputDebugStringA("ERROR: Could not create Command Queue!\n");
 	}
 
-	//Create command allocator. The command allocator object corresponds
-	//to the underlying allocations in which GPU commands are stored.
-	if (!SUCCEEDED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocator))))
+	//Create command allocators. The command allocator object corresponds
+	//to the underlying allocations in which GPU commands are stored, every
+	//frame context has its own so it can be reset while other frames execute.
+	for (UINT n = 0; n < NUM_FRAME_CONTEXTS; n++)
 	{
-		OutputDebugStringA("ERROR: Could not create Command Allocator!\n");
+		frameContexts[n].timed = false;
+		if (!SUCCEEDED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&frameContexts[n].commandAllocator))))
+		{
+			OutputDebugStringA("ERROR: Could not create Command Allocator!\n");
+		}
+
+		//the objects are recorded on the thread pool, one list and allocator per chunk of objects
+		frameContexts[n].recordingAllocators.resize(threadPool.GetNrOfThreads());
+		for (UINT i = 0; i < threadPool.GetNrOfThreads(); i++)
+		{
+			if (!SUCCEEDED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&frameContexts[n].recordingAllocators[i]))))
+			{
+				OutputDebugStringA("ERROR: Could not create Command Allocator!\n");
+			}
+		}
 	}
 
-	//Create command list.
-	if (!SUCCEEDED(hr = device->CreateCommandList(
-		0,
-		D3D12_COMMAND_LIST_TYPE_DIRECT,
-		commandAllocator,
-		nullptr,
-		IID_PPV_ARGS(&commandList))))
+	//Create command lists. The first one is recorded before the objects and the second one after them.
+	ID3D12GraphicsCommandList4** frameLists[] = { &commandList, &endCommandList };
+	for (int i = 0; i < ARRAYSIZE(frameLists); i++)
 	{
-		OutputDebugStringA("ERROR: Could not create Commandlist!\n");
+		if (!SUCCEEDED(hr = device->CreateCommandList(
+			0,
+			D3D12_COMMAND_LIST_TYPE_DIRECT,
+			frameContexts[0].commandAllocator,
+			nullptr,
+			IID_PPV_ARGS(frameLists[i]))))
+		{
+			OutputDebugStringA("ERROR: Could not create Commandlist!\n");
+		}
+
+		//Command lists are created in the recording state. Since there is nothing to
+		//record right now and the main loop expects it to be closed, we close it.
+		(*frameLists[i])->Close();
 	}
 
-	//Command lists are created in the recording state. Since there is nothing to
-	//record right now and the main loop expects it to be closed, we close it.
-	commandList->Close();
+	recordingLists.resize(threadPool.GetNrOfThreads());
+	for (UINT i = 0; i < threadPool.GetNrOfThreads(); i++)
+	{
+		if (!SUCCEEDED(hr = device->CreateCommandList(
+			0,
+			D3D12_COMMAND_LIST_TYPE_DIRECT,
+			frameContexts[0].recordingAllocators[i],
+			nullptr,
+			IID_PPV_ARGS(&recordingLists[i]))))
+		{
+			OutputDebugStringA("ERROR: Could not create Commandlist!\n");
+		}
+		recordingLists[i]->Close();
+	}
 
 	IDXGIFactory5* factory = nullptr;
 	CreateDXGIFactory(IID_PPV_ARGS(&factory));
@@ -146,14 +190,9 @@ void Renderer::CreateCommandInterfacesAndSwapChain()
 
 void Renderer::CreateFenceAndEventHandle()
 {
-	if (!SUCCEEDED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
-	{
-		OutputDebugStringA("ERROR: Could not create Fence!\n");
-	}
-	fenceValue = 1;
-
-	//Create an event handle to use for GPU synchronization.
-	eventHandle = CreateEvent(0, false, false, 0);
+	//the fence is signaled after every frame, the frames of the upload ring are retired with it
+	frameQueue.Create(device, commandQueue);
+	frameScheduler.Reset(&frameQueue, uploadRing.GetAllocator(), NUM_FRAME_CONTEXTS);
 }
 
 void Renderer::CreateRenderTargets()
@@ -179,6 +218,7 @@ void Renderer::CreateRenderTargets()
 		{
 			device->CreateRenderTargetView(renderTargets[n], nullptr, cdh);
 			cdh.ptr += renderTargetDescriptorSize;
+			stateTracker.Register(renderTargets[n], D3D12_RESOURCE_STATE_PRESENT);
 		}
 		else
 		{
@@ -187,57 +227,33 @@ void Renderer::CreateRenderTargets()
 	}
 }
 
-void Renderer::CreateConstantBufferResources()
+void Renderer::CreateShaderVisibleHeap()
 {
-	for (int i = 0; i < NUM_SWAP_BUFFERS; i++)
-	{
-		D3D12_DESCRIPTOR_HEAP_DESC heapDescriptorDesc = {};
-		heapDescriptorDesc.NumDescriptors = 1;
-		heapDescriptorDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-		heapDescriptorDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-		if (!SUCCEEDED(device->CreateDescriptorHeap(&heapDescriptorDesc, IID_PPV_ARGS(&descriptorHeap[i]))))
-		{
-			OutputDebugStringA("ERROR: Could not create Descriptor Heap");
-		}
-	}
-
-	UINT cbSizeAligned = (sizeof(ConstantBuffer) + 255) & ~255;	// 256-byte aligned CB.
-
-	D3D12_HEAP_PROPERTIES heapProperties = {};
-	heapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
-	heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-	heapProperties.CreationNodeMask = 1; //used when multi-gpu
-	heapProperties.VisibleNodeMask = 1; //used when multi-gpu
-	heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	//one heap for every srv and cbv, so a command list only has to set it once
+	shaderVisibleHeap.Create(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, NUM_SHADER_VISIBLE_DESCRIPTORS, true);
+}
 
-	D3D12_RESOURCE_DESC resourceDesc = {};
-	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-	resourceDesc.Width = cbSizeAligned;
-	resourceDesc.Height = 1;
-	resourceDesc.DepthOrArraySize = 1;
-	resourceDesc.MipLevels = 1;
-	resourceDesc.SampleDesc.Count = 1;
-	resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+void Renderer::CreateUploadRing()
+{
+	//the instances of every frame and the texture uploads are written here, the space is reused once the frames retire
+	uploadRing.Create(device, UPLOAD_RING_SIZE);
+}
 
-	//Create a resource heap, descriptor heap, and pointer to cbv for each frame
-	for (int i = 0; i < NUM_SWAP_BUFFERS; i++)
-	{
-		device->CreateCommittedResource(
-			&heapProperties,
-			D3D12_HEAP_FLAG_NONE,
-			&resourceDesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(&constantBufferResource[i])
-			);
+void Renderer::CreateCopyQueue()
+{
+	//static geometry lives in default heaps, it is copied there on a queue of its own
+	copyQueue.Create(device, GEOMETRY_STAGING_SIZE);
+	geometryUploader.Initialize(&copyQueue, GEOMETRY_BATCH_SIZE);
+}
 
-		constantBufferResource[i]->SetName(L"cb heap");
+void Renderer::CreateGeometryPool()
+{
+	geometryPool.Create(device, GEOMETRY_POOL_VERTICES, GEOMETRY_POOL_INDEX_SIZE);
+}
 
-		D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
-		cbvDesc.BufferLocation = constantBufferResource[i]->GetGPUVirtualAddress();
-		cbvDesc.SizeInBytes = cbSizeAligned;
-		device->CreateConstantBufferView(&cbvDesc, descriptorHeap[i]->GetCPUDescriptorHandleForHeapStart());
-	}
+void Renderer::CreateTextureHeaps()
+{
+	textureHeaps.Create(device, TEXTURE_HEAP_SIZE);
 }
 
 void Renderer::CreateDepthStencil()
@@ -312,31 +328,31 @@ void Renderer::CreateRootSignature(ID3D12Device5* device)
 	rootParam[UV].Descriptor.ShaderRegister = UV;
 	rootParam[UV].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
 
-	// create a root parameter for wvp matrix
-	rootParam[WVP].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
-	rootParam[WVP].Constants.ShaderRegister = WVP;
-	rootParam[WVP].Constants.Num32BitValues = 16;
-	rootParam[WVP].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+	// the wvp matrix and texture index of every instance
+	rootParam[Instances].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+	rootParam[Instances].Descriptor.ShaderRegister = Instances;
+	rootParam[Instances].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
 
 	// Texture
 	rootParam[TextureDT].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
 	rootParam[TextureDT].DescriptorTable = dt;
 	rootParam[TextureDT].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
 
-	// create a root parameter for TextureIndex
-	rootParam[TextureIndex].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
-	rootParam[TextureIndex].Constants.ShaderRegister = TextureIndex;
-	rootParam[TextureIndex].Constants.Num32BitValues = 1;
-	rootParam[TextureIndex].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+	// where the mesh of a draw starts in the geometry pool, SV_VertexID does not include the base vertex
+	rootParam[BaseVertex].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+	rootParam[BaseVertex].Constants.ShaderRegister = 0;
+	rootParam[BaseVertex].Constants.RegisterSpace = 0;
+	rootParam[BaseVertex].Constants.Num32BitValues = 1;
+	rootParam[BaseVertex].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
 
 	// create a static sampler
 	D3D12_STATIC_SAMPLER_DESC sampler = {};
-	sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
+	sampler.Filter = TEXTURE_FILTER;
 	sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
 	sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
 	sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
 	sampler.MipLODBias = 0;
-	sampler.MaxAnisotropy = 0;
+	sampler.MaxAnisotropy = TEXTURE_FILTER == D3D12_FILTER_ANISOTROPIC ? TEXTURE_ANISOTROPY : 0;
 	sampler.ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER;
 	sampler.BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
 	sampler.MinLOD = 0.0f;
@@ -368,53 +384,54 @@ void Renderer::CreateRootSignature(ID3D12Device5* device)
 
 void Renderer::Frame()
 {
+	//The cpu may only be as many frames ahead of the gpu as the latency allows, and command list
+	//allocators can only be reset when the associated command lists have finished execution on
+	//the GPU. The scheduler waits for both and gives back what the finished frames kept.
+	FrameContext& context = frameContexts[frameScheduler.BeginFrame()];
+	ReadTimers(context);
+
 	backBufferIndex = swapChain->GetCurrentBackBufferIndex();
+	stateTracker.ResetCounters();
 
-	//Command list allocators can only be reset when the associated command lists have
-	//finished execution on the GPU; fences are used to ensure this (See WaitForGpu method)
-	commandAllocator->Reset();
-	if (!SUCCEEDED(hr = commandList->Reset(commandAllocator, NULL)))
+	context.commandAllocator->Reset();
+	if (!SUCCEEDED(hr = commandList->Reset(context.commandAllocator, NULL)))
 	{
 		OutputDebugStringA("ERROR: Could not reset commandlist!\n");
 	}
 
-	if (!firstFrame)
-	{
-		//benchmark
-		gpuTimerFrame.stop(commandList, 0);
-
-		gpuTimerFrame.resolveQueryToCPU(commandList, 0);
-
-		//get time in ms
-		UINT64 queueFreq;
-		commandQueue->GetTimestampFrequency(&queueFreq);
-		double timestampToMs = (1.0 / queueFreq) * 1000.0;
-		D3D12::GPUTimestampPair drawTime = gpuTimerFrame.getTimestampPair(0);
-		UINT64 dt = drawTime.Stop - drawTime.Start;
-		double timeInMs = dt * timestampToMs;
-		if ((benchmarkVecFrame.size() < benchmarkSamples) && (firstFrame == false))
-		{
-			benchmarkVecFrame.push_back(timeInMs);
-		}
-	}
-
 	//benchmark
-	gpuTimerFrame.start(commandList, 0);
+	context.gpuTimerFrame.start(commandList, 0);
+
+	D3D12CommandRecorder recorder(commandList);
 
 	//Set constant buffer descriptor heap
-	ID3D12DescriptorHeap* descriptorHeaps[] = { descriptorHeap[backBufferIndex] };
+	ID3D12DescriptorHeap* descriptorHeaps[] = { shaderVisibleHeap.GetHeap() };
 	commandList->SetDescriptorHeaps(ARRAYSIZE(descriptorHeaps), descriptorHeaps);
 
 	//Set necessary states.
 	commandList->RSSetViewports(1, window.GetViewport());
 	commandList->RSSetScissorRects(1, window.GetRect());
 
+	//Textures that have not been uploaded yet are copied from their upload heaps and stay
+	//pixel shader resources after that, a texture array is one resource
+	for (int i = 0; i < GetNumObjects(); i++)
+	{
+		Texture* texture = objects.at(i).GetTexture();
+		texture->Bind(commandList);
+		ID3D12Resource* uploadHeap = texture->TakeUploadHeap();
+		if (uploadHeap != nullptr)
+		{
+			frameScheduler.ReleaseAfterFrame(uploadHeap);
+		}
+		for (int j = 0; j < texture->GetNrOfResources(); j++)
+		{
+			stateTracker.Transition(texture->GetTextureBufferArray(j), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		}
+	}
+
 	//Indicate that the back buffer will be used as render target.
-	SetResourceTransitionBarrier(commandList,
-		renderTargets[backBufferIndex],
-		D3D12_RESOURCE_STATE_PRESENT,		//state before
-		D3D12_RESOURCE_STATE_RENDER_TARGET	//state after
-		);
+	stateTracker.Transition(renderTargets[backBufferIndex], D3D12_RESOURCE_STATE_RENDER_TARGET);
+	stateTracker.Flush(&recorder);
 
 	//Record commands.
 	//Get the handle for the current render target used as back buffer.
@@ -432,124 +449,132 @@ void Renderer::Frame()
 	// clear the depth/stencil buffer
 	commandList->ClearDepthStencilView(dsh, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
 
-	//Set root signature
-	commandList->SetGraphicsRootSignature(this->rootSignature);
+	//Close the list to prepare it for execution.
+	if (!SUCCEEDED(hr = commandList->Close()))
+	{
+		OutputDebugStringA("ERROR: Could not close commandlist!\n");
+	}
 
-	Object* object;
-	for (int i = 0; i < GetNumObjects(); i++)
+	//the animated textures show a new frame 60 times per second (60HZ)
+	if (GetCamera()->GetAccumulatedTime() > (1000 / this->herz))
 	{
-		object = &objects.at(i);
+		savedInd++;
+		GetCamera()->ResetAccumulatedTime();
+	}
 
-		// First frame? Bind the textures
-		if (firstFrame && object->GetTexture()->GetVecSize() > 0)
-		{
-			object->GetTexture()->BindMulti(commandList);
-		}
-		else if (firstFrame)
+	//Only the objects in the frustum are recorded, the culling was done by the last transform update
+	//the depth is the w of the object's origin after the wvp matrix, its distance along the view direction
+	visibleObjects.clear();
+	depths.clear();
+	for (int i = 0; i < GetNumObjects(); i++)
+	{
+		if (transforms.IsVisible(objects[i].GetTransform()))
 		{
-			object->GetTexture()->Bind(commandList);
+			visibleObjects.push_back(i);
+			depths.push_back(transforms.GetWvpMatrix(objects[i].GetTransform())->_44);
 		}
+	}
 
-		// Create texture buffer descriptor heap
-		ID3D12DescriptorHeap* textureDescriptorHeaps[] = { object->GetTexture()->GetTextureDescriptorHeap() };
-
-		commandList->SetDescriptorHeaps(ARRAYSIZE(textureDescriptorHeaps), textureDescriptorHeaps);
-
-		commandList->SetPipelineState(object->GetPipeLineState());
-
-		if (object->GetTexture()->GetVecSize() > 0)
-		{
-			if (GetCamera()->GetAccumulatedTime() > (1000 / this->herz)) // 60 images per second (60HZ)
-			{
-				savedInd++;
-				GetCamera()->ResetAccumulatedTime();
-			}
+	//Objects with the same mesh, texture and pipeline state are one instanced draw
+	batcher.Build(drawStates, visibleObjects, depths);
+	UploadAllocation instanceAllocation = {};
+	if (!AllocateInstances((UINT)GetNrOfDrawn(), instanceAllocation))
+	{
+		//nothing can be drawn without its instances
+		visibleObjects.clear();
+		batcher.Clear();
+	}
+	WriteInstances((InstanceData*)instanceAllocation.cpuAddress);
+	DrawBindings bindings = GetDrawBindings(instanceAllocation.gpuAddress);
 
-			this->texInd = savedInd;
-			if (texInd > object->GetTexture()->GetVecSize())
-			{
-				savedInd = 0;
-				texInd = 0;
-			}
+	const std::vector<DrawBatch>& batches = batcher.GetBatches();
+	context.drawnObjects.clear();
+	for (size_t i = 0; i < batches.size(); i++)
+	{
+		context.drawnObjects.push_back(batches[i].object);
+	}
 
-			for (int j = 0; j < object->GetTexture()->GetVecSize(); j++)
-			{
-				// transition the texture default heap to a pixel shader resource
-				commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(object->GetTexture()->GetTextureBufferArray(j), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
-			}
-		}
-		else
+	//The draws are recorded in chunks on the thread pool while this thread records the end of the frame
+	std::vector<ObjectRange> chunks = DrawBatcher::Split(GetNrOfDrawCalls(), (int)recordingLists.size(), MIN_DRAWS_PER_LIST);
+	chunkStateChanges.resize(recordingLists.size());
+	std::vector<std::future<void>> recordingJobs;
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		ObjectRange chunk = chunks[i];
+		ID3D12GraphicsCommandList4* list = recordingLists[i];
+		ID3D12CommandAllocator* allocator = context.recordingAllocators[i];
+		D3D12::D3D12Timer* timer = &context.gpuTimerObj;
+		recordingJobs.push_back(threadPool.Submit([this, i, list, allocator, timer, bindings, chunk, cdh, dsh]()
 		{
-			this->texInd = 0;
-			commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(object->GetTexture()->GetTextureBuffer(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
-		}
-
-		commandList->SetGraphicsRootDescriptorTable(TextureDT, object->GetTexture()->GetTextureDescriptorHeap()->GetGPUDescriptorHandleForHeapStart());
-
-		commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+			allocator->Reset();
+			list->Reset(allocator, NULL);
 
-		commandList->SetGraphicsRootShaderResourceView(Positions, object->GetVertexBuffer(Positions)->GetVertexBufferResource()->GetGPUVirtualAddress());
-		commandList->SetGraphicsRootShaderResourceView(UV, object->GetVertexBuffer(UV)->GetVertexBufferResource()->GetGPUVirtualAddress());
+			//a command list starts without any state
+			list->RSSetViewports(1, window.GetViewport());
+			list->RSSetScissorRects(1, window.GetRect());
+			list->OMSetRenderTargets(1, &cdh, true, &dsh);
 
-		XMFLOAT4X4* wvp = object->GetConstantBuffer()->GetWvpMat();
-		commandList->SetGraphicsRoot32BitConstants(WVP, MATRIXSIZE, wvp, 0);
-		commandList->SetGraphicsRoot32BitConstants(TextureIndex, 1, &texInd, 0);
+			D3D12CommandRecorder chunkRecorder(list, timer, chunk.first);
+			StateFilterCommandRecorder filter(&chunkRecorder);
+			batcher.Record(&filter, drawStates, bindings, chunk.first, chunk.last);
+			chunkStateChanges[i] = filter.GetCounts();
 
-		gpuTimerObj.start(commandList, i);
-		commandList->DrawInstanced(object->GetNrOfVertices(), 1, 0, 0);
-		gpuTimerObj.stop(commandList, i);
-		gpuTimerObj.resolveQueryToCPU(commandList, i);
-
-		if (object->GetTexture()->GetVecSize() > 0)
-		{
-			for (int j = 0; j < object->GetTexture()->GetVecSize(); j++)
+			if (!SUCCEEDED(list->Close()))
 			{
-				commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(object->GetTexture()->GetTextureBufferArray(j), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_DEST));
+				OutputDebugStringA("ERROR: Could not close commandlist!\n");
 			}
-		}
-		else
-		{
-			commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(object->GetTexture()->GetTextureBuffer(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_DEST));
-		}
+		}));
+	}
 
-		//get time in ms
-		UINT64 queueFreq;
-		commandQueue->GetTimestampFrequency(&queueFreq);
-		double timestampToMs = (1.0 / queueFreq) * 1000.0;
-		D3D12::GPUTimestampPair drawTime = gpuTimerObj.getTimestampPair(i);
-		UINT64 dt = drawTime.Stop - drawTime.Start;
-		double timeInMs = dt * timestampToMs;
-		// get benchmarkSamples benchmarks per object
-		if ((benchmarkVecObj.size() < GetNumObjects() * benchmarkSamples) && (firstFrame == false))
-		{
-			benchmarkVecObj.push_back(timeInMs);
-		}
-		///*std::string title = std::to_string(timeInMs) + std::string("ms");
-		//std::cout << "Object: " << i << "		Time: " << title << std::endl;*/
+	//The allocator is free again now that the first list is closed
+	if (!SUCCEEDED(hr = endCommandList->Reset(context.commandAllocator, NULL)))
+	{
+		OutputDebugStringA("ERROR: Could not reset commandlist!\n");
+	}
+	D3D12CommandRecorder endRecorder(endCommandList);
+
+	if (GetNrOfDrawCalls() > 0)
+	{
+		context.gpuTimerObj.resolveQueryToCPU(endCommandList, 0, GetNrOfDrawCalls());
 	}
 
 	//Indicate that the back buffer will now be used to present.
-	SetResourceTransitionBarrier(commandList,
-		renderTargets[backBufferIndex],
-		D3D12_RESOURCE_STATE_RENDER_TARGET,	//state before
-		D3D12_RESOURCE_STATE_PRESENT		//state after
-		);
+	stateTracker.Transition(renderTargets[backBufferIndex], D3D12_RESOURCE_STATE_PRESENT);
+	stateTracker.Flush(&endRecorder);
 
-	//Close the list to prepare it for execution.
-	if (!SUCCEEDED(hr = commandList->Close()))
+	//benchmark
+	context.gpuTimerFrame.stop(endCommandList, 0);
+	context.gpuTimerFrame.resolveQueryToCPU(endCommandList, 0);
+
+	if (!SUCCEEDED(hr = endCommandList->Close()))
 	{
 		OutputDebugStringA("ERROR: Could not close commandlist!\n");
 	}
 
-	//Execute the command list.
-	ID3D12CommandList* listsToExecute[] = { commandList };
-	commandQueue->ExecuteCommandLists(ARRAYSIZE(listsToExecute), listsToExecute);
+	stateChanges = StateChangeCounts();
+	for (size_t i = 0; i < recordingJobs.size(); i++)
+	{
+		threadPool.Wait(recordingJobs[i]);
+		stateChanges.Add(chunkStateChanges[i]);
+	}
+
+	//Execute the command lists in one go, in the order they have to run.
+	std::vector<ID3D12CommandList*> listsToExecute;
+	listsToExecute.push_back(commandList);
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		listsToExecute.push_back(recordingLists[i]);
+	}
+	listsToExecute.push_back(endCommandList);
+	commandQueue->ExecuteCommandLists((UINT)listsToExecute.size(), listsToExecute.data());
 
 	//Present the frame.
 	DXGI_PRESENT_PARAMETERS pp = {};
 	swapChain->Present1(0, 0, &pp);
 
-	WaitForGpu(); //Wait for GPU to finish.
+	//The gpu is not waited for here, the next frame is recorded while it executes this one.
+	frameScheduler.EndFrame();
+	context.timed = !firstFrame;
 
 	if (firstFrame)
 	{
@@ -557,18 +582,105 @@ void Renderer::Frame()
 	}
 }
 
+bool Renderer::AllocateInstances(UINT nrOfInstances, UploadAllocation& allocation)
+{
+	//the ring only runs full when the gpu is behind, then the oldest frame has to finish first
+	while (!uploadRing.Allocate(sizeof(InstanceData) * nrOfInstances, UploadRing::DEFAULT_ALIGNMENT, allocation))
+	{
+		if (!frameScheduler.WaitForOldestFrame())
+		{
+			OutputDebugStringA("ERROR: The instances do not fit in the upload ring!\n");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void Renderer::WriteInstances(InstanceData* instances)
+{
+	if (instances == nullptr)
+	{
+		return;
+	}
+
+	//the upload heap is write combined memory, every instance is written in one go and never read
+	threadPool.ParallelFor(GetNrOfDrawn(), TransformSystem::TRANSFORMS_PER_JOB, [this, instances](int first, int last)
+	{
+		for (int i = first; i < last; i++)
+		{
+			Object& object = objects[visibleObjects[i]];
+
+			InstanceData instance = {};
+			instance.wvp = *transforms.GetWvpMatrix(object.GetTransform());
+
+			// the frame of an animated texture
+			if (object.GetTexture()->GetVecSize() > 0)
+			{
+				instance.textureIndex = savedInd % object.GetTexture()->GetVecSize();
+			}
+
+			memcpy(&instances[i], &instance, sizeof(instance));
+		}
+	});
+}
+
+DrawBindings Renderer::GetDrawBindings(D3D12_GPU_VIRTUAL_ADDRESS instances)
+{
+	DrawBindings bindings;
+	bindings.rootSignature = this->rootSignature;
+	bindings.descriptorHeap = shaderVisibleHeap.GetHeap();
+	bindings.positions = geometryPool.GetPositions();
+	bindings.uvs = geometryPool.GetUVs();
+	bindings.instances = instances;
+	bindings.instanceSize = sizeof(InstanceData);
+	return bindings;
+}
+
 void Renderer::WaitForGpu()
 {
-	//Signal and increment the fence value.
-	const UINT64 fenceV = fenceValue;
-	commandQueue->Signal(fence, fenceV);
-	fenceValue++;
+	frameScheduler.WaitForIdle();
+}
+
+void Renderer::SetFrameLatency(unsigned int frames)
+{
+	this->frameScheduler.SetLatency(frames);
+}
+
+void Renderer::ReadTimers(FrameContext& context)
+{
+	//the timestamps of a context can be read once the gpu has finished the frame that used it last,
+	//the first frame is left out as it uploads the textures
+	if (!context.timed)
+	{
+		return;
+	}
+	context.timed = false;
+
+	//get time in ms
+	UINT64 queueFreq;
+	commandQueue->GetTimestampFrequency(&queueFreq);
+	double timestampToMs = (1.0 / queueFreq) * 1000.0;
+
+	D3D12::GPUTimestampPair drawTime = context.gpuTimerFrame.getTimestampPair(0);
+	if (benchmarkVecFrame.size() < benchmarkSamples)
+	{
+		benchmarkVecFrame.push_back((drawTime.Stop - drawTime.Start) * timestampToMs);
+	}
 
-	//Wait until command queue is done.
-	if (fence->GetCompletedValue() < fenceV)
+	// get benchmarkSamples benchmarks per object, the timers are in draw order and an
+	// instanced draw counts for the first of its objects
+	benchmarkObjTime.resize(GetNumObjects(), 0.0);
+	benchmarkObjSamples.resize(GetNumObjects(), 0);
+	for (size_t i = 0; i < context.drawnObjects.size(); i++)
 	{
-		fence->SetEventOnCompletion(fenceV, eventHandle);
-		WaitForSingleObject(eventHandle, INFINITE);
+		int object = context.drawnObjects[i];
+		drawTime = context.gpuTimerObj.getTimestampPair((UINT)i);
+		if (benchmarkObjSamples[object] < benchmarkSamples)
+		{
+			benchmarkObjTime[object] += (drawTime.Stop - drawTime.Start) * timestampToMs;
+			benchmarkObjSamples[object]++;
+		}
 	}
 }
 
@@ -587,45 +699,126 @@ int Renderer::GetNumObjects()
 	return this->objects.size();
 }
 
+int Renderer::GetNrOfDrawn()
+{
+	return (int)this->visibleObjects.size();
+}
+
+int Renderer::GetNrOfCulled()
+{
+	return GetNumObjects() - GetNrOfDrawn();
+}
+
+int Renderer::GetNrOfDrawCalls()
+{
+	return (int)this->batcher.GetBatches().size();
+}
+
+const StateChangeCounts& Renderer::GetStateChanges()
+{
+	return this->stateChanges;
+}
+
 void Renderer::SetTimer()
 {
 	// benchmarking
-	gpuTimerObj.init(this->device, GetNumObjects());
-	gpuTimerFrame.init(this->device, 1);
+	for (UINT n = 0; n < NUM_FRAME_CONTEXTS; n++)
+	{
+		frameContexts[n].gpuTimerObj.init(this->device, GetNumObjects());
+		frameContexts[n].gpuTimerFrame.init(this->device, 1);
+	}
 }
 
 void Renderer::CreateObject(bool wireframe, XMFLOAT4 pos, float* scale, std::string path)
 {
-	Object object;
-	object.SetPosition(pos);
-	object.SetScale(scale);
-	object.InitializeMatrices();
+	CreateObjectAsync(wireframe, pos, scale, path);
+	FinishLoading();
+}
+
+std::shared_future<int> Renderer::CreateObjectAsync(bool wireframe, XMFLOAT4 pos, float* scale, std::string path)
+{
+	PendingObject pending;
+	pending.object.SetTransform(transforms.Add(pos, scale));
+	pending.wireframe = wireframe;
 
-	//object loader...
-	object.LoadObj(path, this->device);
+	//meshes and textures are only loaded the first time their path is used,
+	//after that the object shares them with the objects created before it
+	pending.object.SetMesh(assetCache.LoadMesh(path, &this->threadPool));
 
-	object.CreateConstantBuffer();
-	object.CreateMaterials(this->device, wireframe, this->rootSignature);
+	std::shared_future<int> created = pending.created.get_future().share();
+	pendingObjects.push_back(std::move(pending));
 
-	objects.push_back(object);
+	return created;
 }
 
-Object* Renderer::GetObj(int pos)
+void Renderer::FinishLoading()
 {
-	return &objects.at(pos);
+	assetCache.FinishLoading(this->device, &this->shaderVisibleHeap, &this->uploadRing, &this->textureHeaps, &this->stateTracker, &this->geometryPool,
+		&this->geometryUploader, &this->threadPool);
+
+	//the frames wait on the gpu for the mesh copies, the cpu does not wait for them
+	commandQueue->Wait(copyQueue.GetFence(), geometryUploader.Flush());
+
+	for (size_t i = 0; i < pendingObjects.size(); i++)
+	{
+		Object& object = pendingObjects[i].object;
+		if (!object.GetMesh()->IsLoaded())
+		{
+			pendingObjects[i].created.set_value(-1);
+			continue;
+		}
+		//the texture registered its resources with the state tracker when it created them
+		object.SetTexture(object.GetMesh()->GetMaterial());
+
+		Mesh* mesh = object.GetMesh();
+		transforms.SetBounds(object.GetTransform(), mesh->GetBoundsMin(), mesh->GetBoundsMax());
+
+		//the pipeline state only depends on the fill mode and on the kind of texture
+		UINT pipeline = (pendingObjects[i].wireframe ? 1 : 0) | (object.GetTexture()->IsTextureArray() ? 2 : 0);
+
+		object.CreateConstantBuffer();
+		object.CreateMaterials(this->device, pendingObjects[i].wireframe, this->rootSignature, &this->pipelineCache);
+
+		DrawState state;
+		state.key = DrawBatcher::MakeSortKey(pipeline, object.GetTexture()->GetId(), mesh->GetId(), 0.0f);
+		state.pipelineState = object.GetPipeLineState();
+		state.textureTable = object.GetTexture()->GetDescriptorTable();
+		const MeshRange& range = object.GetMeshRange();
+		state.indexBuffer = geometryPool.GetIndexBufferView(range.indexFormat);
+		state.nrOfIndices = object.GetNrOfIndices();
+		state.firstIndex = range.firstIndex;
+		state.firstVertex = range.firstVertex;
+		drawStates.push_back(state);
+
+		objects.push_back(object);
+		pendingObjects[i].created.set_value((int)objects.size() - 1);
+	}
+	pendingObjects.clear();
+}
+
+AssetCache* Renderer::GetAssetCache()
+{
+	return &this->assetCache;
+}
+
+PipelineCache* Renderer::GetPipelineCache()
+{
+	return &this->pipelineCache;
 }
 
-void Renderer::SetResourceTransitionBarrier(ID3D12GraphicsCommandList* commandList, ID3D12Resource* resource, D3D12_RESOURCE_STATES StateBefore, D3D12_RESOURCE_STATES StateAfter)
+TransformSystem* Renderer::GetTransforms()
 {
-	D3D12_RESOURCE_BARRIER barrierDesc = {};
+	return &this->transforms;
+}
 
-	barrierDesc.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-	barrierDesc.Transition.pResource = resource;
-	barrierDesc.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-	barrierDesc.Transition.StateBefore = StateBefore;
-	barrierDesc.Transition.StateAfter = StateAfter;
+ThreadPool* Renderer::GetThreadPool()
+{
+	return &this->threadPool;
+}
 
-	commandList->ResourceBarrier(1, &barrierDesc);
+Object* Renderer::GetObj(int pos)
+{
+	return &objects.at(pos);
 }
 
 void Renderer::SetClearColor(float r, float g, float b, float a)
@@ -638,24 +831,52 @@ void Renderer::SetClearColor(float r, float g, float b, float a)
 
 void Renderer::BenchmarkObjects()
 {
-	std::vector<double> sumVec;
-	sumVec.resize(GetNumObjects());
-
-	//get benchmarks for drawcall per object
-	for (int i = 0; i < GetNumObjects(); i++)
+	//print averages of the drawcall per object
+	for (int i = 0; i < (int)benchmarkObjSamples.size(); i++)
 	{
-		for (int j = 0; j < GetNumObjects() * benchmarkSamples; j += GetNumObjects())
+		if (benchmarkObjSamples[i] == 0)
 		{
-			sumVec.at(i) += benchmarkVecObj.at(j + i);
+			std::cout << "Obj nr: " << i << ": culled or drawn as an instance of another object's draw" << std::endl;
+			continue;
 		}
+		std::cout << "Obj nr: " << i << ": " << benchmarkObjTime[i] / benchmarkObjSamples[i] << std::endl;
 	}
+	std::cout << "Benchmark average was made with up to " << benchmarkSamples << " samples" << std::endl;
+}
 
-	//print averages
+void Renderer::PrintResourceStats()
+{
+	// textures are shared between objects, every one is only counted once
+	std::set<Texture*> textures;
+	int textureResources = 0;
 	for (int i = 0; i < GetNumObjects(); i++)
 	{
-		std::cout << "Obj nr: " << i << ": " << sumVec.at(i) / benchmarkSamples << std::endl;
+		if (textures.insert(objects[i].GetTexture()).second)
+		{
+			textureResources += objects[i].GetTexture()->GetNrOfResources();
+		}
 	}
-	std::cout << "Benchmark average was made with " << benchmarkSamples << " samples" << std::endl;
+
+	std::cout << "Texture resources: " << textureResources << ", barriers in the last frame: " << stateTracker.GetBarrierCount()
+		<< " in " << stateTracker.GetBatchCount() << " ResourceBarrier calls" << std::endl;
+	DescriptorAllocatorStats descriptors = shaderVisibleHeap.GetStats();
+	std::cout << "Shader visible descriptors: " << descriptors.used << "/" << descriptors.capacity << " in " << descriptors.nrOfAllocations
+		<< " allocations, " << descriptors.nrOfFreeBlocks << " free blocks, fragmentation " << descriptors.fragmentation << std::endl;
+	RingAllocatorStats ring = uploadRing.GetStats();
+	std::cout << "Upload ring: " << ring.used << "/" << ring.capacity << " bytes in " << ring.framesInFlight << " frames, peak " << ring.peakUsed
+		<< ", " << ring.wasted << " wasted on alignment and wrapping" << std::endl;
+	GeometryUploadStats geometry = geometryUploader.GetStats();
+	std::cout << "Geometry uploads: " << geometry.uploads << " buffers, " << geometry.bytes << " bytes in " << geometry.copies << " copies and "
+		<< geometry.submissions << " submissions, " << geometry.stalls << " waits for the copy queue" << std::endl;
+	TlsfAllocatorStats vertices = geometryPool.GetVertexStats();
+	TlsfAllocatorStats indices = geometryPool.GetIndexStats();
+	std::cout << "Geometry pool: " << vertices.used << "/" << vertices.capacity << " vertices and " << indices.used * GeometryPool::INDEX_UNIT << "/"
+		<< indices.capacity * GeometryPool::INDEX_UNIT << " index bytes for " << vertices.nrOfAllocations << " meshes, fragmentation "
+		<< vertices.fragmentation << " and " << indices.fragmentation << std::endl;
+	textureHeaps.PrintStats();
+	std::cout << "Objects in the last frame: " << GetNrOfDrawn() << " drawn in " << GetNrOfDrawCalls() << " draws, " << GetNrOfCulled() << " culled" << std::endl;
+	std::cout << "State changes in the last frame: " << stateChanges.pipelineStates << " pipeline states, " << stateChanges.descriptorHeaps << " descriptor heaps, "
+		<< stateChanges.rootShaderResourceViews << " root srvs, " << stateChanges.redundant << " redundant commands dropped" << std::endl;
 }
 
 void Renderer::BenchmarkFrame()
@@ -667,4 +888,6 @@ void Renderer::BenchmarkFrame()
 	}
 	std::cout << "Average benchmark in ms for frame: " << sum / benchmarkSamples << std::endl;
 	std::cout << "Benchmark average was made with " << benchmarkSamples << " samples" << std::endl;
+	std::cout << "Average cpu wait for the gpu per frame with " << frameScheduler.GetLatency() << " frames in flight: "
+		<< frameScheduler.GetWaitTime() / (frameScheduler.GetFrameCount() > 0 ? frameScheduler.GetFrameCount() : 1) << " ms" << std::endl;
 }
\ No newline at end of file
@@ -4,13 +4,54 @@
 #include <dxgi1_6.h>
 #include "window.h"
 #include "object.h"
+#include "assetCache.h"
+#include "threadPool.h"
+#include "resourceStateTracker.h"
+#include "d3d12CommandRecorder.h"
+#include "transformSystem.h"
+#include "drawBatcher.h"
+#include "descriptorHeap.h"
+#include "uploadRing.h"
+#include "copyQueue.h"
+#include "frameQueue.h"
 #include <vector>
 #include <string>
 #include "d3dx12.h"
 #include "D3D12Timer.h"
 #include <iostream>
+#include <future>
+#include <set>
+#include <algorithm>
 
 const unsigned int NUM_SWAP_BUFFERS = 2;
+// frames the cpu can record while the gpu still works on earlier ones, see SetFrameLatency
+const unsigned int NUM_FRAME_CONTEXTS = 3;
+// descriptors in the shader visible heap, the srvs of every texture share it
+const UINT NUM_SHADER_VISIBLE_DESCRIPTORS = 4096;
+// bytes in the upload ring, the instances of the frames in flight and the texture uploads share it
+const UINT64 UPLOAD_RING_SIZE = 64 * 1024 * 1024;
+// the mesh buffers are staged in a buffer of this size and copied in batches of at least GEOMETRY_BATCH_SIZE bytes
+const UINT64 GEOMETRY_STAGING_SIZE = 16 * 1024 * 1024;
+const UINT64 GEOMETRY_BATCH_SIZE = 4 * 1024 * 1024;
+// vertices and index bytes of all meshes together
+const UINT GEOMETRY_POOL_VERTICES = 1024 * 1024;
+const UINT GEOMETRY_POOL_INDEX_SIZE = 16 * 1024 * 1024;
+// textures are placed in heaps of this size, a bigger texture gets a heap of its own
+const UINT64 TEXTURE_HEAP_SIZE = 64 * 1024 * 1024;
+// the filter of the static sampler: D3D12_FILTER_MIN_MAG_MIP_POINT, D3D12_FILTER_MIN_MAG_MIP_LINEAR (trilinear)
+// or D3D12_FILTER_ANISOTROPIC. The anisotropy (1 to 16) is only used by the anisotropic filter
+const D3D12_FILTER TEXTURE_FILTER = D3D12_FILTER_ANISOTROPIC;
+const UINT TEXTURE_ANISOTROPY = 8;
+// draws are only split over several command lists if every list gets at least this many
+const int MIN_DRAWS_PER_LIST = 64;
+
+// what the vertex shader reads per instance, the same layout as Instance in VertexShader.hlsl
+struct InstanceData
+{
+	XMFLOAT4X4 wvp;		// transposed
+	UINT textureIndex;
+	UINT padding[3];
+};
 
 template<class Interface>
 inline void SafeRelease(
@@ -35,52 +76,132 @@ public:
 	void CreateCommandInterfacesAndSwapChain();
 	void CreateFenceAndEventHandle();
 	void CreateRenderTargets();
-	void CreateConstantBufferResources();
+	void CreateShaderVisibleHeap();
+	void CreateUploadRing();
+	void CreateCopyQueue();
+	void CreateGeometryPool();
+	void CreateTextureHeaps();
 	void CreateDepthStencil();
 
 	void CreateRootSignature(ID3D12Device5* device);
 
 	void Frame();
 	void WaitForGpu();
+	// how many frames the cpu may be ahead of the gpu, 1..NUM_FRAME_CONTEXTS. 1 waits for every frame.
+	void SetFrameLatency(unsigned int frames);
 
 	Window* GetWindow();
 	Camera* GetCamera();
 	Object* GetObj(int pos);
+	AssetCache* GetAssetCache();
+	PipelineCache* GetPipelineCache();
+	TransformSystem* GetTransforms();
+	ThreadPool* GetThreadPool();
 	int GetNumObjects();
+	// objects that were recorded and left out by the frustum culling in the last frame
+	int GetNrOfDrawn();
+	int GetNrOfCulled();
+	// instanced draws of the last frame, one per mesh, texture and pipeline state that was visible
+	int GetNrOfDrawCalls();
+	// state changes recorded in the last frame, after the redundant ones were dropped
+	const StateChangeCounts& GetStateChanges();
 	void SetTimer();
 
 	void CreateObject(bool wireframe, XMFLOAT4 pos, float* scale, std::string path);
-	void SetResourceTransitionBarrier(ID3D12GraphicsCommandList* commandList, ID3D12Resource* resource,
-		D3D12_RESOURCE_STATES StateBefore, D3D12_RESOURCE_STATES StateAfter);
+	// queues the object and starts loading its mesh and texture on the thread pool.
+	// The future gets the index of the object once FinishLoading has created it, -1 if its mesh could not be loaded
+	std::shared_future<int> CreateObjectAsync(bool wireframe, XMFLOAT4 pos, float* scale, std::string path);
+	void FinishLoading();
 	void SetClearColor(float r, float g, float b, float a);
 
 	// benchmarking
 	void BenchmarkObjects();
 	void BenchmarkFrame();
+	// number of texture resources, descriptors, upload ring and geometry bytes, drawn and culled objects, state changes and the barriers recorded in the last frame
+	void PrintResourceStats();
 
 private:
 	ID3D12RootSignature* rootSignature;
 
+	struct PendingObject
+	{
+		Object object;
+		bool wireframe;
+		std::promise<int> created;
+	};
+
+	// every srv and cbv, set once per command list. Declared before the objects and the
+	// assets so it still exists when they free their descriptors.
+	DescriptorHeap shaderVisibleHeap;
+	// the InstanceData of the frames in flight and the staging copies of the textures
+	UploadRing uploadRing;
+	// the vertices and indices of every mesh, bound once per command list. Declared before the
+	// assets so the meshes can give their ranges back.
+	GeometryPool geometryPool;
+	// the memory of every texture. Declared before the assets so the textures can give their placements back.
+	TextureHeaps textureHeaps;
+	// the state of the render targets and textures. Declared before the assets so the textures can unregister themselves.
+	ResourceStateTracker stateTracker;
+
 	std::vector<Object> objects;
+	std::vector<PendingObject> pendingObjects;
+	AssetCache assetCache;
+	PipelineCache pipelineCache;
+	// fills the mesh buffers. Declared after the assets so it waits for its copies before they are released.
+	D3D12CopyQueue copyQueue;
+	GeometryUploader geometryUploader;
+	ThreadPool threadPool;
+	TransformSystem transforms;
 
 	ID3D12GraphicsCommandList4* commandList;
+	ID3D12GraphicsCommandList4* endCommandList;
+	std::vector<ID3D12GraphicsCommandList4*> recordingLists;
 	ID3D12CommandQueue* commandQueue;
-	ID3D12CommandAllocator* commandAllocator;
+
+	// everything a frame uses until the gpu has executed it
+	struct FrameContext
+	{
+		ID3D12CommandAllocator* commandAllocator;
+		std::vector<ID3D12CommandAllocator*> recordingAllocators;	// one per list in recordingLists
+		D3D12::D3D12Timer gpuTimerObj;
+		D3D12::D3D12Timer gpuTimerFrame;
+		bool timed;			// the timers hold the timestamps of a frame that has not been read
+		std::vector<int> drawnObjects;	// first object of the draw of every gpuTimerObj timer
+	};
+	FrameContext frameContexts[NUM_FRAME_CONTEXTS];
+	// which context a frame uses and when the gpu is done with it, the upload ring and the upload
+	// heaps of the textures are given back through it
+	D3D12FrameQueue frameQueue;
+	FrameScheduler frameScheduler;
 
 	ID3D12Device5* device;
 	IDXGISwapChain4* swapChain;
 	HRESULT hr;
 
-	ID3D12Fence1* fence;
-	HANDLE eventHandle;
-	UINT64 fenceValue;
+	void ReadTimers(FrameContext& context);
+	// the objects that survived the culling of the last transform update, in draw order, and their depths
+	std::vector<int> visibleObjects;
+	std::vector<float> depths;
+
+	// what the draw of every object sets, in the order of objects
+	std::vector<DrawState> drawStates;
+	// the visible objects with the same mesh, texture and pipeline state are one instanced draw
+	DrawBatcher batcher;
+	// one per recording list, added up once the lists are recorded
+	std::vector<StateChangeCounts> chunkStateChanges;
+	StateChangeCounts stateChanges;
+	// the InstanceData of the frame from the upload ring, waits for the oldest frames while it is full.
+	// false if the instances do not fit even into the empty ring.
+	bool AllocateInstances(UINT nrOfInstances, UploadAllocation& allocation);
+	// the wvp matrix and texture frame of every visible object, in draw order
+	void WriteInstances(InstanceData* instances);
+	// what the draws read, instances is the address of the frame's InstanceData
+	DrawBindings GetDrawBindings(D3D12_GPU_VIRTUAL_ADDRESS instances);
 
 	ID3D12DescriptorHeap* renderTargetsHeap;
 	ID3D12Resource1* renderTargets[NUM_SWAP_BUFFERS];
 	UINT renderTargetDescriptorSize;
 
-	ID3D12DescriptorHeap* descriptorHeap[NUM_SWAP_BUFFERS];
-	ID3D12Resource1* constantBufferResource[NUM_SWAP_BUFFERS];
 
 	ID3D12Resource1* depthStencilBuffer[NUM_SWAP_BUFFERS];
 	ID3D12DescriptorHeap* dsDescriptorHeap;
@@ -93,13 +214,12 @@ private:
 
 	bool firstFrame = true;
 
-	int texInd = 0;
 	int savedInd = 0;
 	int herz = 0;
 
-	D3D12::D3D12Timer gpuTimerObj;
-	D3D12::D3D12Timer gpuTimerFrame;
-	std::vector<double> benchmarkVecObj;
+	// gpu time and number of samples per object, culled objects get fewer samples
+	std::vector<double> benchmarkObjTime;
+	std::vector<int> benchmarkObjSamples;
 	std::vector<double> benchmarkVecFrame;
 	int benchmarkSamples = 1000;
 };
\ No newline at end of file
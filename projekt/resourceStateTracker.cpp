@@ -0,0 +1,106 @@
+#include "resourceStateTracker.h"
+
+ResourceStateTracker::ResourceStateTracker()
+{
+	barrierCount = 0;
+	batchCount = 0;
+}
+
+ResourceStateTracker::~ResourceStateTracker()
+{
+}
+
+void ResourceStateTracker::Register(ID3D12Resource* resource, D3D12_RESOURCE_STATES state)
+{
+	states.insert(std::make_pair(resource, state));
+}
+
+void ResourceStateTracker::Unregister(ID3D12Resource* resource)
+{
+	states.erase(resource);
+	for (size_t i = 0; i < pending.size(); i++)
+	{
+		if (pending[i].Transition.pResource == resource)
+		{
+			pending.erase(pending.begin() + i);
+			break;
+		}
+	}
+}
+
+bool ResourceStateTracker::IsRegistered(ID3D12Resource* resource)
+{
+	return states.find(resource) != states.end();
+}
+
+D3D12_RESOURCE_STATES ResourceStateTracker::GetState(ID3D12Resource* resource)
+{
+	return states.at(resource);
+}
+
+void ResourceStateTracker::Transition(ID3D12Resource* resource, D3D12_RESOURCE_STATES state)
+{
+	D3D12_RESOURCE_STATES& current = states.at(resource);
+	if (current == state)
+	{
+		return;
+	}
+
+	// a resource that already waits for a barrier gets that barrier changed instead of a second one,
+	// if it goes back to where it started both cancel out
+	for (size_t i = 0; i < pending.size(); i++)
+	{
+		if (pending[i].Transition.pResource == resource)
+		{
+			if (pending[i].Transition.StateBefore == state)
+			{
+				pending.erase(pending.begin() + i);
+			}
+			else
+			{
+				pending[i].Transition.StateAfter = state;
+			}
+			current = state;
+			return;
+		}
+	}
+
+	D3D12_RESOURCE_BARRIER barrier = {};
+	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+	barrier.Transition.pResource = resource;
+	barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+	barrier.Transition.StateBefore = current;
+	barrier.Transition.StateAfter = state;
+	pending.push_back(barrier);
+
+	current = state;
+}
+
+void ResourceStateTracker::Flush(CommandRecorder* recorder)
+{
+	if (pending.empty())
+	{
+		return;
+	}
+
+	recorder->ResourceBarrier((UINT)pending.size(), pending.data());
+	barrierCount += (unsigned int)pending.size();
+	batchCount++;
+	pending.clear();
+}
+
+unsigned int ResourceStateTracker::GetBarrierCount()
+{
+	return this->barrierCount;
+}
+
+unsigned int ResourceStateTracker::GetBatchCount()
+{
+	return this->batchCount;
+}
+
+void ResourceStateTracker::ResetCounters()
+{
+	barrierCount = 0;
+	batchCount = 0;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <d3d12.h>
+#include <vector>
+#include <unordered_map>
+#include "commandRecorder.h"
+
+// Keeps the current state of every resource that is transitioned through it, so a barrier
+// is only recorded when a resource really changes state. Transitions are queued and
+// recorded together with one ResourceBarrier call by Flush.
+class ResourceStateTracker
+{
+public:
+	ResourceStateTracker();
+	~ResourceStateTracker();
+
+	// a resource is registered once with the state it was created in, later calls keep the tracked state
+	void Register(ID3D12Resource* resource, D3D12_RESOURCE_STATES state);
+	// forgets the resource and its queued barrier, has to be called before the resource is released.
+	// Another resource can be created at the same address afterwards
+	void Unregister(ID3D12Resource* resource);
+	bool IsRegistered(ID3D12Resource* resource);
+	D3D12_RESOURCE_STATES GetState(ID3D12Resource* resource);
+
+	// queues a barrier if the resource is not in the state already
+	void Transition(ID3D12Resource* resource, D3D12_RESOURCE_STATES state);
+	// records the queued barriers, does nothing if there are none
+	void Flush(CommandRecorder* recorder);
+
+	// barriers and ResourceBarrier calls recorded since the counters were reset
+	unsigned int GetBarrierCount();
+	unsigned int GetBatchCount();
+	void ResetCounters();
+
+private:
+	std::unordered_map<ID3D12Resource*, D3D12_RESOURCE_STATES> states;
+	std::vector<D3D12_RESOURCE_BARRIER> pending;
+
+	unsigned int barrierCount;
+	unsigned int batchCount;
+};
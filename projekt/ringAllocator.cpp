@@ -0,0 +1,115 @@
+#include "ringAllocator.h"
+
+RingAllocator::RingAllocator()
+{
+	Reset(0);
+}
+
+RingAllocator::~RingAllocator()
+{
+}
+
+void RingAllocator::Reset(unsigned long long capacity)
+{
+	this->capacity = capacity;
+	this->head = 0;
+	this->tail = 0;
+	this->used = 0;
+	this->openSize = 0;
+	this->peakUsed = 0;
+	this->wasted = 0;
+	this->nrOfAllocations = 0;
+	this->nrOfFailed = 0;
+	frames.clear();
+}
+
+unsigned long long RingAllocator::Allocate(unsigned long long size, unsigned long long alignment)
+{
+	if (size > capacity || (used > 0 && head == tail))
+	{
+		nrOfFailed++;
+		return INVALID;
+	}
+
+	// nothing is in flight, the whole buffer is free in one piece
+	if (used == 0)
+	{
+		head = 0;
+		tail = 0;
+	}
+
+	// the free space is head..capacity and 0..tail, or head..tail once the head has wrapped
+	unsigned long long offset = (head + alignment - 1) & ~(alignment - 1);
+	unsigned long long taken;
+	if (head >= tail && offset + size <= capacity)
+	{
+		taken = offset + size - head;
+	}
+	else if (head >= tail && size <= tail)
+	{
+		// the end of the buffer is skipped, it is freed with this frame
+		offset = 0;
+		taken = capacity - head + size;
+	}
+	else if (head < tail && offset + size <= tail)
+	{
+		taken = offset + size - head;
+	}
+	else
+	{
+		nrOfFailed++;
+		return INVALID;
+	}
+
+	head = offset + size == capacity ? 0 : offset + size;
+	used += taken;
+	openSize += taken;
+	wasted += taken - size;
+	peakUsed = used > peakUsed ? used : peakUsed;
+	nrOfAllocations++;
+	return offset;
+}
+
+void RingAllocator::FinishFrame(unsigned long long fenceValue)
+{
+	if (openSize == 0)
+	{
+		return;
+	}
+
+	Frame frame;
+	frame.fenceValue = fenceValue;
+	frame.end = head;
+	frame.size = openSize;
+	frames.push_back(frame);
+	openSize = 0;
+}
+
+void RingAllocator::Retire(unsigned long long completedValue)
+{
+	// the oldest allocation that is still in use starts where the retired frame ended
+	while (!frames.empty() && frames.front().fenceValue <= completedValue)
+	{
+		tail = frames.front().end;
+		used -= frames.front().size;
+		frames.pop_front();
+	}
+}
+
+unsigned long long RingAllocator::GetOldestFenceValue()
+{
+	return frames.empty() ? 0 : frames.front().fenceValue;
+}
+
+RingAllocatorStats RingAllocator::GetStats()
+{
+	RingAllocatorStats stats;
+	stats.capacity = capacity;
+	stats.used = used;
+	stats.peakUsed = peakUsed;
+	stats.wasted = wasted;
+	stats.framesInFlight = (unsigned int)frames.size();
+	stats.nrOfAllocations = nrOfAllocations;
+	stats.nrOfFailed = nrOfFailed;
+	return stats;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <deque>
+
+// how full the ring is and how much of it was lost to alignment and wrapping
+struct RingAllocatorStats
+{
+	unsigned long long capacity;
+	unsigned long long used;
+	unsigned long long peakUsed;
+	// bytes skipped for alignment and at the end of the buffer when an allocation wrapped
+	unsigned long long wasted;
+	unsigned int framesInFlight;
+	unsigned int nrOfAllocations;
+	unsigned int nrOfFailed;
+};
+
+// Hands out aligned ranges of a buffer front to back and wraps around at the end. Nothing is
+// freed on its own, the ranges of a frame are freed together once the gpu has passed the fence
+// value the frame was finished with. Knows nothing about d3d, so it can be tested on its own.
+class RingAllocator
+{
+public:
+	static const unsigned long long INVALID = ~0ull;
+
+	RingAllocator();
+	~RingAllocator();
+
+	// forgets all allocations and frames
+	void Reset(unsigned long long capacity);
+
+	// returns the offset of size bytes aligned to alignment, a power of two. INVALID if they
+	// do not fit in front of the oldest frame that is still in flight.
+	unsigned long long Allocate(unsigned long long size, unsigned long long alignment);
+	// everything allocated since the last call belongs to the frame that signals fenceValue
+	void FinishFrame(unsigned long long fenceValue);
+	// frees the frames whose fence value is at most completedValue
+	void Retire(unsigned long long completedValue);
+
+	// fence value of the oldest frame that is not retired, 0 if there is none
+	unsigned long long GetOldestFenceValue();
+	RingAllocatorStats GetStats();
+
+private:
+	struct Frame
+	{
+		unsigned long long fenceValue;
+		unsigned long long end;		// the head once the frame was finished
+		unsigned long long size;	// bytes it took, with the wasted ones
+	};
+
+	std::deque<Frame> frames;
+	unsigned long long capacity;
+	unsigned long long head;
+	unsigned long long tail;
+	unsigned long long used;
+	unsigned long long openSize;	// bytes of the frame that is not finished yet
+
+	unsigned long long peakUsed;
+	unsigned long long wasted;
+	unsigned int nrOfAllocations;
+	unsigned int nrOfFailed;
+};
@@ -1,576 +1,425 @@
 #include "texture.h"
+#include "materialParser.h"
+#include <stdio.h>
+#include <string.h>
+
+#pragma warning (disable: 4996)
 
 Texture::Texture()
 {
-	textureBuffer = nullptr; // the resource heap containing our texture
 	descriptorHeap = nullptr;
+	firstDescriptor = DescriptorAllocator::INVALID;
 	textureBufferUploadHeap = nullptr;
+	ownsUploadHeap = false;
+	textureHeaps = nullptr;
+	stateTracker = nullptr;
 
 	textureDesc = {};
-	imageBytesPerRow = 0;
-	imageData = nullptr;
-	imageSize = 0;
+	uploaded = false;
+	id = 0;
+	textureArray = false;
+
+	mappedUploadHeap = nullptr;
 }
 
 Texture::~Texture()
 {
-	delete imageData;
+	if (descriptorHeap != nullptr)
+	{
+		descriptorHeap->Free(firstDescriptor, GetNrOfResources());
+	}
 
+	ReleaseTextures();
+
+	// the copies were never recorded, nothing else has the upload heap
+	if (ownsUploadHeap)
+	{
+		textureBufferUploadHeap->Release();
+	}
 }
 
-int Texture::LoadFromFile(char* filename, ID3D12Device5* device)
+bool Texture::LoadMaterialData(std::string mtlPath)
 {
-	int counter = 0;
-	std::wstring patath = L"../objects/";
-	while (filename[counter] != NULL)
+	//the frames are next to the mtl file
+	if (!MaterialParser::Parse(mtlPath, texVec))
 	{
-		patath.push_back(filename[counter]);
-		counter++;
+		printf("ERROR LOADING MATERIAL! \n");
+		return false;
 	}
 
-	imageSize = LoadImageDataFromFile(patath.c_str());
-
-	if (imageSize <= 0)
+	if (texVec.size() == 0)
 	{
-		OutputDebugStringA("Could not load image file!\n");
-		return -1;
+		printf("ERROR! The material has no textures!\n");
+		return false;
 	}
 
-	CreateHeap(device);
-
-	return 0;
-}
+	textureArray = ANIMATED_TEXTURE_ARRAY && texVec.size() > 1;
 
-void Texture::Bind(ID3D12GraphicsCommandList4* commandList)
-{
-	// store vertex buffer in upload heap
-	textureData.pData = &imageData[0]; // pointer to our image data
-	textureData.RowPitch = imageBytesPerRow; // size of all our triangle vertex data
-	textureData.SlicePitch = imageBytesPerRow * textureDesc.Height; // also the size of our triangle vertex data*/
+	// all of the frames have the same size, the first one describes the texture
+	if (!DecodeFrame(0, firstFrame))
+	{
+		texVec.clear();
+		return false;
+	}
+	DescribeTexture(firstFrame);
 
-	// Now we copy the upload buffer contents to the default heap
-	UpdateSubresources(commandList, textureBuffer, textureBufferUploadHeap, 0, 0, 1, &textureData);
+	return true;
 }
 
-void Texture::BindMulti(ID3D12GraphicsCommandList4* commandList)
+void Texture::CreateResources(ID3D12Device5* device, DescriptorHeap* heap, UploadRing* ring, TextureHeaps* textureHeaps,
+	ResourceStateTracker* stateTracker)
 {
-	for (int i = 0; i < this->texVec.size(); ++i)
+	if (texVec.empty())
 	{
-		// Copy data to the intermediate upload heap and then schedule 
-		// a copy from the upload heap to the appropriate texture.
-		D3D12_SUBRESOURCE_DATA textureData = {};
-		textureData.pData = &imageDataVec.at(i)[0];
-		textureData.RowPitch = static_cast<LONG_PTR>((textureChannelCount * textureDesc.Width));
-		textureData.SlicePitch = textureData.RowPitch * textureDesc.Height;
-
-		UpdateSubresources(commandList, textureBufferVec.at(i), textureBufferUploadHeap, i * uploadBufferStep, 0, subresourceCount, &textureData);
+		return;
 	}
-}
 
-int Texture::LoadImageDataFromFile(LPCWSTR filename)
-{
 	HRESULT hr;
 
-	// we only need one instance of the imaging factory to create decoders and frames
-	static IWICImagingFactory* wicFactory;
-
-	// reset decoder, frame and converter since these will be different for each image we load
-	IWICBitmapDecoder* wicDecoder = NULL;
-	IWICBitmapFrameDecode* wicFrame = NULL;
-	IWICFormatConverter* wicConverter = NULL;
-
-	bool imageConverted = false;
-
-	if (wicFactory == NULL)
+	int nrOfResources = textureArray ? 1 : texVec.size();
+	this->textureHeaps = textureHeaps;
+	this->stateTracker = stateTracker;
+	for (int i = 0; i < nrOfResources; i++)
 	{
-		// Initialize the COM library
-		CoInitialize(NULL);
-
-		// create the WIC factory
-		hr = CoCreateInstance(
-			CLSID_WICImagingFactory,
-			NULL,
-			CLSCTX_INPROC_SERVER,
-			IID_PPV_ARGS(&wicFactory)
-		);
-		if (FAILED(hr)) return 0;
+		// placed in one of the shared texture heaps. We will copy the texture from the upload heap to here, so we start it out in a copy dest state
+		HeapPlacement placement;
+		ID3D12Resource* tempBuff = textureHeaps->CreateTexture(textureDesc, D3D12_RESOURCE_STATE_COPY_DEST, placement);
+		if (tempBuff == nullptr)
+		{
+			// the texture is left without resources instead of with some of its frames
+			OutputDebugStringA("Could not create Texture Buffer Resource Heap");
+			ReleaseTextures();
+			return;
+		}
+		tempBuff->SetName(L"Texture Buffer Resource Heap!\n");
+		textureBufferVec.push_back(tempBuff);
+		placements.push_back(placement);
+		stateTracker->Register(tempBuff, D3D12_RESOURCE_STATE_COPY_DEST);
 	}
 
-	// load a decoder for the image
-	hr = wicFactory->CreateDecoderFromFilename(
-		filename,                        // Image we want to load in
-		NULL,                            // This is a vendor ID, we do not prefer a specific one so set to null
-		GENERIC_READ,                    // We want to read from this file
-		WICDecodeMetadataCacheOnLoad,    // We will cache the metadata right away, rather than when needed, which might be unknown
-		&wicDecoder                      // the wic decoder to be created
-	);
-	if (FAILED(hr)) return 0;
-
-	// get image from decoder (this will decode the "frame")
-	hr = wicDecoder->GetFrame(0, &wicFrame);
-	if (FAILED(hr)) return 0;
-
-	// get wic pixel format of image
-	WICPixelFormatGUID pixelFormat;
-	hr = wicFrame->GetPixelFormat(&pixelFormat);
-	if (FAILED(hr)) return 0;
-
-	// get size of image
-	UINT textureWidth, textureHeight;
-	hr = wicFrame->GetSize(&textureWidth, &textureHeight);
-	if (FAILED(hr))
+	// this function gets the layout an upload buffer needs to upload a texture to the gpu.
+	// each row must be 256 byte aligned except for the last row, which can just be the size in bytes of the row
+	UINT mips = textureDesc.MipLevels;
+	footprints.resize(texVec.size() * mips);
+	UINT64 uploadSize;
+	if (textureArray)
 	{
-		return 0;
+		// one subresource per mip of every slice, the mips of a slice come one after another like the footprints
+		std::vector<UINT> rows(footprints.size());
+		std::vector<UINT64> sizes(footprints.size());
+		device->GetCopyableFootprints(&textureDesc, 0, footprints.size(), 0, footprints.data(), rows.data(), sizes.data(), &uploadSize);
+		numRows.assign(rows.begin(), rows.begin() + mips);
+		rowSizes.assign(sizes.begin(), sizes.begin() + mips);
 	}
-
-	// convert wic pixel format to dxgi pixel format
-	DXGI_FORMAT dxgiFormat = GetDXGIFormatFromWICFormat(pixelFormat);
-
-	// if the format of the image is not a supported dxgi format, try to convert it
-	if (dxgiFormat == DXGI_FORMAT_UNKNOWN)
+	else
 	{
-		// get a dxgi compatible wic format from the current image format
-		WICPixelFormatGUID convertToPixelFormat = GetConvertToWICFormat(pixelFormat);
-
-		// return if no dxgi compatible format was found
-		if (convertToPixelFormat == GUID_WICPixelFormatDontCare) return 0;
-
-		// set the dxgi format
-		dxgiFormat = GetDXGIFormatFromWICFormat(convertToPixelFormat);
-
-		// create the format converter
-		hr = wicFactory->CreateFormatConverter(&wicConverter);
-		if (FAILED(hr)) return 0;
-
-		// make sure we can convert to the dxgi compatible format
-		BOOL canConvert = FALSE;
-		hr = wicConverter->CanConvert(pixelFormat, convertToPixelFormat, &canConvert);
-		if (FAILED(hr) || !canConvert) return 0;
-
-		// do the conversion (wicConverter will contain the converted image)
-		hr = wicConverter->Initialize(wicFrame, convertToPixelFormat, WICBitmapDitherTypeErrorDiffusion, 0, 0, WICBitmapPaletteTypeCustom);
-		if (FAILED(hr)) return 0;
-
-		// this is so we know to get the image data from the wicConverter (otherwise we will get from wicFrame)
-		imageConverted = true;
+		std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> frame(mips);
+		numRows.resize(mips);
+		rowSizes.resize(mips);
+		UINT64 frameSize;
+		device->GetCopyableFootprints(&textureDesc, 0, mips, 0, frame.data(), numRows.data(), rowSizes.data(), &frameSize);
+
+		// the frames are placed one after another, every one of them aligned for a texture copy
+		UINT64 frameStep = (frameSize + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) & ~(UINT64)(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+		for (int i = 0; i < texVec.size(); i++)
+		{
+			for (UINT mip = 0; mip < mips; mip++)
+			{
+				footprints[i * mips + mip] = frame[mip];
+				footprints[i * mips + mip].Offset += frameStep * i;
+			}
+		}
+		uploadSize = frameStep * texVec.size();
 	}
 
-	int bitsPerPixel = GetDXGIFormatBitsPerPixel(dxgiFormat); // number of bits per pixel
-	imageBytesPerRow = (textureWidth * bitsPerPixel) / 8; // number of bytes in each row of the image data
-	int imageSize = imageBytesPerRow * textureHeight; // total image size in bytes
-
-	// allocate enough memory for the raw image data, and set imageData to point to that memory
-	imageData = (BYTE*)malloc(imageSize);
-
-	// copy (decoded) raw image data into the newly allocated memory (imageData)
-	if (imageConverted)
+	// the frames are staged in the upload ring, which is reused once the frame that copies them has finished
+	UploadAllocation staging;
+	if (ring != nullptr && ring->Allocate(uploadSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, staging))
 	{
-		// if image format needed to be converted, the wic converter will contain the converted image
-		hr = wicConverter->CopyPixels(0, imageBytesPerRow, imageSize, imageData);
-		if (FAILED(hr)) return 0;
+		textureBufferUploadHeap = staging.resource;
+		mappedUploadHeap = staging.cpuAddress - staging.offset;
+		for (size_t i = 0; i < footprints.size(); i++)
+		{
+			footprints[i].Offset += staging.offset;
+		}
 	}
 	else
 	{
-		// no need to convert, just copy data from the wic frame
-		hr = wicFrame->CopyPixels(0, imageBytesPerRow, imageSize, imageData);
-		if (FAILED(hr)) return 0;
-	}
-
-	// now describe the texture with the information we have obtained from the image
-	textureDesc = {};
-	textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-	textureDesc.Alignment = 0; // may be 0, 4KB, 64KB, or 4MB. 0 will let runtime decide between 64KB and 4MB (4MB for multi-sampled textures)
-	textureDesc.Width = textureWidth; // width of the texture
-	textureDesc.Height = textureHeight; // height of the texture
-	textureDesc.DepthOrArraySize = 1; // if 3d image, depth of 3d image. Otherwise an array of 1D or 2D textures (we only have one image, so we set 1)
-	textureDesc.MipLevels = 1; // Number of mipmaps. We are not generating mipmaps for this texture, so we have only one level
-	textureDesc.Format = dxgiFormat; // This is the dxgi format of the image (format of the pixels)
-	textureDesc.SampleDesc.Count = 1; // This is the number of samples per pixel, we just want 1 sample
-	textureDesc.SampleDesc.Quality = 0; // The quality level of the samples. Higher is better quality, but worse performance
-	textureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN; // The arrangement of the pixels. Setting to unknown lets the driver choose the most efficient one
-	textureDesc.Flags = D3D12_RESOURCE_FLAG_NONE; // no flags
-
-	// return the size of the image. remember to delete the image once your done with it (in this tutorial once its uploaded to the gpu)
-	return imageSize;
-}
-
-DXGI_FORMAT Texture::GetDXGIFormatFromWICFormat(WICPixelFormatGUID& wicFormatGUID)
-{
-	if (wicFormatGUID == GUID_WICPixelFormat128bppRGBAFloat) return DXGI_FORMAT_R32G32B32A32_FLOAT;
-	else if (wicFormatGUID == GUID_WICPixelFormat64bppRGBAHalf) return DXGI_FORMAT_R16G16B16A16_FLOAT;
-	else if (wicFormatGUID == GUID_WICPixelFormat64bppRGBA) return DXGI_FORMAT_R16G16B16A16_UNORM;
-	else if (wicFormatGUID == GUID_WICPixelFormat32bppRGBA) return DXGI_FORMAT_R8G8B8A8_UNORM;
-	else if (wicFormatGUID == GUID_WICPixelFormat32bppBGRA) return DXGI_FORMAT_B8G8R8A8_UNORM;
-	else if (wicFormatGUID == GUID_WICPixelFormat32bppBGR) return DXGI_FORMAT_B8G8R8X8_UNORM;
-	else if (wicFormatGUID == GUID_WICPixelFormat32bppRGBA1010102XR) return DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM;
-
-	else if (wicFormatGUID == GUID_WICPixelFormat32bppRGBA1010102) return DXGI_FORMAT_R10G10B10A2_UNORM;
-	else if (wicFormatGUID == GUID_WICPixelFormat16bppBGRA5551) return DXGI_FORMAT_B5G5R5A1_UNORM;
-	else if (wicFormatGUID == GUID_WICPixelFormat16bppBGR565) return DXGI_FORMAT_B5G6R5_UNORM;
-	else if (wicFormatGUID == GUID_WICPixelFormat32bppGrayFloat) return DXGI_FORMAT_R32_FLOAT;
-	else if (wicFormatGUID == GUID_WICPixelFormat16bppGrayHalf) return DXGI_FORMAT_R16_FLOAT;
-	else if (wicFormatGUID == GUID_WICPixelFormat16bppGray) return DXGI_FORMAT_R16_UNORM;
-	else if (wicFormatGUID == GUID_WICPixelFormat8bppGray) return DXGI_FORMAT_R8_UNORM;
-	else if (wicFormatGUID == GUID_WICPixelFormat8bppAlpha) return DXGI_FORMAT_A8_UNORM;
-
-	else return DXGI_FORMAT_UNKNOWN;
-}
-
-WICPixelFormatGUID Texture::GetConvertToWICFormat(WICPixelFormatGUID& wicFormatGUID)
-{
-	if (wicFormatGUID == GUID_WICPixelFormatBlackWhite) return GUID_WICPixelFormat8bppGray;
-	else if (wicFormatGUID == GUID_WICPixelFormat1bppIndexed) return GUID_WICPixelFormat32bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat2bppIndexed) return GUID_WICPixelFormat32bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat4bppIndexed) return GUID_WICPixelFormat32bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat8bppIndexed) return GUID_WICPixelFormat32bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat2bppGray) return GUID_WICPixelFormat8bppGray;
-	else if (wicFormatGUID == GUID_WICPixelFormat4bppGray) return GUID_WICPixelFormat8bppGray;
-	else if (wicFormatGUID == GUID_WICPixelFormat16bppGrayFixedPoint) return GUID_WICPixelFormat16bppGrayHalf;
-	else if (wicFormatGUID == GUID_WICPixelFormat32bppGrayFixedPoint) return GUID_WICPixelFormat32bppGrayFloat;
-	else if (wicFormatGUID == GUID_WICPixelFormat16bppBGR555) return GUID_WICPixelFormat16bppBGRA5551;
-	else if (wicFormatGUID == GUID_WICPixelFormat32bppBGR101010) return GUID_WICPixelFormat32bppRGBA1010102;
-	else if (wicFormatGUID == GUID_WICPixelFormat24bppBGR) return GUID_WICPixelFormat32bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat24bppRGB) return GUID_WICPixelFormat32bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat32bppPBGRA) return GUID_WICPixelFormat32bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat32bppPRGBA) return GUID_WICPixelFormat32bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat48bppRGB) return GUID_WICPixelFormat64bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat48bppBGR) return GUID_WICPixelFormat64bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat64bppBGRA) return GUID_WICPixelFormat64bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat64bppPRGBA) return GUID_WICPixelFormat64bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat64bppPBGRA) return GUID_WICPixelFormat64bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat48bppRGBFixedPoint) return GUID_WICPixelFormat64bppRGBAHalf;
-	else if (wicFormatGUID == GUID_WICPixelFormat48bppBGRFixedPoint) return GUID_WICPixelFormat64bppRGBAHalf;
-	else if (wicFormatGUID == GUID_WICPixelFormat64bppRGBAFixedPoint) return GUID_WICPixelFormat64bppRGBAHalf;
-	else if (wicFormatGUID == GUID_WICPixelFormat64bppBGRAFixedPoint) return GUID_WICPixelFormat64bppRGBAHalf;
-	else if (wicFormatGUID == GUID_WICPixelFormat64bppRGBFixedPoint) return GUID_WICPixelFormat64bppRGBAHalf;
-	else if (wicFormatGUID == GUID_WICPixelFormat64bppRGBHalf) return GUID_WICPixelFormat64bppRGBAHalf;
-	else if (wicFormatGUID == GUID_WICPixelFormat48bppRGBHalf) return GUID_WICPixelFormat64bppRGBAHalf;
-	else if (wicFormatGUID == GUID_WICPixelFormat128bppPRGBAFloat) return GUID_WICPixelFormat128bppRGBAFloat;
-	else if (wicFormatGUID == GUID_WICPixelFormat128bppRGBFloat) return GUID_WICPixelFormat128bppRGBAFloat;
-	else if (wicFormatGUID == GUID_WICPixelFormat128bppRGBAFixedPoint) return GUID_WICPixelFormat128bppRGBAFloat;
-	else if (wicFormatGUID == GUID_WICPixelFormat128bppRGBFixedPoint) return GUID_WICPixelFormat128bppRGBAFloat;
-	else if (wicFormatGUID == GUID_WICPixelFormat32bppRGBE) return GUID_WICPixelFormat128bppRGBAFloat;
-	else if (wicFormatGUID == GUID_WICPixelFormat32bppCMYK) return GUID_WICPixelFormat32bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat64bppCMYK) return GUID_WICPixelFormat64bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat40bppCMYKAlpha) return GUID_WICPixelFormat64bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat80bppCMYKAlpha) return GUID_WICPixelFormat64bppRGBA;
-
-#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8) || defined(_WIN7_PLATFORM_UPDATE)
-	else if (wicFormatGUID == GUID_WICPixelFormat32bppRGB) return GUID_WICPixelFormat32bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat64bppRGB) return GUID_WICPixelFormat64bppRGBA;
-	else if (wicFormatGUID == GUID_WICPixelFormat64bppPRGBAHalf) return GUID_WICPixelFormat64bppRGBAHalf;
-#endif
-
-	else return GUID_WICPixelFormatDontCare;
-}
+		// too big for what is left of the ring, now we create an upload heap to upload our texture to the GPU
+		hr = device->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD), // upload heap
+			D3D12_HEAP_FLAG_NONE, // no flags
+			&CD3DX12_RESOURCE_DESC::Buffer(uploadSize), // resource description for a buffer (storing the image data in this heap just to copy to the default heap)
+			D3D12_RESOURCE_STATE_GENERIC_READ, // We will copy the contents from this heap to the default heap above
+			nullptr,
+			IID_PPV_ARGS(&textureBufferUploadHeap));
+		if (FAILED(hr))
+		{
+			OutputDebugStringA("Could not create Texture Buffer Upload Resource Heap!\n");
+			textureBufferUploadHeap = nullptr;
+			ReleaseTextures();
+			return;
+		}
+		textureBufferUploadHeap->SetName(L"Texture Buffer Upload Resource Heap");
+		ownsUploadHeap = true;
 
-int Texture::GetDXGIFormatBitsPerPixel(DXGI_FORMAT& dxgiFormat)
-{
-	if (dxgiFormat == DXGI_FORMAT_R32G32B32A32_FLOAT) return 128;
-	else if (dxgiFormat == DXGI_FORMAT_R16G16B16A16_FLOAT) return 64;
-	else if (dxgiFormat == DXGI_FORMAT_R16G16B16A16_UNORM) return 64;
-	else if (dxgiFormat == DXGI_FORMAT_R8G8B8A8_UNORM) return 32;
-	else if (dxgiFormat == DXGI_FORMAT_B8G8R8A8_UNORM) return 32;
-	else if (dxgiFormat == DXGI_FORMAT_B8G8R8X8_UNORM) return 32;
-	else if (dxgiFormat == DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM) return 32;
-
-	else if (dxgiFormat == DXGI_FORMAT_R10G10B10A2_UNORM) return 32;
-	else if (dxgiFormat == DXGI_FORMAT_B5G5R5A1_UNORM) return 16;
-	else if (dxgiFormat == DXGI_FORMAT_B5G6R5_UNORM) return 16;
-	else if (dxgiFormat == DXGI_FORMAT_R32_FLOAT) return 32;
-	else if (dxgiFormat == DXGI_FORMAT_R16_FLOAT) return 16;
-	else if (dxgiFormat == DXGI_FORMAT_R16_UNORM) return 16;
-	else if (dxgiFormat == DXGI_FORMAT_R8_UNORM) return 8;
-	else if (dxgiFormat == DXGI_FORMAT_A8_UNORM) return 8;
-}
+		// the frames are decoded right into the upload heap, the cpu never reads from it
+		CD3DX12_RANGE readRange(0, 0);
+		hr = textureBufferUploadHeap->Map(0, &readRange, reinterpret_cast<void**>(&mappedUploadHeap));
+		if (FAILED(hr))
+		{
+			OutputDebugStringA("Could not map the Texture Buffer Upload Resource Heap!\n");
+			mappedUploadHeap = nullptr;
+		}
+	}
 
-ID3D12Resource* Texture::GetTextureBuffer()
-{
-	return this->textureBuffer;
-}
+	// the srvs are a range in the shader visible heap that every texture shares
+	firstDescriptor = heap->Allocate(nrOfResources);
+	if (firstDescriptor == DescriptorAllocator::INVALID)
+	{
+		return;
+	}
+	descriptorHeap = heap;
 
-ID3D12Resource* Texture::GetTextureBufferArray(int pos)
-{
-	return this->textureBufferVec.at(pos);
+	for (int i = 0; i < nrOfResources; i++)
+	{
+		// now we create a shader resource view (descriptor that points to the texture and describes it)
+		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		srvDesc.Format = textureDesc.Format;
+		if (textureArray)
+		{
+			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+			srvDesc.Texture2DArray.MipLevels = textureDesc.MipLevels;
+			srvDesc.Texture2DArray.FirstArraySlice = 0;
+			srvDesc.Texture2DArray.ArraySize = texVec.size();
+		}
+		else
+		{
+			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+			srvDesc.Texture2D.MipLevels = textureDesc.MipLevels;
+		}
+		device->CreateShaderResourceView(textureBufferVec.at(i), &srvDesc, heap->GetCpuHandle(firstDescriptor + i));
+	}
 }
 
-void Texture::CreateHeap(ID3D12Device5* device)
+void Texture::UploadFrames(ThreadPool* pool)
 {
-	HRESULT hr = device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT), // a default heap
-		D3D12_HEAP_FLAG_NONE, // no flags
-		&textureDesc, // the description of our texture
-		D3D12_RESOURCE_STATE_COPY_DEST, // We will copy the texture from the upload heap to here, so we start it out in a copy dest state
-		nullptr, // used for render targets and depth/stencil buffers
-		IID_PPV_ARGS(&textureBuffer));
-	if (FAILED(hr))
+	if (mappedUploadHeap == nullptr)
 	{
-		OutputDebugStringA("Could not create Texture Buffer Resource Heap");
+		return;
 	}
-	textureBuffer->SetName(L"Texture Buffer Resource Heap!\n");
 
-
-	// this function gets the size an upload buffer needs to be to upload a texture to the gpu.
-	// each row must be 256 byte aligned except for the last row, which can just be the size in bytes of the row
-	// eg. textureUploadBufferSize = ((((width * numBytesPerPixel) + 255) & ~255) * (height - 1)) + (width * numBytesPerPixel);
-	//textureUploadBufferSize = (((imageBytesPerRow + 255) & ~255) * (textureDesc.Height - 1)) + imageBytesPerRow;
-	device->GetCopyableFootprints(&textureDesc, 0, 1, 0, nullptr, nullptr, nullptr, &textureUploadBufferSize);
-
-	// now we create an upload heap to upload our texture to the GPU
-	hr = device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD), // upload heap
-		D3D12_HEAP_FLAG_NONE, // no flags
-		&CD3DX12_RESOURCE_DESC::Buffer(textureUploadBufferSize), // resource description for a buffer (storing the image data in this heap just to copy to the default heap)
-		D3D12_RESOURCE_STATE_GENERIC_READ, // We will copy the contents from this heap to the default heap above
-		nullptr,
-		IID_PPV_ARGS(&textureBufferUploadHeap));
-	if (FAILED(hr))
+	// every frame is decoded on its own, so they can all be decoded at the same time
+	if (pool == nullptr)
 	{
-		OutputDebugStringA("Could not create Texture Buffer Upload Resource Heap!\n");
+		for (int i = 0; i < this->texVec.size(); i++)
+		{
+			UploadFrame(i);
+		}
 	}
-	textureBufferUploadHeap->SetName(L"Texture Buffer Upload Resource Heap");
-
-	// create the descriptor heap that will store our srv
-	heapDesc.NumDescriptors = 1;
-	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	hr = device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&descriptorHeap));
-	if (FAILED(hr))
+	else
 	{
-		OutputDebugStringA("Could not create the Texture Main Heap!\n");
+		std::vector<std::future<void>> frames;
+		for (int i = 0; i < this->texVec.size(); i++)
+		{
+			frames.push_back(pool->Submit([this, i]() { UploadFrame(i); }));
+		}
+		for (size_t i = 0; i < frames.size(); i++)
+		{
+			pool->Wait(frames[i]);
+		}
 	}
 
-	// now we create a shader resource view (descriptor that points to the texture and describes it)
-	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-	srvDesc.Format = textureDesc.Format;
-	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Texture2D.MipLevels = 1;
-	device->CreateShaderResourceView(textureBuffer, &srvDesc, descriptorHeap->GetCPUDescriptorHandleForHeapStart());
-}
-
-ID3D12DescriptorHeap* Texture::GetTextureDescriptorHeap()
-{
-	return this->descriptorHeap;
+	// the ring stays mapped
+	if (ownsUploadHeap)
+	{
+		textureBufferUploadHeap->Unmap(0, nullptr);
+	}
+	mappedUploadHeap = nullptr;
 }
 
-void Texture::BindlessTechnique(std::vector<std::string> textureVec, ID3D12Device5* device)
+void Texture::UploadFrame(int frame)
 {
-	for (int i = 0; i < textureVec.size(); i++)
+	// the first frame was decoded while loading the material, it is released here with the others
+	DecodedImage image;
+	if (frame == 0)
 	{
-		int counter = 0;
-		std::wstring patath = L"../objects/";
-		while (textureVec.at(i)[counter] != NULL)
-		{
-			patath.push_back(textureVec.at(i)[counter]);
-			counter++;
-		}
-		texVec.push_back(patath);
-		patath = L"";
+		image = std::move(firstFrame);
+		firstFrame.Clear();
 	}
-
-	//____________________________________________________________________________________________________________
-
-	HRESULT hr;
-
-	// we only need one instance of the imaging factory to create decoders and frames
-	static IWICImagingFactory* wicFactory;
-	UINT textureWidth, textureHeight;
-	DXGI_FORMAT dxgiFormat;
-
-	for (int i = 0; i < this->texVec.size(); i++)
+	else if (!DecodeFrame(frame, image))
 	{
-		// reset decoder, frame and converter since these will be different for each image we load
-		IWICBitmapDecoder* wicDecoder = NULL;
-		IWICBitmapFrameDecode* wicFrame = NULL;
-		IWICFormatConverter* wicConverter = NULL;
+		return;
+	}
 
-		bool imageConverted = false;
+	if (image.width != textureDesc.Width || image.height != textureDesc.Height)
+	{
+		printf("ERROR! %s does not have the same size as the first frame\n", texVec.at(frame).c_str());
+		return;
+	}
 
-		if (wicFactory == NULL)
-		{
-			// Initialize the COM library
-			CoInitialize(NULL);
-
-			// create the WIC factory
-			hr = CoCreateInstance(
-				CLSID_WICImagingFactory,
-				NULL,
-				CLSCTX_INPROC_SERVER,
-				IID_PPV_ARGS(&wicFactory)
-			);
-			if (FAILED(hr)) OutputDebugStringA("Could not create the Wic factory!\n");
-		}
-	
-		// load a decoder for the image
-		hr = wicFactory->CreateDecoderFromFilename(
-			texVec.at(i).c_str(),            // Image we want to load in
-			NULL,                            // This is a vendor ID, we do not prefer a specific one so set to null
-			GENERIC_READ,                    // We want to read from this file
-			WICDecodeMetadataCacheOnLoad,    // We will cache the metadata right away, rather than when needed, which might be unknown
-			&wicDecoder                      // the wic decoder to be created
-		);
-		if (FAILED(hr)) OutputDebugStringA("Could not load decoder from image!\n");
-
-		// get image from decoder (this will decode the "frame")
-		hr = wicDecoder->GetFrame(0, &wicFrame);
-		if (FAILED(hr)) OutputDebugStringA("Could not get the image from decoder!\n");
-
-		// get wic pixel format of image
-		WICPixelFormatGUID pixelFormat;
-		hr = wicFrame->GetPixelFormat(&pixelFormat);
-		if (FAILED(hr)) OutputDebugStringA("Could not get wic picel format of image!\n");
-
-		// get size of image
-		hr = wicFrame->GetSize(&textureWidth, &textureHeight);
-		if (FAILED(hr))
+	// the first mip is the decoded frame, every other one is made from the mip before it. The mips are made
+	// in memory of their own, the upload heap is write combined and slow to read from.
+	const unsigned char* source = image.pixels.data();
+	size_t sourcePitch = image.GetRowPitch();
+	std::vector<unsigned char> levels[2];
+	for (UINT mip = 0; mip < textureDesc.MipLevels; mip++)
+	{
+		if (mip > 0)
 		{
-			OutputDebugStringA("Could not get size of image!\n");
+			std::vector<unsigned char>& level = levels[mip % 2];
+			size_t pitch = (size_t)MipGenerator::GetMipSize(image.width, mip) * 4;
+			level.resize(pitch * MipGenerator::GetMipSize(image.height, mip));
+			MipGenerator::Downsample(source, MipGenerator::GetMipSize(image.width, mip - 1), MipGenerator::GetMipSize(image.height, mip - 1),
+				sourcePitch, level.data(), pitch);
+			source = level.data();
+			sourcePitch = pitch;
 		}
 
-		// convert wic pixel format to dxgi pixel format
-		dxgiFormat = GetDXGIFormatFromWICFormat(pixelFormat);
-
-		// if the format of the image is not a supported dxgi format, try to convert it
-		if (dxgiFormat == DXGI_FORMAT_UNKNOWN)
+		// the rows of the upload heap are 256 byte aligned, the rows of the mips are tightly packed
+		const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = footprints[frame * textureDesc.MipLevels + mip];
+		BYTE* destination = mappedUploadHeap + footprint.Offset;
+		for (UINT row = 0; row < numRows[mip]; row++)
 		{
-			// get a dxgi compatible wic format from the current image format
-			WICPixelFormatGUID convertToPixelFormat = GetConvertToWICFormat(pixelFormat);
-
-			// return if no dxgi compatible format was found
-			if (convertToPixelFormat == GUID_WICPixelFormatDontCare) OutputDebugStringA("No compatible dxgi format found!\n");
-
-			// set the dxgi format
-			dxgiFormat = GetDXGIFormatFromWICFormat(convertToPixelFormat);
-
-			// create the format converter
-			hr = wicFactory->CreateFormatConverter(&wicConverter);
-			if (FAILED(hr)) OutputDebugStringA("Could not create format converter!\n");
-
-			// make sure we can convert to the dxgi compatible format
-			BOOL canConvert = FALSE;
-			hr = wicConverter->CanConvert(pixelFormat, convertToPixelFormat, &canConvert);
-			if (FAILED(hr) || !canConvert) OutputDebugStringA("Could not convert to compatible dxgi format!\n");
-
-			// do the conversion (wicConverter will contain the converted image)
-			hr = wicConverter->Initialize(wicFrame, convertToPixelFormat, WICBitmapDitherTypeErrorDiffusion, 0, 0, WICBitmapPaletteTypeCustom);
-			if (FAILED(hr)) OutputDebugStringA("Could not convert from Wic!\n");
-
-			// this is so we know to get the image data from the wicConverter (otherwise we will get from wicFrame)
-			imageConverted = true;
+			memcpy(destination + row * footprint.Footprint.RowPitch, source + row * sourcePitch, (size_t)rowSizes[mip]);
 		}
+	}
+}
 
-		int bitsPerPixel = GetDXGIFormatBitsPerPixel(dxgiFormat); // number of bits per pixel
-		imageBytesPerRowVec.push_back((textureWidth * bitsPerPixel) / 8); // number of bytes in each row of the image data
-		int imageSize = imageBytesPerRowVec.at(i) * textureHeight; // total image size in bytes
+void Texture::Bind(ID3D12GraphicsCommandList4* commandList)
+{
+	if (uploaded)
+	{
+		return;
+	}
+	uploaded = true;
 
-		// allocate enough memory for the raw image data, and set imageData to point to that memory
-		imageDataVec.push_back((BYTE*)malloc(imageSize));
+	// a texture whose resources could not be created has nothing to copy
+	if (textureBufferVec.empty() || textureBufferUploadHeap == nullptr)
+	{
+		return;
+	}
 
-		// copy (decoded) raw image data into the newly allocated memory (imageData)
-		if (imageConverted)
-		{
-			// if image format needed to be converted, the wic converter will contain the converted image
-			hr = wicConverter->CopyPixels(0, imageBytesPerRowVec.at(i), imageSize, imageDataVec.at(i));
-			if (FAILED(hr)) OutputDebugStringA("Could not contain the converted image!\n");
-		}
-		else
+	// Now we copy the upload buffer contents to the default heap, a frame of a texture array is a slice.
+	// Every mip is a subresource of its own
+	UINT mips = textureDesc.MipLevels;
+	int nrOfFrames = textureArray ? texVec.size() : textureBufferVec.size();
+	for (int i = 0; i < nrOfFrames; i++)
+	{
+		ID3D12Resource* texture = textureArray ? textureBufferVec.at(0) : textureBufferVec.at(i);
+		for (UINT mip = 0; mip < mips; mip++)
 		{
-			// no need to convert, just copy data from the wic frame
-			hr = wicFrame->CopyPixels(0, imageBytesPerRowVec.at(i), imageSize, imageDataVec.at(i));
-			if (FAILED(hr)) OutputDebugStringA("Could not copy the converted image!\n");
+			UINT subresource = textureArray ? D3D12CalcSubresource(mip, i, 0, mips, texVec.size()) : mip;
+			CD3DX12_TEXTURE_COPY_LOCATION destination(texture, subresource);
+			CD3DX12_TEXTURE_COPY_LOCATION source(textureBufferUploadHeap, footprints[i * mips + mip]);
+			commandList->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
 		}
+	}
+}
 
-		if (imageSize <= 0)
-		{
-			OutputDebugStringA("Could not load image file!\n");
-		}
+ID3D12Resource* Texture::TakeUploadHeap()
+{
+	if (!uploaded || !ownsUploadHeap)
+	{
+		return nullptr;
 	}
 
+	ID3D12Resource* uploadHeap = textureBufferUploadHeap;
+	textureBufferUploadHeap = nullptr;
+	ownsUploadHeap = false;
+	return uploadHeap;
+}
+
+bool Texture::DecodeFrame(int frame, DecodedImage& image)
+{
+	// png and jpeg files are decoded by the portable decoders, anything else by WIC
+	if (!ImageLoader::GetDefault().Load(texVec.at(frame), image))
+	{
+		OutputDebugStringA("Could not load image file!\n");
+		return false;
+	}
+
+	return true;
+}
+
+int Texture::GetNrOfFrames()
+{
+	return this->texVec.size();
+}
+
+void Texture::DescribeTexture(const DecodedImage& image)
+{
 	// now describe the texture with the information we have obtained from the image
 	textureDesc = {};
 	textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
 	textureDesc.Alignment = 0; // may be 0, 4KB, 64KB, or 4MB. 0 will let runtime decide between 64KB and 4MB (4MB for multi-sampled textures)
-	textureDesc.Width = textureWidth; // width of the texture
-	textureDesc.Height = textureHeight; // height of the texture
-	textureDesc.DepthOrArraySize = 1; // if 3d image, depth of 3d image. Otherwise an array of 1D or 2D textures (we only have one image, so we set 1)
-	textureDesc.MipLevels = 1; // Number of mipmaps. We are not generating mipmaps for this texture, so we have only one level
-	textureDesc.Format = dxgiFormat; // This is the dxgi format of the image (format of the pixels)
+	textureDesc.Width = image.width; // width of the texture
+	textureDesc.Height = image.height; // height of the texture
+	textureDesc.DepthOrArraySize = textureArray ? texVec.size() : 1; // if 3d image, depth of 3d image. Otherwise an array of 1D or 2D textures (one slice per frame for a texture array)
+	textureDesc.MipLevels = TEXTURE_MIPS ? MipGenerator::GetNrOfMips(image.width, image.height) : 1; // Number of mipmaps, a full chain down to 1x1 when they are generated
+	textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM; // every decoder produces 8-bit RGBA
 	textureDesc.SampleDesc.Count = 1; // This is the number of samples per pixel, we just want 1 sample
 	textureDesc.SampleDesc.Quality = 0; // The quality level of the samples. Higher is better quality, but worse performance
 	textureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN; // The arrangement of the pixels. Setting to unknown lets the driver choose the most efficient one
 	textureDesc.Flags = D3D12_RESOURCE_FLAG_NONE; // no flags
+}
 
-	//____________________________________________________________________________________________________________
+ID3D12Resource* Texture::GetTextureBuffer()
+{
+	return this->textureBufferVec.at(0);
+}
 
-	for (int i = 0; i < texVec.size(); i++)
-	{
-		ID3D12Resource* tempBuff;
-		hr = device->CreateCommittedResource(
-			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT), // a default heap
-			D3D12_HEAP_FLAG_NONE, // no flags
-			&textureDesc, // the description of our texture
-			D3D12_RESOURCE_STATE_COPY_DEST, // We will copy the texture from the upload heap to here, so we start it out in a copy dest state
-			nullptr, // used for render targets and depth/stencil buffers
-			IID_PPV_ARGS(&tempBuff));
-		textureBufferVec.push_back(tempBuff);
-		if (FAILED(hr))
-		{
-			OutputDebugStringA("Could not create Texture Buffer Resource Heap");
-		}
-		textureBufferVec.at(i)->SetName(L"Texture Buffer Resource Heap!\n");
-	}
-	//__________________________________________________________________________________________________________
-
-	subresourceCount = textureDesc.DepthOrArraySize * textureDesc.MipLevels;
-	uploadBufferStep = GetRequiredIntermediateSize(&textureBufferVec.at(0)[0], 0, subresourceCount); // All of our textures are the same size in this case.
-	uploadBufferSize = uploadBufferStep * texVec.size();
-
-	// now we create an upload heap to upload our texture to the GPU
-	hr = device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD), // upload heap
-		D3D12_HEAP_FLAG_NONE, // no flags
-		&CD3DX12_RESOURCE_DESC::Buffer(uploadBufferSize), // resource description for a buffer (storing the image data in this heap just to copy to the default heap)
-		D3D12_RESOURCE_STATE_GENERIC_READ, // We will copy the contents from this heap to the default heap above
-		nullptr,
-		IID_PPV_ARGS(&textureBufferUploadHeap));
-	if (FAILED(hr))
-	{
-		OutputDebugStringA("Could not create Texture Buffer Upload Resource Heap!\n");
-	}
+ID3D12Resource* Texture::GetTextureBufferArray(int pos)
+{
+	return this->textureBufferVec.at(pos);
+}
+
+int Texture::GetNrOfResources()
+{
+	return this->textureBufferVec.size();
+}
 
-	textureBufferUploadHeap->SetName(L"Texture Buffer Upload Resource Heap");
+bool Texture::IsTextureArray()
+{
+	return this->textureArray;
+}
 
-	// create the descriptor heap that will store our srv
-	heapDesc.NumDescriptors = texVec.size();
-	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	hr = device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&descriptorHeap));
-	if (FAILED(hr))
+D3D12_GPU_DESCRIPTOR_HANDLE Texture::GetDescriptorTable()
+{
+	if (this->descriptorHeap == nullptr)
 	{
-		OutputDebugStringA("Could not create the Texture Main Heap!\n");
+		D3D12_GPU_DESCRIPTOR_HANDLE none = {};
+		return none;
 	}
+	return this->descriptorHeap->GetGpuHandle(this->firstDescriptor);
+}
 
-	// Get pointer to the start of the heap.
-	UINT descriptorSize = device->GetDescriptorHandleIncrementSize(heapDesc.Type);
-	CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(descriptorHeap->GetCPUDescriptorHandleForHeapStart(), 0, descriptorSize);
-	for (int i = 0; i < texVec.size(); i++)
+void Texture::ReleaseTextures()
+{
+	// placed textures are released before their memory is given back. A texture placed at the same
+	// address later must not get the tracked state of this one
+	for (size_t i = 0; i < textureBufferVec.size(); i++)
 	{
-		// now we create a shader resource view (descriptor that points to the texture and describes it)
-		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-		srvDesc.Format = textureDesc.Format;
-		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-		srvDesc.Texture2D.MipLevels = 1;
-		device->CreateShaderResourceView(textureBufferVec.at(i), &srvDesc, hDescriptor);
-
-		// offset to next descriptor in heap
-		hDescriptor.Offset(descriptorSize);
+		stateTracker->Unregister(textureBufferVec[i]);
+		textureBufferVec[i]->Release();
+		textureHeaps->Free(placements[i]);
 	}
+	textureBufferVec.clear();
+	placements.clear();
 }
 
 int Texture::GetVecSize()
 {
-	return this->texVec.size();
+	return this->texVec.size() > 1 ? this->texVec.size() : 0;
+}
+
+unsigned int Texture::GetId()
+{
+	return this->id;
 }
 
+void Texture::SetId(unsigned int id)
+{
+	this->id = id;
+}
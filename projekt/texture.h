@@ -1,62 +1,108 @@
 #pragma once
 #include <d3d12.h>
-#include <wincodec.h>
 #include <string>
 #include "d3dx12.h"
 #include <DirectXMath.h>
+#include <vector>
+#include "threadPool.h"
+#include "imageDecoder.h"
+#include "descriptorHeap.h"
+#include "uploadRing.h"
+#include "textureHeaps.h"
+#include "resourceStateTracker.h"
+#include "mipGenerator.h"
 
 using namespace DirectX;
 
+// true packs the frames of an animated texture into one Texture2DArray with one srv,
+// false creates a texture and a srv per frame
+#define ANIMATED_TEXTURE_ARRAY true
+
+// true gives every texture a full mip chain, made on the cpu while the frames are uploaded.
+// false only uploads the decoded frames
+#define TEXTURE_MIPS true
+
+// A texture from an mtl file. A material with several map_Kd entries is an animated texture,
+// one frame per entry, otherwise the texture has a single frame. Both are loaded the same way:
+// the frames are decoded one at a time straight into the mapped upload heap, so no more than
+// one decoded frame per thread is held in memory.
 class Texture
 {
 public:
 	Texture();
 	~Texture();
 
-	int LoadFromFile(char* filename, ID3D12Device5* device);
+	// cpu part of the loading, reads the mtl file and decodes the first frame to get the size
+	bool LoadMaterialData(std::string mtlPath);
+	// gpu part of the loading, places the textures in textureHeaps and allocates their srvs from the
+	// shader visible heap. The frames are staged in the upload ring, or in an upload heap of
+	// the texture's own if they do not fit. Bind has to be called in the next frame.
+	// The textures are registered with stateTracker until they are released.
+	void CreateResources(ID3D12Device5* device, DescriptorHeap* heap, UploadRing* ring, TextureHeaps* textureHeaps,
+		ResourceStateTracker* stateTracker);
+	// decodes the frames into the upload heap, on the pool if there is one. Needs CreateResources.
+	void UploadFrames(ThreadPool* pool);
+
+	// records the copies from the upload heap to the textures, only the first call does anything
 	void Bind(ID3D12GraphicsCommandList4* commandList);
-	void BindMulti(ID3D12GraphicsCommandList4* commandList);
+	// the upload heap of the texture's own once Bind has recorded the copies from it, nullptr if the
+	// frames were staged in the ring. The caller releases it once the gpu is done with the copies
+	ID3D12Resource* TakeUploadHeap();
 
-	int LoadImageDataFromFile(LPCWSTR filename);
-	DXGI_FORMAT GetDXGIFormatFromWICFormat(WICPixelFormatGUID& wicFormatGUID);
-	WICPixelFormatGUID GetConvertToWICFormat(WICPixelFormatGUID& wicFormatGUID);
-	int GetDXGIFormatBitsPerPixel(DXGI_FORMAT& dxgiFormat);
+	bool DecodeFrame(int frame, DecodedImage& image);
+	int GetNrOfFrames();
 
 	ID3D12Resource* GetTextureBuffer();
 	ID3D12Resource* GetTextureBufferArray(int pos);
+	int GetNrOfResources();
+	// the pixel shader samples a Texture2DArray instead of an array of textures
+	bool IsTextureArray();
 
-	void CreateHeap(ID3D12Device5* device);
-
-	ID3D12DescriptorHeap* GetTextureDescriptorHeap();
-
-	void BindlessTechnique(std::vector<std::string> textureVec, ID3D12Device5* device);
+	// the srvs of the texture, one per resource in a row
+	D3D12_GPU_DESCRIPTOR_HANDLE GetDescriptorTable();
 
+	// number of frames of an animated texture, 0 if it is not animated
 	int GetVecSize();
 
+	// small id of the live texture for the draw sort keys, given by the AssetCache
+	unsigned int GetId();
+	void SetId(unsigned int id);
+
 private:
-	ID3D12DescriptorHeap* descriptorHeap;
-	ID3D12Resource* textureBuffer; // the resource heap containing our texture
+	void DescribeTexture(const DecodedImage& image);
+	void UploadFrame(int frame);
+	// unregisters and releases the textures and gives their placements back
+	void ReleaseTextures();
+
+	// shared textures are only uploaded by the first object that binds them
+	bool uploaded;
+	unsigned int id;
+
+	// the heap the srvs are allocated from and the first of them
+	DescriptorHeap* descriptorHeap;
+	UINT firstDescriptor;
+	// the upload ring's buffer or an upload heap that belongs to the texture
 	ID3D12Resource* textureBufferUploadHeap;
-	D3D12_SUBRESOURCE_DATA textureData = {};
-	D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+	bool ownsUploadHeap;
 	D3D12_RESOURCE_DESC textureDesc;
 
-	UINT64 textureUploadBufferSize;
-	int imageBytesPerRow;
-	BYTE* imageData;
-	int imageSize;
-
-	/*------------ BINDLESS STUFF -------------*/
-	//UINT64 textureUploadBufferSize;
-	std::vector<int> imageBytesPerRowVec;
-	std::vector<BYTE*> imageDataVec;
+	// paths of the frames and one texture per frame, or one texture array for all of them
+	std::vector<std::string> texVec;
 	std::vector<ID3D12Resource*> textureBufferVec;
-	std::vector<ID3D12Resource*> textureBufferUploadHeapVec;
-	std::vector<std::wstring> texVec;
-
-	BYTE** textureImageData;
-	UINT textureChannelCount = 4;
-	UINT subresourceCount;
-	UINT64 uploadBufferStep;
-	UINT64 uploadBufferSize;
-};
\ No newline at end of file
+	bool textureArray;
+	// where the textures are in the texture heaps, one per texture
+	TextureHeaps* textureHeaps;
+	std::vector<HeapPlacement> placements;
+	ResourceStateTracker* stateTracker;
+
+	// decoded while loading the material, uploaded and released with the other frames
+	DecodedImage firstFrame;
+
+	// every frame (or array slice) has the same layout, at its own offset in the upload heap.
+	// One footprint per mip of every frame, the mips of a frame are next to each other
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints;
+	// rows of every mip and the bytes of a row, the same for every frame
+	std::vector<UINT> numRows;
+	std::vector<UINT64> rowSizes;
+	BYTE* mappedUploadHeap;	// the start of textureBufferUploadHeap, the footprint offsets are from here
+};
@@ -0,0 +1,112 @@
+#include "textureHeaps.h"
+#include <iostream>
+
+TextureHeaps::TextureHeaps()
+{
+	device = nullptr;
+}
+
+TextureHeaps::~TextureHeaps()
+{
+	for (size_t i = 0; i < heaps.size(); i++)
+	{
+		if (heaps[i] != nullptr)
+		{
+			heaps[i]->Release();
+		}
+	}
+}
+
+void TextureHeaps::Create(ID3D12Device5* device, UINT64 heapSize)
+{
+	this->device = device;
+	allocator.Reset(heapSize);
+}
+
+ID3D12Resource* TextureHeaps::CreateTexture(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState, HeapPlacement& placement)
+{
+	//the small alignment is only asked for when the first mip can fit into 64KB, the debug layer
+	//complains about the others. Every texture here is 8-bit rgba.
+	D3D12_RESOURCE_DESC placed = desc;
+	D3D12_RESOURCE_ALLOCATION_INFO info = {};
+	UINT64 firstMipSize = desc.Width * desc.Height * desc.DepthOrArraySize * 4;
+	if ((desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) == 0 &&
+		firstMipSize <= D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT)
+	{
+		placed.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+		info = device->GetResourceAllocationInfo(0, 1, &placed);
+	}
+	if (info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+	{
+		placed.Alignment = 0;
+		info = device->GetResourceAllocationInfo(0, 1, &placed);
+	}
+
+	if (!allocator.Allocate(info.SizeInBytes, info.Alignment, placement))
+	{
+		OutputDebugStringA("ERROR: Could not place the texture in a heap!\n");
+		return nullptr;
+	}
+
+	//the allocator took a heap that does not exist yet
+	if (heaps.size() < allocator.GetNrOfHeaps())
+	{
+		heaps.resize(allocator.GetNrOfHeaps(), nullptr);
+	}
+	if (heaps[placement.heap] == nullptr)
+	{
+		D3D12_HEAP_DESC heapDesc = {};
+		heapDesc.SizeInBytes = allocator.GetHeapSize(placement.heap);
+		heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+		heapDesc.Properties.CreationNodeMask = 1;
+		heapDesc.Properties.VisibleNodeMask = 1;
+		heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+		if (!SUCCEEDED(device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heaps[placement.heap]))))
+		{
+			OutputDebugStringA("ERROR: Could not create a texture heap!\n");
+			heaps[placement.heap] = nullptr;
+			allocator.Free(placement);
+			return nullptr;
+		}
+		heaps[placement.heap]->SetName(L"Texture Heap");
+	}
+
+	ID3D12Resource* texture = nullptr;
+	if (!SUCCEEDED(device->CreatePlacedResource(heaps[placement.heap], placement.offset, &placed, initialState, nullptr, IID_PPV_ARGS(&texture))))
+	{
+		OutputDebugStringA("ERROR: Could not create the placed texture!\n");
+		Free(placement);
+		return nullptr;
+	}
+	return texture;
+}
+
+void TextureHeaps::Free(const HeapPlacement& placement)
+{
+	allocator.Free(placement);
+
+	//a heap that was made for one big texture goes with it
+	if (placement.heap < heaps.size() && heaps[placement.heap] != nullptr && allocator.GetHeapSize(placement.heap) == 0)
+	{
+		heaps[placement.heap]->Release();
+		heaps[placement.heap] = nullptr;
+	}
+}
+
+void TextureHeaps::PrintStats()
+{
+	for (unsigned int i = 0; i < allocator.GetNrOfHeaps(); i++)
+	{
+		HeapStats stats = allocator.GetHeapStats(i);
+		if (stats.size == 0)
+		{
+			continue;
+		}
+
+		std::cout << "Texture heap " << i << ": " << stats.nrOfResources << " textures using " << stats.requested / (1024.0 * 1024.0) << "/"
+			<< stats.size / (1024.0 * 1024.0) << " MB, " << (stats.allocated - stats.requested) / 1024 << " KB lost to alignment, "
+			<< stats.pageSlack / 1024 << " KB free in small texture pages, largest free block " << stats.largestFreeBlock / (1024.0 * 1024.0)
+			<< " MB, fragmentation " << stats.fragmentation << std::endl;
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <d3d12.h>
+#include <vector>
+#include "heapAllocator.h"
+
+// Places the textures in a few big default heaps instead of creating every texture as a committed
+// resource with a heap of its own. Textures whose most detailed mip fits into 64KB are placed with
+// 4KB alignment when the device allows it. Used from the thread that loads the assets.
+class TextureHeaps
+{
+public:
+	TextureHeaps();
+	// the textures have to be released first
+	~TextureHeaps();
+
+	void Create(ID3D12Device5* device, UINT64 heapSize);
+
+	// a texture placed in one of the heaps, nullptr if it could not be created. The placement
+	// gives the memory back in Free.
+	ID3D12Resource* CreateTexture(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState, HeapPlacement& placement);
+	// after the texture is released and the gpu is done with it
+	void Free(const HeapPlacement& placement);
+
+	// occupancy and waste of every heap
+	void PrintStats();
+
+private:
+	TextureHeaps(const TextureHeaps&) = delete;
+	TextureHeaps& operator=(const TextureHeaps&) = delete;
+
+	ID3D12Device5* device;
+	HeapAllocator allocator;
+	// one per heap of the allocator, nullptr until something is placed in it
+	std::vector<ID3D12Heap*> heaps;
+};
@@ -0,0 +1,140 @@
+#include "threadPool.h"
+
+thread_local ThreadPool* ThreadPool::currentPool = nullptr;
+thread_local unsigned int ThreadPool::currentWorker = 0;
+
+ThreadPool::ThreadPool(unsigned int nrOfThreads)
+{
+	if (nrOfThreads == 0)
+	{
+		nrOfThreads = std::thread::hardware_concurrency();
+		if (nrOfThreads == 0)
+		{
+			nrOfThreads = 1;
+		}
+	}
+
+	this->pendingJobs = 0;
+	this->nextQueue = 0;
+	this->stop = false;
+
+	for (unsigned int i = 0; i < nrOfThreads; i++)
+	{
+		queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+	}
+
+	for (unsigned int i = 0; i < nrOfThreads; i++)
+	{
+		threads.push_back(std::thread(&ThreadPool::WorkerLoop, this, i));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stop = true;
+	}
+	wakeUp.notify_all();
+
+	for (size_t i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+}
+
+bool ThreadPool::RunPendingJob()
+{
+	// a worker starts with its own queue, any other thread just steals
+	unsigned int queueIndex = currentPool == this ? currentWorker : nextQueue.load() % queues.size();
+
+	std::function<void()> job;
+	if (!PopOrSteal(queueIndex, job))
+	{
+		return false;
+	}
+
+	job();
+	return true;
+}
+
+unsigned int ThreadPool::GetNrOfThreads()
+{
+	return (unsigned int)this->threads.size();
+}
+
+void ThreadPool::Push(std::function<void()> job)
+{
+	// jobs created by a job are likely to use the same data, keep them on the same worker
+	unsigned int queueIndex = currentPool == this ? currentWorker : nextQueue++ % queues.size();
+
+	// counted before the job can be seen, a thread that steals it right away would
+	// otherwise take the count below 0
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		pendingJobs++;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(queues[queueIndex]->mutex);
+		queues[queueIndex]->jobs.push_back(job);
+	}
+	wakeUp.notify_one();
+}
+
+bool ThreadPool::PopOrSteal(unsigned int queueIndex, std::function<void()>& job)
+{
+	// newest job from the own queue
+	{
+		WorkerQueue* queue = queues[queueIndex].get();
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (!queue->jobs.empty())
+		{
+			job = std::move(queue->jobs.back());
+			queue->jobs.pop_back();
+			pendingJobs--;
+			return true;
+		}
+	}
+
+	// oldest job from someone else
+	for (size_t i = 1; i < queues.size(); i++)
+	{
+		WorkerQueue* queue = queues[(queueIndex + i) % queues.size()].get();
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (!queue->jobs.empty())
+		{
+			job = std::move(queue->jobs.front());
+			queue->jobs.pop_front();
+			pendingJobs--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ThreadPool::WorkerLoop(unsigned int worker)
+{
+	currentPool = this;
+	currentWorker = worker;
+
+	while (true)
+	{
+		std::function<void()> job;
+		if (PopOrSteal(worker, job))
+		{
+			job();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wakeUp.wait(lock, [this]() { return stop || pendingJobs > 0; });
+		if (stop && pendingJobs == 0)
+		{
+			break;
+		}
+	}
+
+	currentPool = nullptr;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <functional>
+#include <future>
+#include <atomic>
+#include <memory>
+#include <chrono>
+
+// Work stealing thread pool. Every worker owns a queue, jobs submitted from a worker go
+// to its own queue and idle workers steal from the other queues.
+class ThreadPool
+{
+public:
+	// 0 threads means one per hardware thread
+	ThreadPool(unsigned int nrOfThreads = 0);
+	~ThreadPool();
+
+	template<class Function>
+	auto Submit(Function function) -> std::future<decltype(function())>
+	{
+		typedef decltype(function()) Result;
+
+		std::shared_ptr<std::packaged_task<Result()>> task = std::make_shared<std::packaged_task<Result()>>(function);
+		std::future<Result> future = task->get_future();
+		Push([task]() { (*task)(); });
+
+		return future;
+	}
+
+	// waits for the future and runs queued jobs on the calling thread in the meantime,
+	// so that a job can wait for other jobs without blocking a worker
+	template<class Future>
+	void Wait(Future& future)
+	{
+		while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			if (!RunPendingJob())
+			{
+				future.wait_for(std::chrono::microseconds(100));
+			}
+		}
+	}
+
+	// fork/join: calls function(first, last) for ranges of at most grainSize of the count items
+	// as jobs on the pool and returns once all of them are done. The calling thread runs the
+	// first range itself. With jobTimes the time in ms of every range is stored in it.
+	template<class Function>
+	void ParallelFor(int count, int grainSize, Function function, std::vector<double>* jobTimes = nullptr)
+	{
+		if (grainSize < 1)
+		{
+			grainSize = 1;
+		}
+		int nrOfJobs = count > 0 ? (count + grainSize - 1) / grainSize : 0;
+		if (jobTimes != nullptr)
+		{
+			jobTimes->assign(nrOfJobs, 0.0);
+		}
+		if (nrOfJobs == 0)
+		{
+			return;
+		}
+
+		auto job = [&function, count, grainSize, jobTimes](int index)
+		{
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+			int first = index * grainSize;
+			int last = count - first > grainSize ? first + grainSize : count;
+			function(first, last);
+
+			if (jobTimes != nullptr)
+			{
+				(*jobTimes)[index] = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			}
+		};
+
+		// the jobs only live until the join below, so they can refer to the locals
+		std::vector<std::future<void>> jobs;
+		for (int i = 1; i < nrOfJobs; i++)
+		{
+			jobs.push_back(Submit([&job, i]() { job(i); }));
+		}
+		job(0);
+
+		for (size_t i = 0; i < jobs.size(); i++)
+		{
+			Wait(jobs[i]);
+		}
+	}
+
+	bool RunPendingJob();
+	unsigned int GetNrOfThreads();
+
+private:
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<std::function<void()>> jobs;
+	};
+
+	void Push(std::function<void()> job);
+	bool PopOrSteal(unsigned int queueIndex, std::function<void()>& job);
+	void WorkerLoop(unsigned int worker);
+
+	std::vector<std::thread> threads;
+	std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+	std::atomic<unsigned int> pendingJobs;
+	std::atomic<unsigned int> nextQueue;
+	bool stop;
+
+	// the pool and queue of the calling thread, if it is a worker
+	static thread_local ThreadPool* currentPool;
+	static thread_local unsigned int currentWorker;
+};
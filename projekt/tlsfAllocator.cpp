@@ -0,0 +1,307 @@
+#include "tlsfAllocator.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+	// index of the lowest and the highest set bit, bits is never 0
+	unsigned int LowestBit(unsigned int bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, bits);
+		return index;
+#else
+		return __builtin_ctz(bits);
+#endif
+	}
+
+	unsigned int HighestBit(unsigned int bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse(&index, bits);
+		return index;
+#else
+		return 31 - __builtin_clz(bits);
+#endif
+	}
+}
+
+TlsfAllocator::TlsfAllocator()
+{
+	Reset(0);
+}
+
+TlsfAllocator::~TlsfAllocator()
+{
+}
+
+void TlsfAllocator::Reset(unsigned int capacity)
+{
+	this->capacity = capacity;
+	this->used = 0;
+	this->nrOfFreeBlocks = 0;
+
+	blocks.clear();
+	unusedBlocks.clear();
+	allocated.clear();
+
+	firstLevel = 0;
+	for (unsigned int fl = 0; fl < FL_COUNT; fl++)
+	{
+		secondLevel[fl] = 0;
+		for (unsigned int sl = 0; sl < SL_COUNT; sl++)
+		{
+			freeLists[fl][sl] = NONE;
+		}
+	}
+
+	if (capacity > 0)
+	{
+		unsigned int block = NewBlock();
+		blocks[block].offset = 0;
+		blocks[block].size = capacity;
+		InsertFree(block);
+	}
+}
+
+unsigned int TlsfAllocator::Allocate(unsigned int size)
+{
+	if (size == 0 || size > capacity - used)
+	{
+		return INVALID;
+	}
+
+	unsigned int fl, sl;
+	unsigned int block = NONE;
+	if (FindFreeClass(size, fl, sl))
+	{
+		block = freeLists[fl][sl];
+	}
+	else
+	{
+		// the class of the size itself is skipped by the search, one of its blocks may still be big enough
+		Mapping(size, fl, sl);
+		for (unsigned int i = freeLists[fl][sl]; i != NONE; i = blocks[i].nextFree)
+		{
+			if (blocks[i].size >= size)
+			{
+				block = i;
+				break;
+			}
+		}
+		if (block == NONE)
+		{
+			return INVALID;
+		}
+	}
+
+	RemoveFree(block);
+
+	// the allocation is taken from the start of the block, the rest stays free
+	if (blocks[block].size > size)
+	{
+		unsigned int rest = NewBlock();
+		blocks[rest].offset = blocks[block].offset + size;
+		blocks[rest].size = blocks[block].size - size;
+		blocks[rest].previous = block;
+		blocks[rest].next = blocks[block].next;
+		if (blocks[block].next != NONE)
+		{
+			blocks[blocks[block].next].previous = rest;
+		}
+		blocks[block].next = rest;
+		blocks[block].size = size;
+		InsertFree(rest);
+	}
+
+	allocated[blocks[block].offset] = block;
+	used += size;
+	return blocks[block].offset;
+}
+
+void TlsfAllocator::Free(unsigned int offset)
+{
+	std::unordered_map<unsigned int, unsigned int>::iterator found = allocated.find(offset);
+	if (found == allocated.end())
+	{
+		return;
+	}
+
+	unsigned int block = found->second;
+	allocated.erase(found);
+	used -= blocks[block].size;
+
+	// merge with the free block after the range and with the one before it
+	unsigned int next = blocks[block].next;
+	if (next != NONE && blocks[next].free)
+	{
+		RemoveFree(next);
+		blocks[block].size += blocks[next].size;
+		blocks[block].next = blocks[next].next;
+		if (blocks[next].next != NONE)
+		{
+			blocks[blocks[next].next].previous = block;
+		}
+		unusedBlocks.push_back(next);
+	}
+
+	unsigned int previous = blocks[block].previous;
+	if (previous != NONE && blocks[previous].free)
+	{
+		RemoveFree(previous);
+		blocks[previous].size += blocks[block].size;
+		blocks[previous].next = blocks[block].next;
+		if (blocks[block].next != NONE)
+		{
+			blocks[blocks[block].next].previous = previous;
+		}
+		unusedBlocks.push_back(block);
+		block = previous;
+	}
+
+	InsertFree(block);
+}
+
+TlsfAllocatorStats TlsfAllocator::GetStats()
+{
+	TlsfAllocatorStats stats;
+	stats.capacity = capacity;
+	stats.used = used;
+	stats.nrOfAllocations = (unsigned int)allocated.size();
+	stats.nrOfFreeBlocks = nrOfFreeBlocks;
+	stats.largestFreeBlock = 0;
+
+	// the largest block is in the highest class that is not empty
+	if (firstLevel != 0)
+	{
+		unsigned int fl = HighestBit(firstLevel);
+		unsigned int sl = HighestBit(secondLevel[fl]);
+		for (unsigned int i = freeLists[fl][sl]; i != NONE; i = blocks[i].nextFree)
+		{
+			stats.largestFreeBlock = blocks[i].size > stats.largestFreeBlock ? blocks[i].size : stats.largestFreeBlock;
+		}
+	}
+
+	unsigned int free = capacity - used;
+	stats.fragmentation = free > 0 ? 1.0 - (double)stats.largestFreeBlock / free : 0.0;
+	return stats;
+}
+
+void TlsfAllocator::Mapping(unsigned int size, unsigned int& fl, unsigned int& sl)
+{
+	if (size < SL_COUNT)
+	{
+		fl = 0;
+		sl = size;
+		return;
+	}
+
+	unsigned int highest = HighestBit(size);
+	fl = highest - SL_BITS + 1;
+	sl = (size >> (highest - SL_BITS)) - SL_COUNT;
+}
+
+bool TlsfAllocator::FindFreeClass(unsigned int size, unsigned int& fl, unsigned int& sl)
+{
+	// round up to the next class, then every block of that class and the ones above it fits
+	unsigned long long rounded = size;
+	if (size >= SL_COUNT)
+	{
+		rounded += (1ull << (HighestBit(size) - SL_BITS)) - 1;
+	}
+	if (rounded > 0xFFFFFFFFull)
+	{
+		return false;
+	}
+	Mapping((unsigned int)rounded, fl, sl);
+
+	unsigned int slBits = secondLevel[fl] & (~0u << sl);
+	if (slBits == 0)
+	{
+		unsigned int flBits = firstLevel & (~0u << (fl + 1));
+		if (flBits == 0)
+		{
+			return false;
+		}
+		fl = LowestBit(flBits);
+		slBits = secondLevel[fl];
+	}
+	sl = LowestBit(slBits);
+	return true;
+}
+
+unsigned int TlsfAllocator::NewBlock()
+{
+	unsigned int block;
+	if (!unusedBlocks.empty())
+	{
+		block = unusedBlocks.back();
+		unusedBlocks.pop_back();
+	}
+	else
+	{
+		block = (unsigned int)blocks.size();
+		blocks.push_back(Block());
+	}
+
+	blocks[block].previous = NONE;
+	blocks[block].next = NONE;
+	blocks[block].previousFree = NONE;
+	blocks[block].nextFree = NONE;
+	blocks[block].free = false;
+	return block;
+}
+
+void TlsfAllocator::InsertFree(unsigned int block)
+{
+	unsigned int fl, sl;
+	Mapping(blocks[block].size, fl, sl);
+
+	blocks[block].free = true;
+	blocks[block].previousFree = NONE;
+	blocks[block].nextFree = freeLists[fl][sl];
+	if (freeLists[fl][sl] != NONE)
+	{
+		blocks[freeLists[fl][sl]].previousFree = block;
+	}
+	freeLists[fl][sl] = block;
+
+	firstLevel |= 1u << fl;
+	secondLevel[fl] |= 1u << sl;
+	nrOfFreeBlocks++;
+}
+
+void TlsfAllocator::RemoveFree(unsigned int block)
+{
+	unsigned int fl, sl;
+	Mapping(blocks[block].size, fl, sl);
+
+	Block& removed = blocks[block];
+	if (removed.previousFree != NONE)
+	{
+		blocks[removed.previousFree].nextFree = removed.nextFree;
+	}
+	else
+	{
+		freeLists[fl][sl] = removed.nextFree;
+	}
+	if (removed.nextFree != NONE)
+	{
+		blocks[removed.nextFree].previousFree = removed.previousFree;
+	}
+	removed.free = false;
+
+	// the bits say which lists have blocks
+	if (freeLists[fl][sl] == NONE)
+	{
+		secondLevel[fl] &= ~(1u << sl);
+		if (secondLevel[fl] == 0)
+		{
+			firstLevel &= ~(1u << fl);
+		}
+	}
+	nrOfFreeBlocks--;
+}
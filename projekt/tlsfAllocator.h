@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+
+// how full the allocator is and how its free space is split up
+struct TlsfAllocatorStats
+{
+	unsigned int capacity;
+	unsigned int used;
+	unsigned int nrOfAllocations;
+	unsigned int nrOfFreeBlocks;
+	unsigned int largestFreeBlock;
+	// 0 when all free space is one block, close to 1 when it is split into many small ones
+	double fragmentation;
+};
+
+// Two-level segregated fit allocator for ranges of 0..capacity-1, e.g. vertices of a shared vertex
+// buffer. The free blocks are kept in lists by size class, the first level is the highest bit of
+// the size and the second level splits it into SL_COUNT classes. Two bitmaps find a big enough
+// class without walking any list, so allocating and freeing take the same time however full it is.
+// A freed range is merged with the free ranges next to it. Knows nothing about d3d.
+class TlsfAllocator
+{
+public:
+	static const unsigned int INVALID = 0xFFFFFFFF;
+
+	TlsfAllocator();
+	~TlsfAllocator();
+
+	// forgets all allocations
+	void Reset(unsigned int capacity);
+
+	// returns the first element of size elements in a row, INVALID if there is no such range
+	unsigned int Allocate(unsigned int size);
+	// the first element of an earlier allocation
+	void Free(unsigned int offset);
+
+	TlsfAllocatorStats GetStats();
+
+private:
+	static const unsigned int SL_BITS = 4;
+	static const unsigned int SL_COUNT = 1 << SL_BITS;
+	// sizes below SL_COUNT are class 0, the largest 32-bit sizes end up in 31 - SL_BITS + 1
+	static const unsigned int FL_COUNT = 32 - SL_BITS + 1;
+	static const unsigned int NONE = 0xFFFFFFFF;
+
+	struct Block
+	{
+		unsigned int offset;
+		unsigned int size;
+		// the blocks right before and after this one in the range
+		unsigned int previous;
+		unsigned int next;
+		// the other free blocks of the same size class
+		unsigned int previousFree;
+		unsigned int nextFree;
+		bool free;
+	};
+
+	static void Mapping(unsigned int size, unsigned int& fl, unsigned int& sl);
+	// the class of the smallest free block that is at least size, false if there is none
+	bool FindFreeClass(unsigned int size, unsigned int& fl, unsigned int& sl);
+
+	unsigned int NewBlock();
+	void InsertFree(unsigned int block);
+	void RemoveFree(unsigned int block);
+
+	std::vector<Block> blocks;
+	std::vector<unsigned int> unusedBlocks;
+	// first element -> block of the allocations
+	std::unordered_map<unsigned int, unsigned int> allocated;
+
+	unsigned int firstLevel;
+	unsigned int secondLevel[FL_COUNT];
+	unsigned int freeLists[FL_COUNT][SL_COUNT];
+
+	unsigned int capacity;
+	unsigned int used;
+	unsigned int nrOfFreeBlocks;
+};
@@ -0,0 +1,247 @@
+#include "transformSystem.h"
+#include <string.h>
+#include <atomic>
+#include <float.h>
+#include <math.h>
+
+TransformSystem::TransformSystem()
+{
+	viewProjValid = false;
+	nrOfUpdated = 0;
+	nrOfVisible = 0;
+}
+
+TransformSystem::~TransformSystem()
+{
+}
+
+int TransformSystem::Add(XMFLOAT4 position, const float* scale)
+{
+	positions.push_back(XMFLOAT4A(position.x, position.y, position.z, 1.0f));
+	scales.push_back(XMFLOAT4A(scale[0], scale[1], scale[2], 1.0f));
+
+	XMFLOAT4A identity;
+	XMStoreFloat4A(&identity, XMQuaternionIdentity());
+	rotations.push_back(identity);
+
+	worlds.push_back(XMFLOAT4X4A());
+	wvps.push_back(XMFLOAT4X4A());
+	dirty.push_back(1);
+
+	localBounds.push_back(XMFLOAT4A(0.0f, 0.0f, 0.0f, FLT_MAX));
+	if (boundsX.size() < positions.size())
+	{
+		// the sphere of the new object is written by the next update
+		size_t padded = boundsX.size() + CULL_WIDTH;
+		boundsX.resize(padded, 0.0f);
+		boundsY.resize(padded, 0.0f);
+		boundsZ.resize(padded, 0.0f);
+		boundsRadius.resize(padded, -FLT_MAX);
+		visible.resize(padded, 0);
+	}
+
+	return (int)positions.size() - 1;
+}
+
+void TransformSystem::SetPosition(int index, XMFLOAT4 position)
+{
+	positions[index] = XMFLOAT4A(position.x, position.y, position.z, 1.0f);
+	dirty[index] = 1;
+}
+
+void TransformSystem::SetScale(int index, const float* scale)
+{
+	scales[index] = XMFLOAT4A(scale[0], scale[1], scale[2], 1.0f);
+	dirty[index] = 1;
+}
+
+void TransformSystem::SetRotation(int index, FXMVECTOR quaternion)
+{
+	XMStoreFloat4A(&rotations[index], quaternion);
+	dirty[index] = 1;
+}
+
+void TransformSystem::Rotate(int index, FXMVECTOR quaternion)
+{
+	XMStoreFloat4A(&rotations[index], XMQuaternionMultiply(XMLoadFloat4A(&rotations[index]), quaternion));
+	dirty[index] = 1;
+}
+
+void TransformSystem::SetBounds(int index, const float* boundsMin, const float* boundsMax)
+{
+	// the sphere around the box
+	XMVECTOR boxMin = XMVectorSet(boundsMin[0], boundsMin[1], boundsMin[2], 0.0f);
+	XMVECTOR boxMax = XMVectorSet(boundsMax[0], boundsMax[1], boundsMax[2], 0.0f);
+	XMVECTOR center = XMVectorScale(XMVectorAdd(boxMin, boxMax), 0.5f);
+	float radius = XMVectorGetX(XMVector3Length(XMVectorSubtract(boxMax, center)));
+
+	XMStoreFloat4A(&localBounds[index], XMVectorSetW(center, radius));
+	dirty[index] = 1;
+}
+
+void TransformSystem::UpdateWorld(size_t index)
+{
+	// scale * rotation * translation, written out: the rows of the rotation are scaled
+	// and the position is the last row
+	XMMATRIX world = XMMatrixRotationQuaternion(XMLoadFloat4A(&rotations[index]));
+	XMVECTOR scale = XMLoadFloat4A(&scales[index]);
+	world.r[0] = XMVectorMultiply(world.r[0], XMVectorSplatX(scale));
+	world.r[1] = XMVectorMultiply(world.r[1], XMVectorSplatY(scale));
+	world.r[2] = XMVectorMultiply(world.r[2], XMVectorSplatZ(scale));
+	world.r[3] = XMLoadFloat4A(&positions[index]);
+	XMStoreFloat4x4A(&worlds[index], world);
+
+	// the sphere grows with the largest scale, so it still holds the object when the scale is not uniform
+	const XMFLOAT4A& local = localBounds[index];
+	XMVECTOR center = XMVector3Transform(XMLoadFloat4A(&local), world);
+	float maxScale = fmaxf(fabsf(scales[index].x), fmaxf(fabsf(scales[index].y), fabsf(scales[index].z)));
+	boundsX[index] = XMVectorGetX(center);
+	boundsY[index] = XMVectorGetY(center);
+	boundsZ[index] = XMVectorGetZ(center);
+	boundsRadius[index] = local.w * maxScale;
+}
+
+void TransformSystem::Update(const XMFLOAT4X4& view, const XMFLOAT4X4& projection, ThreadPool* pool)
+{
+	XMMATRIX viewProjMat = XMLoadFloat4x4(&view) * XMLoadFloat4x4(&projection);
+
+	// if the camera has not moved only the dirty objects need a new wvp matrix
+	XMFLOAT4X4A newViewProj;
+	XMStoreFloat4x4A(&newViewProj, viewProjMat);
+	bool cameraMoved = !viewProjValid || memcmp(&newViewProj, &viewProj, sizeof(viewProj)) != 0;
+	viewProj = newViewProj;
+	viewProjValid = true;
+
+	// the planes of the frustum are sums of the columns of view * projection, the near plane
+	// is z >= 0 in d3d. They are normalized so the distance can be compared with the radius.
+	XMMATRIX columns = XMMatrixTranspose(viewProjMat);
+	XMStoreFloat4A(&frustum[0], XMPlaneNormalize(XMVectorAdd(columns.r[3], columns.r[0])));
+	XMStoreFloat4A(&frustum[1], XMPlaneNormalize(XMVectorSubtract(columns.r[3], columns.r[0])));
+	XMStoreFloat4A(&frustum[2], XMPlaneNormalize(XMVectorAdd(columns.r[3], columns.r[1])));
+	XMStoreFloat4A(&frustum[3], XMPlaneNormalize(XMVectorSubtract(columns.r[3], columns.r[1])));
+	XMStoreFloat4A(&frustum[4], XMPlaneNormalize(columns.r[2]));
+	XMStoreFloat4A(&frustum[5], XMPlaneNormalize(XMVectorSubtract(columns.r[3], columns.r[2])));
+
+	if (pool == nullptr)
+	{
+		nrOfUpdated = UpdateRange(0, positions.size(), viewProjMat, cameraMoved);
+		nrOfVisible = CullRange(0, positions.size());
+		jobTimes.clear();
+		return;
+	}
+
+	// every job writes to its own part of the arrays, TRANSFORMS_PER_JOB is a multiple of CULL_WIDTH
+	std::atomic<int> updated(0);
+	std::atomic<int> visibleObjects(0);
+	pool->ParallelFor((int)positions.size(), TRANSFORMS_PER_JOB, [&](int first, int last)
+	{
+		updated += UpdateRange(first, last, viewProjMat, cameraMoved);
+		visibleObjects += CullRange(first, last);
+	}, &jobTimes);
+	nrOfUpdated = updated;
+	nrOfVisible = visibleObjects;
+}
+
+int TransformSystem::UpdateRange(size_t first, size_t last, const XMMATRIX& viewProjMat, bool cameraMoved)
+{
+	int updated = 0;
+	for (size_t i = first; i < last; i++)
+	{
+		if (dirty[i])
+		{
+			UpdateWorld(i);
+			dirty[i] = 0;
+		}
+		else if (!cameraMoved)
+		{
+			continue;
+		}
+
+		XMMATRIX wvp = XMLoadFloat4x4A(&worlds[i]) * viewProjMat;
+		XMStoreFloat4x4A(&wvps[i], XMMatrixTranspose(wvp));
+		updated++;
+	}
+	return updated;
+}
+
+int TransformSystem::CullRange(size_t first, size_t last)
+{
+	XMVECTOR planeX[6];
+	XMVECTOR planeY[6];
+	XMVECTOR planeZ[6];
+	XMVECTOR planeW[6];
+	for (int p = 0; p < 6; p++)
+	{
+		planeX[p] = XMVectorReplicate(frustum[p].x);
+		planeY[p] = XMVectorReplicate(frustum[p].y);
+		planeZ[p] = XMVectorReplicate(frustum[p].z);
+		planeW[p] = XMVectorReplicate(frustum[p].w);
+	}
+
+	// CULL_WIDTH spheres against one plane at a time, a sphere is visible if it is not
+	// completely behind any of the planes. The padding at the end is never visible.
+	int visibleObjects = 0;
+	for (size_t i = first; i < last; i += CULL_WIDTH)
+	{
+		XMVECTOR x = XMLoadFloat4((const XMFLOAT4*)&boundsX[i]);
+		XMVECTOR y = XMLoadFloat4((const XMFLOAT4*)&boundsY[i]);
+		XMVECTOR z = XMLoadFloat4((const XMFLOAT4*)&boundsZ[i]);
+		XMVECTOR negativeRadius = XMVectorNegate(XMLoadFloat4((const XMFLOAT4*)&boundsRadius[i]));
+
+		XMVECTOR inside = XMVectorTrueInt();
+		for (int p = 0; p < 6; p++)
+		{
+			XMVECTOR distance = XMVectorMultiplyAdd(x, planeX[p], XMVectorMultiplyAdd(y, planeY[p], XMVectorMultiplyAdd(z, planeZ[p], planeW[p])));
+			inside = XMVectorAndInt(inside, XMVectorGreater(distance, negativeRadius));
+		}
+
+		XMUINT4 mask;
+		XMStoreUInt4(&mask, inside);
+		visible[i] = mask.x != 0;
+		visible[i + 1] = mask.y != 0;
+		visible[i + 2] = mask.z != 0;
+		visible[i + 3] = mask.w != 0;
+		visibleObjects += visible[i] + visible[i + 1] + visible[i + 2] + visible[i + 3];
+	}
+	return visibleObjects;
+}
+
+int TransformSystem::GetSize()
+{
+	return (int)this->positions.size();
+}
+
+XMFLOAT4* TransformSystem::GetPosition(int index)
+{
+	return &this->positions[index];
+}
+
+XMFLOAT4X4* TransformSystem::GetWorldMatrix(int index)
+{
+	return &this->worlds[index];
+}
+
+XMFLOAT4X4* TransformSystem::GetWvpMatrix(int index)
+{
+	return &this->wvps[index];
+}
+
+int TransformSystem::GetNrOfUpdated()
+{
+	return this->nrOfUpdated;
+}
+
+bool TransformSystem::IsVisible(int index)
+{
+	return this->visible[index] != 0;
+}
+
+int TransformSystem::GetNrOfVisible()
+{
+	return this->nrOfVisible;
+}
+
+const std::vector<double>& TransformSystem::GetJobTimes()
+{
+	return this->jobTimes;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <vector>
+#include <DirectXMath.h>
+#include "threadPool.h"
+
+using namespace DirectX;
+
+// Transforms of every object, stored as one array per component so the update walks
+// them in order. A world matrix is only rebuilt when the object has moved, the wvp
+// matrices when the object or the camera has moved.
+// Every update also culls the bounding spheres against the frustum, CULL_WIDTH at a time.
+class TransformSystem
+{
+public:
+	TransformSystem();
+	~TransformSystem();
+
+	// returns the index of the new transform
+	int Add(XMFLOAT4 position, const float* scale);
+
+	void SetPosition(int index, XMFLOAT4 position);
+	void SetScale(int index, const float* scale);
+	void SetRotation(int index, FXMVECTOR quaternion);
+	// adds a rotation to the current one
+	void Rotate(int index, FXMVECTOR quaternion);
+	// bounding box in object space, until it is set the object is never culled
+	void SetBounds(int index, const float* boundsMin, const float* boundsMax);
+
+	// view * projection is computed once and applied to the objects that need it.
+	// With a pool the objects are updated in parallel, TRANSFORMS_PER_JOB per job.
+	void Update(const XMFLOAT4X4& view, const XMFLOAT4X4& projection, ThreadPool* pool = nullptr);
+
+	int GetSize();
+	XMFLOAT4* GetPosition(int index);
+	XMFLOAT4X4* GetWorldMatrix(int index);
+	// transposed for the gpu
+	XMFLOAT4X4* GetWvpMatrix(int index);
+	// objects that got a new wvp matrix in the last update
+	int GetNrOfUpdated();
+	// result of the culling in the last update
+	bool IsVisible(int index);
+	int GetNrOfVisible();
+	// time in ms of every job of the last parallel update
+	const std::vector<double>& GetJobTimes();
+
+	static const int TRANSFORMS_PER_JOB = 2048;
+	static const int CULL_WIDTH = 4;
+
+private:
+	void UpdateWorld(size_t index);
+	// returns the number of wvp matrices that were updated
+	int UpdateRange(size_t first, size_t last, const XMMATRIX& viewProjMat, bool cameraMoved);
+	// returns the number of visible objects in the range, first has to be a multiple of CULL_WIDTH
+	int CullRange(size_t first, size_t last);
+
+	std::vector<XMFLOAT4A> positions;
+	std::vector<XMFLOAT4A> scales;
+	std::vector<XMFLOAT4A> rotations;	// quaternions
+	std::vector<XMFLOAT4X4A> worlds;
+	std::vector<XMFLOAT4X4A> wvps;
+	std::vector<unsigned char> dirty;
+
+	// object space bounding spheres, xyz is the center and w the radius
+	std::vector<XMFLOAT4A> localBounds;
+	// world space bounding spheres, padded to a multiple of CULL_WIDTH with spheres that are never visible
+	std::vector<float> boundsX;
+	std::vector<float> boundsY;
+	std::vector<float> boundsZ;
+	std::vector<float> boundsRadius;
+	std::vector<unsigned char> visible;
+
+	XMFLOAT4X4A viewProj;
+	bool viewProjValid;
+	XMFLOAT4A frustum[6];	// normalized planes, inside is positive
+	int nrOfUpdated;
+	int nrOfVisible;
+	std::vector<double> jobTimes;
+};
@@ -0,0 +1,87 @@
+#include "uploadRing.h"
+
+UploadRing::UploadRing()
+{
+	buffer = nullptr;
+	mapped = nullptr;
+	gpuStart = 0;
+}
+
+UploadRing::~UploadRing()
+{
+	if (buffer != nullptr)
+	{
+		buffer->Unmap(0, nullptr);
+		buffer->Release();
+	}
+}
+
+bool UploadRing::Create(ID3D12Device5* device, UINT64 capacity)
+{
+	D3D12_HEAP_PROPERTIES hp = {};
+	hp.Type = D3D12_HEAP_TYPE_UPLOAD;
+	hp.CreationNodeMask = 1;
+	hp.VisibleNodeMask = 1;
+
+	D3D12_RESOURCE_DESC rd = {};
+	rd.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	rd.Width = capacity;
+	rd.Height = 1;
+	rd.DepthOrArraySize = 1;
+	rd.MipLevels = 1;
+	rd.SampleDesc.Count = 1;
+	rd.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	if (!SUCCEEDED(device->CreateCommittedResource(
+		&hp,
+		D3D12_HEAP_FLAG_NONE,
+		&rd,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&buffer))))
+	{
+		OutputDebugStringA("ERROR: Could not create the upload ring!\n");
+		buffer = nullptr;
+		return false;
+	}
+	buffer->SetName(L"upload ring");
+
+	//mapped as long as it exists, the cpu never reads from it
+	D3D12_RANGE range = { 0, 0 };
+	if (!SUCCEEDED(buffer->Map(0, &range, (void**)&mapped)))
+	{
+		OutputDebugStringA("ERROR: Could not map the upload ring!\n");
+		buffer->Release();
+		buffer = nullptr;
+		return false;
+	}
+	gpuStart = buffer->GetGPUVirtualAddress();
+	allocator.Reset(capacity);
+
+	return true;
+}
+
+bool UploadRing::Allocate(UINT64 size, UINT64 alignment, UploadAllocation& allocation)
+{
+	UINT64 offset = allocator.Allocate(size, alignment);
+	if (offset == RingAllocator::INVALID)
+	{
+		return false;
+	}
+
+	allocation.resource = buffer;
+	allocation.offset = offset;
+	allocation.cpuAddress = mapped + offset;
+	allocation.gpuAddress = gpuStart + offset;
+	return true;
+}
+
+RingAllocator* UploadRing::GetAllocator()
+{
+	return &this->allocator;
+}
+
+RingAllocatorStats UploadRing::GetStats()
+{
+	return allocator.GetStats();
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <d3d12.h>
+#include "ringAllocator.h"
+
+// a range of the upload ring, written by the cpu and read by the gpu
+struct UploadAllocation
+{
+	ID3D12Resource* resource;
+	UINT64 offset;	// from the start of resource
+	BYTE* cpuAddress;
+	D3D12_GPU_VIRTUAL_ADDRESS gpuAddress;
+};
+
+// One persistently mapped upload heap buffer that the per frame data and the staging copies are
+// allocated from. Whatever is allocated before the frame is finished in the allocator belongs to
+// that frame and is reused once the fence value of the frame has been reached, FrameScheduler
+// finishes and retires the frames. Used from the thread that records the frames.
+class UploadRing
+{
+public:
+	// enough for constant buffers, buffer srvs and copies from a buffer
+	static const UINT64 DEFAULT_ALIGNMENT = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+
+	UploadRing();
+	~UploadRing();
+
+	bool Create(ID3D12Device5* device, UINT64 capacity);
+
+	// false if the size does not fit until older frames are retired
+	bool Allocate(UINT64 size, UINT64 alignment, UploadAllocation& allocation);
+	// the frames of the ring are finished and retired through it
+	RingAllocator* GetAllocator();
+	RingAllocatorStats GetStats();
+
+private:
+	UploadRing(const UploadRing&) = delete;
+	UploadRing& operator=(const UploadRing&) = delete;
+
+	ID3D12Resource* buffer;
+	BYTE* mapped;
+	D3D12_GPU_VIRTUAL_ADDRESS gpuStart;
+	RingAllocator allocator;
+};
@@ -0,0 +1,314 @@
+#include "vertexCacheOptimizer.h"
+#include <math.h>
+
+namespace
+{
+	// constants from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+	const unsigned int CACHE_SIZE = VertexCacheOptimizer::OPTIMIZE_CACHE_SIZE;
+	const unsigned int MAX_VALENCE_SCORES = 32;
+	const float CACHE_DECAY_POWER = 1.5f;
+	const float LAST_TRIANGLE_SCORE = 0.75f;
+	const float VALENCE_BOOST_SCALE = 2.0f;
+	const float VALENCE_BOOST_POWER = 0.5f;
+
+	struct ScoreTables
+	{
+		float cache[CACHE_SIZE];
+		float valence[MAX_VALENCE_SCORES];
+
+		ScoreTables()
+		{
+			for (unsigned int i = 0; i < CACHE_SIZE; i++)
+			{
+				// the three vertices of the last triangle get a fixed score so that the
+				// algorithm does not prefer to reuse a single edge over and over
+				if (i < 3)
+				{
+					cache[i] = LAST_TRIANGLE_SCORE;
+				}
+				else
+				{
+					const float scaler = 1.0f / (CACHE_SIZE - 3);
+					cache[i] = powf(1.0f - (i - 3) * scaler, CACHE_DECAY_POWER);
+				}
+			}
+
+			valence[0] = 0.0f;
+			for (unsigned int i = 1; i < MAX_VALENCE_SCORES; i++)
+			{
+				valence[i] = VALENCE_BOOST_SCALE * powf((float)i, -VALENCE_BOOST_POWER);
+			}
+		}
+	};
+
+	float VertexScore(const ScoreTables& tables, int cachePosition, unsigned int activeTriangles)
+	{
+		// vertices without triangles left should never be picked
+		if (activeTriangles == 0)
+		{
+			return -1.0f;
+		}
+
+		float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+
+		// boost vertices with few triangles left so that lone triangles are not left behind
+		if (activeTriangles < MAX_VALENCE_SCORES)
+		{
+			score += tables.valence[activeTriangles];
+		}
+		else
+		{
+			score += VALENCE_BOOST_SCALE * powf((float)activeTriangles, -VALENCE_BOOST_POWER);
+		}
+
+		return score;
+	}
+}
+
+void VertexCacheOptimizer::Optimize(IndexedMesh& mesh)
+{
+	OptimizeTriangleOrder(mesh.indices, mesh.GetNrOfVertices());
+	OptimizeVertexFetch(mesh);
+}
+
+void VertexCacheOptimizer::OptimizeTriangleOrder(std::vector<unsigned int>& indices, size_t nrOfVertices)
+{
+	static const ScoreTables tables;
+
+	const size_t nrOfTriangles = indices.size() / 3;
+	if (nrOfTriangles == 0)
+	{
+		return;
+	}
+
+	// build the vertex to triangle adjacency, the active triangles of vertex v are
+	// stored in triangleList[triangleOffset[v]] to triangleList[triangleOffset[v] + activeTriangles[v] - 1]
+	std::vector<unsigned int> activeTriangles(nrOfVertices, 0);
+	for (size_t i = 0; i < nrOfTriangles * 3; i++)
+	{
+		activeTriangles[indices[i]]++;
+	}
+
+	std::vector<unsigned int> triangleOffset(nrOfVertices, 0);
+	for (size_t v = 1; v < nrOfVertices; v++)
+	{
+		triangleOffset[v] = triangleOffset[v - 1] + activeTriangles[v - 1];
+	}
+
+	std::vector<unsigned int> triangleList(nrOfTriangles * 3);
+	std::vector<unsigned int> fillOffset = triangleOffset;
+	for (size_t t = 0; t < nrOfTriangles; t++)
+	{
+		for (size_t k = 0; k < 3; k++)
+		{
+			triangleList[fillOffset[indices[t * 3 + k]]++] = (unsigned int)t;
+		}
+	}
+
+	std::vector<int> cachePosition(nrOfVertices, -1);
+	std::vector<float> vertexScore(nrOfVertices);
+	for (size_t v = 0; v < nrOfVertices; v++)
+	{
+		vertexScore[v] = VertexScore(tables, -1, activeTriangles[v]);
+	}
+
+	std::vector<float> triangleScore(nrOfTriangles);
+	std::vector<bool> triangleAdded(nrOfTriangles, false);
+	int bestTriangle = 0;
+	for (size_t t = 0; t < nrOfTriangles; t++)
+	{
+		triangleScore[t] = vertexScore[indices[t * 3 + 0]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+		if (triangleScore[t] > triangleScore[bestTriangle])
+		{
+			bestTriangle = (int)t;
+		}
+	}
+
+	// the cache holds three extra entries for the vertices that are pushed out by a new triangle
+	std::vector<unsigned int> cache;
+	std::vector<unsigned int> newCache;
+	cache.reserve(CACHE_SIZE + 3);
+	newCache.reserve(CACHE_SIZE + 3);
+
+	std::vector<unsigned int> output(nrOfTriangles * 3);
+	size_t scanPosition = 0;
+
+	for (size_t n = 0; n < nrOfTriangles; n++)
+	{
+		// nothing in the cache has triangles left, continue with the next unused triangle
+		if (bestTriangle < 0)
+		{
+			while (triangleAdded[scanPosition])
+			{
+				scanPosition++;
+			}
+			bestTriangle = (int)scanPosition;
+		}
+
+		const unsigned int* triangle = &indices[bestTriangle * 3];
+		triangleAdded[bestTriangle] = true;
+		output[n * 3 + 0] = triangle[0];
+		output[n * 3 + 1] = triangle[1];
+		output[n * 3 + 2] = triangle[2];
+
+		// remove the triangle from the active lists of its vertices
+		for (size_t k = 0; k < 3; k++)
+		{
+			const unsigned int v = triangle[k];
+			unsigned int* list = &triangleList[triangleOffset[v]];
+			const unsigned int count = activeTriangles[v];
+			for (unsigned int i = 0; i < count; i++)
+			{
+				if (list[i] == (unsigned int)bestTriangle)
+				{
+					list[i] = list[count - 1];
+					break;
+				}
+			}
+			activeTriangles[v]--;
+		}
+
+		// the new triangle goes to the front of the cache, followed by the old entries
+		newCache.clear();
+		for (size_t k = 0; k < 3; k++)
+		{
+			bool found = false;
+			for (size_t i = 0; i < newCache.size(); i++)
+			{
+				found = found || newCache[i] == triangle[k];
+			}
+			if (!found)
+			{
+				newCache.push_back(triangle[k]);
+			}
+		}
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			const unsigned int v = cache[i];
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+			{
+				newCache.push_back(v);
+			}
+		}
+
+		// update the scores of everything that moved, including what fell out of the cache
+		for (size_t i = 0; i < newCache.size(); i++)
+		{
+			const unsigned int v = newCache[i];
+			cachePosition[v] = i < CACHE_SIZE ? (int)i : -1;
+
+			const float score = VertexScore(tables, cachePosition[v], activeTriangles[v]);
+			const float delta = score - vertexScore[v];
+			vertexScore[v] = score;
+
+			const unsigned int* list = &triangleList[triangleOffset[v]];
+			for (unsigned int j = 0; j < activeTriangles[v]; j++)
+			{
+				triangleScore[list[j]] += delta;
+			}
+		}
+
+		if (newCache.size() > CACHE_SIZE)
+		{
+			newCache.resize(CACHE_SIZE);
+		}
+		cache.swap(newCache);
+
+		// the next triangle is the best one that uses a vertex in the cache
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			const unsigned int v = cache[i];
+			const unsigned int* list = &triangleList[triangleOffset[v]];
+			for (unsigned int j = 0; j < activeTriangles[v]; j++)
+			{
+				if (triangleScore[list[j]] > bestScore)
+				{
+					bestScore = triangleScore[list[j]];
+					bestTriangle = (int)list[j];
+				}
+			}
+		}
+	}
+
+	indices.swap(output);
+}
+
+void VertexCacheOptimizer::OptimizeVertexFetch(IndexedMesh& mesh)
+{
+	const size_t nrOfVertices = mesh.GetNrOfVertices();
+	const unsigned int UNUSED = 0xFFFFFFFF;
+
+	// give every vertex a new position in the order it is first used
+	std::vector<unsigned int> remap(nrOfVertices, UNUSED);
+	unsigned int nextVertex = 0;
+	for (size_t i = 0; i < mesh.indices.size(); i++)
+	{
+		unsigned int& newIndex = remap[mesh.indices[i]];
+		if (newIndex == UNUSED)
+		{
+			newIndex = nextVertex++;
+		}
+		mesh.indices[i] = newIndex;
+	}
+
+	// vertices that no triangle uses are dropped
+	std::vector<float> positions(nextVertex * 3);
+	std::vector<float> uvs(nextVertex * 2);
+	std::vector<float> normals(nextVertex * 3);
+	for (size_t v = 0; v < nrOfVertices; v++)
+	{
+		const unsigned int n = remap[v];
+		if (n == UNUSED)
+		{
+			continue;
+		}
+
+		positions[n * 3 + 0] = mesh.positions[v * 3 + 0];
+		positions[n * 3 + 1] = mesh.positions[v * 3 + 1];
+		positions[n * 3 + 2] = mesh.positions[v * 3 + 2];
+		uvs[n * 2 + 0] = mesh.uvs[v * 2 + 0];
+		uvs[n * 2 + 1] = mesh.uvs[v * 2 + 1];
+		normals[n * 3 + 0] = mesh.normals[v * 3 + 0];
+		normals[n * 3 + 1] = mesh.normals[v * 3 + 1];
+		normals[n * 3 + 2] = mesh.normals[v * 3 + 2];
+	}
+
+	mesh.positions.swap(positions);
+	mesh.uvs.swap(uvs);
+	mesh.normals.swap(normals);
+}
+
+VertexCacheStats VertexCacheOptimizer::SimulateFifoCache(const std::vector<unsigned int>& indices, size_t nrOfVertices, unsigned int cacheSize)
+{
+	VertexCacheStats stats = {};
+
+	// a vertex is in the cache if fewer than cacheSize misses happened since it was added
+	std::vector<size_t> addedAt(nrOfVertices, 0);
+	std::vector<bool> referenced(nrOfVertices, false);
+	size_t time = (size_t)cacheSize + 1;
+	size_t uniqueVertices = 0;
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		const unsigned int v = indices[i];
+		if (time - addedAt[v] > cacheSize)
+		{
+			addedAt[v] = time;
+			time++;
+			stats.transformedVertices++;
+		}
+		if (!referenced[v])
+		{
+			referenced[v] = true;
+			uniqueVertices++;
+		}
+	}
+
+	const size_t nrOfTriangles = indices.size() / 3;
+	stats.acmr = nrOfTriangles > 0 ? (double)stats.transformedVertices / nrOfTriangles : 0.0;
+	stats.atvr = uniqueVertices > 0 ? (double)stats.transformedVertices / uniqueVertices : 0.0;
+
+	return stats;
+}
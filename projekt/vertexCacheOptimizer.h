@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+#include <stddef.h>
+#include "meshBuilder.h"
+
+// result of running an index list through a simulated post-transform cache
+struct VertexCacheStats
+{
+	size_t transformedVertices;	// cache misses, i.e. vertex shader invocations
+	double acmr;				// average cache miss ratio, misses per triangle
+	double atvr;				// average transform to vertex ratio, misses per unique vertex (1.0 is optimal)
+};
+
+class VertexCacheOptimizer
+{
+public:
+	// cache size that the triangle ordering is optimized for
+	static const unsigned int OPTIMIZE_CACHE_SIZE = 32;
+
+	// reorders triangles and then vertices of the mesh, see the two functions below
+	static void Optimize(IndexedMesh& mesh);
+
+	// reorders the triangles with Tom Forsyth's linear-speed algorithm so that vertices
+	// are reused while they are still in the post-transform cache
+	static void OptimizeTriangleOrder(std::vector<unsigned int>& indices, size_t nrOfVertices);
+
+	// sorts the vertex streams in the order that the indices first reference them,
+	// which makes the vertex fetches as linear as possible
+	static void OptimizeVertexFetch(IndexedMesh& mesh);
+
+	// simulates a FIFO post-transform cache of the given size
+	static VertexCacheStats SimulateFifoCache(const std::vector<unsigned int>& indices, size_t nrOfVertices, unsigned int cacheSize);
+};
@@ -0,0 +1,187 @@
+#include "wicDecoder.h"
+#include <mutex>
+
+namespace
+{
+	// one imaging factory is shared by every thread that decodes images,
+	// but COM has to be initialized on each of those threads
+	IWICImagingFactory* GetWicFactory()
+	{
+		static IWICImagingFactory* wicFactory = NULL;
+		static std::once_flag createFactory;
+		static thread_local bool comInitialized = false;
+
+		if (!comInitialized)
+		{
+			// Initialize the COM library
+			CoInitializeEx(NULL, COINIT_MULTITHREADED);
+			comInitialized = true;
+		}
+
+		std::call_once(createFactory, []()
+		{
+			// create the WIC factory
+			HRESULT hr = CoCreateInstance(
+				CLSID_WICImagingFactory,
+				NULL,
+				CLSCTX_INPROC_SERVER,
+				IID_PPV_ARGS(&wicFactory)
+			);
+			if (FAILED(hr)) OutputDebugStringA("Could not create the Wic factory!\n");
+		});
+
+		return wicFactory;
+	}
+}
+
+const char* WicDecoder::GetName() const
+{
+	return "wic";
+}
+
+bool WicDecoder::CanDecode(const unsigned char* data, size_t size) const
+{
+	// WIC finds the format itself
+	return size > 0;
+}
+
+bool WicDecoder::Decode(const unsigned char* data, size_t size, DecodedImage& image) const
+{
+	// we only need one instance of the imaging factory to create decoders and frames
+	IWICImagingFactory* wicFactory = GetWicFactory();
+	if (wicFactory == NULL) return false;
+
+	IWICStream* wicStream = NULL;
+	IWICBitmapDecoder* wicDecoder = NULL;
+	IWICBitmapFrameDecode* wicFrame = NULL;
+	IWICFormatConverter* wicConverter = NULL;
+	IWICBitmapSource* source = NULL;
+
+	// the file is already in memory, so the decoder reads it from there
+	HRESULT hr = wicFactory->CreateStream(&wicStream);
+	if (SUCCEEDED(hr)) hr = wicStream->InitializeFromMemory((BYTE*)data, (DWORD)size);
+	if (SUCCEEDED(hr)) hr = wicFactory->CreateDecoderFromStream(wicStream, NULL, WICDecodeMetadataCacheOnLoad, &wicDecoder);
+
+	// get image from decoder (this will decode the "frame")
+	if (SUCCEEDED(hr)) hr = wicDecoder->GetFrame(0, &wicFrame);
+
+	// get wic pixel format of image
+	WICPixelFormatGUID pixelFormat = GUID_WICPixelFormatDontCare;
+	if (SUCCEEDED(hr)) hr = wicFrame->GetPixelFormat(&pixelFormat);
+
+	// get size of image
+	UINT textureWidth = 0, textureHeight = 0;
+	if (SUCCEEDED(hr)) hr = wicFrame->GetSize(&textureWidth, &textureHeight);
+
+	// formats without a dxgi format and without a dxgi compatible format to convert to are not supported
+	if (SUCCEEDED(hr) && GetDXGIFormatFromWICFormat(pixelFormat) == DXGI_FORMAT_UNKNOWN &&
+		GetConvertToWICFormat(pixelFormat) == GUID_WICPixelFormatDontCare)
+	{
+		OutputDebugStringA("No compatible dxgi format found!\n");
+		hr = E_FAIL;
+	}
+
+	// every image ends up as 8-bit RGBA, the same as the portable decoders produce
+	if (SUCCEEDED(hr) && pixelFormat == GUID_WICPixelFormat32bppRGBA)
+	{
+		source = wicFrame;
+	}
+	else if (SUCCEEDED(hr))
+	{
+		hr = wicFactory->CreateFormatConverter(&wicConverter);
+
+		// make sure we can convert to the dxgi compatible format
+		BOOL canConvert = FALSE;
+		if (SUCCEEDED(hr)) hr = wicConverter->CanConvert(pixelFormat, GUID_WICPixelFormat32bppRGBA, &canConvert);
+		if (SUCCEEDED(hr) && !canConvert) hr = E_FAIL;
+
+		// do the conversion (wicConverter will contain the converted image)
+		if (SUCCEEDED(hr)) hr = wicConverter->Initialize(wicFrame, GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeErrorDiffusion, 0, 0, WICBitmapPaletteTypeCustom);
+		source = wicConverter;
+	}
+
+	if (SUCCEEDED(hr))
+	{
+		image.width = textureWidth;
+		image.height = textureHeight;
+		image.pixels.resize(image.GetRowPitch() * textureHeight);
+		hr = source->CopyPixels(0, (UINT)image.GetRowPitch(), (UINT)image.pixels.size(), image.pixels.data());
+	}
+
+	if (wicConverter != NULL) wicConverter->Release();
+	if (wicFrame != NULL) wicFrame->Release();
+	if (wicDecoder != NULL) wicDecoder->Release();
+	if (wicStream != NULL) wicStream->Release();
+
+	return SUCCEEDED(hr);
+}
+
+DXGI_FORMAT WicDecoder::GetDXGIFormatFromWICFormat(WICPixelFormatGUID& wicFormatGUID)
+{
+	if (wicFormatGUID == GUID_WICPixelFormat128bppRGBAFloat) return DXGI_FORMAT_R32G32B32A32_FLOAT;
+	else if (wicFormatGUID == GUID_WICPixelFormat64bppRGBAHalf) return DXGI_FORMAT_R16G16B16A16_FLOAT;
+	else if (wicFormatGUID == GUID_WICPixelFormat64bppRGBA) return DXGI_FORMAT_R16G16B16A16_UNORM;
+	else if (wicFormatGUID == GUID_WICPixelFormat32bppRGBA) return DXGI_FORMAT_R8G8B8A8_UNORM;
+	else if (wicFormatGUID == GUID_WICPixelFormat32bppBGRA) return DXGI_FORMAT_B8G8R8A8_UNORM;
+	else if (wicFormatGUID == GUID_WICPixelFormat32bppBGR) return DXGI_FORMAT_B8G8R8X8_UNORM;
+	else if (wicFormatGUID == GUID_WICPixelFormat32bppRGBA1010102XR) return DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM;
+
+	else if (wicFormatGUID == GUID_WICPixelFormat32bppRGBA1010102) return DXGI_FORMAT_R10G10B10A2_UNORM;
+	else if (wicFormatGUID == GUID_WICPixelFormat16bppBGRA5551) return DXGI_FORMAT_B5G5R5A1_UNORM;
+	else if (wicFormatGUID == GUID_WICPixelFormat16bppBGR565) return DXGI_FORMAT_B5G6R5_UNORM;
+	else if (wicFormatGUID == GUID_WICPixelFormat32bppGrayFloat) return DXGI_FORMAT_R32_FLOAT;
+	else if (wicFormatGUID == GUID_WICPixelFormat16bppGrayHalf) return DXGI_FORMAT_R16_FLOAT;
+	else if (wicFormatGUID == GUID_WICPixelFormat16bppGray) return DXGI_FORMAT_R16_UNORM;
+	else if (wicFormatGUID == GUID_WICPixelFormat8bppGray) return DXGI_FORMAT_R8_UNORM;
+	else if (wicFormatGUID == GUID_WICPixelFormat8bppAlpha) return DXGI_FORMAT_A8_UNORM;
+
+	else return DXGI_FORMAT_UNKNOWN;
+}
+
+WICPixelFormatGUID WicDecoder::GetConvertToWICFormat(WICPixelFormatGUID& wicFormatGUID)
+{
+	if (wicFormatGUID == GUID_WICPixelFormatBlackWhite) return GUID_WICPixelFormat8bppGray;
+	else if (wicFormatGUID == GUID_WICPixelFormat1bppIndexed) return GUID_WICPixelFormat32bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat2bppIndexed) return GUID_WICPixelFormat32bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat4bppIndexed) return GUID_WICPixelFormat32bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat8bppIndexed) return GUID_WICPixelFormat32bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat2bppGray) return GUID_WICPixelFormat8bppGray;
+	else if (wicFormatGUID == GUID_WICPixelFormat4bppGray) return GUID_WICPixelFormat8bppGray;
+	else if (wicFormatGUID == GUID_WICPixelFormat16bppGrayFixedPoint) return GUID_WICPixelFormat16bppGrayHalf;
+	else if (wicFormatGUID == GUID_WICPixelFormat32bppGrayFixedPoint) return GUID_WICPixelFormat32bppGrayFloat;
+	else if (wicFormatGUID == GUID_WICPixelFormat16bppBGR555) return GUID_WICPixelFormat16bppBGRA5551;
+	else if (wicFormatGUID == GUID_WICPixelFormat32bppBGR101010) return GUID_WICPixelFormat32bppRGBA1010102;
+	else if (wicFormatGUID == GUID_WICPixelFormat24bppBGR) return GUID_WICPixelFormat32bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat24bppRGB) return GUID_WICPixelFormat32bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat32bppPBGRA) return GUID_WICPixelFormat32bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat32bppPRGBA) return GUID_WICPixelFormat32bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat48bppRGB) return GUID_WICPixelFormat64bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat48bppBGR) return GUID_WICPixelFormat64bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat64bppBGRA) return GUID_WICPixelFormat64bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat64bppPRGBA) return GUID_WICPixelFormat64bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat64bppPBGRA) return GUID_WICPixelFormat64bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat48bppRGBFixedPoint) return GUID_WICPixelFormat64bppRGBAHalf;
+	else if (wicFormatGUID == GUID_WICPixelFormat48bppBGRFixedPoint) return GUID_WICPixelFormat64bppRGBAHalf;
+	else if (wicFormatGUID == GUID_WICPixelFormat64bppRGBAFixedPoint) return GUID_WICPixelFormat64bppRGBAHalf;
+	else if (wicFormatGUID == GUID_WICPixelFormat64bppBGRAFixedPoint) return GUID_WICPixelFormat64bppRGBAHalf;
+	else if (wicFormatGUID == GUID_WICPixelFormat64bppRGBFixedPoint) return GUID_WICPixelFormat64bppRGBAHalf;
+	else if (wicFormatGUID == GUID_WICPixelFormat64bppRGBHalf) return GUID_WICPixelFormat64bppRGBAHalf;
+	else if (wicFormatGUID == GUID_WICPixelFormat48bppRGBHalf) return GUID_WICPixelFormat64bppRGBAHalf;
+	else if (wicFormatGUID == GUID_WICPixelFormat128bppPRGBAFloat) return GUID_WICPixelFormat128bppRGBAFloat;
+	else if (wicFormatGUID == GUID_WICPixelFormat128bppRGBFloat) return GUID_WICPixelFormat128bppRGBAFloat;
+	else if (wicFormatGUID == GUID_WICPixelFormat128bppRGBAFixedPoint) return GUID_WICPixelFormat128bppRGBAFloat;
+	else if (wicFormatGUID == GUID_WICPixelFormat128bppRGBFixedPoint) return GUID_WICPixelFormat128bppRGBAFloat;
+	else if (wicFormatGUID == GUID_WICPixelFormat32bppRGBE) return GUID_WICPixelFormat128bppRGBAFloat;
+	else if (wicFormatGUID == GUID_WICPixelFormat32bppCMYK) return GUID_WICPixelFormat32bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat64bppCMYK) return GUID_WICPixelFormat64bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat40bppCMYKAlpha) return GUID_WICPixelFormat64bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat80bppCMYKAlpha) return GUID_WICPixelFormat64bppRGBA;
+
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8) || defined(_WIN7_PLATFORM_UPDATE)
+	else if (wicFormatGUID == GUID_WICPixelFormat32bppRGB) return GUID_WICPixelFormat32bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat64bppRGB) return GUID_WICPixelFormat64bppRGBA;
+	else if (wicFormatGUID == GUID_WICPixelFormat64bppPRGBAHalf) return GUID_WICPixelFormat64bppRGBAHalf;
+#endif
+
+	else return GUID_WICPixelFormatDontCare;
+}
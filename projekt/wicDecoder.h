@@ -0,0 +1,17 @@
+#pragma once
+#include "imageDecoder.h"
+#include <d3d12.h>
+#include <wincodec.h>
+
+// Decodes every format that WIC can read, the fallback for files the portable decoders
+// can not decode. Images are converted to 8-bit RGBA like the other decoders.
+class WicDecoder : public ImageDecoder
+{
+public:
+	const char* GetName() const;
+	bool CanDecode(const unsigned char* data, size_t size) const;
+	bool Decode(const unsigned char* data, size_t size, DecodedImage& image) const;
+
+	static DXGI_FORMAT GetDXGIFormatFromWICFormat(WICPixelFormatGUID& wicFormatGUID);
+	static WICPixelFormatGUID GetConvertToWICFormat(WICPixelFormatGUID& wicFormatGUID);
+};
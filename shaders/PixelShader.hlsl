@@ -1,21 +1,28 @@
+// TEXTURE_ARRAY is defined for objects whose animated texture is one Texture2DArray
+#ifdef TEXTURE_ARRAY
+Texture2DArray t1 : register(t0);
+#else
 Texture2D t1[] : register(t0);
+#endif
 SamplerState s1 : register(s0);
-cbuffer texInd : register(b4)
-{
-	int index;
-}
 
 struct VSOut
 {
 	float4 pos : SV_Position;
 	//float4 color : color;
 	float2 uv : uv;
+	nointerpolation uint textureIndex : textureIndex;
 };
 
 float4 main(VSOut input) : SV_TARGET0
 {
-	// texture
-	float4 col = t1[index].Sample(s1, input.uv);
+	// texture, the index is the frame of an animated texture. The instances of a draw share
+	// the texture and the frame, so the index is the same for all of them.
+#ifdef TEXTURE_ARRAY
+	float4 col = t1.Sample(s1, float3(input.uv, input.textureIndex));
+#else
+	float4 col = t1[input.textureIndex].Sample(s1, input.uv);
+#endif
 
 	return col;
 }
\ No newline at end of file
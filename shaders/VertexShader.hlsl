@@ -3,23 +3,37 @@ struct VSOut
 	float4 pos : SV_Position;
 	//float4 color : color;
 	float2 uv: uv;
+	nointerpolation uint textureIndex : textureIndex;
+};
+
+// one per instance, the same layout as InstanceData in renderer.h
+struct Instance
+{
+	float4x4 wvp;
+	uint textureIndex;
+	uint3 padding;
 };
 
 StructuredBuffer<float3> pos : register(t0);
 //StructuredBuffer<float3> col : register(t1);
 StructuredBuffer<float2> uv : register(t1);
+// starts at the first instance of the draw
+StructuredBuffer<Instance> instances : register(t2);
 
-cbuffer CBmatrix : register(b2)
+// pos and uv hold every mesh, the draw's mesh starts at baseVertex
+cbuffer DrawConstants : register(b0)
 {
-	float4x4 wvp;
-}
+	uint baseVertex;
+};
 
-VSOut main(uint vertexId : SV_VertexID)
+VSOut main(uint vertexId : SV_VertexID, uint instanceId : SV_InstanceID)
 {
 	VSOut output = (VSOut)0;
 
-	output.pos = mul(float4(pos[vertexId], 1.0), wvp);
-	output.uv = uv[vertexId];
+	Instance instance = instances[instanceId];
+	output.pos = mul(float4(pos[baseVertex + vertexId], 1.0), instance.wvp);
+	output.uv = uv[baseVertex + vertexId];
+	output.textureIndex = instance.textureIndex;
 
 	return output;
 }
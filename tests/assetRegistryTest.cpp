@@ -0,0 +1,180 @@
+#include "test.h"
+#include "assetRegistry.h"
+#include <vector>
+#include <thread>
+
+namespace
+{
+	// what the registry needs of a mesh or texture
+	class StandInAsset
+	{
+	public:
+		StandInAsset()
+		{
+			id = 0;
+			alive++;
+		}
+
+		~StandInAsset()
+		{
+			alive--;
+		}
+
+		unsigned int GetId()
+		{
+			return this->id;
+		}
+
+		void SetId(unsigned int id)
+		{
+			this->id = id;
+		}
+
+		static int alive;
+
+	private:
+		unsigned int id;
+	};
+
+	int StandInAsset::alive = 0;
+
+	// every way to write the path of a file is the same asset, until the last reference to it is
+	// dropped. The next find loads it again.
+	void TestSharedPerPath()
+	{
+		AssetRegistry<StandInAsset> registry;
+		bool created = false;
+		std::shared_ptr<StandInAsset> box = registry.Find(AssetPath::Canonical(OBJECTS_DIR "box.obj"), created);
+		CHECK(created);
+		std::shared_ptr<StandInAsset> same = registry.Find(AssetPath::Canonical(OBJECTS_DIR "../objects/./box.obj"), created);
+		CHECK(!created && same == box);
+		std::shared_ptr<StandInAsset> piedmon = registry.Find(AssetPath::Canonical(OBJECTS_DIR "piedmon.obj"), created);
+		CHECK(created && piedmon != box);
+		CHECK(registry.GetHits() == 1 && registry.GetMisses() == 2);
+
+		// a weak reference does not keep the asset
+		std::weak_ptr<StandInAsset> released = box;
+		box.reset();
+		same.reset();
+		CHECK(released.expired());
+		box = registry.Find(AssetPath::Canonical(OBJECTS_DIR "box.obj"), created);
+		CHECK(created && box != nullptr);
+		CHECK(registry.GetHits() == 1 && registry.GetMisses() == 3);
+
+		// a file that does not exist is still one asset per path
+		CHECK(AssetPath::Canonical("missing.obj") == "missing.obj");
+	}
+
+	// a mesh that fails to load is shared like any other while it is referenced, the objects of
+	// all its finds are not created. Once it is released the next find tries to load it again.
+	void TestFailedLoad()
+	{
+		AssetRegistry<StandInAsset> registry;
+		bool created = false;
+		std::shared_ptr<StandInAsset> failed = registry.Find("broken.obj", created);
+		CHECK(created);
+		CHECK(registry.Find("broken.obj", created) == failed && !created);
+
+		failed.reset();
+		CHECK(StandInAsset::alive == 0);
+		std::shared_ptr<StandInAsset> retried = registry.Find("broken.obj", created);
+		CHECK(created && registry.GetMisses() == 2);
+	}
+
+	// the live assets have different ids, the id of a released asset is given to the next new one
+	void TestIdReuse()
+	{
+		AssetRegistry<StandInAsset> registry;
+		bool created = false;
+		std::shared_ptr<StandInAsset> box = registry.Find("box.obj", created);
+		std::shared_ptr<StandInAsset> piedmon = registry.Find("piedmon.obj", created);
+		CHECK(box->GetId() == 0 && piedmon->GetId() == 1);
+
+		box.reset();
+		CHECK(StandInAsset::alive == 1 && registry.GetIds()->GetNrOfUsed() == 1);
+		std::shared_ptr<StandInAsset> sphere = registry.Find("sphere.obj", created);
+		CHECK(created && sphere->GetId() == 0);
+		CHECK(registry.GetIds()->GetEnd() == 2);
+	}
+
+	// loading and releasing assets for a long time never needs more ids than are alive at once,
+	// so they fit the 16 bits of the sort key
+	void TestIdsStaySmall()
+	{
+		AssetRegistry<StandInAsset> registry;
+		std::vector<std::shared_ptr<StandInAsset>> live;
+		bool created = false;
+		for (int i = 0; i < 100000; i++)
+		{
+			live.push_back(registry.Find("asset" + std::to_string(i), created));
+			if (live.size() > 100)
+			{
+				live.erase(live.begin() + (i * 7) % live.size());
+			}
+		}
+		CHECK(registry.GetIds()->GetEnd() == 101);
+		CHECK(registry.GetIds()->GetNrOfUsed() == live.size());
+
+		bool unique = true;
+		std::vector<bool> used(registry.GetIds()->GetEnd(), false);
+		for (size_t i = 0; i < live.size(); i++)
+		{
+			unique = unique && !used[live[i]->GetId()];
+			used[live[i]->GetId()] = true;
+		}
+		CHECK(unique);
+	}
+
+	// an asset that outlives the registry still gives its id back
+	void TestAssetOutlivesRegistry()
+	{
+		std::shared_ptr<StandInAsset> kept;
+		{
+			AssetRegistry<StandInAsset> registry;
+			bool created = false;
+			kept = registry.Find("box.obj", created);
+		}
+		CHECK(StandInAsset::alive == 1);
+		kept.reset();
+		CHECK(StandInAsset::alive == 0);
+	}
+
+	// the assets are released on whichever thread drops the last reference
+	void TestReleaseOnThreads()
+	{
+		AssetRegistry<StandInAsset> registry;
+		std::vector<std::shared_ptr<StandInAsset>> assets;
+		bool created = false;
+		for (int i = 0; i < 1000; i++)
+		{
+			assets.push_back(registry.Find("asset" + std::to_string(i), created));
+		}
+
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; t++)
+		{
+			std::vector<std::shared_ptr<StandInAsset>> part(assets.begin() + t * 250, assets.begin() + (t + 1) * 250);
+			threads.push_back(std::thread([part]() mutable
+			{
+				part.clear();
+			}));
+		}
+		assets.clear();
+		for (size_t t = 0; t < threads.size(); t++)
+		{
+			threads[t].join();
+		}
+		CHECK(registry.GetIds()->GetNrOfUsed() == 0 && StandInAsset::alive == 0);
+	}
+}
+
+int main()
+{
+	TestSharedPerPath();
+	TestFailedLoad();
+	TestIdReuse();
+	TestIdsStaySmall();
+	TestAssetOutlivesRegistry();
+	TestReleaseOnThreads();
+	return TestResult();
+}
@@ -0,0 +1,133 @@
+#include "test.h"
+#include "commandRecorder.h"
+#include <vector>
+
+namespace
+{
+	typedef RecordingCommandRecorder Recorder;
+
+	// the same state twice in a row is only passed on once
+	void TestRedundantState()
+	{
+		Recorder recorder;
+		StateFilterCommandRecorder filter(&recorder);
+		ID3D12RootSignature rootSignature;
+		ID3D12PipelineState pipelineState;
+		ID3D12DescriptorHeap heap;
+		ID3D12DescriptorHeap* heaps[] = { &heap };
+		D3D12_INDEX_BUFFER_VIEW indexBuffer = { 0x1000, 64, DXGI_FORMAT_R16_UINT };
+		UINT baseVertex = 3;
+
+		for (int i = 0; i < 2; i++)
+		{
+			filter.SetGraphicsRootSignature(&rootSignature);
+			filter.SetDescriptorHeaps(1, heaps);
+			filter.SetPipelineState(&pipelineState);
+			filter.SetGraphicsRootDescriptorTable(3, { 0x50 });
+			filter.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+			filter.SetGraphicsRootShaderResourceView(0, 0x2000);
+			filter.IASetIndexBuffer(&indexBuffer);
+			filter.SetGraphicsRoot32BitConstants(4, 1, &baseVertex, 0);
+			filter.DrawIndexedInstanced(3, 1, 0, 0, 0);
+		}
+
+		// constants and draws are always passed on
+		const StateChangeCounts& counts = filter.GetCounts();
+		CHECK(counts.pipelineStates == 1 && counts.descriptorHeaps == 1 && counts.rootShaderResourceViews == 1);
+		CHECK(counts.redundant == 7);
+		CHECK(recorder.GetCommands().size() == 9 + 2);
+		CHECK(recorder.GetCount(Recorder::RootConstants) == 2 && recorder.GetCount(Recorder::Draw) == 2);
+
+		// only the root index that changed is set
+		filter.SetGraphicsRootShaderResourceView(1, 0x2000);
+		filter.SetGraphicsRootDescriptorTable(3, { 0x60 });
+		CHECK(recorder.GetCount(Recorder::RootShaderResourceView) == 2 && recorder.GetCount(Recorder::RootDescriptorTable) == 2);
+		CHECK(counts.redundant == 7);
+
+		// another view of the same buffer is a new index buffer
+		D3D12_INDEX_BUFFER_VIEW wider = { 0x1000, 64, DXGI_FORMAT_R32_UINT };
+		filter.IASetIndexBuffer(&wider);
+		CHECK(recorder.GetCount(Recorder::IndexBuffer) == 2);
+	}
+
+	// the tables point into the heaps, new heaps make every table unknown but keep the root views
+	void TestTablesAfterHeaps()
+	{
+		Recorder recorder;
+		StateFilterCommandRecorder filter(&recorder);
+		ID3D12DescriptorHeap first;
+		ID3D12DescriptorHeap second;
+		ID3D12DescriptorHeap* firstHeaps[] = { &first };
+		ID3D12DescriptorHeap* secondHeaps[] = { &second };
+
+		filter.SetDescriptorHeaps(1, firstHeaps);
+		filter.SetGraphicsRootDescriptorTable(3, { 0x50 });
+		filter.SetGraphicsRootShaderResourceView(0, 0x2000);
+		filter.SetDescriptorHeaps(1, secondHeaps);
+		filter.SetGraphicsRootDescriptorTable(3, { 0x50 });
+		filter.SetGraphicsRootShaderResourceView(0, 0x2000);
+
+		CHECK(recorder.GetCount(Recorder::DescriptorHeaps) == 2);
+		CHECK(recorder.GetCount(Recorder::RootDescriptorTable) == 2);
+		CHECK(recorder.GetCount(Recorder::RootShaderResourceView) == 1);
+		CHECK(filter.GetCounts().descriptorHeaps == 2 && filter.GetCounts().redundant == 1);
+	}
+
+	// the root arguments are undefined after a new root signature, the pipeline state and heaps are not
+	void TestArgumentsAfterRootSignature()
+	{
+		Recorder recorder;
+		StateFilterCommandRecorder filter(&recorder);
+		ID3D12RootSignature first;
+		ID3D12RootSignature second;
+		ID3D12PipelineState pipelineState;
+		ID3D12DescriptorHeap heap;
+		ID3D12DescriptorHeap* heaps[] = { &heap };
+
+		filter.SetGraphicsRootSignature(&first);
+		filter.SetDescriptorHeaps(1, heaps);
+		filter.SetPipelineState(&pipelineState);
+		filter.SetGraphicsRootDescriptorTable(3, { 0x50 });
+		filter.SetGraphicsRootShaderResourceView(0, 0x2000);
+
+		filter.SetGraphicsRootSignature(&second);
+		filter.SetDescriptorHeaps(1, heaps);
+		filter.SetPipelineState(&pipelineState);
+		filter.SetGraphicsRootDescriptorTable(3, { 0x50 });
+		filter.SetGraphicsRootShaderResourceView(0, 0x2000);
+
+		CHECK(recorder.GetCount(Recorder::RootSignature) == 2);
+		CHECK(recorder.GetCount(Recorder::DescriptorHeaps) == 1 && recorder.GetCount(Recorder::PipelineState) == 1);
+		CHECK(recorder.GetCount(Recorder::RootDescriptorTable) == 2 && recorder.GetCount(Recorder::RootShaderResourceView) == 2);
+		CHECK(filter.GetCounts().redundant == 2);
+	}
+
+	// a new command list starts without any state
+	void TestReset()
+	{
+		Recorder recorder;
+		StateFilterCommandRecorder filter(&recorder);
+		ID3D12PipelineState pipelineState;
+
+		filter.SetPipelineState(&pipelineState);
+		filter.SetPipelineState(&pipelineState);
+		filter.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		CHECK(filter.GetCounts().pipelineStates == 1 && filter.GetCounts().redundant == 1);
+
+		filter.Reset();
+		CHECK(filter.GetCounts().pipelineStates == 0 && filter.GetCounts().redundant == 0);
+		filter.SetPipelineState(&pipelineState);
+		filter.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		CHECK(filter.GetCounts().pipelineStates == 1 && filter.GetCounts().redundant == 0);
+		CHECK(recorder.GetCount(Recorder::PipelineState) == 2 && recorder.GetCount(Recorder::PrimitiveTopology) == 2);
+	}
+}
+
+int main()
+{
+	TestRedundantState();
+	TestTablesAfterHeaps();
+	TestArgumentsAfterRootSignature();
+	TestReset();
+	return TestResult();
+}
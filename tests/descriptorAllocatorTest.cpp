@@ -0,0 +1,135 @@
+#include "test.h"
+#include "descriptorAllocator.h"
+#include <vector>
+#include <random>
+#include <chrono>
+#include <stdio.h>
+
+namespace
+{
+	const unsigned int INVALID = DescriptorAllocator::INVALID;
+
+	// the first block that is big enough is used and freed ranges merge with both neighbours
+	void TestFirstFit()
+	{
+		DescriptorAllocator allocator;
+		CHECK(allocator.Allocate(1) == INVALID);
+
+		allocator.Reset(100);
+		CHECK(allocator.Allocate(0) == INVALID);
+		CHECK(allocator.Allocate(10) == 0);
+		CHECK(allocator.Allocate(20) == 10);
+		CHECK(allocator.Allocate(70) == 30);
+		CHECK(allocator.Allocate(1) == INVALID);
+
+		allocator.Free(10, 20);
+		CHECK(allocator.Allocate(21) == INVALID);
+		CHECK(allocator.Allocate(5) == 10);
+		allocator.Free(0, 10);
+		DescriptorAllocatorStats stats = allocator.GetStats();
+		CHECK(stats.used == 75 && stats.nrOfAllocations == 2 && stats.nrOfFreeBlocks == 2 && stats.largestFreeBlock == 15);
+		CHECK(stats.fragmentation > 0.0);
+
+		allocator.Free(10, 5);
+		stats = allocator.GetStats();
+		CHECK(stats.nrOfFreeBlocks == 1 && stats.largestFreeBlock == 30 && stats.fragmentation == 0.0);
+		allocator.Free(30, 70);
+		stats = allocator.GetStats();
+		CHECK(stats.used == 0 && stats.nrOfAllocations == 0 && stats.nrOfFreeBlocks == 1 && stats.largestFreeBlock == 100);
+		CHECK(allocator.Allocate(100) == 0);
+
+		// an allocation that failed can be freed without changing anything
+		allocator.Free(INVALID, 10);
+		CHECK(allocator.GetStats().used == 100);
+	}
+
+	// the sizes of textures and animated texture arrays, allocated and freed at random. Every slot
+	// remembers its owner, so a slot that is handed out twice is found.
+	void TestRandom()
+	{
+		struct Allocation
+		{
+			unsigned int first;
+			unsigned int count;
+		};
+
+		const unsigned int capacity = 4096;
+		const int steps = 100000;
+
+		DescriptorAllocator allocator;
+		allocator.Reset(capacity);
+		std::vector<Allocation> allocations;
+		std::vector<int> owners(capacity, -1);
+		std::mt19937 random(1);
+		unsigned int usedSlots = 0;
+		int overlaps = 0;
+		int failed = 0;
+
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		for (int step = 0; step < steps; step++)
+		{
+			// mostly allocations until it is about half full, then as many frees as allocations
+			bool allocate = allocations.empty() || random() % 100 < (usedSlots < capacity / 2 ? 70u : 50u);
+			if (allocate)
+			{
+				Allocation allocation;
+				allocation.count = random() % 4 == 0 ? 1 + random() % 64 : 1;
+				allocation.first = allocator.Allocate(allocation.count);
+				if (allocation.first == INVALID)
+				{
+					// only when no free block is big enough
+					CHECK(allocator.GetStats().largestFreeBlock < allocation.count);
+					failed++;
+					continue;
+				}
+
+				CHECK(allocation.first + allocation.count <= capacity);
+				for (unsigned int i = allocation.first; i < allocation.first + allocation.count && i < capacity; i++)
+				{
+					overlaps += owners[i] != -1;
+					owners[i] = step;
+				}
+				allocations.push_back(allocation);
+				usedSlots += allocation.count;
+			}
+			else
+			{
+				size_t index = random() % allocations.size();
+				Allocation allocation = allocations[index];
+				allocations[index] = allocations.back();
+				allocations.pop_back();
+
+				for (unsigned int i = allocation.first; i < allocation.first + allocation.count; i++)
+				{
+					owners[i] = -1;
+				}
+				allocator.Free(allocation.first, allocation.count);
+				usedSlots -= allocation.count;
+			}
+		}
+		std::chrono::duration<double, std::micro> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+		DescriptorAllocatorStats stats = allocator.GetStats();
+		CHECK(overlaps == 0);
+		CHECK(stats.used == usedSlots);
+		CHECK(stats.nrOfAllocations == allocations.size());
+		printf("Descriptor allocator: %d allocations and frees in %.3f us each, %u allocations using %u/%u slots, "
+			"%u free blocks, largest %u, fragmentation %.3f, %d failed allocations\n", steps, elapsed.count() / steps,
+			stats.nrOfAllocations, stats.used, stats.capacity, stats.nrOfFreeBlocks, stats.largestFreeBlock, stats.fragmentation, failed);
+
+		// everything freed has to be one block again
+		for (size_t i = 0; i < allocations.size(); i++)
+		{
+			allocator.Free(allocations[i].first, allocations[i].count);
+		}
+		stats = allocator.GetStats();
+		CHECK(stats.used == 0 && stats.nrOfFreeBlocks == 1 && stats.largestFreeBlock == capacity);
+	}
+}
+
+int main()
+{
+	TestFirstFit();
+	TestRandom();
+	return TestResult();
+}
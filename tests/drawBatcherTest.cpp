@@ -0,0 +1,362 @@
+#include "test.h"
+#include "drawBatcher.h"
+#include <vector>
+#include <stdio.h>
+
+namespace
+{
+	typedef RecordingCommandRecorder Recorder;
+
+	const UINT INSTANCE_SIZE = 80;
+
+	struct ExpectedCommand
+	{
+		Recorder::CommandType type;
+		UINT rootIndex;
+		UINT count;
+		UINT64 value;
+	};
+
+	// the recorded commands have to be the expected ones, in the same order
+	bool IsSequence(Recorder& recorder, const std::vector<ExpectedCommand>& expected)
+	{
+		const std::vector<Recorder::Command>& commands = recorder.GetCommands();
+		bool same = commands.size() == expected.size();
+		for (size_t i = 0; same && i < commands.size(); i++)
+		{
+			same = commands[i].type == expected[i].type && commands[i].rootIndex == expected[i].rootIndex &&
+				commands[i].count == expected[i].count && commands[i].value == expected[i].value;
+			if (!same)
+			{
+				printf("command %zu is %s, expected %s\n", i, Recorder::GetName(commands[i].type), Recorder::GetName(expected[i].type));
+			}
+		}
+		return same;
+	}
+
+	// the start index, base vertex and start instance of a draw
+	bool IsDraw(Recorder& recorder, size_t command, UINT startIndex, UINT baseVertex, UINT startInstance)
+	{
+		const Recorder::Command& draw = recorder.GetCommands()[command];
+		const UINT* arguments = recorder.GetConstants().data() + draw.firstValue;
+		return draw.type == Recorder::Draw && arguments[0] == startIndex && arguments[1] == baseVertex && arguments[2] == startInstance;
+	}
+
+	// two boxes that share their mesh and texture, a piedmon with the same pipeline state and one with a texture array
+	struct Scene
+	{
+		ID3D12RootSignature rootSignature;
+		ID3D12DescriptorHeap heap;
+		ID3D12PipelineState textured;
+		ID3D12PipelineState textureArray;
+		D3D12_INDEX_BUFFER_VIEW indexBuffers[2];
+		std::vector<DrawState> states;
+		DrawBindings bindings;
+
+		Scene()
+		{
+			indexBuffers[0] = { 0x10000, 4096, DXGI_FORMAT_R16_UINT };
+			indexBuffers[1] = { 0x10000, 4096, DXGI_FORMAT_R32_UINT };
+
+			DrawState box = { DrawBatcher::MakeSortKey(0, 0, 0, 0.0f), &textured, { 0x100 }, &indexBuffers[0], 36, 0, 0 };
+			DrawState piedmon = { DrawBatcher::MakeSortKey(0, 1, 1, 0.0f), &textured, { 0x200 }, &indexBuffers[1], 300, 18, 24 };
+			DrawState animated = { DrawBatcher::MakeSortKey(2, 2, 1, 0.0f), &textureArray, { 0x300 }, &indexBuffers[1], 300, 18, 24 };
+			states.push_back(animated);
+			states.push_back(box);
+			states.push_back(piedmon);
+			states.push_back(box);
+
+			bindings.rootSignature = &rootSignature;
+			bindings.descriptorHeap = &heap;
+			bindings.positions = 0x20000;
+			bindings.uvs = 0x30000;
+			bindings.instances = 0x40000;
+			bindings.instanceSize = INSTANCE_SIZE;
+		}
+	};
+
+	// the draws of the scene through the state filter: what every list needs first, then per draw only
+	// what changed, an instanced draw for the boxes with the nearer one first
+	void TestRecordedScene()
+	{
+		Scene scene;
+		std::vector<int> visibleObjects = { 0, 1, 2, 3 };
+		std::vector<float> depths = { 5.0f, 20.0f, 10.0f, 2.0f };
+		DrawBatcher batcher;
+		batcher.Build(scene.states, visibleObjects, depths);
+		CHECK((visibleObjects == std::vector<int>{ 3, 1, 2, 0 }));
+		CHECK(batcher.GetBatches().size() == 3);
+
+		Recorder recorder;
+		StateFilterCommandRecorder filter(&recorder);
+		batcher.Record(&filter, scene.states, scene.bindings, 0, (int)batcher.GetBatches().size());
+
+		const UINT64 instances = scene.bindings.instances;
+		std::vector<ExpectedCommand> expected = {
+			{ Recorder::RootSignature, 0, 0, (UINT64)&scene.rootSignature },
+			{ Recorder::DescriptorHeaps, 0, 1, (UINT64)&scene.heap },
+			{ Recorder::RootShaderResourceView, Positions, 0, 0x20000 },
+			{ Recorder::RootShaderResourceView, UV, 0, 0x30000 },
+
+			{ Recorder::PipelineState, 0, 0, (UINT64)&scene.textured },
+			{ Recorder::RootDescriptorTable, TextureDT, 0, 0x100 },
+			{ Recorder::PrimitiveTopology, 0, 0, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST },
+			{ Recorder::IndexBuffer, 0, 4096, 0x10000 },
+			{ Recorder::RootConstants, BaseVertex, 1, 0 },
+			{ Recorder::RootShaderResourceView, Instances, 0, instances },
+			{ Recorder::Draw, 0, 36, 2 },
+
+			{ Recorder::RootDescriptorTable, TextureDT, 0, 0x200 },
+			{ Recorder::IndexBuffer, 0, 4096, 0x10000 },
+			{ Recorder::RootConstants, BaseVertex, 1, 0 },
+			{ Recorder::RootShaderResourceView, Instances, 0, instances + 2 * INSTANCE_SIZE },
+			{ Recorder::Draw, 0, 300, 1 },
+
+			{ Recorder::PipelineState, 0, 0, (UINT64)&scene.textureArray },
+			{ Recorder::RootDescriptorTable, TextureDT, 0, 0x300 },
+			{ Recorder::RootConstants, BaseVertex, 1, 0 },
+			{ Recorder::RootShaderResourceView, Instances, 0, instances + 3 * INSTANCE_SIZE },
+			{ Recorder::Draw, 0, 300, 1 },
+		};
+		CHECK(IsSequence(recorder, expected));
+
+		// the constants are the base vertices
+		const std::vector<UINT>& constants = recorder.GetConstants();
+		CHECK(constants.size() == 3 + 3 * 3);
+		CHECK(constants[recorder.GetCommands()[8].firstValue] == 0 && constants[recorder.GetCommands()[13].firstValue] == 24);
+		CHECK(IsDraw(recorder, 10, 0, 0, 0) && IsDraw(recorder, 15, 18, 24, 0) && IsDraw(recorder, 20, 18, 24, 0));
+
+		// without the filter every draw sets all of its state
+		Recorder unfiltered;
+		batcher.Record(&unfiltered, scene.states, scene.bindings, 0, (int)batcher.GetBatches().size());
+		CHECK(unfiltered.GetCommands().size() == 4 + 3 * 7);
+		CHECK(unfiltered.GetCount(Recorder::PipelineState) == 3 && unfiltered.GetCount(Recorder::Draw) == 3);
+		CHECK(filter.GetCounts().redundant == 4);
+	}
+
+	// nothing visible is no draw, but a list still binds what the draws read
+	void TestEmptyScene()
+	{
+		Scene scene;
+		std::vector<int> visibleObjects;
+		std::vector<float> depths;
+		DrawBatcher batcher;
+		batcher.Build(scene.states, visibleObjects, depths);
+		CHECK(batcher.GetBatches().empty());
+
+		Recorder recorder;
+		batcher.Record(&recorder, scene.states, scene.bindings, 0, 0);
+		CHECK(recorder.GetCommands().size() == 4 && recorder.GetCount(Recorder::Draw) == 0);
+	}
+
+	// a thousand objects of the four states of the scene are four instanced draws, and every visible
+	// object is an instance of exactly one of them
+	void TestInstancing()
+	{
+		Scene scene;
+		std::vector<DrawState> states;
+		std::vector<int> visibleObjects;
+		std::vector<float> depths;
+		for (int i = 0; i < 1000; i++)
+		{
+			states.push_back(scene.states[i % scene.states.size()]);
+			if (i % 5 != 0)
+			{
+				visibleObjects.push_back(i);
+				depths.push_back((float)(1000 - i));
+			}
+		}
+		DrawBatcher batcher;
+		batcher.Build(states, visibleObjects, depths);
+
+		// the two boxes share their state, so they are merged into one draw
+		const std::vector<DrawBatch>& batches = batcher.GetBatches();
+		CHECK(batches.size() == 3);
+
+		Recorder recorder;
+		batcher.Record(&recorder, states, scene.bindings, 0, (int)batches.size());
+		UINT64 instances = 0;
+		for (size_t i = 0; i < recorder.GetCommands().size(); i++)
+		{
+			if (recorder.GetCommands()[i].type == Recorder::Draw)
+			{
+				instances += recorder.GetCommands()[i].value;
+			}
+		}
+		CHECK(recorder.GetCount(Recorder::Draw) == 3);
+		CHECK(instances == visibleObjects.size() && visibleObjects.size() == 800);
+
+		// the batches follow each other in the instance data
+		int firstInstance = 0;
+		for (size_t i = 0; i < batches.size(); i++)
+		{
+			CHECK(batches[i].firstInstance == firstInstance);
+			firstInstance += batches[i].nrOfInstances;
+		}
+		CHECK(batches[0].nrOfInstances == 400 && batches[1].nrOfInstances == 200 && batches[2].nrOfInstances == 200);
+
+		// and every object in a batch has the state of the batch, front to back
+		bool sameState = true;
+		bool frontToBack = true;
+		for (size_t i = 0; i < batches.size(); i++)
+		{
+			for (int j = batches[i].firstInstance; j < batches[i].firstInstance + batches[i].nrOfInstances; j++)
+			{
+				sameState = sameState && states[visibleObjects[j]].key == states[batches[i].object].key;
+				frontToBack = frontToBack && (j == batches[i].firstInstance || visibleObjects[j] < visibleObjects[j - 1]);
+			}
+		}
+		CHECK(sameState);
+		CHECK(frontToBack);
+	}
+
+	// an object whose texture failed to load has no texture table, it is not drawn and not an instance
+	void TestMissingTexture()
+	{
+		Scene scene;
+		scene.states[2].textureTable.ptr = 0;
+		std::vector<int> visibleObjects = { 0, 1, 2, 3 };
+		std::vector<float> depths = { 5.0f, 20.0f, 10.0f, 2.0f };
+		DrawBatcher batcher;
+		batcher.Build(scene.states, visibleObjects, depths);
+		CHECK((visibleObjects == std::vector<int>{ 3, 1, 0 }));
+		CHECK(batcher.GetBatches().size() == 2);
+		CHECK(batcher.GetBatches()[1].object == 0 && batcher.GetBatches()[1].firstInstance == 2);
+
+		Recorder recorder;
+		batcher.Record(&recorder, scene.states, scene.bindings, 0, (int)batcher.GetBatches().size());
+		bool noEmptyTable = true;
+		for (size_t i = 0; i < recorder.GetCommands().size(); i++)
+		{
+			const Recorder::Command& command = recorder.GetCommands()[i];
+			noEmptyTable = noEmptyTable && (command.type != Recorder::RootDescriptorTable || command.value != 0);
+		}
+		CHECK(noEmptyTable);
+		CHECK(recorder.GetCount(Recorder::Draw) == 2);
+
+		// nothing is left if no texture loaded
+		for (size_t i = 0; i < scene.states.size(); i++)
+		{
+			scene.states[i].textureTable.ptr = 0;
+		}
+		visibleObjects = { 0, 1, 2, 3 };
+		batcher.Build(scene.states, visibleObjects, depths);
+		CHECK(visibleObjects.empty() && batcher.GetBatches().empty());
+	}
+
+	// the chunks have to follow each other and cover all the draws, every chunk at least minPerChunk
+	// of them unless there is only one
+	bool IsSplit(const std::vector<ObjectRange>& chunks, int nrOfDraws, int maxChunks, int minPerChunk)
+	{
+		if (nrOfDraws == 0)
+		{
+			return chunks.empty();
+		}
+
+		bool covered = !chunks.empty() && (int)chunks.size() <= maxChunks && chunks[0].first == 0 && chunks.back().last == nrOfDraws;
+		for (size_t i = 0; covered && i < chunks.size(); i++)
+		{
+			covered = chunks[i].last > chunks[i].first && (i == 0 || chunks[i].first == chunks[i - 1].last);
+			covered = covered && (chunks.size() == 1 || chunks[i].last - chunks[i].first >= minPerChunk);
+		}
+		return covered;
+	}
+
+	void TestSplit()
+	{
+		const int chunk = 64;
+		const int maxChunks = 7;
+		const int counts[] = { 0, 1, chunk - 1, chunk, chunk + 1, 3 * chunk, maxChunks * chunk, 100 * chunk + 13 };
+		for (int nrOfDraws : counts)
+		{
+			std::vector<ObjectRange> chunks = DrawBatcher::Split(nrOfDraws, maxChunks, chunk);
+			CHECK(IsSplit(chunks, nrOfDraws, maxChunks, chunk));
+		}
+
+		// a chunk per chunk of draws until there are more than the lists
+		CHECK(DrawBatcher::Split(chunk - 1, maxChunks, chunk).size() == 1);
+		CHECK(DrawBatcher::Split(3 * chunk, maxChunks, chunk).size() == 3);
+		CHECK(DrawBatcher::Split(100 * chunk + 13, maxChunks, chunk).size() == maxChunks);
+
+		// without a minimum every draw can be its own chunk
+		CHECK(DrawBatcher::Split(5, maxChunks, 0).size() == 5);
+		CHECK(IsSplit(DrawBatcher::Split(5, maxChunks, 0), 5, maxChunks, 1));
+	}
+
+	// the chunks recorded each into their own recorder, as the threads of Renderer::Frame do, are
+	// the same draws as the whole frame recorded at once
+	void TestChunkedRecording()
+	{
+		Scene scene;
+		std::vector<DrawState> states;
+		std::vector<int> visibleObjects;
+		std::vector<float> depths;
+		for (int i = 0; i < 1000; i++)
+		{
+			DrawState state = scene.states[i % scene.states.size()];
+			state.key = DrawBatcher::MakeSortKey(i % 3, i % 17, i % 29, 0.0f);
+			state.firstIndex = i;
+			states.push_back(state);
+			visibleObjects.push_back(i);
+			depths.push_back((float)(i % 50));
+		}
+		DrawBatcher batcher;
+		batcher.Build(states, visibleObjects, depths);
+		const int nrOfDraws = (int)batcher.GetBatches().size();
+
+		Recorder whole;
+		batcher.Record(&whole, states, scene.bindings, 0, nrOfDraws);
+
+		std::vector<ObjectRange> chunks = DrawBatcher::Split(nrOfDraws, 4, 16);
+		CHECK(chunks.size() == 4);
+		std::vector<Recorder> recorders(chunks.size());
+		for (size_t i = 0; i < chunks.size(); i++)
+		{
+			StateFilterCommandRecorder filter(&recorders[i]);
+			batcher.Record(&filter, states, scene.bindings, chunks[i].first, chunks[i].last);
+		}
+
+		// the draws of the chunks one after the other, with the arguments they were recorded with
+		size_t draw = 0;
+		bool same = true;
+		for (size_t i = 0; i < recorders.size(); i++)
+		{
+			const std::vector<Recorder::Command>& commands = recorders[i].GetCommands();
+			same = same && commands[0].type == Recorder::RootSignature;
+			for (size_t j = 0; j < commands.size(); j++)
+			{
+				if (commands[j].type != Recorder::Draw)
+				{
+					continue;
+				}
+				while (whole.GetCommands()[draw].type != Recorder::Draw)
+				{
+					draw++;
+				}
+				const Recorder::Command& expected = whole.GetCommands()[draw];
+				same = same && commands[j].count == expected.count && commands[j].value == expected.value &&
+					recorders[i].GetConstants()[commands[j].firstValue] == whole.GetConstants()[expected.firstValue];
+				draw++;
+			}
+		}
+
+		unsigned int chunkedDraws = 0;
+		for (size_t i = 0; i < recorders.size(); i++)
+		{
+			chunkedDraws += recorders[i].GetCount(Recorder::Draw);
+		}
+		CHECK(same);
+		CHECK(chunkedDraws == whole.GetCount(Recorder::Draw) && (int)chunkedDraws == nrOfDraws);
+	}
+}
+
+int main()
+{
+	TestRecordedScene();
+	TestEmptyScene();
+	TestInstancing();
+	TestMissingTexture();
+	TestSplit();
+	TestChunkedRecording();
+	return TestResult();
+}
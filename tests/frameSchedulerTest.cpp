@@ -0,0 +1,185 @@
+#include "test.h"
+#include "frameScheduler.h"
+#include <vector>
+
+namespace
+{
+	const unsigned int NR_OF_CONTEXTS = 3;
+
+	// a gpu that only finishes frames when the test completes them or the cpu waits for them,
+	// every wait is kept
+	class StandInFrameQueue : public FrameQueue
+	{
+	public:
+		StandInFrameQueue()
+		{
+			signaled = 0;
+			completed = 0;
+		}
+
+		unsigned long long Signal()
+		{
+			return ++signaled;
+		}
+
+		unsigned long long GetCompletedValue()
+		{
+			return completed;
+		}
+
+		void Wait(unsigned long long fenceValue)
+		{
+			waits.push_back(fenceValue);
+			Complete(fenceValue);
+		}
+
+		void Complete(unsigned long long fenceValue)
+		{
+			completed = fenceValue > completed ? fenceValue : completed;
+		}
+
+		unsigned long long GetNrOfInFlight()
+		{
+			return signaled - completed;
+		}
+
+		std::vector<unsigned long long> waits;
+
+	private:
+		unsigned long long signaled;
+		unsigned long long completed;
+	};
+
+	// frame f signals fence value f + 1. With a gpu that never catches up on its own, frame f waits
+	// for frame f - latency and no more than latency frames are ever in flight
+	void TestLatency()
+	{
+		for (unsigned int latency = 1; latency <= NR_OF_CONTEXTS; latency++)
+		{
+			StandInFrameQueue queue;
+			FrameScheduler scheduler;
+			scheduler.Reset(&queue, nullptr, NR_OF_CONTEXTS);
+			scheduler.SetLatency(latency);
+			CHECK(scheduler.GetLatency() == latency);
+
+			const unsigned int nrOfFrames = 10;
+			int wrongContexts = 0;
+			unsigned long long mostInFlight = 0;
+			for (unsigned int frame = 0; frame < nrOfFrames; frame++)
+			{
+				wrongContexts += scheduler.BeginFrame() != frame % NR_OF_CONTEXTS;
+				wrongContexts += scheduler.EndFrame() != frame + 1;
+				mostInFlight = queue.GetNrOfInFlight() > mostInFlight ? queue.GetNrOfInFlight() : mostInFlight;
+			}
+
+			std::vector<unsigned long long> waits;
+			for (unsigned long long fenceValue = 1; fenceValue + latency <= nrOfFrames; fenceValue++)
+			{
+				waits.push_back(fenceValue);
+			}
+			CHECK(wrongContexts == 0);
+			CHECK(queue.waits == waits);
+			CHECK(mostInFlight == latency);
+			CHECK(scheduler.GetFrameCount() == nrOfFrames);
+			CHECK(scheduler.GetFenceValue((nrOfFrames - 1) % NR_OF_CONTEXTS) == nrOfFrames);
+		}
+
+		// the latency is one to the number of contexts
+		FrameScheduler scheduler;
+		StandInFrameQueue queue;
+		scheduler.Reset(&queue, nullptr, NR_OF_CONTEXTS);
+		CHECK(scheduler.GetLatency() == NR_OF_CONTEXTS);
+		scheduler.SetLatency(0);
+		CHECK(scheduler.GetLatency() == 1);
+		scheduler.SetLatency(NR_OF_CONTEXTS + 1);
+		CHECK(scheduler.GetLatency() == NR_OF_CONTEXTS);
+	}
+
+	// an upload heap is released once the gpu has passed the frame it was given to, not while that
+	// frame is recorded even if the gpu is idle, and the ones that are left go with the scheduler
+	void TestUploadHeaps()
+	{
+		StandInFrameQueue queue;
+		ID3D12Resource* heap = new ID3D12Resource();
+		ID3D12Resource* left = new ID3D12Resource();
+		heap->AddRef();
+		left->AddRef();
+		{
+			FrameScheduler scheduler;
+			scheduler.Reset(&queue, nullptr, NR_OF_CONTEXTS);
+			scheduler.BeginFrame();
+			scheduler.ReleaseAfterFrame(heap);
+			CHECK(heap->references == 2);
+			CHECK(scheduler.EndFrame() == 1);
+			scheduler.BeginFrame();
+			CHECK(heap->references == 2);
+			scheduler.EndFrame();
+			queue.Complete(1);
+			scheduler.BeginFrame();
+			CHECK(heap->references == 1);
+			scheduler.EndFrame();
+
+			scheduler.BeginFrame();
+			scheduler.ReleaseAfterFrame(left);
+			queue.Complete(3);
+			CHECK(!scheduler.WaitForOldestFrame());
+			CHECK(left->references == 2);
+			scheduler.EndFrame();
+			CHECK(left->references == 2);
+		}
+		CHECK(left->references == 1);
+		CHECK(queue.waits.empty());
+		heap->Release();
+		left->Release();
+	}
+
+	// the space of a frame in the ring is only handed out again once the gpu has passed the frame,
+	// because a new frame retired it or because the cpu waited for the oldest one
+	void TestRingReuse()
+	{
+		const unsigned long long INVALID = RingAllocator::INVALID;
+		StandInFrameQueue queue;
+		RingAllocator ring;
+		ring.Reset(1024);
+		FrameScheduler scheduler;
+		scheduler.Reset(&queue, &ring, NR_OF_CONTEXTS);
+
+		scheduler.BeginFrame();
+		CHECK(ring.Allocate(512, 256) == 0);
+		scheduler.EndFrame();
+		scheduler.BeginFrame();
+		CHECK(ring.Allocate(512, 256) == 512);
+		scheduler.EndFrame();
+
+		scheduler.BeginFrame();
+		CHECK(ring.GetStats().framesInFlight == 2);
+		CHECK(ring.Allocate(256, 256) == INVALID);
+		CHECK(scheduler.WaitForOldestFrame());
+		CHECK(queue.waits.size() == 1 && queue.waits[0] == 1);
+		CHECK(ring.GetStats().framesInFlight == 1);
+		CHECK(ring.Allocate(256, 256) == 0);
+		CHECK(ring.Allocate(512, 256) == INVALID);
+		scheduler.EndFrame();
+
+		// the gpu catches up on its own, the next frame finds everything retired
+		queue.Complete(3);
+		CHECK(ring.Allocate(512, 256) == INVALID);
+		scheduler.BeginFrame();
+		CHECK(ring.GetStats().framesInFlight == 0 && ring.GetStats().used == 0);
+		CHECK(ring.Allocate(1024, 256) != INVALID);
+		scheduler.EndFrame();
+
+		scheduler.WaitForIdle();
+		CHECK(ring.GetOldestFenceValue() == 0);
+		CHECK(!scheduler.WaitForOldestFrame());
+		CHECK(queue.waits.size() == 2 && queue.waits[1] == 5);
+	}
+}
+
+int main()
+{
+	TestLatency();
+	TestUploadHeaps();
+	TestRingReuse();
+	return TestResult();
+}
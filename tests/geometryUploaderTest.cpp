@@ -0,0 +1,189 @@
+#include "test.h"
+#include "geometryUploader.h"
+#include <vector>
+#include <deque>
+#include <random>
+#include <chrono>
+#include <string.h>
+#include <stdio.h>
+
+namespace
+{
+	// executes the copies of a batch only when it is waited for or polled a few times, like a
+	// queue that is behind. Overwriting staging space too early shows up as wrong destination bytes.
+	class StandInCopyQueue : public CopyQueue
+	{
+	public:
+		StandInCopyQueue(unsigned long long stagingSize) : staging((size_t)stagingSize)
+		{
+			submitted = 0;
+			completed = 0;
+			polls = 0;
+		}
+
+		unsigned char* GetStaging()
+		{
+			return staging.data();
+		}
+
+		unsigned long long GetStagingSize()
+		{
+			return staging.size();
+		}
+
+		void Copy(void* destination, unsigned long long destinationOffset, unsigned long long stagingOffset, unsigned long long size)
+		{
+			Command command = { (std::vector<unsigned char>*)destination, destinationOffset, stagingOffset, size };
+			recorded.push_back(command);
+		}
+
+		unsigned long long Submit()
+		{
+			batches.push_back(recorded);
+			recorded.clear();
+			return ++submitted;
+		}
+
+		unsigned long long GetCompletedValue()
+		{
+			if (++polls % 3 == 0 && completed < submitted)
+			{
+				Execute();
+			}
+			return completed;
+		}
+
+		void Wait(unsigned long long fenceValue)
+		{
+			while (completed < fenceValue)
+			{
+				Execute();
+			}
+		}
+
+		unsigned long long GetNrOfSubmitted()
+		{
+			return this->submitted;
+		}
+
+	private:
+		struct Command
+		{
+			std::vector<unsigned char>* destination;
+			unsigned long long destinationOffset;
+			unsigned long long stagingOffset;
+			unsigned long long size;
+		};
+
+		void Execute()
+		{
+			for (size_t i = 0; i < batches.front().size(); i++)
+			{
+				Command& command = batches.front()[i];
+				memcpy(command.destination->data() + command.destinationOffset, staging.data() + command.stagingOffset, (size_t)command.size);
+			}
+			batches.pop_front();
+			completed++;
+		}
+
+		std::vector<unsigned char> staging;
+		std::vector<Command> recorded;
+		std::deque<std::vector<Command>> batches;
+		unsigned long long submitted;
+		unsigned long long completed;
+		unsigned int polls;
+	};
+
+	// small uploads wait for Flush, a buffer bigger than the staging buffer is copied in pieces
+	void TestBatching()
+	{
+		StandInCopyQueue queue(1024);
+		GeometryUploader uploader;
+		uploader.Initialize(&queue, 512);
+		CHECK(uploader.Flush() == 0);
+
+		std::vector<unsigned char> source(3000);
+		for (size_t i = 0; i < source.size(); i++)
+		{
+			source[i] = (unsigned char)(i * 7);
+		}
+		std::vector<unsigned char> small(100, 0);
+		std::vector<unsigned char> big(source.size(), 0);
+
+		uploader.Upload(&small, 0, source.data(), small.size());
+		CHECK(queue.GetNrOfSubmitted() == 0);
+		unsigned long long fenceValue = uploader.Flush();
+		CHECK(fenceValue == 1 && uploader.Flush() == 1);
+		queue.Wait(fenceValue);
+		CHECK(memcmp(small.data(), source.data(), small.size()) == 0);
+
+		uploader.Upload(&big, 0, source.data(), big.size());
+		queue.Wait(uploader.Flush());
+		CHECK(big == source);
+
+		GeometryUploadStats stats = uploader.GetStats();
+		CHECK(stats.uploads == 2 && stats.copies == 4 && stats.bytes == small.size() + big.size());
+		CHECK(stats.submissions == queue.GetNrOfSubmitted());
+	}
+
+	// mostly small meshes and a few that are bigger than the staging buffer
+	void TestRandomBuffers()
+	{
+		const unsigned long long stagingSize = 1024 * 1024;
+		const unsigned long long batchSize = 256 * 1024;
+		const int nrOfBuffers = 2000;
+
+		std::mt19937 random(1);
+		std::vector<std::vector<unsigned char>> sources(nrOfBuffers);
+		std::vector<std::vector<unsigned char>> destinations(nrOfBuffers);
+		unsigned long long totalBytes = 0;
+		for (int i = 0; i < nrOfBuffers; i++)
+		{
+			size_t size = i % 500 == 0 ? 3 * 1024 * 1024 + random() % 1024 : 1 + random() % (16 * 1024);
+			sources[i].resize(size);
+			for (size_t j = 0; j < size; j++)
+			{
+				sources[i][j] = (unsigned char)random();
+			}
+			destinations[i].resize(size, 0);
+			totalBytes += size;
+		}
+
+		StandInCopyQueue queue(stagingSize);
+		GeometryUploader uploader;
+		uploader.Initialize(&queue, batchSize);
+
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < nrOfBuffers; i++)
+		{
+			// in two parts like the streams of a mesh in a shared buffer
+			size_t half = sources[i].size() / 2;
+			uploader.Upload(&destinations[i], 0, sources[i].data(), half);
+			uploader.Upload(&destinations[i], half, sources[i].data() + half, sources[i].size() - half);
+		}
+		queue.Wait(uploader.Flush());
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+		// a buffer without its data means staging memory was reused too early
+		int wrong = 0;
+		for (int i = 0; i < nrOfBuffers; i++)
+		{
+			wrong += destinations[i] != sources[i];
+		}
+		CHECK(wrong == 0);
+
+		GeometryUploadStats stats = uploader.GetStats();
+		CHECK(stats.uploads == 2 * nrOfBuffers && stats.bytes == totalBytes);
+		CHECK(stats.copies > stats.uploads);
+		CHECK(stats.submissions * 10 < stats.uploads);
+		printf("Geometry upload: %u buffers, %.2f MB in %u copies and %u submissions (%u without batching), %u waits for the queue, %.2f ms\n",
+			stats.uploads, stats.bytes / (1024.0 * 1024.0), stats.copies, stats.submissions, stats.uploads, stats.stalls, elapsed.count());
+	}
+}
+
+int main()
+{
+	TestBatching();
+	TestRandomBuffers();
+	return TestResult();
+}
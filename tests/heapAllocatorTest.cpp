@@ -0,0 +1,255 @@
+#include "test.h"
+#include "heapAllocator.h"
+#include <vector>
+#include <random>
+#include <chrono>
+#include <stdio.h>
+
+namespace
+{
+	const unsigned long long SMALL_ALIGNMENT = HeapAllocator::SMALL_ALIGNMENT;
+	const unsigned long long LARGE_ALIGNMENT = HeapAllocator::LARGE_ALIGNMENT;
+
+	unsigned long long RoundUp(unsigned long long size, unsigned long long alignment)
+	{
+		return (size + alignment - 1) / alignment * alignment;
+	}
+
+	// what GetResourceAllocationInfo roughly returns for an 8-bit rgba texture without mips, in 4KB
+	// tiles of 32x32 texels when it fits into 64KB and may use the small alignment, otherwise in
+	// 64KB tiles of 128x128 texels
+	void EstimateTexture(unsigned int width, unsigned int height, unsigned long long& size, unsigned long long& alignment)
+	{
+		size = (unsigned long long)((width + 31) / 32) * ((height + 31) / 32) * SMALL_ALIGNMENT;
+		alignment = SMALL_ALIGNMENT;
+		if (size > LARGE_ALIGNMENT)
+		{
+			size = (unsigned long long)((width + 127) / 128) * ((height + 127) / 128) * LARGE_ALIGNMENT;
+			alignment = LARGE_ALIGNMENT;
+		}
+	}
+
+	// small resources share a page that is freed with its last slot, big ones get a heap of their own
+	void TestPagesAndHeaps()
+	{
+		HeapAllocator allocator;
+		allocator.Reset(1024 * 1024);
+		HeapPlacement a, b, c, d, e;
+		CHECK(allocator.Allocate(4096, SMALL_ALIGNMENT, a) && a.heap == 0 && a.offset == 0);
+		CHECK(allocator.Allocate(10000, SMALL_ALIGNMENT, b) && b.heap == 0 && b.offset == 4096);
+		CHECK(allocator.Allocate(100000, LARGE_ALIGNMENT, c) && c.heap == 0 && c.offset == LARGE_ALIGNMENT);
+		CHECK(allocator.Allocate(2 * 1024 * 1024, LARGE_ALIGNMENT, d) && d.heap == 1 && d.offset == 0);
+		CHECK(allocator.GetHeapSize(1) == 2 * 1024 * 1024);
+		CHECK(allocator.Allocate(20000, SMALL_ALIGNMENT, e) && e.heap == 0 && e.offset == 4 * 4096);
+		HeapPlacement unsupported;
+		CHECK(!allocator.Allocate(4096, 4 * 1024 * 1024, unsupported));
+
+		HeapStats stats = allocator.GetHeapStats(0);
+		CHECK(stats.nrOfResources == 4 && stats.requested == 4096 + 10000 + 100000 + 20000);
+		CHECK(stats.allocated == 9 * 4096 + 2 * LARGE_ALIGNMENT);
+		CHECK(stats.pageSlack == 7 * 4096 && stats.free == 13 * LARGE_ALIGNMENT);
+
+		allocator.Free(a);
+		allocator.Free(b);
+		allocator.Free(e);
+		allocator.Free(c);
+		allocator.Free(d);
+		stats = allocator.GetHeapStats(0);
+		CHECK(stats.nrOfResources == 0 && stats.allocated == 0 && stats.requested == 0 && stats.pageSlack == 0);
+		CHECK(stats.largestFreeBlock == stats.size);
+		CHECK(allocator.GetHeapSize(1) == 0);
+
+		// the dropped heap comes back with the size of the new resource
+		CHECK(allocator.Allocate(3 * 1024 * 1024, LARGE_ALIGNMENT, d) && d.heap == 1);
+		CHECK(allocator.GetHeapSize(1) == 3 * 1024 * 1024 && allocator.GetNrOfHeaps() == 2);
+	}
+
+	// the textures of the objects folder, with the animation as one texture per frame
+	void TestRecordedTextures()
+	{
+		struct RecordedTexture
+		{
+			unsigned int width;
+			unsigned int height;
+			unsigned int count;
+		};
+		const RecordedTexture recorded[] = {
+			{ 800, 1000, 1 },		// box.jpg
+			{ 2048, 2048, 1 },		// dummy_wood.jpg
+			{ 1067, 1067, 1 },		// piedmon.png
+			{ 640, 360, 105 },		// bindless/0001.png..0105.png
+		};
+		const unsigned long long heapSize = 64 * 1024 * 1024;
+
+		HeapAllocator allocator;
+		allocator.Reset(heapSize);
+		unsigned long long committed = 0;
+		unsigned long long total = 0;
+		unsigned int nrOfTextures = 0;
+		int failed = 0;
+		for (size_t i = 0; i < sizeof(recorded) / sizeof(recorded[0]); i++)
+		{
+			for (unsigned int j = 0; j < recorded[i].count; j++)
+			{
+				unsigned long long size, alignment;
+				EstimateTexture(recorded[i].width, recorded[i].height, size, alignment);
+				HeapPlacement placement;
+				failed += !allocator.Allocate(size, alignment, placement);
+				committed += RoundUp(size, LARGE_ALIGNMENT);
+				total += size;
+				nrOfTextures++;
+			}
+		}
+
+		unsigned long long heapBytes = 0, requested = 0;
+		for (unsigned int i = 0; i < allocator.GetNrOfHeaps(); i++)
+		{
+			HeapStats stats = allocator.GetHeapStats(i);
+			heapBytes += stats.size;
+			requested += stats.requested;
+		}
+		CHECK(failed == 0);
+		CHECK(requested == total);
+		CHECK(allocator.GetNrOfHeaps() == 2);
+		printf("Heap allocator, recorded textures: %u textures in %u heaps of %.2f MB (committed: %u implicit heaps of %.2f MB), "
+			"%.1f%% of the heaps in use\n", nrOfTextures, allocator.GetNrOfHeaps(), heapBytes / (1024.0 * 1024.0), nrOfTextures,
+			committed / (1024.0 * 1024.0), 100.0 * requested / heapBytes);
+	}
+
+	// random textures, half of them small enough for 4KB alignment and a few bigger than a heap,
+	// until about three heaps are in use, then more frees than placements. Every 4KB slot of every
+	// heap remembers its owner.
+	void TestRandomTextures()
+	{
+		struct Placed
+		{
+			HeapPlacement placement;
+			int owner;
+		};
+
+		const int steps = 20000;
+		const unsigned long long heapSize = 16 * 1024 * 1024;
+		HeapAllocator allocator;
+		allocator.Reset(heapSize);
+		std::vector<std::vector<int>> owners;
+		std::vector<Placed> placed;
+		std::mt19937 random(1);
+		unsigned long long liveBytes = 0;
+		unsigned long long committed = 0;
+		double time = 0.0;
+		int failed = 0;
+		int misplaced = 0;
+		int overlaps = 0;
+
+		for (int step = 0; step < steps; step++)
+		{
+			bool allocate = placed.empty() || random() % 100 < (liveBytes < 3 * heapSize ? 70u : 40u);
+			if (allocate)
+			{
+				unsigned int kind = random() % 100;
+				unsigned int width = kind < 50 ? 1 + random() % 128 : (kind < 99 ? 129 + random() % 1024 : 2500 + random() % 1000);
+				unsigned int height = kind < 50 ? 1 + random() % 128 : (kind < 99 ? 129 + random() % 1024 : 2500 + random() % 1000);
+
+				Placed texture;
+				unsigned long long size, alignment;
+				EstimateTexture(width, height, size, alignment);
+				std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+				bool allocated = allocator.Allocate(size, alignment, texture.placement);
+				time += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+				if (!allocated)
+				{
+					failed++;
+					continue;
+				}
+
+				// a heap that was dropped can come back with another size, it was empty
+				owners.resize(allocator.GetNrOfHeaps());
+				for (unsigned int i = 0; i < owners.size(); i++)
+				{
+					if (owners[i].size() != allocator.GetHeapSize(i) / SMALL_ALIGNMENT)
+					{
+						owners[i].assign((size_t)(allocator.GetHeapSize(i) / SMALL_ALIGNMENT), -1);
+					}
+				}
+
+				texture.owner = step;
+				std::vector<int>& heapOwners = owners[texture.placement.heap];
+				unsigned long long first = texture.placement.offset / SMALL_ALIGNMENT;
+				unsigned long long last = (texture.placement.offset + size + SMALL_ALIGNMENT - 1) / SMALL_ALIGNMENT;
+				misplaced += texture.placement.offset % alignment != 0 || last > heapOwners.size();
+				for (unsigned long long i = first; i < last && i < heapOwners.size(); i++)
+				{
+					overlaps += heapOwners[i] != -1;
+					heapOwners[i] = step;
+				}
+				placed.push_back(texture);
+				liveBytes += size;
+				committed += RoundUp(size, LARGE_ALIGNMENT);
+			}
+			else
+			{
+				size_t index = random() % placed.size();
+				Placed texture = placed[index];
+				placed[index] = placed.back();
+				placed.pop_back();
+
+				std::vector<int>& heapOwners = owners[texture.placement.heap];
+				unsigned long long first = texture.placement.offset / SMALL_ALIGNMENT;
+				unsigned long long last = (texture.placement.offset + texture.placement.size + SMALL_ALIGNMENT - 1) / SMALL_ALIGNMENT;
+				for (unsigned long long i = first; i < last; i++)
+				{
+					heapOwners[i] = -1;
+				}
+
+				std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+				allocator.Free(texture.placement);
+				time += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+				liveBytes -= texture.placement.size;
+				committed -= RoundUp(texture.placement.size, LARGE_ALIGNMENT);
+			}
+		}
+
+		unsigned long long heapBytes = 0, slack = 0, requested = 0;
+		unsigned int nrOfHeaps = 0;
+		double fragmentation = 0.0;
+		for (unsigned int i = 0; i < allocator.GetNrOfHeaps(); i++)
+		{
+			HeapStats stats = allocator.GetHeapStats(i);
+			heapBytes += stats.size;
+			slack += stats.pageSlack;
+			requested += stats.requested;
+			fragmentation += stats.fragmentation;
+			nrOfHeaps += stats.size > 0;
+		}
+		CHECK(failed == 0);
+		CHECK(misplaced == 0);
+		CHECK(overlaps == 0);
+		CHECK(requested == liveBytes);
+		// sharing pages has to lose less than giving every texture its own 64KB blocks
+		CHECK(slack < committed - liveBytes);
+		printf("Heap allocator, random textures: %d placements and frees in %.3f us each, %zu textures of %.2f MB in %u heaps of %.2f MB, "
+			"%llu KB lost to half full pages (committed: %llu KB lost to 64KB alignment), average fragmentation %.3f\n", steps, time / steps,
+			placed.size(), liveBytes / (1024.0 * 1024.0), nrOfHeaps, heapBytes / (1024.0 * 1024.0), slack / 1024,
+			(committed - liveBytes) / 1024, fragmentation / nrOfHeaps);
+
+		// once everything is freed every heap is one free block again
+		for (size_t i = 0; i < placed.size(); i++)
+		{
+			allocator.Free(placed[i].placement);
+		}
+		for (unsigned int i = 0; i < allocator.GetNrOfHeaps(); i++)
+		{
+			HeapStats stats = allocator.GetHeapStats(i);
+			CHECK(stats.nrOfResources == 0 && stats.allocated == 0 && stats.pageSlack == 0 && stats.largestFreeBlock == stats.size);
+			CHECK(stats.size == 0 || stats.size == heapSize);
+		}
+	}
+}
+
+int main()
+{
+	TestPagesAndHeaps();
+	TestRecordedTextures();
+	TestRandomTextures();
+	return TestResult();
+}
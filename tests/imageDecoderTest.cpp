@@ -0,0 +1,518 @@
+#include "test.h"
+#include "pngDecoder.h"
+#include "jpegDecoder.h"
+#include "inflate.h"
+#include <vector>
+#include <random>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+
+namespace
+{
+	// Small reference images, made with zlib and a minimal baseline jpeg encoder. The rows of the pngs
+	// go through the filter types 0, 1, 2, 3, 4 in turn and their pixels are PngPixel.
+
+	// 8x5 rgb, deflate stored blocks, one row per filter type
+	const unsigned char STORED_PNG[] =
+	{
+		0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x48, 0x44, 0x52,
+		0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x05, 0x08, 0x02, 0x00, 0x00, 0x00, 0xF7, 0xF3, 0x3A,
+		0x02, 0x00, 0x00, 0x00, 0x88, 0x49, 0x44, 0x41, 0x54, 0x78, 0x01, 0x01, 0x7D, 0x00, 0x82, 0xFF,
+		0x00, 0x00, 0xFF, 0x00, 0x1F, 0xF2, 0x00, 0x3E, 0xE5, 0x00, 0x5D, 0xD8, 0x00, 0x7C, 0xCB, 0x00,
+		0x9B, 0xBE, 0x00, 0xBA, 0xB1, 0x00, 0xD9, 0xA4, 0x00, 0x01, 0x11, 0xE2, 0x00, 0x1F, 0xF3, 0x07,
+		0x1F, 0xF3, 0x07, 0x1F, 0xF3, 0x07, 0x1F, 0xF3, 0x07, 0x1F, 0xF3, 0x07, 0x1F, 0xF3, 0x07, 0x1F,
+		0xF3, 0x07, 0x02, 0x11, 0xE3, 0x00, 0x11, 0xE3, 0x07, 0x11, 0xE3, 0x0E, 0x11, 0xE3, 0x15, 0x11,
+		0xE3, 0x1C, 0x11, 0xE3, 0x23, 0x11, 0xE3, 0x2A, 0x11, 0xE3, 0x31, 0x03, 0x22, 0x46, 0x00, 0x18,
+		0xEB, 0x0E, 0x18, 0xEB, 0x12, 0x18, 0xEB, 0x15, 0x18, 0xEB, 0x19, 0x18, 0xEB, 0x1C, 0x18, 0xEB,
+		0x20, 0x18, 0xEB, 0x23, 0x04, 0x11, 0xE3, 0x00, 0x11, 0xF3, 0x07, 0x11, 0xF3, 0x0E, 0x11, 0xF3,
+		0x15, 0x11, 0xF3, 0x1C, 0x11, 0xF3, 0x1C, 0x11, 0xF3, 0x1C, 0x11, 0xF3, 0x1C, 0xEA, 0x11, 0x2B,
+		0xD5, 0x0C, 0x47, 0x06, 0x07, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4E, 0x44, 0xAE, 0x42, 0x60,
+		0x82,
+	};
+
+	// the same image as fixed huffman codes
+	const unsigned char FIXED_PNG[] =
+	{
+		0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x48, 0x44, 0x52,
+		0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x05, 0x08, 0x02, 0x00, 0x00, 0x00, 0xF7, 0xF3, 0x3A,
+		0x02, 0x00, 0x00, 0x00, 0x6F, 0x49, 0x44, 0x41, 0x54, 0x78, 0x01, 0x63, 0x60, 0xF8, 0xCF, 0x20,
+		0xFF, 0x89, 0xC1, 0xEE, 0x29, 0x43, 0xEC, 0x0D, 0x86, 0x9A, 0xD3, 0x0C, 0xB3, 0xF7, 0x31, 0xEC,
+		0xDA, 0xC8, 0x70, 0x73, 0x09, 0x03, 0xA3, 0xE0, 0x23, 0x06, 0xF9, 0xCF, 0xEC, 0x98, 0x88, 0x49,
+		0xF0, 0x31, 0x83, 0xE0, 0x63, 0x76, 0xC1, 0xC7, 0x7C, 0x82, 0x8F, 0x45, 0x05, 0x1F, 0xCB, 0x08,
+		0x3E, 0x56, 0x16, 0x7C, 0xAC, 0x25, 0xF8, 0xD8, 0x90, 0x59, 0xC9, 0x8D, 0x41, 0xE2, 0x35, 0x9F,
+		0xC4, 0x6B, 0x21, 0x89, 0xD7, 0xA2, 0x12, 0xAF, 0x25, 0x25, 0x5E, 0xCB, 0x48, 0xBC, 0x56, 0x90,
+		0x78, 0xAD, 0xCC, 0x02, 0xD2, 0xF1, 0x99, 0x5D, 0xF0, 0x33, 0x9F, 0xE0, 0x67, 0x51, 0xC1, 0xCF,
+		0x32, 0x70, 0x04, 0x00, 0xEA, 0x11, 0x2B, 0xD5, 0x66, 0x8C, 0xCA, 0x8D, 0x00, 0x00, 0x00, 0x00,
+		0x49, 0x45, 0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82,
+	};
+
+	// 16x16 rgba, dynamic huffman codes with matches
+	const unsigned char DYNAMIC_PNG[] =
+	{
+		0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x48, 0x44, 0x52,
+		0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x10, 0x08, 0x06, 0x00, 0x00, 0x00, 0x1F, 0xF3, 0xFF,
+		0x61, 0x00, 0x00, 0x02, 0x2A, 0x49, 0x44, 0x41, 0x54, 0x78, 0xDA, 0xA5, 0xD0, 0x5D, 0x48, 0x53,
+		0x71, 0x18, 0xC7, 0xF1, 0x67, 0x5B, 0x75, 0xA2, 0xE1, 0x62, 0xD5, 0xF4, 0x34, 0x96, 0x1B, 0x8D,
+		0x36, 0x1A, 0x35, 0x5A, 0x34, 0x59, 0x39, 0x3B, 0x58, 0x78, 0x5A, 0x2F, 0x47, 0x18, 0x6C, 0x15,
+		0x4D, 0xAD, 0x66, 0x44, 0x63, 0x15, 0x82, 0xB6, 0x28, 0x8D, 0x48, 0x89, 0x5E, 0x14, 0xA3, 0x8C,
+		0x1C, 0xD6, 0x55, 0xED, 0x26, 0xBB, 0xA8, 0x79, 0x11, 0xBD, 0x98, 0x15, 0x11, 0x65, 0x42, 0xB8,
+		0x25, 0x68, 0x81, 0x28, 0x9D, 0x0A, 0xF3, 0x0C, 0x2A, 0x87, 0x54, 0x17, 0xB5, 0x7E, 0xCA, 0x58,
+		0x52, 0xD4, 0xC5, 0xBC, 0xF8, 0xF0, 0x3C, 0xFF, 0x73, 0x6E, 0x1E, 0xBE, 0x44, 0x29, 0x7A, 0xAE,
+		0x1F, 0xA3, 0x9E, 0xB5, 0xEF, 0xE9, 0x65, 0xF9, 0x00, 0xC5, 0xEA, 0x7A, 0xA8, 0xEF, 0x72, 0x17,
+		0xF5, 0xDF, 0x8B, 0xD2, 0x9B, 0xD7, 0x11, 0x1A, 0xFC, 0xD6, 0x4A, 0xC3, 0x79, 0x67, 0x49, 0x2C,
+		0x38, 0x46, 0x1F, 0xBC, 0x55, 0xF4, 0xB1, 0xA6, 0x92, 0x12, 0x2D, 0x5B, 0xE9, 0x53, 0xC7, 0x46,
+		0x1A, 0x8B, 0x39, 0x69, 0x5C, 0xA6, 0x7E, 0x4B, 0xAF, 0xF4, 0x49, 0x46, 0x91, 0x2D, 0xB9, 0x5A,
+		0x24, 0xA5, 0x5A, 0x64, 0x40, 0x05, 0x1A, 0xD0, 0x81, 0x11, 0x2C, 0x60, 0x03, 0x07, 0x70, 0xC0,
+		0x83, 0x00, 0x1E, 0xF0, 0x81, 0x1F, 0x02, 0x4A, 0xC5, 0x62, 0x9E, 0x8E, 0xB2, 0x92, 0x8A, 0x61,
+		0xA5, 0x79, 0xA0, 0x81, 0x85, 0xA0, 0x03, 0x03, 0x18, 0xC1, 0x0C, 0x96, 0x53, 0xAC, 0x64, 0x05,
+		0x1B, 0xD8, 0xF1, 0x76, 0x30, 0x6C, 0xB0, 0x13, 0x1E, 0x32, 0x33, 0x26, 0x2F, 0xC0, 0x29, 0xEA,
+		0xA4, 0x0A, 0x34, 0xA0, 0xFB, 0x93, 0xF2, 0xAF, 0x6F, 0xA2, 0x2F, 0xB3, 0x93, 0xF7, 0x20, 0xA5,
+		0x6A, 0x76, 0x1B, 0xE5, 0x2D, 0x1E, 0x7E, 0x66, 0xC7, 0x86, 0xC0, 0xEC, 0xD8, 0x9A, 0x26, 0xE5,
+		0xE7, 0xE5, 0x37, 0x55, 0x73, 0x0D, 0x71, 0xB5, 0x75, 0xFE, 0xF8, 0x02, 0x61, 0x16, 0x9B, 0xB7,
+		0xFF, 0x7B, 0xA1, 0xB6, 0x31, 0x51, 0xB1, 0xA8, 0x7D, 0xE8, 0x84, 0xA1, 0x3B, 0x1E, 0x31, 0x8E,
+		0x3C, 0x7D, 0x66, 0x62, 0xEE, 0x8C, 0x2E, 0x35, 0xDD, 0xC8, 0x59, 0x26, 0xDB, 0xEB, 0xA6, 0x39,
+		0xFA, 0xA4, 0x45, 0x91, 0xAD, 0xE9, 0x47, 0x14, 0x7E, 0x50, 0x6E, 0x26, 0x58, 0x10, 0xC1, 0x82,
+		0x16, 0xEC, 0x56, 0xB0, 0x31, 0x99, 0x60, 0x92, 0x13, 0x38, 0x58, 0x0F, 0x3C, 0x13, 0x96, 0x36,
+		0x61, 0x0A, 0x10, 0x9B, 0x12, 0x51, 0x9C, 0x1A, 0xD1, 0x08, 0x16, 0xB0, 0x81, 0x03, 0x38, 0xE0,
+		0xD3, 0x93, 0xC3, 0xE9, 0x13, 0xD3, 0x3F, 0xB9, 0x53, 0xFB, 0x20, 0x15, 0x74, 0xF7, 0xF2, 0xAB,
+		0x47, 0x9E, 0x34, 0x39, 0x99, 0xDB, 0x71, 0xCE, 0x74, 0x9D, 0x5D, 0x57, 0x72, 0xA5, 0xA2, 0x64,
+		0xCF, 0xB9, 0x88, 0xAB, 0xA1, 0x7E, 0x74, 0xF3, 0xD5, 0x43, 0x2B, 0x4A, 0x1F, 0xEF, 0x0B, 0xB9,
+		0x87, 0x7D, 0x9D, 0x9E, 0x54, 0xA9, 0x7C, 0x5B, 0x7E, 0xB1, 0x6B, 0x47, 0xD1, 0xAA, 0xE6, 0xF2,
+		0x32, 0x73, 0xDF, 0xAE, 0x5A, 0xAD, 0xB6, 0x52, 0x76, 0xFF, 0x11, 0x15, 0xEB, 0x93, 0x82, 0x22,
+		0x5B, 0xD3, 0x8F, 0x78, 0xD8, 0x4E, 0xB6, 0x89, 0x60, 0xE1, 0x7F, 0x04, 0x63, 0xD3, 0xC1, 0xC2,
+		0x92, 0x1B, 0xD3, 0x83, 0xC8, 0xDB, 0x31, 0x7D, 0xB0, 0x13, 0xFC, 0xBF, 0x23, 0xEA, 0x93, 0xFF,
+		0x8B, 0xE8, 0xC7, 0x7F, 0x44, 0x14, 0x85, 0x74, 0x3C, 0x5F, 0x7A, 0x06, 0x14, 0x94, 0xDA, 0x42,
+		0x07, 0xF2, 0xB9, 0x40, 0x55, 0xD1, 0xCA, 0x78, 0x75, 0xD9, 0x92, 0xC2, 0x50, 0x2D, 0x1B, 0x39,
+		0xD2, 0xA6, 0xCC, 0xA9, 0xBB, 0xFB, 0x33, 0x74, 0x7C, 0xE0, 0xCB, 0x50, 0xFD, 0xD7, 0x77, 0xAE,
+		0x93, 0xB9, 0xFD, 0xD1, 0xD3, 0xF6, 0x17, 0xDA, 0x46, 0xCF, 0x83, 0x86, 0xE6, 0xEA, 0x5B, 0x89,
+		0xF3, 0x17, 0xAE, 0x79, 0x2F, 0x46, 0x2F, 0x75, 0xB5, 0xF6, 0x9E, 0x31, 0xB7, 0xFD, 0x02, 0xFA,
+		0x2F, 0x61, 0xEB, 0xB1, 0xEE, 0xBF, 0x79, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4E, 0x44, 0xAE,
+		0x42, 0x60, 0x82,
+	};
+
+	// 9x7 rgba, adam7 interlaced, every pass starts with another filter type
+	const unsigned char INTERLACED_PNG[] =
+	{
+		0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x48, 0x44, 0x52,
+		0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x07, 0x08, 0x06, 0x00, 0x00, 0x01, 0xAD, 0x9C, 0x57,
+		0xF6, 0x00, 0x00, 0x00, 0xCD, 0x49, 0x44, 0x41, 0x54, 0x78, 0x01, 0x63, 0x60, 0xF8, 0xCF, 0x70,
+		0xE2, 0xC7, 0x74, 0x86, 0x07, 0x8C, 0x35, 0xA7, 0x19, 0xAE, 0x30, 0xB9, 0x74, 0x33, 0x7C, 0x39,
+		0x10, 0x5E, 0xC0, 0x60, 0xA3, 0xFC, 0x80, 0x87, 0xD9, 0xEE, 0x29, 0xC3, 0xB9, 0xD9, 0xF6, 0x0C,
+		0xC5, 0x2C, 0x2E, 0x3D, 0x16, 0x3A, 0x2E, 0x67, 0x0A, 0x78, 0x58, 0x94, 0x8E, 0x32, 0xDC, 0xB3,
+		0x7B, 0x26, 0xC3, 0x86, 0x8C, 0x19, 0xD2, 0x02, 0x19, 0xB8, 0x96, 0x98, 0x87, 0x08, 0x3C, 0x92,
+		0x5D, 0x21, 0xA6, 0xC0, 0xFC, 0x47, 0x26, 0xEE, 0x65, 0x80, 0x12, 0x83, 0xFC, 0x27, 0x86, 0xD3,
+		0xB1, 0x37, 0x18, 0x2E, 0xCE, 0xDE, 0xC7, 0x70, 0xFD, 0xE6, 0x12, 0x86, 0xBB, 0x8C, 0x8E, 0x3B,
+		0xF8, 0x1E, 0x22, 0x6B, 0x63, 0x52, 0x3A, 0xC6, 0x27, 0xA6, 0x74, 0x4C, 0x0B, 0x88, 0xDD, 0x80,
+		0x38, 0x49, 0x8C, 0x39, 0x84, 0x55, 0x66, 0x92, 0xC1, 0x35, 0xFB, 0x3E, 0x83, 0x6B, 0xBE, 0x7C,
+		0x06, 0xD7, 0xA2, 0xF9, 0x18, 0x05, 0x1F, 0x31, 0x5C, 0x96, 0xFF, 0xCC, 0xCE, 0x8C, 0x0F, 0x03,
+		0x8D, 0x61, 0x10, 0x83, 0x18, 0x25, 0x03, 0x35, 0xCE, 0x02, 0x6A, 0x64, 0x08, 0xD8, 0x58, 0xA5,
+		0x63, 0x05, 0x62, 0xCC, 0x36, 0x52, 0x0C, 0xDD, 0x8A, 0x77, 0x25, 0x79, 0x15, 0xEF, 0x2A, 0xF4,
+		0x2A, 0xDE, 0x55, 0x07, 0x62, 0x3D, 0x20, 0x36, 0x05, 0x62, 0x1B, 0x20, 0x76, 0x06, 0x62, 0x2F,
+		0x5E, 0x00, 0x4B, 0xB3, 0x5A, 0x86, 0x03, 0xCC, 0x82, 0x43, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45,
+		0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82,
+	};
+
+	// 20x12, 4:2:0, the quantization tables are all 1 and the pixels are Ycc420
+	const unsigned char JPEG_420[] =
+	{
+		0xFF, 0xD8, 0xFF, 0xDB, 0x00, 0x43, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+		0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+		0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+		0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+		0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF, 0xC0, 0x00, 0x11, 0x08, 0x00, 0x0C, 0x00, 0x14,
+		0x03, 0x01, 0x22, 0x00, 0x02, 0x11, 0x00, 0x03, 0x11, 0x00, 0xFF, 0xC4, 0x00, 0x41, 0x00, 0x00,
+		0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06,
+		0x07, 0x08, 0x09, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x19, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x04, 0x05, 0x06, 0x07, 0x15, 0x16, 0x17, 0x24, 0x25, 0x34,
+		0x41, 0x42, 0x51, 0x52, 0x54, 0x61, 0x62, 0x64, 0x71, 0xA1, 0xA2, 0xD2, 0xE1, 0xFF, 0xDA, 0x00,
+		0x0C, 0x03, 0x01, 0x00, 0x02, 0x00, 0x03, 0x00, 0x00, 0x3F, 0x00, 0x33, 0x98, 0x29, 0x20, 0x54,
+		0x81, 0x68, 0x12, 0xA1, 0xE0, 0x68, 0x28, 0x11, 0x00, 0x1E, 0x00, 0x14, 0x90, 0x2A, 0x40, 0xB4,
+		0x09, 0x50, 0xF0, 0x34, 0x14, 0x08, 0x80, 0x04, 0x68, 0x29, 0x20, 0x46, 0xC0, 0xD2, 0x12, 0x81,
+		0x2E, 0x1E, 0x06, 0x40, 0x51, 0x10, 0x92, 0x00, 0x78, 0x00, 0x52, 0x40, 0x8D, 0x81, 0xA4, 0x25,
+		0x02, 0x5C, 0x3C, 0x0C, 0x80, 0xA2, 0x21, 0x24, 0x00, 0x87, 0xC0, 0x0E, 0x00, 0x00, 0x1B, 0x02,
+		0x26, 0x0A, 0x90, 0x28, 0x80, 0x4A, 0x12, 0xA1, 0xD0, 0xD0, 0x49, 0x01, 0x04, 0x40, 0x01, 0x20,
+		0x42, 0x41, 0x35, 0x16, 0x06, 0x00, 0x05, 0xD4, 0x08, 0x98, 0x23, 0x60, 0x69, 0x06, 0x20, 0x12,
+		0x84, 0xB8, 0x74, 0x32, 0x02, 0x87, 0xA0, 0x20, 0x92, 0x00, 0x12, 0x03, 0xB6, 0x06, 0x91, 0x07,
+		0x15, 0x80, 0xA2, 0xE8, 0x01, 0xE4, 0x00, 0x0C, 0xDE, 0x01, 0xFF, 0xD9,
+	};
+
+	// 11x9, 4:4:4 with a restart marker every two mcus, the pixels are Ycc444
+	const unsigned char JPEG_444[] =
+	{
+		0xFF, 0xD8, 0xFF, 0xDB, 0x00, 0x43, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+		0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+		0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+		0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+		0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF, 0xC0, 0x00, 0x11, 0x08, 0x00, 0x09, 0x00, 0x0B,
+		0x03, 0x01, 0x11, 0x00, 0x02, 0x11, 0x00, 0x03, 0x11, 0x00, 0xFF, 0xC4, 0x00, 0x46, 0x00, 0x00,
+		0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05,
+		0x06, 0x07, 0x08, 0x09, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1D, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x04, 0x05, 0x06, 0x07, 0x08, 0x23, 0x24, 0x25,
+		0x34, 0x35, 0x42, 0x43, 0x44, 0x45, 0x52, 0x53, 0x61, 0x62, 0x71, 0x73, 0x74, 0x82, 0x83, 0xB1,
+		0xB2, 0xC1, 0xFF, 0xDD, 0x00, 0x04, 0x00, 0x02, 0xFF, 0xDA, 0x00, 0x0C, 0x03, 0x01, 0x00, 0x02,
+		0x00, 0x03, 0x00, 0x00, 0x3F, 0x00, 0x23, 0xE0, 0xEB, 0x60, 0xEF, 0xE1, 0x8E, 0x09, 0x21, 0x24,
+		0x1C, 0xC5, 0x42, 0x60, 0x02, 0x5E, 0x0C, 0x90, 0x14, 0x80, 0xB5, 0x08, 0x22, 0x20, 0x6A, 0x2A,
+		0x00, 0x1E, 0x01, 0xA4, 0x83, 0x6D, 0x0B, 0x80, 0x9B, 0x11, 0x83, 0x71, 0x58, 0x9C, 0x01, 0x37,
+		0x20, 0xAD, 0x83, 0xBF, 0x85, 0x0C, 0x11, 0x81, 0x24, 0x1E, 0xC0, 0x48, 0x73, 0x14, 0x80, 0xA1,
+		0x30, 0x01, 0xFA, 0x82, 0x2C, 0x14, 0x80, 0xA7, 0x81, 0xA8, 0x41, 0x0E, 0x40, 0x20, 0xD4, 0x4E,
+		0x03, 0x00, 0x33, 0xB0, 0x48, 0x03, 0x6D, 0x09, 0xD0, 0x38, 0x09, 0xB0, 0xE8, 0x03, 0x0D, 0xC4,
+		0xC0, 0x21, 0x38, 0x07, 0xFF, 0xD0, 0x39, 0xC0, 0x75, 0xB1, 0x07, 0x0C, 0xA1, 0xC0, 0x00, 0x70,
+		0x19, 0x20, 0x7A, 0x8C, 0x03, 0x80, 0x03, 0x5F, 0x06, 0x92, 0x1F, 0x03, 0x10, 0xE4, 0x01, 0x37,
+		0x20, 0xAD, 0x86, 0x0C, 0x11, 0x82, 0xEC, 0x04, 0x8D, 0xC0, 0x50, 0x01, 0xFA, 0x82, 0x2C, 0x31,
+		0xE0, 0x6A, 0x2C, 0x80, 0x43, 0x50, 0x18, 0x01, 0x9D, 0x82, 0x40, 0x2F, 0x40, 0xE0, 0x5A, 0x00,
+		0xC6, 0x80, 0x20, 0x0F, 0xFF, 0xD9,
+	};
+
+	struct Reference
+	{
+		const char* name;
+		const unsigned char* data;
+		size_t size;
+		unsigned int width;
+		unsigned int height;
+	};
+
+	const Reference PNGS[] = {
+		{ "stored", STORED_PNG, sizeof(STORED_PNG), 8, 5 },
+		{ "fixed", FIXED_PNG, sizeof(FIXED_PNG), 8, 5 },
+		{ "dynamic", DYNAMIC_PNG, sizeof(DYNAMIC_PNG), 16, 16 },
+		{ "interlaced", INTERLACED_PNG, sizeof(INTERLACED_PNG), 9, 7 },
+	};
+
+	const Reference JPEGS[] = {
+		{ "4:2:0", JPEG_420, sizeof(JPEG_420), 20, 12 },
+		{ "4:4:4", JPEG_444, sizeof(JPEG_444), 11, 9 },
+	};
+
+	// rgb images have no alpha, it is 255 after decoding
+	unsigned char PngPixel(unsigned int x, unsigned int y, unsigned int channel, unsigned int nrOfChannels)
+	{
+		switch (channel)
+		{
+		case 0:
+			return (unsigned char)(x * 31 + y * 17);
+		case 1:
+			return (unsigned char)(255 - x * 13 - y * 29);
+		case 2:
+			return (unsigned char)(x * y * 7);
+		default:
+			return nrOfChannels == 3 ? 255 : (unsigned char)(200 + x * 3 + y * 11);
+		}
+	}
+
+	void Ycc420(unsigned int x, unsigned int y, float ycc[3])
+	{
+		ycc[0] = 40.0f + 6.0f * x + 5.0f * y;
+		ycc[1] = x < 16 ? 100.0f : 150.0f;
+		ycc[2] = x < 16 ? 160.0f : 110.0f;
+	}
+
+	void Ycc444(unsigned int x, unsigned int y, float ycc[3])
+	{
+		ycc[0] = 60.0f + 9.0f * x + 7.0f * y;
+		ycc[1] = 90.0f + 5.0f * x + 3.0f * y;
+		ycc[2] = 170.0f - 4.0f * x - 6.0f * y;
+	}
+
+	// the jfif conversion in floating point
+	void YccToRgb(const float ycc[3], int rgb[3])
+	{
+		float values[3] = {
+			ycc[0] + 1.402f * (ycc[2] - 128.0f),
+			ycc[0] - 0.344136f * (ycc[1] - 128.0f) - 0.714136f * (ycc[2] - 128.0f),
+			ycc[0] + 1.772f * (ycc[1] - 128.0f)
+		};
+		for (int i = 0; i < 3; i++)
+		{
+			rgb[i] = (int)lroundf(fminf(fmaxf(values[i], 0.0f), 255.0f));
+		}
+	}
+
+	// the zlib stream of the only IDAT chunk
+	std::vector<unsigned char> GetImageData(const Reference& png)
+	{
+		for (size_t pos = 8; pos + 12 <= png.size; )
+		{
+			size_t length = ((size_t)png.data[pos] << 24) | (png.data[pos + 1] << 16) | (png.data[pos + 2] << 8) | png.data[pos + 3];
+			if (memcmp(png.data + pos + 4, "IDAT", 4) == 0)
+			{
+				return std::vector<unsigned char>(png.data + pos + 8, png.data + pos + 8 + length);
+			}
+			pos += length + 12;
+		}
+		return std::vector<unsigned char>();
+	}
+
+	// offset of the first segment with the marker, the segments in front of the scan are walked by their lengths
+	size_t FindSegment(const unsigned char* jpeg, size_t size, unsigned char marker)
+	{
+		size_t pos = 2;
+		while (pos + 4 <= size && jpeg[pos + 1] != marker)
+		{
+			pos += 2 + ((jpeg[pos + 2] << 8) | jpeg[pos + 3]);
+		}
+		return pos;
+	}
+
+	// changed copies of a file have to be decoded or rejected without reading or writing outside of
+	// the buffers, a decoded image always has all of its pixels
+	int CountInconsistentResults(const ImageDecoder& decoder, const Reference& reference, std::mt19937& random, int nrOfCopies)
+	{
+		int inconsistent = 0;
+		for (int i = 0; i < nrOfCopies; i++)
+		{
+			std::vector<unsigned char> copy(reference.data, reference.data + reference.size);
+			int nrOfChanges = 1 + random() % 4;
+			for (int j = 0; j < nrOfChanges; j++)
+			{
+				copy[random() % copy.size()] = (unsigned char)random();
+			}
+
+			DecodedImage image;
+			if (decoder.Decode(copy.data(), copy.size(), image))
+			{
+				inconsistent += image.width == 0 || image.height == 0 || image.pixels.size() != image.GetRowPitch() * image.height;
+			}
+		}
+		return inconsistent;
+	}
+
+	// the three block types, every stream ends at the end of its last block and fails when it is cut short
+	void TestInflate()
+	{
+		const size_t rawSizes[] = { 5 * (1 + 8 * 3), 5 * (1 + 8 * 3), 16 * (1 + 16 * 4), 0 };
+		for (int i = 0; i < 3; i++)
+		{
+			std::vector<unsigned char> stream = GetImageData(PNGS[i]);
+			CHECK(stream.size() > 6);
+			// the type of the first block is in bits 1 and 2 after the zlib header
+			CHECK((unsigned int)((stream[2] >> 1) & 3) == (unsigned int)i);
+
+			std::vector<unsigned char> raw;
+			CHECK(Inflate::DecompressZlib(stream.data(), stream.size(), raw));
+			CHECK(raw.size() == rawSizes[i]);
+
+			// the adler-32 at the end is not checked, everything before it is needed
+			int decoded = 0;
+			for (size_t size = 0; size < stream.size() - 4; size++)
+			{
+				std::vector<unsigned char> out;
+				decoded += Inflate::DecompressZlib(stream.data(), size, out);
+			}
+			CHECK(decoded == 0);
+		}
+
+		std::vector<unsigned char> out;
+		const unsigned char reservedType[] = { 0x07, 0x00 };
+		const unsigned char wrongStoredLength[] = { 0x01, 0x05, 0x00, 0x00, 0x00, 'a', 'b', 'c', 'd', 'e' };
+		const unsigned char wrongCheck[] = { 0x78, 0x9D, 0x03, 0x00 };
+		const unsigned char presetDictionary[] = { 0x78, 0xBB, 0x03, 0x00 };
+		CHECK(!Inflate::Decompress(reservedType, sizeof(reservedType), out));
+		CHECK(!Inflate::Decompress(wrongStoredLength, sizeof(wrongStoredLength), out));
+		CHECK(!Inflate::DecompressZlib(wrongCheck, sizeof(wrongCheck), out));
+		CHECK(!Inflate::DecompressZlib(presetDictionary, sizeof(presetDictionary), out));
+
+		// an empty fixed block, and a stored block with the length and its complement
+		const unsigned char empty[] = { 0x78, 0x9C, 0x03, 0x00 };
+		const unsigned char storedBlock[] = { 0x01, 0x03, 0x00, 0xFC, 0xFF, 'a', 'b', 'c' };
+		std::vector<unsigned char> emptyOut;
+		std::vector<unsigned char> storedOut;
+		CHECK(Inflate::DecompressZlib(empty, sizeof(empty), emptyOut) && emptyOut.empty());
+		CHECK(Inflate::Decompress(storedBlock, sizeof(storedBlock), storedOut) && storedOut.size() == 3 && memcmp(storedOut.data(), "abc", 3) == 0);
+	}
+
+	void TestPng()
+	{
+		PngDecoder decoder;
+		for (size_t i = 0; i < sizeof(PNGS) / sizeof(PNGS[0]); i++)
+		{
+			const Reference& png = PNGS[i];
+			DecodedImage image;
+			CHECK(decoder.CanDecode(png.data, png.size));
+			CHECK(decoder.Decode(png.data, png.size, image));
+			CHECK(image.width == png.width && image.height == png.height && image.pixels.size() == (size_t)png.width * png.height * 4);
+			if (image.pixels.size() != (size_t)png.width * png.height * 4)
+			{
+				continue;
+			}
+
+			const unsigned int nrOfChannels = png.data[25] == 2 ? 3 : 4;
+			int wrong = 0;
+			for (unsigned int y = 0; y < png.height; y++)
+			{
+				for (unsigned int x = 0; x < png.width; x++)
+				{
+					for (unsigned int channel = 0; channel < 4; channel++)
+					{
+						wrong += image.pixels[(y * png.width + x) * 4 + channel] != PngPixel(x, y, channel, nrOfChannels);
+					}
+				}
+			}
+			if (wrong > 0)
+			{
+				printf("png %s: %d wrong channels\n", png.name, wrong);
+			}
+			CHECK(wrong == 0);
+
+			// cut off anywhere before the end of the image data
+			const size_t imageEnd = png.size - 12;
+			int decoded = 0;
+			for (size_t size = 0; size < imageEnd; size++)
+			{
+				decoded += decoder.Decode(png.data, size, image);
+			}
+			CHECK(decoded == 0);
+		}
+
+		// broken headers and image data of the stored image, where the filter types can be changed directly
+		struct Change
+		{
+			const char* name;
+			size_t offset;
+			unsigned char value;
+		};
+		const size_t header = 16;
+		const size_t firstRow = 8 + 12 + 13 + 8 + 2 + 5;
+		const Change changes[] = {
+			{ "signature", 1, 'Q' },
+			{ "bit depth", header + 8, 3 },
+			{ "color type", header + 9, 5 },
+			{ "compression method", header + 10, 1 },
+			{ "filter method", header + 11, 1 },
+			{ "interlace method", header + 12, 2 },
+			{ "zero width", header + 3, 0 },
+			{ "filter type", firstRow, 5 },
+			{ "zlib header", firstRow - 7, 0x79 },
+			{ "stored length", firstRow - 4, 0x7E },
+		};
+		CHECK(STORED_PNG[header + 3] == 8 && STORED_PNG[firstRow] == 0);
+		for (size_t i = 0; i < sizeof(changes) / sizeof(changes[0]); i++)
+		{
+			std::vector<unsigned char> copy(STORED_PNG, STORED_PNG + sizeof(STORED_PNG));
+			copy[changes[i].offset] = changes[i].value;
+			DecodedImage image;
+			bool decoded = decoder.Decode(copy.data(), copy.size(), image);
+			if (decoded)
+			{
+				printf("png with a broken %s was decoded\n", changes[i].name);
+			}
+			CHECK(!decoded && image.pixels.empty());
+		}
+
+		std::mt19937 random(1);
+		for (size_t i = 0; i < sizeof(PNGS) / sizeof(PNGS[0]); i++)
+		{
+			CHECK(CountInconsistentResults(decoder, PNGS[i], random, 2000) == 0);
+		}
+	}
+
+	void TestJpeg()
+	{
+		JpegDecoder decoder;
+		for (size_t i = 0; i < sizeof(JPEGS) / sizeof(JPEGS[0]); i++)
+		{
+			const Reference& jpeg = JPEGS[i];
+			DecodedImage image;
+			CHECK(decoder.CanDecode(jpeg.data, jpeg.size));
+			CHECK(decoder.Decode(jpeg.data, jpeg.size, image));
+			CHECK(image.width == jpeg.width && image.height == jpeg.height && image.pixels.size() == (size_t)jpeg.width * jpeg.height * 4);
+			if (image.pixels.size() != (size_t)jpeg.width * jpeg.height * 4)
+			{
+				continue;
+			}
+
+			// the quantization is lossless, only the rounding of the dct and the color conversion is left
+			int wrong = 0;
+			int maxDifference = 0;
+			for (unsigned int y = 0; y < jpeg.height; y++)
+			{
+				for (unsigned int x = 0; x < jpeg.width; x++)
+				{
+					float ycc[3];
+					int rgb[3];
+					if (i == 0)
+					{
+						Ycc420(x, y, ycc);
+					}
+					else
+					{
+						Ycc444(x, y, ycc);
+					}
+					YccToRgb(ycc, rgb);
+
+					const unsigned char* pixel = image.pixels.data() + (y * jpeg.width + x) * 4;
+					for (int channel = 0; channel < 3; channel++)
+					{
+						int difference = abs(pixel[channel] - rgb[channel]);
+						maxDifference = difference > maxDifference ? difference : maxDifference;
+						wrong += difference > 2;
+					}
+					wrong += pixel[3] != 255;
+				}
+			}
+			if (wrong > 0)
+			{
+				printf("jpeg %s: %d wrong channels, up to %d off\n", jpeg.name, wrong, maxDifference);
+			}
+			CHECK(wrong == 0);
+
+			// without the end of the entropy coded data the file was cut off
+			int decoded = 0;
+			for (size_t size = 0; size < jpeg.size; size++)
+			{
+				decoded += decoder.Decode(jpeg.data, size, image);
+			}
+			CHECK(decoded == 0);
+		}
+
+		// broken segments of the 4:2:0 image: quantization table, frame, huffman tables and scan header
+		struct Change
+		{
+			const char* name;
+			size_t offset;
+			unsigned char value;
+		};
+		const size_t frame = FindSegment(JPEG_420, sizeof(JPEG_420), 0xC0);
+		const size_t huffmanTables = FindSegment(JPEG_420, sizeof(JPEG_420), 0xC4);
+		const size_t scan = FindSegment(JPEG_420, sizeof(JPEG_420), 0xDA);
+		const Change changes[] = {
+			{ "quantization table id", FindSegment(JPEG_420, sizeof(JPEG_420), 0xDB) + 4, 0x04 },
+			{ "progressive frame", frame + 1, 0xC2 },
+			{ "sample precision", frame + 4, 12 },
+			{ "number of components", frame + 9, 2 },
+			{ "sampling factor", frame + 11, 0x52 },
+			{ "huffman table class", huffmanTables + 4, 0x20 },
+			{ "huffman code lengths", huffmanTables + 5, 0x10 },
+			{ "scan component", scan + 5, 7 },
+			{ "scan huffman table", scan + 6, 0x11 },
+			{ "spectral selection", scan + 11, 5 },
+		};
+		for (size_t i = 0; i < sizeof(changes) / sizeof(changes[0]); i++)
+		{
+			std::vector<unsigned char> copy(JPEG_420, JPEG_420 + sizeof(JPEG_420));
+			copy[changes[i].offset] = changes[i].value;
+			DecodedImage image;
+			bool decoded = decoder.Decode(copy.data(), copy.size(), image);
+			if (decoded)
+			{
+				printf("jpeg with a broken %s was decoded\n", changes[i].name);
+			}
+			CHECK(!decoded);
+		}
+
+		std::mt19937 random(1);
+		for (size_t i = 0; i < sizeof(JPEGS) / sizeof(JPEGS[0]); i++)
+		{
+			CHECK(CountInconsistentResults(decoder, JPEGS[i], random, 2000) == 0);
+		}
+	}
+}
+
+int main()
+{
+	TestInflate();
+	TestPng();
+	TestJpeg();
+	return TestResult();
+}
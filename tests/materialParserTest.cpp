@@ -0,0 +1,88 @@
+#include "test.h"
+#include "materialParser.h"
+#include "mappedFile.h"
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+namespace
+{
+	bool Exists(const std::string& path)
+	{
+		MappedFile file;
+		return file.Open(path);
+	}
+
+	void MakeDirectory(const std::string& path)
+	{
+#ifdef _WIN32
+		_mkdir(path.c_str());
+#else
+		mkdir(path.c_str(), 0755);
+#endif
+	}
+
+	// the textures of the shipped materials are found next to them
+	void TestShippedMaterials()
+	{
+		std::vector<std::string> textures;
+		CHECK(MaterialParser::Parse(OBJECTS_DIR "piedmon.mtl", textures));
+		CHECK(textures.size() == 1 && textures[0] == OBJECTS_DIR "piedmon.png" && Exists(textures[0]));
+
+		CHECK(MaterialParser::Parse(OBJECTS_DIR "dummy_obj.mtl", textures));
+		CHECK(textures.size() == 1 && textures[0] == OBJECTS_DIR "dummy_wood.jpg");
+
+		// the animated texture, its frames are written with a leading slash
+		CHECK(MaterialParser::Parse(OBJECTS_DIR "box.mtl", textures));
+		CHECK(textures.size() == 105);
+		CHECK(textures[0] == OBJECTS_DIR "bindless/0001.png" && textures[104] == OBJECTS_DIR "bindless/0105.png");
+		bool allExist = true;
+		for (size_t i = 0; i < textures.size(); i++)
+		{
+			allExist = allExist && Exists(textures[i]);
+		}
+		CHECK(allExist);
+
+		CHECK(!MaterialParser::Parse(OBJECTS_DIR "missing.mtl", textures));
+		CHECK(textures.empty());
+	}
+
+	// a material somewhere else does not look in the objects folder
+	void TestOtherDirectory()
+	{
+		MakeDirectory("materials");
+		{
+			std::ofstream file("materials/crate.mtl", std::ios::binary);
+			file << "newmtl crate\r\n\tmap_Kd  crate.png \r\nmap_Ks specular.png\r\nmap_Kd frames/0001 a.png\n\nmap_Kd\n";
+		}
+		std::vector<std::string> textures;
+		CHECK(MaterialParser::Parse("materials/crate.mtl", textures));
+		CHECK(textures.size() == 2 && textures[0] == "materials/crate.png" && textures[1] == "materials/frames/0001 a.png");
+
+		// windows paths use either slash
+		const char text[] = "map_Kd crate.png";
+		CHECK(MaterialParser::ParseBuffer("materials\\crate.mtl", text, sizeof(text) - 1, textures));
+		CHECK(textures.size() == 1 && textures[0] == "materials\\crate.png");
+	}
+
+	void TestResolvePath()
+	{
+		CHECK(MaterialParser::ResolvePath("../objects/box.mtl", "box.jpg") == "../objects/box.jpg");
+		CHECK(MaterialParser::ResolvePath("../objects/box.mtl", "/bindless/0001.png") == "../objects/bindless/0001.png");
+		CHECK(MaterialParser::ResolvePath("box.mtl", "box.jpg") == "box.jpg");
+		CHECK(MaterialParser::ResolvePath("textures/box.mtl", "../shared/box.jpg") == "textures/../shared/box.jpg");
+		CHECK(MaterialParser::ResolvePath("textures/box.mtl", "C:\\textures\\box.jpg") == "C:\\textures\\box.jpg");
+	}
+}
+
+int main()
+{
+	TestShippedMaterials();
+	TestOtherDirectory();
+	TestResolvePath();
+	return TestResult();
+}
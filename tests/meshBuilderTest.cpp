@@ -0,0 +1,151 @@
+#include "test.h"
+#include "meshBuilder.h"
+#include <set>
+#include <tuple>
+#include <string>
+#include <stdio.h>
+
+namespace
+{
+	// what the mesh builder should make of the shipped objects, a vertex per unique v/vt/vn triple
+	struct ShippedObject
+	{
+		const char* name;
+		size_t nrOfVertices;
+		size_t nrOfIndices;
+	};
+
+	const ShippedObject shippedObjects[] = {
+		{ "box.obj", 24, 36 },
+		{ "dummy_obj.obj", 16119, 86148 },
+		{ "dummy_obj_fixed.obj", 15894, 86148 },
+		{ "piedmon.obj", 4376, 17604 },
+		{ "piedmonGif.obj", 4376, 17604 },
+	};
+
+	// the vertex an index points to has the attributes of the corner it came from
+	size_t CountWrongCorners(const ObjMeshData& obj, const IndexedMesh& mesh)
+	{
+		size_t wrong = 0;
+		for (size_t i = 0; i < obj.corners.size(); i++)
+		{
+			const ObjCorner& corner = obj.corners[i];
+			unsigned int vertex = mesh.indices[i];
+			for (int k = 0; k < 3; k++)
+			{
+				wrong += mesh.positions[vertex * 3 + k] != obj.positions[corner.position * 3 + k];
+				wrong += mesh.normals[vertex * 3 + k] != (corner.normal >= 0 ? obj.normals[corner.normal * 3 + k] : 0.0f);
+			}
+			for (int k = 0; k < 2; k++)
+			{
+				wrong += mesh.uvs[vertex * 2 + k] != (corner.uv >= 0 ? obj.uvs[corner.uv * 2 + k] : 0.0f);
+			}
+		}
+		return wrong;
+	}
+
+	void TestSmallMesh()
+	{
+		// a quad and a triangle that shares two of its corners, one of them with another uv
+		const std::string text =
+			"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 2 2 2\n"
+			"vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\nvt 0.5 0.5\n"
+			"vn 0 0 1\n"
+			"f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+			"f 3/3/1 2/5/1 5\n";
+
+		ObjParser parser;
+		ObjMeshData obj;
+		CHECK(parser.ParseBuffer(text.data(), text.size(), obj));
+
+		IndexedMesh mesh;
+		MeshBuilder::BuildIndexedMesh(obj, mesh);
+		CHECK(mesh.GetNrOfVertices() == 6);
+		CHECK(mesh.GetNrOfIndices() == 9);
+		const unsigned int indices[] = { 0, 1, 2, 0, 2, 3, 2, 4, 5 };
+		for (int i = 0; i < 9; i++)
+		{
+			CHECK(mesh.indices[i] == indices[i]);
+		}
+		CHECK(CountWrongCorners(obj, mesh) == 0);
+
+		// the corner without uv and normal gets zeroes
+		CHECK(mesh.uvs[10] == 0.0f && mesh.uvs[11] == 0.0f && mesh.normals[17] == 0.0f);
+
+		float boundsMin[3], boundsMax[3];
+		mesh.GetBounds(boundsMin, boundsMax);
+		CHECK(boundsMin[0] == 0.0f && boundsMin[1] == 0.0f && boundsMin[2] == 0.0f);
+		CHECK(boundsMax[0] == 2.0f && boundsMax[1] == 2.0f && boundsMax[2] == 2.0f);
+
+		std::vector<unsigned short> indices16;
+		CHECK(mesh.CanUse16BitIndices());
+		mesh.GetIndices16(indices16);
+		CHECK(indices16.size() == 9 && indices16[8] == 5);
+	}
+
+	void TestLargeMesh()
+	{
+		// a strip of 70000 positions is more than 16-bit indices can address
+		ObjMeshData obj;
+		const int nrOfPositions = 70000;
+		for (int i = 0; i < nrOfPositions; i++)
+		{
+			obj.positions.push_back((float)(i / 2));
+			obj.positions.push_back((float)(i % 2));
+			obj.positions.push_back(0.0f);
+		}
+		for (int i = 0; i + 2 < nrOfPositions; i++)
+		{
+			obj.corners.push_back({ i, -1, -1 });
+			obj.corners.push_back({ i + 1, -1, -1 });
+			obj.corners.push_back({ i + 2, -1, -1 });
+		}
+
+		IndexedMesh mesh;
+		MeshBuilder::BuildIndexedMesh(obj, mesh);
+		CHECK(mesh.GetNrOfVertices() == nrOfPositions);
+		CHECK(mesh.GetNrOfIndices() == obj.corners.size());
+		CHECK(!mesh.CanUse16BitIndices());
+		CHECK(CountWrongCorners(obj, mesh) == 0);
+	}
+
+	void TestShippedObjects()
+	{
+		for (size_t i = 0; i < sizeof(shippedObjects) / sizeof(shippedObjects[0]); i++)
+		{
+			const ShippedObject& expected = shippedObjects[i];
+			ObjParser parser;
+			ObjMeshData obj;
+			CHECK(parser.Parse(std::string(OBJECTS_DIR) + expected.name, obj));
+
+			IndexedMesh mesh;
+			MeshBuilder::BuildIndexedMesh(obj, mesh);
+			CHECK(mesh.GetNrOfVertices() == expected.nrOfVertices);
+			CHECK(mesh.GetNrOfIndices() == expected.nrOfIndices);
+			CHECK(mesh.CanUse16BitIndices());
+			CHECK(CountWrongCorners(obj, mesh) == 0);
+
+			// no triple is stored twice
+			std::set<std::tuple<int, int, int>> triples;
+			for (size_t j = 0; j < obj.corners.size(); j++)
+			{
+				triples.insert(std::make_tuple(obj.corners[j].position, obj.corners[j].uv, obj.corners[j].normal));
+			}
+			CHECK(triples.size() == mesh.GetNrOfVertices());
+
+			// position, uv and normal per vertex, against a vertex per corner before
+			size_t expandedBytes = obj.corners.size() * 8 * sizeof(float);
+			size_t indexedBytes = mesh.GetNrOfVertices() * 8 * sizeof(float) + mesh.GetNrOfIndices() * sizeof(unsigned short);
+			printf("%s: %zu corners -> %zu vertices (%.2fx), %zu KB -> %zu KB\n", expected.name, obj.corners.size(),
+				mesh.GetNrOfVertices(), (double)obj.corners.size() / mesh.GetNrOfVertices(), expandedBytes / 1024, indexedBytes / 1024);
+		}
+	}
+}
+
+int main()
+{
+	TestSmallMesh();
+	TestLargeMesh();
+	TestShippedObjects();
+	return TestResult();
+}
@@ -0,0 +1,295 @@
+#include "test.h"
+#include "meshCache.h"
+#include "vertexCacheOptimizer.h"
+#include <filesystem>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+
+namespace
+{
+	const char* shippedObjects[] = { "box.obj", "dummy_obj.obj", "dummy_obj_fixed.obj", "piedmon.obj", "piedmonGif.obj" };
+
+	// what Mesh::LoadData does without a cooked file
+	bool LoadText(const std::string& path, IndexedMesh& mesh, std::string& materialLib)
+	{
+		ObjParser parser;
+		ObjMeshData obj;
+		if (!parser.Parse(path, obj))
+		{
+			return false;
+		}
+		materialLib = obj.materialLib;
+		MeshBuilder::BuildIndexedMesh(obj, mesh);
+		VertexCacheOptimizer::Optimize(mesh);
+		return true;
+	}
+
+	// the tests work on copies in the build folder, the cooked files are written next to them
+	std::string CopyObject(const char* name)
+	{
+		std::string path = std::string("meshCacheTest_") + name;
+		std::filesystem::copy_file(std::string(OBJECTS_DIR) + name, path, std::filesystem::copy_options::overwrite_existing);
+		std::filesystem::remove(MeshCache::GetCookedPath(path));
+		return path;
+	}
+
+	void WriteBytes(const std::string& path, unsigned long long offset, const void* data, size_t size)
+	{
+		FILE* file = fopen(path.c_str(), "r+b");
+		CHECK(file != NULL);
+		if (file != NULL)
+		{
+			CHECK(fseek(file, (long)offset, SEEK_SET) == 0);
+			CHECK(fwrite(data, 1, size, file) == size);
+			fclose(file);
+		}
+	}
+
+	void MoveModificationTime(const std::string& path, int hours)
+	{
+		std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::hours(hours));
+	}
+
+	bool SameMesh(const CookedMesh& cooked, const IndexedMesh& mesh, const std::string& materialLib)
+	{
+		if (cooked.GetNrOfVertices() != mesh.GetNrOfVertices() || cooked.GetNrOfIndices() != mesh.GetNrOfIndices() ||
+			cooked.GetIndexSize() != (mesh.CanUse16BitIndices() ? 2u : 4u) || materialLib != cooked.GetMaterials()[0].materialLib)
+		{
+			return false;
+		}
+
+		float boundsMin[3], boundsMax[3];
+		mesh.GetBounds(boundsMin, boundsMax);
+		bool same = memcmp(boundsMin, cooked.GetHeader()->boundsMin, sizeof(boundsMin)) == 0;
+		same = same && memcmp(boundsMax, cooked.GetHeader()->boundsMax, sizeof(boundsMax)) == 0;
+		same = same && memcmp(mesh.positions.data(), cooked.GetPositions(), mesh.positions.size() * sizeof(float)) == 0;
+		same = same && memcmp(mesh.uvs.data(), cooked.GetUVs(), mesh.uvs.size() * sizeof(float)) == 0;
+		same = same && memcmp(mesh.normals.data(), cooked.GetNormals(), mesh.normals.size() * sizeof(float)) == 0;
+		if (cooked.GetIndexSize() == 2)
+		{
+			std::vector<unsigned short> indices16;
+			mesh.GetIndices16(indices16);
+			same = same && memcmp(indices16.data(), cooked.GetIndices(), indices16.size() * sizeof(unsigned short)) == 0;
+		}
+		else
+		{
+			same = same && memcmp(mesh.indices.data(), cooked.GetIndices(), mesh.indices.size() * sizeof(unsigned int)) == 0;
+		}
+		return same;
+	}
+
+	void TestRoundTrip()
+	{
+		std::string path = CopyObject("piedmon.obj");
+		CookedMesh cooked;
+		CHECK(!MeshCache::Load(path, cooked));
+
+		IndexedMesh mesh;
+		std::string materialLib;
+		CHECK(LoadText(path, mesh, materialLib));
+		CHECK(MeshCache::Cook(path, mesh, materialLib));
+		CHECK(MeshCache::Load(path, cooked));
+		CHECK(SameMesh(cooked, mesh, materialLib));
+
+		// every section starts on 16 bytes
+		const CookedMeshHeader* header = cooked.GetHeader();
+		CHECK(header->version == COOKED_MESH_VERSION && header->cookerVersion == MESH_COOKER_VERSION);
+		CHECK(header->positionsOffset % 16 == 0 && header->uvsOffset % 16 == 0 && header->normalsOffset % 16 == 0);
+		CHECK(header->indicesOffset % 16 == 0 && header->materialsOffset % 16 == 0);
+		CHECK(header->fileSize == std::filesystem::file_size(MeshCache::GetCookedPath(path)));
+		cooked.Close();
+
+		// a mesh that needs 32-bit indices
+		IndexedMesh large;
+		for (unsigned int i = 0; i < 70000; i++)
+		{
+			large.positions.insert(large.positions.end(), { (float)i, 0.0f, 0.0f });
+			large.uvs.insert(large.uvs.end(), { 0.0f, 0.0f });
+			large.normals.insert(large.normals.end(), { 0.0f, 1.0f, 0.0f });
+		}
+		for (unsigned int i = 0; i + 2 < 70000; i++)
+		{
+			large.indices.insert(large.indices.end(), { i, i + 1, i + 2 });
+		}
+		CHECK(MeshCache::Cook(path, large, "large.mtl"));
+		CHECK(MeshCache::Load(path, cooked));
+		CHECK(cooked.GetIndexSize() == 4);
+		CHECK(SameMesh(cooked, large, "large.mtl"));
+	}
+
+	void TestSourceChanges()
+	{
+		std::string path = CopyObject("box.obj");
+		std::string cookedPath = MeshCache::GetCookedPath(path);
+		IndexedMesh mesh;
+		std::string materialLib;
+		CHECK(LoadText(path, mesh, materialLib));
+		CHECK(MeshCache::Cook(path, mesh, materialLib));
+
+		// only the time changed, the cooked file is still used and gets the new time
+		MoveModificationTime(path, -1);
+		unsigned long long size;
+		long long modified;
+		CHECK(MeshCache::GetFileInfo(path, size, modified));
+		CookedMesh cooked;
+		CHECK(MeshCache::Load(path, cooked));
+		CHECK(cooked.GetHeader() != nullptr && cooked.GetHeader()->sourceModified == modified);
+		CHECK(SameMesh(cooked, mesh, materialLib));
+		cooked.Close();
+
+		// the same size with other content
+		WriteBytes(path, 0, "X", 1);
+		MoveModificationTime(path, -2);
+		CHECK(!MeshCache::Load(path, cooked));
+		CHECK(cooked.GetHeader() == nullptr);
+
+		// another size
+		CHECK(MeshCache::Cook(path, mesh, materialLib));
+		std::filesystem::resize_file(path, std::filesystem::file_size(path) + 1);
+		CHECK(!MeshCache::Load(path, cooked));
+
+		// without the source the cooked file is all there is
+		CHECK(MeshCache::Cook(path, mesh, materialLib));
+		std::filesystem::remove(path);
+		CHECK(MeshCache::Load(path, cooked));
+		cooked.Close();
+		std::filesystem::remove(cookedPath);
+		CHECK(!MeshCache::Load(path, cooked));
+	}
+
+	void TestBrokenCookedFiles()
+	{
+		std::string path = CopyObject("box.obj");
+		std::string cookedPath = MeshCache::GetCookedPath(path);
+		IndexedMesh mesh;
+		std::string materialLib;
+		CHECK(LoadText(path, mesh, materialLib));
+
+		const unsigned int oldVersion = COOKED_MESH_VERSION - 1;
+		const unsigned int oldCookerVersion = MESH_COOKER_VERSION + 1;
+		const unsigned int noMaterials = 0;
+		const unsigned long long outside = 1ull << 40;
+		// the end of the positions wraps around to a small number
+		const unsigned long long wrapping = ~0ull - 15;
+		const char noMagic[4] = {};
+		char longName[sizeof(CookedMaterial)];
+		memset(longName, 'a', sizeof(longName));
+
+		// every change makes Open fail
+		struct Change
+		{
+			size_t offset;
+			const void* data;
+			size_t size;
+		};
+		const Change changes[] = {
+			{ offsetof(CookedMeshHeader, magic), noMagic, sizeof(noMagic) },
+			{ offsetof(CookedMeshHeader, version), &oldVersion, sizeof(oldVersion) },
+			{ offsetof(CookedMeshHeader, cookerVersion), &oldCookerVersion, sizeof(oldCookerVersion) },
+			{ offsetof(CookedMeshHeader, nrOfMaterials), &noMaterials, sizeof(noMaterials) },
+			{ offsetof(CookedMeshHeader, indicesOffset), &outside, sizeof(outside) },
+			{ offsetof(CookedMeshHeader, materialsOffset), &outside, sizeof(outside) },
+			{ offsetof(CookedMeshHeader, positionsOffset), &wrapping, sizeof(wrapping) },
+		};
+
+		CookedMesh cooked;
+		for (size_t i = 0; i < sizeof(changes) / sizeof(changes[0]); i++)
+		{
+			CHECK(MeshCache::Cook(path, mesh, materialLib));
+			CHECK(MeshCache::Load(path, cooked));
+			cooked.Close();
+
+			WriteBytes(cookedPath, changes[i].offset, changes[i].data, changes[i].size);
+			CHECK(!MeshCache::Load(path, cooked));
+			CHECK(!cooked.Open(cookedPath));
+		}
+
+		// a material name that does not end
+		CHECK(MeshCache::Cook(path, mesh, materialLib));
+		CHECK(cooked.Open(cookedPath));
+		unsigned long long materialsOffset = cooked.GetHeader()->materialsOffset;
+		cooked.Close();
+		WriteBytes(cookedPath, materialsOffset, longName, sizeof(longName));
+		CHECK(!cooked.Open(cookedPath));
+
+		// a section that does not start on its boundary
+		CHECK(MeshCache::Cook(path, mesh, materialLib));
+		CHECK(cooked.Open(cookedPath));
+		unsigned long long misaligned = cooked.GetHeader()->uvsOffset + 4;
+		cooked.Close();
+		WriteBytes(cookedPath, offsetof(CookedMeshHeader, uvsOffset), &misaligned, sizeof(misaligned));
+		CHECK(!cooked.Open(cookedPath));
+
+		// an index past the last vertex, in the last index of the file
+		CHECK(MeshCache::Cook(path, mesh, materialLib));
+		CHECK(cooked.Open(cookedPath));
+		unsigned int indexSize = cooked.GetIndexSize();
+		unsigned long long lastIndex = cooked.GetHeader()->indicesOffset + (cooked.GetNrOfIndices() - 1ull) * indexSize;
+		unsigned int pastTheEnd = cooked.GetNrOfVertices();
+		cooked.Close();
+		WriteBytes(cookedPath, lastIndex, &pastTheEnd, indexSize);
+		CHECK(!cooked.Open(cookedPath));
+
+		// a file that is longer or shorter than the header says
+		CHECK(MeshCache::Cook(path, mesh, materialLib));
+		unsigned long long fileSize = std::filesystem::file_size(cookedPath);
+		std::filesystem::resize_file(cookedPath, fileSize + 1);
+		CHECK(!cooked.Open(cookedPath));
+		std::filesystem::resize_file(cookedPath, fileSize - 1);
+		CHECK(!cooked.Open(cookedPath));
+		std::filesystem::resize_file(cookedPath, sizeof(CookedMeshHeader) - 1);
+		CHECK(!cooked.Open(cookedPath));
+	}
+
+	// the text path against the cooked one for every shipped object, the way Mesh::LoadData takes them
+	void TestLoadTimes()
+	{
+		const int runs = 5;
+		double totalText = 0.0, totalCooked = 0.0;
+		for (size_t i = 0; i < sizeof(shippedObjects) / sizeof(shippedObjects[0]); i++)
+		{
+			std::string path = CopyObject(shippedObjects[i]);
+
+			double textTime = 0.0;
+			IndexedMesh mesh;
+			std::string materialLib;
+			for (int run = 0; run < runs; run++)
+			{
+				std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+				CHECK(LoadText(path, mesh, materialLib));
+				textTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			}
+			CHECK(MeshCache::Cook(path, mesh, materialLib));
+
+			double cookedTime = 0.0;
+			for (int run = 0; run < runs; run++)
+			{
+				std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+				CookedMesh cooked;
+				CHECK(MeshCache::Load(path, cooked));
+				cookedTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+				CHECK(SameMesh(cooked, mesh, materialLib));
+			}
+
+			textTime /= runs;
+			cookedTime /= runs;
+			totalText += textTime;
+			totalCooked += cookedTime;
+			printf("%s: text %.3f ms, cooked %.3f ms (%.1fx)\n", shippedObjects[i], textTime, cookedTime, textTime / cookedTime);
+		}
+		printf("All shipped objects: text %.3f ms, cooked %.3f ms (%.1fx)\n", totalText, totalCooked, totalText / totalCooked);
+	}
+}
+
+int main()
+{
+	TestRoundTrip();
+	TestSourceChanges();
+	TestBrokenCookedFiles();
+	TestLoadTimes();
+	return TestResult();
+}
@@ -0,0 +1,207 @@
+#include "test.h"
+#include "mipGenerator.h"
+#include <vector>
+#include <random>
+#include <chrono>
+#include <stdio.h>
+
+namespace
+{
+	// the source columns or rows of a pixel of the next level, the last pixel of an odd size takes three
+	unsigned int GetTaps(unsigned int size, unsigned int position, unsigned int taps[3])
+	{
+		if (size == 1)
+		{
+			taps[0] = 0;
+			return 1;
+		}
+		unsigned int nrOfTaps = size % 2 == 1 && position == size / 2 - 1 ? 3 : 2;
+		for (unsigned int i = 0; i < nrOfTaps; i++)
+		{
+			taps[i] = 2 * position + i;
+		}
+		return nrOfTaps;
+	}
+
+	// the filter written out a pixel at a time, what Downsample is checked against
+	void DownsampleReference(const unsigned char* source, unsigned int width, unsigned int height, size_t sourcePitch,
+		unsigned char* destination, size_t destinationPitch)
+	{
+		for (unsigned int y = 0; y < MipGenerator::GetMipSize(height, 1); y++)
+		{
+			unsigned int rows[3];
+			unsigned int nrOfRows = GetTaps(height, y, rows);
+			for (unsigned int x = 0; x < MipGenerator::GetMipSize(width, 1); x++)
+			{
+				unsigned int columns[3];
+				unsigned int nrOfColumns = GetTaps(width, x, columns);
+				unsigned int count = nrOfRows * nrOfColumns;
+				for (int channel = 0; channel < 4; channel++)
+				{
+					unsigned int sum = 0;
+					for (unsigned int r = 0; r < nrOfRows; r++)
+					{
+						for (unsigned int c = 0; c < nrOfColumns; c++)
+						{
+							sum += source[rows[r] * sourcePitch + columns[c] * 4 + channel];
+						}
+					}
+					destination[y * destinationPitch + x * 4 + channel] = (unsigned char)((sum + count / 2) / count);
+				}
+			}
+		}
+	}
+
+	// a whole chain, level after level in one buffer
+	template<typename DownsampleFunction>
+	void MakeChain(const std::vector<unsigned char>& image, unsigned int width, unsigned int height,
+		std::vector<unsigned char>& chain, DownsampleFunction downsample)
+	{
+		chain.clear();
+		chain.insert(chain.end(), image.begin(), image.end());
+		size_t level = 0;
+		for (unsigned int mip = 1; mip < MipGenerator::GetNrOfMips(width, height); mip++)
+		{
+			unsigned int sourceWidth = MipGenerator::GetMipSize(width, mip - 1);
+			unsigned int sourceHeight = MipGenerator::GetMipSize(height, mip - 1);
+			size_t next = chain.size();
+			chain.resize(next + (size_t)MipGenerator::GetMipSize(width, mip) * MipGenerator::GetMipSize(height, mip) * 4);
+			downsample(chain.data() + level, sourceWidth, sourceHeight, (size_t)sourceWidth * 4, chain.data() + next,
+				(size_t)MipGenerator::GetMipSize(width, mip) * 4);
+			level = next;
+		}
+	}
+
+	// the number and sizes of the levels of the textures in the objects folder
+	void TestSizes()
+	{
+		CHECK(MipGenerator::GetNrOfMips(1, 1) == 1);
+		CHECK(MipGenerator::GetNrOfMips(2048, 2048) == 12 && MipGenerator::GetNrOfMips(1067, 1067) == 11);
+		CHECK(MipGenerator::GetNrOfMips(640, 360) == 10 && MipGenerator::GetNrOfMips(800, 1000) == 10);
+		CHECK(MipGenerator::GetMipSize(1067, 1) == 533 && MipGenerator::GetMipSize(360, 8) == 1);
+		CHECK(MipGenerator::GetMipSize(360, 9) == 1 && MipGenerator::GetMipSize(640, 9) == 1);
+	}
+
+	// 2x2 to the rounded average, a 3x3 image is a single pixel with all nine in it, a 1x2 averages the two
+	void TestKnownAverages()
+	{
+		unsigned char square[16] = { 0, 10, 255, 1, 1, 20, 255, 2, 2, 30, 255, 3, 3, 41, 255, 4 };
+		unsigned char pixel[4];
+		MipGenerator::Downsample(square, 2, 2, 8, pixel, 4);
+		CHECK(pixel[0] == 2 && pixel[1] == 25 && pixel[2] == 255 && pixel[3] == 3);
+
+		unsigned char nine[36];
+		for (int i = 0; i < 9; i++)
+		{
+			nine[i * 4] = (unsigned char)(i * 10);
+			nine[i * 4 + 1] = 0;
+			nine[i * 4 + 2] = i == 8 ? 90 : 0;
+			nine[i * 4 + 3] = 255;
+		}
+		MipGenerator::Downsample(nine, 3, 3, 12, pixel, 4);
+		CHECK(pixel[0] == 40 && pixel[1] == 0 && pixel[2] == 10 && pixel[3] == 255);
+
+		unsigned char column[8] = { 0, 100, 200, 255, 100, 100, 0, 255 };
+		MipGenerator::Downsample(column, 1, 2, 4, pixel, 4);
+		CHECK(pixel[0] == 50 && pixel[1] == 100 && pixel[2] == 100 && pixel[3] == 255);
+	}
+
+	// a single color stays the same down to 1x1
+	void TestConstantColor()
+	{
+		unsigned int width = 1067, height = 601;
+		std::vector<unsigned char> image((size_t)width * height * 4);
+		for (size_t i = 0; i < image.size(); i += 4)
+		{
+			image[i] = 17;
+			image[i + 1] = 34;
+			image[i + 2] = 51;
+			image[i + 3] = 255;
+		}
+		std::vector<unsigned char> chain;
+		MakeChain(image, width, height, chain, MipGenerator::Downsample);
+
+		int wrong = 0;
+		for (size_t i = 0; i < chain.size(); i += 4)
+		{
+			wrong += chain[i] != 17 || chain[i + 1] != 34 || chain[i + 2] != 51 || chain[i + 3] != 255;
+		}
+		CHECK(wrong == 0);
+	}
+
+	// random images of odd and even sizes with padded rows have to give the same levels as the reference,
+	// and the last level of a big one is close to the average of all of its pixels
+	void TestRandomImages()
+	{
+		std::mt19937 random(1);
+		const unsigned int sizes[][2] = { { 1, 1 }, { 1, 7 }, { 7, 1 }, { 2, 2 }, { 3, 5 }, { 9, 17 }, { 17, 9 }, { 64, 64 }, { 640, 360 }, { 1067, 601 } };
+		for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+		{
+			unsigned int width = sizes[i][0], height = sizes[i][1];
+			size_t sourcePitch = (size_t)width * 4 + random() % 3 * 4;
+			size_t destinationPitch = (size_t)MipGenerator::GetMipSize(width, 1) * 4 + 256;
+			std::vector<unsigned char> image(sourcePitch * height);
+			for (size_t j = 0; j < image.size(); j++)
+			{
+				image[j] = (unsigned char)random();
+			}
+
+			std::vector<unsigned char> fast(destinationPitch * MipGenerator::GetMipSize(height, 1), 0);
+			std::vector<unsigned char> reference(fast.size(), 0);
+			MipGenerator::Downsample(image.data(), width, height, sourcePitch, fast.data(), destinationPitch);
+			DownsampleReference(image.data(), width, height, sourcePitch, reference.data(), destinationPitch);
+			if (fast != reference)
+			{
+				printf("%ux%u is not the same as the reference\n", width, height);
+			}
+			CHECK(fast == reference);
+		}
+
+		const unsigned int width = 2048, height = 2048;
+		std::vector<unsigned char> image((size_t)width * height * 4);
+		unsigned long long sums[4] = {};
+		for (size_t i = 0; i < image.size(); i++)
+		{
+			image[i] = (unsigned char)random();
+			sums[i % 4] += image[i];
+		}
+		std::vector<unsigned char> chain;
+		MakeChain(image, width, height, chain, MipGenerator::Downsample);
+		for (int channel = 0; channel < 4; channel++)
+		{
+			int average = (int)(sums[channel] / ((unsigned long long)width * height));
+			int last = chain[chain.size() - 4 + channel];
+			CHECK(last >= average - 2 && last <= average + 2);
+		}
+
+		// the whole chain of the biggest texture, with Downsample and with the reference
+		const int runs = 20;
+		std::vector<unsigned char> referenceChain;
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < runs; i++)
+		{
+			MakeChain(image, width, height, referenceChain, DownsampleReference);
+		}
+		double referenceTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / runs;
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < runs; i++)
+		{
+			MakeChain(image, width, height, chain, MipGenerator::Downsample);
+		}
+		double time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / runs;
+		CHECK(chain == referenceChain);
+
+		double pixels = (double)(chain.size() - image.size()) / 4;
+		printf("Mip chain of %ux%u: %u levels, %zu pixels made in %.3f ms (%.1f Mpixels/s), reference filter %.3f ms\n", width, height,
+			MipGenerator::GetNrOfMips(width, height), (size_t)pixels, time, pixels / time / 1000, referenceTime);
+	}
+}
+
+int main()
+{
+	TestSizes();
+	TestKnownAverages();
+	TestConstantColor();
+	TestRandomImages();
+	return TestResult();
+}
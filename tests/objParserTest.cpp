@@ -0,0 +1,241 @@
+#include "test.h"
+#include "objParser.h"
+#include "mappedFile.h"
+#include <string>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+	// what the parser should make of the shipped objects
+	struct ShippedObject
+	{
+		const char* name;
+		size_t nrOfPositions;
+		size_t nrOfUVs;
+		size_t nrOfNormals;
+		size_t nrOfTriangles;
+		const char* materialLib;
+	};
+
+	const ShippedObject shippedObjects[] = {
+		{ "box.obj", 8, 20, 6, 12, "box.mtl" },
+		{ "dummy_obj.obj", 14652, 14652, 16119, 28716, "dummy_obj.mtl" },
+		{ "dummy_obj_fixed.obj", 14652, 14652, 1909, 28716, "dummy_obj.mtl" },
+		{ "piedmon.obj", 3054, 4376, 3036, 5868, "piedmon.mtl" },
+		{ "piedmonGif.obj", 3054, 4376, 3036, 5868, "box.mtl" },
+	};
+
+	bool ParseString(const std::string& text, ObjMeshData& mesh)
+	{
+		ObjParser parser;
+		return parser.ParseBuffer(text.data(), text.size(), mesh);
+	}
+
+	bool SameFloat(float a, float b)
+	{
+		return fabs(a - b) <= 1e-6f * (fabs(b) > 1.0f ? fabs(b) : 1.0f);
+	}
+
+	// how Object::LoadObj read the files before the parser, a sscanf per line
+	size_t ParseWithSscanf(const char* data, size_t size)
+	{
+		size_t values = 0;
+		std::string line;
+		const char* end = data + size;
+		for (const char* cursor = data; cursor < end;)
+		{
+			const char* lineEnd = (const char*)memchr(cursor, '\n', end - cursor);
+			lineEnd = lineEnd ? lineEnd : end;
+			line.assign(cursor, lineEnd);
+			cursor = lineEnd + 1;
+
+			float x, y, z;
+			int v[3], vt[3], vn[3];
+			if (line.compare(0, 2, "v ") == 0)
+			{
+				values += sscanf(line.c_str() + 2, "%f %f %f", &x, &y, &z);
+			}
+			else if (line.compare(0, 3, "vt ") == 0)
+			{
+				values += sscanf(line.c_str() + 3, "%f %f", &x, &y);
+			}
+			else if (line.compare(0, 3, "vn ") == 0)
+			{
+				values += sscanf(line.c_str() + 3, "%f %f %f", &x, &y, &z);
+			}
+			else if (line.compare(0, 2, "f ") == 0)
+			{
+				values += sscanf(line.c_str() + 2, "%d/%d/%d %d/%d/%d %d/%d/%d", &v[0], &vt[0], &vn[0], &v[1], &vt[1], &vn[1], &v[2], &vt[2], &vn[2]);
+			}
+		}
+		return values;
+	}
+
+	void TestParseFloat()
+	{
+		const struct
+		{
+			const char* text;
+			float value;
+			size_t length;	// characters the cursor has to move
+		} cases[] = {
+			{ "1", 1.0f, 1 },
+			{ "  -2.5 ", -2.5f, 6 },
+			{ "+0.125", 0.125f, 6 },
+			{ ".5", 0.5f, 2 },
+			{ "1e3", 1000.0f, 3 },
+			{ "2.5E-2/", 0.025f, 6 },
+			{ "-0.000001", -0.000001f, 9 },
+			{ "0.123456789012345678901", 0.123456789f, 23 },
+			{ "12345678901234567890123", 1.2345679e22f, 23 },
+			{ "3.4e38", 3.4e38f, 6 },
+		};
+
+		for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+		{
+			const char* cursor = cases[i].text;
+			float value = ObjParser::ParseFloat(cursor, cases[i].text + strlen(cases[i].text));
+			CHECK(SameFloat(value, cases[i].value));
+			CHECK((size_t)(cursor - cases[i].text) == cases[i].length);
+		}
+	}
+
+	void TestParseBuffer()
+	{
+		// a quad and a triangle with negative indices, windows line endings and a comment
+		const std::string text =
+			"# comment\r\n"
+			"mtllib  quad.mtl \r\n"
+			"v 0 0 0\r\n"
+			"v 1 0 0\r\n"
+			"v 1 1 0\r\n"
+			"v 0 1 0\r\n"
+			"vt 0 0\r\n"
+			"vt 1 0.25\r\n"
+			"vn 0 0 -1\r\n"
+			"f 1/1/1 2/2/1 3/1/1 4/2/1\r\n"
+			"f -1//-1 -2//-1 -3//-1\r\n"
+			"f 1 2 3";
+
+		ObjMeshData mesh;
+		CHECK(ParseString(text, mesh));
+		CHECK(mesh.positions.size() == 12 && mesh.uvs.size() == 4 && mesh.normals.size() == 3);
+		CHECK(mesh.materialLib == "quad.mtl");
+		CHECK(mesh.positions[6] == 1.0f && mesh.positions[7] == 1.0f);
+		// v is flipped for d3d
+		CHECK(mesh.uvs[2] == 1.0f && mesh.uvs[3] == 0.75f);
+
+		// the quad is a fan of two triangles
+		CHECK(mesh.GetNrOfTriangles() == 4);
+		const int positions[] = { 0, 1, 2, 0, 2, 3, 3, 2, 1, 0, 1, 2 };
+		for (int i = 0; i < 12; i++)
+		{
+			CHECK(mesh.corners[i].position == positions[i]);
+		}
+		CHECK(mesh.corners[3].uv == 0 && mesh.corners[5].uv == 1 && mesh.corners[5].normal == 0);
+		CHECK(mesh.corners[6].uv == -1 && mesh.corners[6].normal == 0);
+		CHECK(mesh.corners[9].uv == -1 && mesh.corners[9].normal == -1);
+	}
+
+	void TestBrokenFaces()
+	{
+		const std::string vertices = "mtllib a.mtl\nv 0 0 0\nv 1 0 0\nv 1 1 0\nvt 0 0\n";
+		const char* faces[] = {
+			"f 1 2\n",			// too few corners
+			"f 1 2 4\n",		// a position that does not exist
+			"f 1/2 2/1 3/1\n",	// a uv that does not exist
+			"f 1//1 2//1 3//1\n",	// a normal that does not exist
+			"f 1 2 x\n",		// not a number
+			"f 0 1 2\n",		// indices start at 1
+		};
+
+		for (size_t i = 0; i < sizeof(faces) / sizeof(faces[0]); i++)
+		{
+			// the good face in front of the broken one is thrown away as well
+			ObjMeshData mesh;
+			CHECK(!ParseString(vertices + "f 1 2 3\n" + faces[i], mesh));
+			CHECK(mesh.positions.empty() && mesh.corners.empty() && mesh.materialLib.empty());
+		}
+
+		ObjParser parser;
+		ObjMeshData mesh;
+		CHECK(!parser.Parse(OBJECTS_DIR "missing.obj", mesh));
+	}
+
+	void TestShippedObjects()
+	{
+		for (size_t i = 0; i < sizeof(shippedObjects) / sizeof(shippedObjects[0]); i++)
+		{
+			const ShippedObject& expected = shippedObjects[i];
+			std::string path = std::string(OBJECTS_DIR) + expected.name;
+
+			ObjParser parser;
+			ObjMeshData mesh;
+			CHECK(parser.Parse(path, mesh));
+			CHECK(mesh.positions.size() == expected.nrOfPositions * 3);
+			CHECK(mesh.uvs.size() == expected.nrOfUVs * 2);
+			CHECK(mesh.normals.size() == expected.nrOfNormals * 3);
+			CHECK(mesh.GetNrOfTriangles() == expected.nrOfTriangles);
+			CHECK(mesh.materialLib == expected.materialLib);
+
+			// every position is what strtod makes of it
+			MappedFile file;
+			CHECK(file.Open(path));
+			std::string text(file.GetData(), file.GetSize());
+			size_t position = 0, mismatches = 0;
+			size_t line = 0;
+			while (line < text.size() && position + 3 <= mesh.positions.size())
+			{
+				if (text.compare(line, 2, "v ") == 0)
+				{
+					const char* cursor = text.c_str() + line + 2;
+					for (int j = 0; j < 3; j++)
+					{
+						char* next = nullptr;
+						mismatches += !SameFloat(mesh.positions[position++], (float)strtod(cursor, &next));
+						cursor = next;
+					}
+				}
+				size_t lineEnd = text.find('\n', line);
+				line = lineEnd == std::string::npos ? text.size() : lineEnd + 1;
+			}
+			CHECK(position == mesh.positions.size());
+			CHECK(mismatches == 0);
+
+			// the same file through sscanf like the old loader for comparison, only printed since it depends on the machine
+			const int runs = 5;
+			double parseTime = 0.0, sscanfTime = 0.0;
+			for (int run = 0; run < runs; run++)
+			{
+				std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+				parser.ParseBuffer(file.GetData(), file.GetSize(), mesh);
+				std::chrono::high_resolution_clock::time_point middle = std::chrono::high_resolution_clock::now();
+				size_t values = ParseWithSscanf(file.GetData(), file.GetSize());
+				std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+				CHECK(values > 0);
+
+				parseTime += std::chrono::duration<double, std::milli>(middle - start).count();
+				sscanfTime += std::chrono::duration<double, std::milli>(end - middle).count();
+			}
+			parseTime /= runs;
+			sscanfTime /= runs;
+
+			double megabytes = file.GetSize() / (1024.0 * 1024.0);
+			printf("%s: %zu bytes in %.3f ms (%.1f MB/s), sscanf %.3f ms (%.1f MB/s)\n", expected.name, file.GetSize(),
+				parseTime, megabytes / (parseTime / 1000.0), sscanfTime, megabytes / (sscanfTime / 1000.0));
+		}
+	}
+}
+
+int main()
+{
+	TestParseFloat();
+	TestParseBuffer();
+	TestBrokenFaces();
+	TestShippedObjects();
+	return TestResult();
+}
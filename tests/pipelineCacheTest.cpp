@@ -0,0 +1,184 @@
+#include "test.h"
+#include "pipelineCache.h"
+#include <fstream>
+#include <string>
+
+namespace
+{
+	void WriteFile(const std::string& path, const std::string& text)
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << text;
+	}
+
+	// a root signature that tells when it is destroyed
+	struct StandInRootSignature : ID3D12RootSignature
+	{
+		StandInRootSignature(bool* destroyed)
+		{
+			this->destroyed = destroyed;
+		}
+
+		~StandInRootSignature()
+		{
+			*destroyed = true;
+		}
+
+		bool* destroyed;
+	};
+
+	// what Object::CreatePSO asks for
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC MakeDesc(ID3D12RootSignature* rootSignature, ID3DBlob* vertexShader, ID3DBlob* pixelShader, bool wireframe)
+	{
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = {};
+		desc.pRootSignature = rootSignature;
+		desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+		desc.VS.pShaderBytecode = vertexShader->GetBufferPointer();
+		desc.VS.BytecodeLength = vertexShader->GetBufferSize();
+		desc.PS.pShaderBytecode = pixelShader->GetBufferPointer();
+		desc.PS.BytecodeLength = pixelShader->GetBufferSize();
+		desc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
+		desc.NumRenderTargets = 1;
+		desc.SampleDesc.Count = 1;
+		desc.SampleMask = UINT_MAX;
+		desc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+		desc.RasterizerState.FrontCounterClockwise = TRUE;
+		desc.RasterizerState.FillMode = wireframe ? D3D12_FILL_MODE_WIREFRAME : D3D12_FILL_MODE_SOLID;
+		desc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
+		desc.DepthStencilState.DepthEnable = TRUE;
+		desc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_LESS;
+		desc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
+		for (UINT i = 0; i < D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT; i++)
+		{
+			desc.BlendState.RenderTarget[i] = { TRUE, FALSE, D3D12_BLEND_SRC_ALPHA, D3D12_BLEND_INV_SRC_ALPHA, D3D12_BLEND_OP_ADD,
+				D3D12_BLEND_ONE, D3D12_BLEND_ZERO, D3D12_BLEND_OP_ADD, D3D12_LOGIC_OP_NOOP, D3D12_COLOR_WRITE_ENABLE_ALL };
+		}
+		return desc;
+	}
+
+	// a thousand objects, solid or wireframe and with or without a texture array, compile every
+	// shader once and create one pipeline state per combination
+	void TestObjectsShareShaders()
+	{
+		WriteFile("vs.hlsl", "float4 main() : SV_POSITION { return 0; }");
+		WriteFile("ps.hlsl", "float4 main() : SV_TARGET { return 1; }");
+		GetNrOfCompiles() = 0;
+		ID3D12Device5 device;
+		ID3D12RootSignature rootSignature;
+		D3D_SHADER_MACRO textureArrayDefines[] = { { "TEXTURE_ARRAY", "1" }, { nullptr, nullptr } };
+		{
+			PipelineCache cache;
+			for (int i = 0; i < 1000; i++)
+			{
+				bool textureArray = i % 3 == 0;
+				ID3DBlob* vertexShader = cache.GetShader("vs.hlsl", nullptr, "main", "vs_5_1");
+				ID3DBlob* pixelShader = cache.GetShader("ps.hlsl", textureArray ? textureArrayDefines : nullptr, "main", "ps_5_1");
+				CHECK(vertexShader != nullptr && pixelShader != nullptr);
+				if (vertexShader != nullptr && pixelShader != nullptr)
+				{
+					CHECK(cache.GetPipelineState(&device, MakeDesc(&rootSignature, vertexShader, pixelShader, i % 2 == 0)) != nullptr);
+				}
+			}
+
+			CHECK(GetNrOfCompiles() == 3);
+			CHECK(cache.GetShaderMisses() == 3 && cache.GetShaderHits() == 2000 - 3);
+			CHECK(device.createdPipelineStates == 4);
+			CHECK(cache.GetPipelineStateMisses() == 4 && cache.GetPipelineStateHits() == 1000 - 4);
+
+			// every pipeline state holds a reference to the root signature
+			CHECK(rootSignature.references == 1 + 4);
+		}
+		CHECK(rootSignature.references == 1);
+	}
+
+	// everything in the key makes a different shader or pipeline state
+	void TestKeyFields()
+	{
+		WriteFile("key.hlsl", "float4 main() : SV_TARGET { return 1; }");
+		GetNrOfCompiles() = 0;
+		ID3D12Device5 device;
+		ID3D12RootSignature rootSignature;
+		ID3D12RootSignature otherRootSignature;
+		PipelineCache cache;
+
+		D3D_SHADER_MACRO one[] = { { "TEXTURE_ARRAY", "1" }, { nullptr, nullptr } };
+		D3D_SHADER_MACRO two[] = { { "TEXTURE_ARRAY", "2" }, { nullptr, nullptr } };
+		// a define without a value followed by another one is not the first define with the second as value
+		D3D_SHADER_MACRO nameThenName[] = { { "A", nullptr }, { "B", "" }, { nullptr, nullptr } };
+		D3D_SHADER_MACRO nameWithValue[] = { { "A", "B" }, { nullptr, nullptr } };
+		ID3DBlob* shader = cache.GetShader("key.hlsl", nullptr, "main", "ps_5_1");
+		CHECK(cache.GetShader("key.hlsl", one, "main", "ps_5_1") != shader);
+		CHECK(cache.GetShader("key.hlsl", two, "main", "ps_5_1") != cache.GetShader("key.hlsl", one, "main", "ps_5_1"));
+		CHECK(cache.GetShader("key.hlsl", nameThenName, "main", "ps_5_1") != cache.GetShader("key.hlsl", nameWithValue, "main", "ps_5_1"));
+		CHECK(cache.GetShader("key.hlsl", nullptr, "other", "ps_5_1") != shader);
+		CHECK(cache.GetShader("key.hlsl", nullptr, "main", "ps_5_0") != shader);
+		CHECK(cache.GetShader("key.hlsl", nullptr, "main", "ps_5_1") == shader);
+		CHECK(GetNrOfCompiles() == 7);
+
+		// a changed file is compiled again
+		WriteFile("key.hlsl", "float4 main() : SV_TARGET { return 0; }");
+		CHECK(cache.GetShader("key.hlsl", nullptr, "main", "ps_5_1") != shader);
+		CHECK(GetNrOfCompiles() == 8);
+		CHECK(cache.GetShader("missing.hlsl", nullptr, "main", "ps_5_1") == nullptr);
+
+		// the same bytecode at another address is the same pipeline state
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = MakeDesc(&rootSignature, shader, shader, false);
+		ID3D12PipelineState* pipelineState = cache.GetPipelineState(&device, desc);
+		ID3DBlob copy;
+		copy.bytes = shader->bytes;
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC copied = MakeDesc(&rootSignature, &copy, &copy, false);
+		CHECK(cache.GetPipelineState(&device, copied) == pipelineState);
+
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC changed = desc;
+		changed.pRootSignature = &otherRootSignature;
+		CHECK(cache.GetPipelineState(&device, changed) != pipelineState);
+		changed = desc;
+		changed.RasterizerState.CullMode = D3D12_CULL_MODE_BACK;
+		CHECK(cache.GetPipelineState(&device, changed) != pipelineState);
+		changed = desc;
+		changed.RTVFormats[0] = DXGI_FORMAT_R32G32B32A32_FLOAT;
+		CHECK(cache.GetPipelineState(&device, changed) != pipelineState);
+		changed = desc;
+		changed.BlendState.RenderTarget[7].BlendEnable = FALSE;
+		CHECK(cache.GetPipelineState(&device, changed) != pipelineState);
+		changed = desc;
+		changed.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
+		CHECK(cache.GetPipelineState(&device, changed) != pipelineState);
+
+		// formats of render targets that are not used are not part of the key
+		changed = desc;
+		changed.RTVFormats[5] = DXGI_FORMAT_R32G32B32A32_FLOAT;
+		CHECK(cache.GetPipelineState(&device, changed) == pipelineState);
+		CHECK(device.createdPipelineStates == 6);
+	}
+
+	// the cache keeps the root signature alive, so no other one can be created at its address
+	// while a pipeline state with its address in the key is cached
+	void TestRootSignatureReference()
+	{
+		WriteFile("vs.hlsl", "float4 main() : SV_POSITION { return 0; }");
+		ID3D12Device5 device;
+		bool destroyed = false;
+		StandInRootSignature* rootSignature = new StandInRootSignature(&destroyed);
+		{
+			PipelineCache cache;
+			ID3DBlob* shader = cache.GetShader("vs.hlsl", nullptr, "main", "vs_5_1");
+			CHECK(shader != nullptr);
+			if (shader != nullptr)
+			{
+				CHECK(cache.GetPipelineState(&device, MakeDesc(rootSignature, shader, shader, false)) != nullptr);
+			}
+			rootSignature->Release();
+			CHECK(!destroyed);
+		}
+		CHECK(destroyed);
+	}
+}
+
+int main()
+{
+	TestObjectsShareShaders();
+	TestKeyFields();
+	TestRootSignatureReference();
+	return TestResult();
+}
@@ -0,0 +1,146 @@
+#include "test.h"
+#include "radixSort.h"
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <stdio.h>
+
+namespace
+{
+	std::vector<SortItem> MakeItems(const std::vector<unsigned long long>& keys)
+	{
+		std::vector<SortItem> items;
+		for (size_t i = 0; i < keys.size(); i++)
+		{
+			items.push_back({ keys[i], (int)i });
+		}
+		return items;
+	}
+
+	// sorted by key and the items with the same key in the order they were given
+	bool IsStableSorted(const std::vector<SortItem>& items)
+	{
+		for (size_t i = 1; i < items.size(); i++)
+		{
+			if (items[i - 1].key > items[i].key || (items[i - 1].key == items[i].key && items[i - 1].value > items[i].value))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void TestFewItems()
+	{
+		std::vector<SortItem> items;
+		std::vector<SortItem> scratch;
+		RadixSort::Sort(items, scratch);
+		CHECK(items.empty());
+
+		items = MakeItems({ 7 });
+		RadixSort::Sort(items, scratch);
+		CHECK(items.size() == 1 && items[0].key == 7 && items[0].value == 0);
+
+		items = MakeItems({ 0x100, 0x1 });
+		RadixSort::Sort(items, scratch);
+		CHECK(items.size() == 2 && items[0].value == 1 && items[1].value == 0);
+
+		items = MakeItems({ 0x1, 0x100 });
+		RadixSort::Sort(items, scratch);
+		CHECK(items.size() == 2 && items[0].value == 0 && items[1].value == 1);
+	}
+
+	// every pass is skipped, the items stay where they are and scratch is not written
+	void TestEqualKeys()
+	{
+		std::vector<SortItem> items = MakeItems(std::vector<unsigned long long>(100, 0x0123456789ABCDEFull));
+		std::vector<SortItem> scratch(100, SortItem{ 0, -1 });
+		const SortItem* data = items.data();
+		RadixSort::Sort(items, scratch);
+		CHECK(items.data() == data);
+		CHECK(IsStableSorted(items));
+		CHECK(std::all_of(scratch.begin(), scratch.end(), [](const SortItem& item) { return item.value == -1; }));
+	}
+
+	// keys that differ in one byte take one pass, which leaves the result in scratch, so the buffers
+	// are swapped. Two bytes take two passes and end in items.
+	void TestPassCount()
+	{
+		std::vector<SortItem> scratch;
+		std::vector<SortItem> items = MakeItems({ 0x500, 0x300, 0x400, 0x300, 0x100 });
+		RadixSort::Sort(items, scratch);
+		CHECK(IsStableSorted(items) && items.size() == 5 && scratch.size() == 5);
+		CHECK(items[0].value == 4 && items[1].value == 1 && items[2].value == 3 && items[4].value == 0);
+
+		items = MakeItems({ 0x0502, 0x0301, 0x0402, 0x0302, 0x0301, 0x0501 });
+		RadixSort::Sort(items, scratch);
+		CHECK(IsStableSorted(items) && items.size() == 6);
+		CHECK(items[0].value == 1 && items[1].value == 4 && items[2].value == 3 && items[5].value == 0);
+
+		// the top and bottom byte, the passes between them are skipped
+		items = MakeItems({ 0xFF00000000000001ull, 0x0100000000000002ull, 0xFF00000000000000ull, 0x0100000000000002ull });
+		RadixSort::Sort(items, scratch);
+		CHECK(IsStableSorted(items));
+		CHECK(items[0].value == 1 && items[1].value == 3 && items[2].value == 2 && items[3].value == 0);
+	}
+
+	// random sort keys with few distinct values against std::stable_sort
+	void TestRandomKeys()
+	{
+		std::mt19937_64 random(18);
+		std::vector<SortItem> scratch;
+		const size_t sizes[] = { 3, 255, 256, 257, 10000 };
+		for (size_t size : sizes)
+		{
+			std::vector<unsigned long long> keys;
+			for (size_t i = 0; i < size; i++)
+			{
+				keys.push_back((random() % 7) << 52 | (random() % 300) << 20 | (random() % 1000));
+			}
+			std::vector<SortItem> items = MakeItems(keys);
+			std::vector<SortItem> expected = items;
+			std::stable_sort(expected.begin(), expected.end(), [](const SortItem& a, const SortItem& b) { return a.key < b.key; });
+			RadixSort::Sort(items, scratch);
+
+			bool same = items.size() == expected.size();
+			for (size_t i = 0; same && i < items.size(); i++)
+			{
+				same = items[i].key == expected[i].key && items[i].value == expected[i].value;
+			}
+			CHECK(same);
+		}
+	}
+
+	void PrintSortTime()
+	{
+		std::mt19937_64 random(5);
+		std::vector<unsigned long long> keys;
+		for (int i = 0; i < 100000; i++)
+		{
+			keys.push_back(random());
+		}
+		std::vector<SortItem> items;
+		std::vector<SortItem> scratch;
+		const int runs = 20;
+		double elapsed = 0.0;
+		for (int i = 0; i < runs; i++)
+		{
+			items = MakeItems(keys);
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			RadixSort::Sort(items, scratch);
+			elapsed += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+		}
+		printf("sorting %zu random keys took %.1f us\n", keys.size(), elapsed / runs);
+	}
+}
+
+int main()
+{
+	TestFewItems();
+	TestEqualKeys();
+	TestPassCount();
+	TestRandomKeys();
+	PrintSortTime();
+	return TestResult();
+}
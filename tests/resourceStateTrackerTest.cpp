@@ -0,0 +1,172 @@
+#include "test.h"
+#include "resourceStateTracker.h"
+#include <vector>
+#include <stdio.h>
+
+namespace
+{
+	// the barrier of a transition of the whole resource
+	bool IsTransition(const D3D12_RESOURCE_BARRIER& barrier, ID3D12Resource* resource, D3D12_RESOURCE_STATES before,
+		D3D12_RESOURCE_STATES after)
+	{
+		return barrier.Type == D3D12_RESOURCE_BARRIER_TYPE_TRANSITION && barrier.Transition.pResource == resource &&
+			barrier.Transition.Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES &&
+			barrier.Transition.StateBefore == before && barrier.Transition.StateAfter == after;
+	}
+
+	// the same transition twice is one barrier, a flush without anything queued records nothing
+	void TestRepeatedTransition()
+	{
+		ID3D12Resource texture;
+		ResourceStateTracker tracker;
+		RecordingCommandRecorder recorder;
+		tracker.Register(&texture, D3D12_RESOURCE_STATE_COPY_DEST);
+		tracker.Transition(&texture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		tracker.Transition(&texture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		tracker.Flush(&recorder);
+		tracker.Transition(&texture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		tracker.Flush(&recorder);
+
+		CHECK(recorder.GetCommands().size() == 1 && recorder.GetCount(RecordingCommandRecorder::Barrier) == 1);
+		CHECK(recorder.GetCommands()[0].count == 1 && recorder.GetBarriers().size() == 1);
+		CHECK(IsTransition(recorder.GetBarriers()[0], &texture, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+		CHECK(tracker.GetState(&texture) == D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		CHECK(tracker.GetBarrierCount() == 1 && tracker.GetBatchCount() == 1);
+	}
+
+	// transitions of a resource before the flush become one barrier from the first state to the last,
+	// and none if the resource ends up where it started
+	void TestMergedTransition()
+	{
+		ID3D12Resource texture, backBuffer;
+		ResourceStateTracker tracker;
+		RecordingCommandRecorder recorder;
+		tracker.Register(&texture, D3D12_RESOURCE_STATE_COPY_DEST);
+		tracker.Register(&backBuffer, D3D12_RESOURCE_STATE_PRESENT);
+		tracker.Transition(&texture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		tracker.Transition(&backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+		tracker.Transition(&texture, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+		tracker.Transition(&backBuffer, D3D12_RESOURCE_STATE_PRESENT);
+		tracker.Flush(&recorder);
+
+		CHECK(recorder.GetCommands().size() == 1 && recorder.GetCommands()[0].count == 1);
+		CHECK(recorder.GetBarriers().size() == 1);
+		CHECK(IsTransition(recorder.GetBarriers()[0], &texture, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+		CHECK(tracker.GetState(&backBuffer) == D3D12_RESOURCE_STATE_PRESENT);
+
+		// both of them going back and forth cancel out completely
+		recorder.Reset();
+		tracker.Transition(&texture, D3D12_RESOURCE_STATE_COPY_DEST);
+		tracker.Transition(&texture, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+		tracker.Flush(&recorder);
+		CHECK(recorder.GetCommands().empty());
+		CHECK(tracker.GetBarrierCount() == 1 && tracker.GetBatchCount() == 1);
+	}
+
+	// a resource that is already in the state, or registered a second time, gets no barrier
+	void TestAlreadyInState()
+	{
+		ID3D12Resource texture;
+		ResourceStateTracker tracker;
+		RecordingCommandRecorder recorder;
+		CHECK(!tracker.IsRegistered(&texture));
+		tracker.Register(&texture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		tracker.Register(&texture, D3D12_RESOURCE_STATE_COPY_DEST);
+		CHECK(tracker.IsRegistered(&texture) && tracker.GetState(&texture) == D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		tracker.Transition(&texture, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		tracker.Flush(&recorder);
+		CHECK(recorder.GetCommands().empty());
+		CHECK(tracker.GetBarrierCount() == 0 && tracker.GetBatchCount() == 0);
+
+		// an unregistered resource loses its queued barrier, one at the same address starts over
+		tracker.Transition(&texture, D3D12_RESOURCE_STATE_COPY_DEST);
+		tracker.Unregister(&texture);
+		CHECK(!tracker.IsRegistered(&texture));
+		tracker.Register(&texture, D3D12_RESOURCE_STATE_COPY_DEST);
+		tracker.Flush(&recorder);
+		CHECK(recorder.GetCommands().empty());
+	}
+
+	// everything queued goes out in one ResourceBarrier call, in the order of the transitions
+	void TestOneCallPerFlush()
+	{
+		std::vector<ID3D12Resource> textures(10);
+		ResourceStateTracker tracker;
+		RecordingCommandRecorder recorder;
+		for (size_t i = 0; i < textures.size(); i++)
+		{
+			tracker.Register(&textures[i], D3D12_RESOURCE_STATE_COPY_DEST);
+		}
+		for (size_t i = textures.size(); i > 0; i--)
+		{
+			tracker.Transition(&textures[i - 1], D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		}
+		tracker.Flush(&recorder);
+
+		CHECK(recorder.GetCommands().size() == 1 && recorder.GetCommands()[0].count == textures.size());
+		int wrong = 0;
+		for (size_t i = 0; i < recorder.GetBarriers().size(); i++)
+		{
+			wrong += !IsTransition(recorder.GetBarriers()[i], &textures[textures.size() - 1 - i], D3D12_RESOURCE_STATE_COPY_DEST,
+				D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		}
+		CHECK(recorder.GetBarriers().size() == textures.size() && wrong == 0);
+		CHECK(tracker.GetBarrierCount() == textures.size() && tracker.GetBatchCount() == 1);
+		tracker.ResetCounters();
+		CHECK(tracker.GetBarrierCount() == 0 && tracker.GetBatchCount() == 0);
+	}
+
+	// the barriers of the frames of Renderer::Frame for the animated texture, with a texture per frame
+	// and with one texture array. Only the first frame after the upload transitions the textures,
+	// after that a frame only transitions the back buffer to a render target and back
+	void TestAnimatedTextureFrames()
+	{
+		const unsigned int nrOfFrames = 105;
+		const unsigned int resources[2] = { nrOfFrames, 1 };
+		for (int i = 0; i < 2; i++)
+		{
+			std::vector<ID3D12Resource> textures(resources[i]);
+			ID3D12Resource backBuffers[2];
+			ResourceStateTracker tracker;
+			RecordingCommandRecorder recorder;
+			for (size_t j = 0; j < textures.size(); j++)
+			{
+				tracker.Register(&textures[j], D3D12_RESOURCE_STATE_COPY_DEST);
+			}
+			tracker.Register(&backBuffers[0], D3D12_RESOURCE_STATE_PRESENT);
+			tracker.Register(&backBuffers[1], D3D12_RESOURCE_STATE_PRESENT);
+
+			unsigned int barriers[3], batches[3];
+			for (int frame = 0; frame < 3; frame++)
+			{
+				tracker.ResetCounters();
+				for (size_t j = 0; j < textures.size(); j++)
+				{
+					tracker.Transition(&textures[j], D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+				}
+				tracker.Transition(&backBuffers[frame % 2], D3D12_RESOURCE_STATE_RENDER_TARGET);
+				tracker.Flush(&recorder);
+				tracker.Transition(&backBuffers[frame % 2], D3D12_RESOURCE_STATE_PRESENT);
+				tracker.Flush(&recorder);
+				barriers[frame] = tracker.GetBarrierCount();
+				batches[frame] = tracker.GetBatchCount();
+			}
+
+			CHECK(barriers[0] == resources[i] + 2 && batches[0] == 2);
+			CHECK(barriers[1] == 2 && batches[1] == 2 && barriers[2] == 2 && batches[2] == 2);
+			CHECK(recorder.GetCount(RecordingCommandRecorder::Barrier) == 6);
+			printf("Animated texture of %u frames as %s: %u barriers in the first frame, %u in the next ones\n", nrOfFrames,
+				i == 0 ? "a texture per frame" : "a texture array", barriers[0], barriers[1]);
+		}
+	}
+}
+
+int main()
+{
+	TestRepeatedTransition();
+	TestMergedTransition();
+	TestAlreadyInState();
+	TestOneCallPerFlush();
+	TestAnimatedTextureFrames();
+	return TestResult();
+}
@@ -0,0 +1,144 @@
+#include "test.h"
+#include "ringAllocator.h"
+#include <vector>
+#include <deque>
+#include <random>
+#include <chrono>
+#include <stdio.h>
+
+namespace
+{
+	const unsigned long long INVALID = RingAllocator::INVALID;
+
+	// two frames fill the ring, the third only fits once the first one is retired and then wraps
+	void TestWrapAround()
+	{
+		RingAllocator ring;
+		ring.Reset(1024);
+		CHECK(ring.Allocate(400, 256) == 0);
+		ring.FinishFrame(1);
+		CHECK(ring.Allocate(400, 256) == 512);
+		ring.FinishFrame(2);
+		CHECK(ring.GetOldestFenceValue() == 1 && ring.GetStats().framesInFlight == 2);
+		CHECK(ring.Allocate(256, 256) == INVALID);
+		ring.Retire(0);
+		CHECK(ring.Allocate(256, 256) == INVALID);
+		ring.Retire(1);
+		CHECK(ring.GetOldestFenceValue() == 2);
+		CHECK(ring.GetStats().used == 512);
+		CHECK(ring.Allocate(256, 256) == 0);
+		CHECK(ring.Allocate(200, 16) == INVALID);
+		CHECK(ring.Allocate(144, 16) == 256);
+		CHECK(ring.GetStats().used == 1024);
+		CHECK(ring.Allocate(1, 1) == INVALID);
+		ring.FinishFrame(3);
+		ring.Retire(3);
+
+		RingAllocatorStats stats = ring.GetStats();
+		CHECK(stats.used == 0 && stats.framesInFlight == 0 && ring.GetOldestFenceValue() == 0);
+		CHECK(stats.nrOfFailed == 4 && stats.peakUsed == 1024);
+		CHECK(ring.Allocate(1024, 256) == 0);
+		CHECK(ring.Allocate(1025, 1) == INVALID);
+	}
+
+	// random frames with a gpu that is 0..3 frames behind, every byte remembers the frame it belongs to
+	void TestRandomFrames()
+	{
+		struct Allocation
+		{
+			unsigned long long offset;
+			unsigned long long size;
+			unsigned long long fenceValue;
+		};
+
+		const unsigned long long capacity = 64 * 1024;
+		const int nrOfFrames = 20000;
+
+		RingAllocator ring;
+		ring.Reset(capacity);
+		std::vector<unsigned long long> owners(capacity, 0);
+		std::deque<Allocation> allocations;
+		std::mt19937 random(1);
+		unsigned long long completed = 0;
+		int stalls = 0;
+		int overlaps = 0;
+		int misplaced = 0;
+		double allocateTime = 0.0;
+
+		auto retire = [&]()
+		{
+			ring.Retire(completed);
+			while (!allocations.empty() && allocations.front().fenceValue <= completed)
+			{
+				for (unsigned long long j = 0; j < allocations.front().size; j++)
+				{
+					owners[allocations.front().offset + j] = 0;
+				}
+				allocations.pop_front();
+			}
+		};
+
+		for (unsigned long long fenceValue = 1; fenceValue <= nrOfFrames; fenceValue++)
+		{
+			int nrOfAllocations = 1 + random() % 16;
+			for (int i = 0; i < nrOfAllocations; i++)
+			{
+				Allocation allocation;
+				allocation.size = random() % 4 == 0 ? 1 + random() % 8192 : 1 + random() % 512;
+				allocation.fenceValue = fenceValue;
+				unsigned long long alignment = 1ull << (random() % 9);
+
+				std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+				allocation.offset = ring.Allocate(allocation.size, alignment);
+				allocateTime += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+
+				// like the renderer, wait for the oldest frame and try again
+				while (allocation.offset == INVALID && ring.GetOldestFenceValue() != 0)
+				{
+					stalls++;
+					completed = ring.GetOldestFenceValue();
+					retire();
+					allocation.offset = ring.Allocate(allocation.size, alignment);
+				}
+
+				// with nothing in flight every allocation fits
+				if (allocation.offset == INVALID || allocation.offset % alignment != 0 || allocation.offset + allocation.size > capacity)
+				{
+					misplaced++;
+					continue;
+				}
+				for (unsigned long long j = 0; j < allocation.size; j++)
+				{
+					overlaps += owners[allocation.offset + j] != 0;
+					owners[allocation.offset + j] = fenceValue;
+				}
+				allocations.push_back(allocation);
+			}
+			ring.FinishFrame(fenceValue);
+
+			unsigned long long behind = random() % 4;
+			completed = fenceValue > behind && fenceValue - behind > completed ? fenceValue - behind : completed;
+			retire();
+		}
+
+		RingAllocatorStats stats = ring.GetStats();
+		CHECK(overlaps == 0);
+		CHECK(misplaced == 0);
+		CHECK(stats.peakUsed <= capacity);
+		printf("Ring allocator: %u allocations in %.3f us each, peak %llu/%llu bytes, %llu bytes wasted on alignment and wrapping, "
+			"%d waits for the gpu\n", stats.nrOfAllocations, allocateTime / stats.nrOfAllocations, stats.peakUsed, stats.capacity,
+			stats.wasted, stalls);
+
+		// once the gpu has caught up everything is free again
+		ring.Retire(nrOfFrames);
+		stats = ring.GetStats();
+		CHECK(stats.used == 0 && stats.framesInFlight == 0);
+	}
+}
+
+int main()
+{
+	TestWrapAround();
+	TestRandomFrames();
+	return TestResult();
+}
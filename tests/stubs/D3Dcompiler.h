@@ -0,0 +1,40 @@
+#pragma once
+#include "d3d12.h"
+
+// The part of D3Dcompiler.h the PipelineCache needs. Nothing is compiled, the blob holds the
+// source, the defines, the entry point and the target, so different shaders differ.
+
+struct D3D_SHADER_MACRO
+{
+	LPCSTR Name;
+	LPCSTR Definition;
+};
+
+#define D3DCOMPILE_DEBUG (1 << 0)
+#define D3DCOMPILE_SKIP_OPTIMIZATION (1 << 2)
+#define D3DCOMPILE_OPTIMIZATION_LEVEL3 (1 << 15)
+#define D3DCOMPILE_ENABLE_UNBOUNDED_DESCRIPTOR_TABLES (1 << 20)
+
+// the number of D3DCompile calls
+inline unsigned int& GetNrOfCompiles()
+{
+	static unsigned int compiles = 0;
+	return compiles;
+}
+
+inline HRESULT D3DCompile(const void* source, SIZE_T size, LPCSTR, const D3D_SHADER_MACRO* defines, void*, LPCSTR entry, LPCSTR target,
+	UINT, UINT, ID3DBlob** code, ID3DBlob** errors)
+{
+	GetNrOfCompiles()++;
+	ID3DBlob* blob = new ID3DBlob();
+	blob->bytes.assign((const BYTE*)source, (const BYTE*)source + size);
+	for (const D3D_SHADER_MACRO* define = defines; define != nullptr && define->Name != nullptr; define++)
+	{
+		blob->bytes.insert(blob->bytes.end(), define->Name, define->Name + strlen(define->Name));
+	}
+	blob->bytes.insert(blob->bytes.end(), entry, entry + strlen(entry));
+	blob->bytes.insert(blob->bytes.end(), target, target + strlen(target));
+	*code = blob;
+	*errors = nullptr;
+	return S_OK;
+}
@@ -0,0 +1,432 @@
+#pragma once
+#include <math.h>
+#include <stdint.h>
+
+// The part of DirectXMath that the renderer uses, written out without intrinsics like the
+// _XM_NO_INTRINSICS_ path of the real header, so the tests that need it build where the windows
+// sdk is not installed. Same conventions as the real one: row vectors, rows of a matrix are r[0..3]
+// and matrices multiply as v * M.
+namespace DirectX
+{
+	const float XM_PI = 3.141592654f;
+	const float XM_PIDIV2 = 1.570796327f;
+	const float XM_PIDIV4 = 0.785398163f;
+
+	struct XMVECTOR
+	{
+		union
+		{
+			float f[4];
+			uint32_t u[4];
+		};
+	};
+	typedef const XMVECTOR& FXMVECTOR;
+	typedef const XMVECTOR& GXMVECTOR;
+	typedef const XMVECTOR& HXMVECTOR;
+	typedef const XMVECTOR& CXMVECTOR;
+
+	struct XMMATRIX
+	{
+		XMVECTOR r[4];
+	};
+	typedef const XMMATRIX& FXMMATRIX;
+	typedef const XMMATRIX& CXMMATRIX;
+
+	struct XMFLOAT3
+	{
+		float x;
+		float y;
+		float z;
+
+		XMFLOAT3() = default;
+		XMFLOAT3(float x, float y, float z) : x(x), y(y), z(z) {}
+	};
+
+	struct XMFLOAT4
+	{
+		float x;
+		float y;
+		float z;
+		float w;
+
+		XMFLOAT4() = default;
+		XMFLOAT4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+	};
+
+	struct alignas(16) XMFLOAT4A : public XMFLOAT4
+	{
+		XMFLOAT4A() = default;
+		XMFLOAT4A(float x, float y, float z, float w) : XMFLOAT4(x, y, z, w) {}
+	};
+
+	struct XMUINT4
+	{
+		uint32_t x;
+		uint32_t y;
+		uint32_t z;
+		uint32_t w;
+	};
+
+	struct XMFLOAT4X4
+	{
+		union
+		{
+			struct
+			{
+				float _11, _12, _13, _14;
+				float _21, _22, _23, _24;
+				float _31, _32, _33, _34;
+				float _41, _42, _43, _44;
+			};
+			float m[4][4];
+		};
+
+		XMFLOAT4X4() = default;
+	};
+
+	struct alignas(16) XMFLOAT4X4A : public XMFLOAT4X4
+	{
+		XMFLOAT4X4A() = default;
+	};
+
+	// loads and stores
+
+	inline XMVECTOR XMVectorSet(float x, float y, float z, float w)
+	{
+		XMVECTOR v;
+		v.f[0] = x;
+		v.f[1] = y;
+		v.f[2] = z;
+		v.f[3] = w;
+		return v;
+	}
+
+	inline XMVECTOR XMLoadFloat4(const XMFLOAT4* source)
+	{
+		return XMVectorSet(source->x, source->y, source->z, source->w);
+	}
+
+	inline XMVECTOR XMLoadFloat4A(const XMFLOAT4A* source)
+	{
+		return XMLoadFloat4(source);
+	}
+
+	inline void XMStoreFloat4(XMFLOAT4* destination, FXMVECTOR v)
+	{
+		*destination = XMFLOAT4(v.f[0], v.f[1], v.f[2], v.f[3]);
+	}
+
+	inline void XMStoreFloat4A(XMFLOAT4A* destination, FXMVECTOR v)
+	{
+		XMStoreFloat4(destination, v);
+	}
+
+	inline void XMStoreUInt4(XMUINT4* destination, FXMVECTOR v)
+	{
+		destination->x = v.u[0];
+		destination->y = v.u[1];
+		destination->z = v.u[2];
+		destination->w = v.u[3];
+	}
+
+	inline XMMATRIX XMLoadFloat4x4(const XMFLOAT4X4* source)
+	{
+		XMMATRIX result;
+		for (int row = 0; row < 4; row++)
+		{
+			result.r[row] = XMVectorSet(source->m[row][0], source->m[row][1], source->m[row][2], source->m[row][3]);
+		}
+		return result;
+	}
+
+	inline XMMATRIX XMLoadFloat4x4A(const XMFLOAT4X4A* source)
+	{
+		return XMLoadFloat4x4(source);
+	}
+
+	inline void XMStoreFloat4x4(XMFLOAT4X4* destination, FXMMATRIX m)
+	{
+		for (int row = 0; row < 4; row++)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				destination->m[row][column] = m.r[row].f[column];
+			}
+		}
+	}
+
+	inline void XMStoreFloat4x4A(XMFLOAT4X4A* destination, FXMMATRIX m)
+	{
+		XMStoreFloat4x4(destination, m);
+	}
+
+	// vectors
+
+	inline XMVECTOR XMVectorZero()
+	{
+		return XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f);
+	}
+
+	inline XMVECTOR XMVectorReplicate(float value)
+	{
+		return XMVectorSet(value, value, value, value);
+	}
+
+	inline XMVECTOR XMVectorTrueInt()
+	{
+		XMVECTOR v;
+		v.u[0] = v.u[1] = v.u[2] = v.u[3] = 0xFFFFFFFFu;
+		return v;
+	}
+
+	inline float XMVectorGetX(FXMVECTOR v)
+	{
+		return v.f[0];
+	}
+
+	inline float XMVectorGetY(FXMVECTOR v)
+	{
+		return v.f[1];
+	}
+
+	inline float XMVectorGetZ(FXMVECTOR v)
+	{
+		return v.f[2];
+	}
+
+	inline float XMVectorGetW(FXMVECTOR v)
+	{
+		return v.f[3];
+	}
+
+	inline XMVECTOR XMVectorSetW(FXMVECTOR v, float w)
+	{
+		return XMVectorSet(v.f[0], v.f[1], v.f[2], w);
+	}
+
+	inline XMVECTOR XMVectorSplatX(FXMVECTOR v)
+	{
+		return XMVectorReplicate(v.f[0]);
+	}
+
+	inline XMVECTOR XMVectorSplatY(FXMVECTOR v)
+	{
+		return XMVectorReplicate(v.f[1]);
+	}
+
+	inline XMVECTOR XMVectorSplatZ(FXMVECTOR v)
+	{
+		return XMVectorReplicate(v.f[2]);
+	}
+
+	inline XMVECTOR XMVectorAdd(FXMVECTOR a, FXMVECTOR b)
+	{
+		return XMVectorSet(a.f[0] + b.f[0], a.f[1] + b.f[1], a.f[2] + b.f[2], a.f[3] + b.f[3]);
+	}
+
+	inline XMVECTOR XMVectorSubtract(FXMVECTOR a, FXMVECTOR b)
+	{
+		return XMVectorSet(a.f[0] - b.f[0], a.f[1] - b.f[1], a.f[2] - b.f[2], a.f[3] - b.f[3]);
+	}
+
+	inline XMVECTOR XMVectorMultiply(FXMVECTOR a, FXMVECTOR b)
+	{
+		return XMVectorSet(a.f[0] * b.f[0], a.f[1] * b.f[1], a.f[2] * b.f[2], a.f[3] * b.f[3]);
+	}
+
+	inline XMVECTOR XMVectorMultiplyAdd(FXMVECTOR a, FXMVECTOR b, FXMVECTOR c)
+	{
+		return XMVectorSet(a.f[0] * b.f[0] + c.f[0], a.f[1] * b.f[1] + c.f[1], a.f[2] * b.f[2] + c.f[2], a.f[3] * b.f[3] + c.f[3]);
+	}
+
+	inline XMVECTOR XMVectorScale(FXMVECTOR v, float scale)
+	{
+		return XMVectorSet(v.f[0] * scale, v.f[1] * scale, v.f[2] * scale, v.f[3] * scale);
+	}
+
+	inline XMVECTOR XMVectorNegate(FXMVECTOR v)
+	{
+		return XMVectorSet(-v.f[0], -v.f[1], -v.f[2], -v.f[3]);
+	}
+
+	inline XMVECTOR XMVectorGreater(FXMVECTOR a, FXMVECTOR b)
+	{
+		XMVECTOR v;
+		for (int i = 0; i < 4; i++)
+		{
+			v.u[i] = a.f[i] > b.f[i] ? 0xFFFFFFFFu : 0u;
+		}
+		return v;
+	}
+
+	inline XMVECTOR XMVectorAndInt(FXMVECTOR a, FXMVECTOR b)
+	{
+		XMVECTOR v;
+		for (int i = 0; i < 4; i++)
+		{
+			v.u[i] = a.u[i] & b.u[i];
+		}
+		return v;
+	}
+
+	inline XMVECTOR XMVector3Dot(FXMVECTOR a, FXMVECTOR b)
+	{
+		return XMVectorReplicate(a.f[0] * b.f[0] + a.f[1] * b.f[1] + a.f[2] * b.f[2]);
+	}
+
+	inline XMVECTOR XMVector3Cross(FXMVECTOR a, FXMVECTOR b)
+	{
+		return XMVectorSet(a.f[1] * b.f[2] - a.f[2] * b.f[1], a.f[2] * b.f[0] - a.f[0] * b.f[2], a.f[0] * b.f[1] - a.f[1] * b.f[0], 0.0f);
+	}
+
+	inline XMVECTOR XMVector3Length(FXMVECTOR v)
+	{
+		return XMVectorReplicate(sqrtf(XMVectorGetX(XMVector3Dot(v, v))));
+	}
+
+	inline XMVECTOR XMVector3Normalize(FXMVECTOR v)
+	{
+		float length = XMVectorGetX(XMVector3Length(v));
+		return length > 0.0f ? XMVectorScale(v, 1.0f / length) : v;
+	}
+
+	// x * r[0] + y * r[1] + z * r[2] + r[3], the w of the vector is ignored
+	inline XMVECTOR XMVector3Transform(FXMVECTOR v, FXMMATRIX m)
+	{
+		XMVECTOR result = XMVectorMultiplyAdd(XMVectorSplatZ(v), m.r[2], m.r[3]);
+		result = XMVectorMultiplyAdd(XMVectorSplatY(v), m.r[1], result);
+		return XMVectorMultiplyAdd(XMVectorSplatX(v), m.r[0], result);
+	}
+
+	// the normal of the plane gets the length 1
+	inline XMVECTOR XMPlaneNormalize(FXMVECTOR plane)
+	{
+		float length = XMVectorGetX(XMVector3Length(plane));
+		return length > 0.0f ? XMVectorScale(plane, 1.0f / length) : plane;
+	}
+
+	// quaternions
+
+	inline XMVECTOR XMQuaternionIdentity()
+	{
+		return XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	// the rotation of q1 followed by the one of q2, q2 * q1
+	inline XMVECTOR XMQuaternionMultiply(FXMVECTOR q1, FXMVECTOR q2)
+	{
+		return XMVectorSet(
+			q2.f[3] * q1.f[0] + q2.f[0] * q1.f[3] + q2.f[1] * q1.f[2] - q2.f[2] * q1.f[1],
+			q2.f[3] * q1.f[1] - q2.f[0] * q1.f[2] + q2.f[1] * q1.f[3] + q2.f[2] * q1.f[0],
+			q2.f[3] * q1.f[2] + q2.f[0] * q1.f[1] - q2.f[1] * q1.f[0] + q2.f[2] * q1.f[3],
+			q2.f[3] * q1.f[3] - q2.f[0] * q1.f[0] - q2.f[1] * q1.f[1] - q2.f[2] * q1.f[2]);
+	}
+
+	// roll around z first, then pitch around x and yaw around y
+	inline XMVECTOR XMQuaternionRotationRollPitchYaw(float pitch, float yaw, float roll)
+	{
+		float sp = sinf(pitch * 0.5f), cp = cosf(pitch * 0.5f);
+		float sy = sinf(yaw * 0.5f), cy = cosf(yaw * 0.5f);
+		float sr = sinf(roll * 0.5f), cr = cosf(roll * 0.5f);
+		return XMVectorSet(
+			sp * cy * cr + cp * sy * sr,
+			cp * sy * cr - sp * cy * sr,
+			cp * cy * sr - sp * sy * cr,
+			cp * cy * cr + sp * sy * sr);
+	}
+
+	// matrices
+
+	inline XMMATRIX XMMatrixSet(float m00, float m01, float m02, float m03, float m10, float m11, float m12, float m13,
+		float m20, float m21, float m22, float m23, float m30, float m31, float m32, float m33)
+	{
+		XMMATRIX result;
+		result.r[0] = XMVectorSet(m00, m01, m02, m03);
+		result.r[1] = XMVectorSet(m10, m11, m12, m13);
+		result.r[2] = XMVectorSet(m20, m21, m22, m23);
+		result.r[3] = XMVectorSet(m30, m31, m32, m33);
+		return result;
+	}
+
+	inline XMMATRIX XMMatrixIdentity()
+	{
+		return XMMatrixSet(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	inline XMMATRIX XMMatrixMultiply(FXMMATRIX a, CXMMATRIX b)
+	{
+		XMMATRIX result;
+		for (int row = 0; row < 4; row++)
+		{
+			XMVECTOR v = a.r[row];
+			XMVECTOR sum = XMVectorMultiply(XMVectorReplicate(v.f[3]), b.r[3]);
+			sum = XMVectorMultiplyAdd(XMVectorReplicate(v.f[2]), b.r[2], sum);
+			sum = XMVectorMultiplyAdd(XMVectorReplicate(v.f[1]), b.r[1], sum);
+			result.r[row] = XMVectorMultiplyAdd(XMVectorReplicate(v.f[0]), b.r[0], sum);
+		}
+		return result;
+	}
+
+	inline XMMATRIX operator*(FXMMATRIX a, CXMMATRIX b)
+	{
+		return XMMatrixMultiply(a, b);
+	}
+
+	inline XMMATRIX XMMatrixTranspose(FXMMATRIX m)
+	{
+		XMMATRIX result;
+		for (int row = 0; row < 4; row++)
+		{
+			result.r[row] = XMVectorSet(m.r[0].f[row], m.r[1].f[row], m.r[2].f[row], m.r[3].f[row]);
+		}
+		return result;
+	}
+
+	inline XMMATRIX XMMatrixScaling(float x, float y, float z)
+	{
+		return XMMatrixSet(x, 0.0f, 0.0f, 0.0f, 0.0f, y, 0.0f, 0.0f, 0.0f, 0.0f, z, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	inline XMMATRIX XMMatrixTranslation(float x, float y, float z)
+	{
+		return XMMatrixSet(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, x, y, z, 1.0f);
+	}
+
+	inline XMMATRIX XMMatrixRotationQuaternion(FXMVECTOR q)
+	{
+		float x = q.f[0], y = q.f[1], z = q.f[2], w = q.f[3];
+		return XMMatrixSet(
+			1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w), 0.0f,
+			2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w), 0.0f,
+			2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y), 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	inline XMMATRIX XMMatrixLookToLH(FXMVECTOR eyePosition, FXMVECTOR eyeDirection, FXMVECTOR upDirection)
+	{
+		XMVECTOR r2 = XMVector3Normalize(eyeDirection);
+		XMVECTOR r0 = XMVector3Normalize(XMVector3Cross(upDirection, r2));
+		XMVECTOR r1 = XMVector3Cross(r2, r0);
+		XMVECTOR negativeEye = XMVectorNegate(eyePosition);
+		return XMMatrixSet(
+			r0.f[0], r1.f[0], r2.f[0], 0.0f,
+			r0.f[1], r1.f[1], r2.f[1], 0.0f,
+			r0.f[2], r1.f[2], r2.f[2], 0.0f,
+			XMVectorGetX(XMVector3Dot(r0, negativeEye)), XMVectorGetX(XMVector3Dot(r1, negativeEye)),
+			XMVectorGetX(XMVector3Dot(r2, negativeEye)), 1.0f);
+	}
+
+	inline XMMATRIX XMMatrixLookAtLH(FXMVECTOR eyePosition, FXMVECTOR focusPosition, FXMVECTOR upDirection)
+	{
+		return XMMatrixLookToLH(eyePosition, XMVectorSubtract(focusPosition, eyePosition), upDirection);
+	}
+
+	// z goes from 0 at the near plane to 1 at the far plane
+	inline XMMATRIX XMMatrixPerspectiveFovLH(float fovAngleY, float aspectRatio, float nearZ, float farZ)
+	{
+		float height = cosf(fovAngleY * 0.5f) / sinf(fovAngleY * 0.5f);
+		float width = height / aspectRatio;
+		float range = farZ / (farZ - nearZ);
+		return XMMatrixSet(width, 0.0f, 0.0f, 0.0f, 0.0f, height, 0.0f, 0.0f, 0.0f, 0.0f, range, 1.0f, 0.0f, 0.0f, -range * nearZ, 0.0f);
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <iostream>
+
+// The checks of the tests, without a test framework so they build wherever the renderer does.
+// A failed check prints where it is and is counted, main returns TestResult() so that ctest
+// sees the failure.
+
+inline int& GetNrOfFailedChecks()
+{
+	static int failed = 0;
+	return failed;
+}
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			GetNrOfFailedChecks()++; \
+			std::cout << __FILE__ << "(" << __LINE__ << "): check failed: " << #condition << std::endl; \
+		} \
+	} while (false)
+
+inline int TestResult()
+{
+	if (GetNrOfFailedChecks() > 0)
+	{
+		std::cout << GetNrOfFailedChecks() << " checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "all checks passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,246 @@
+#include "test.h"
+#include "threadPool.h"
+#include "objParser.h"
+#include "meshBuilder.h"
+#include "vertexCacheOptimizer.h"
+#include "imageDecoder.h"
+#include <atomic>
+#include <vector>
+#include <string>
+#include <stdio.h>
+
+namespace
+{
+	void TestSubmit()
+	{
+		ThreadPool pool(4);
+		CHECK(pool.GetNrOfThreads() == 4);
+
+		std::vector<std::future<int>> results;
+		for (int i = 0; i < 10000; i++)
+		{
+			results.push_back(pool.Submit([i]() { return i * 2; }));
+		}
+		long long sum = 0;
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			pool.Wait(results[i]);
+			sum += results[i].get();
+		}
+		CHECK(sum == 9999ll * 10000);
+
+		ThreadPool defaultPool;
+		CHECK(defaultPool.GetNrOfThreads() >= 1);
+	}
+
+	// jobs pushed from several threads while the workers take them, every job runs once and the
+	// pool can still be shut down
+	void TestConcurrentPush()
+	{
+		const int nrOfThreads = 4;
+		const int jobsPerThread = 20000;
+		std::atomic<int> done(0);
+		{
+			ThreadPool pool(3);
+			std::vector<std::thread> pushers;
+			for (int t = 0; t < nrOfThreads; t++)
+			{
+				pushers.push_back(std::thread([&pool, &done]()
+				{
+					for (int i = 0; i < jobsPerThread; i++)
+					{
+						pool.Submit([&done]() { done++; });
+					}
+				}));
+			}
+			for (size_t t = 0; t < pushers.size(); t++)
+			{
+				pushers[t].join();
+			}
+
+			// the calling thread helps until everything has run
+			while (done < nrOfThreads * jobsPerThread)
+			{
+				pool.RunPendingJob();
+			}
+			CHECK(!pool.RunPendingJob());
+		}
+		CHECK(done == nrOfThreads * jobsPerThread);
+	}
+
+	// a job waiting for the jobs it submitted runs them itself, even with a single worker
+	void TestNestedWait()
+	{
+		ThreadPool pool(1);
+		std::future<int> outer = pool.Submit([&pool]()
+		{
+			std::vector<std::future<int>> inner;
+			for (int i = 0; i < 100; i++)
+			{
+				inner.push_back(pool.Submit([i]() { return i; }));
+			}
+			int sum = 0;
+			for (size_t i = 0; i < inner.size(); i++)
+			{
+				pool.Wait(inner[i]);
+				sum += inner[i].get();
+			}
+			return sum;
+		});
+		pool.Wait(outer);
+		CHECK(outer.get() == 4950);
+	}
+
+	void TestParallelFor()
+	{
+		ThreadPool pool(4);
+		const int count = 10007;
+		std::vector<std::atomic<int>> visits(count);
+		std::vector<double> jobTimes;
+		pool.ParallelFor(count, 100, [&visits](int first, int last)
+		{
+			for (int i = first; i < last; i++)
+			{
+				visits[i]++;
+			}
+		}, &jobTimes);
+
+		int wrong = 0;
+		for (int i = 0; i < count; i++)
+		{
+			wrong += visits[i] != 1;
+		}
+		CHECK(wrong == 0);
+		CHECK(jobTimes.size() == 101);
+
+		int calls = 0;
+		pool.ParallelFor(0, 100, [&calls](int, int) { calls++; }, &jobTimes);
+		CHECK(calls == 0 && jobTimes.empty());
+		pool.ParallelFor(5, 0, [&calls](int first, int last) { calls += last - first == 1; });
+		CHECK(calls == 5);
+	}
+
+	// what is read and decoded on the pool for the demo scene, a mesh without its cooked file
+	// and the textures with the 105 frames of the animation
+	struct LoadResult
+	{
+		size_t vertices;
+		size_t indices;
+		unsigned long long pixelSum;
+		int failed;
+	};
+
+	LoadResult LoadScene(ThreadPool& pool)
+	{
+		const char* meshes[] = { "box.obj", "piedmonGif.obj", "piedmon.obj" };
+		const char* textures[] = { "box.jpg", "piedmon.png" };
+		const int nrOfFrames = 105;
+
+		std::mutex mutex;
+		LoadResult result = {};
+		std::vector<std::future<void>> jobs;
+		for (size_t i = 0; i < sizeof(meshes) / sizeof(meshes[0]); i++)
+		{
+			std::string path = std::string(OBJECTS_DIR) + meshes[i];
+			jobs.push_back(pool.Submit([path, &mutex, &result]()
+			{
+				ObjParser parser;
+				ObjMeshData obj;
+				IndexedMesh mesh;
+				bool parsed = parser.Parse(path, obj);
+				MeshBuilder::BuildIndexedMesh(obj, mesh);
+				VertexCacheOptimizer::Optimize(mesh);
+
+				std::lock_guard<std::mutex> lock(mutex);
+				result.vertices += mesh.GetNrOfVertices();
+				result.indices += mesh.GetNrOfIndices();
+				result.failed += !parsed;
+			}));
+		}
+
+		auto decode = [&mutex, &result](const std::string& path)
+		{
+			DecodedImage image;
+			bool decoded = ImageLoader::GetDefault().Load(path, image);
+			unsigned long long sum = 0;
+			for (size_t i = 0; i < image.pixels.size(); i++)
+			{
+				sum += image.pixels[i];
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			result.pixelSum += sum;
+			result.failed += !decoded;
+		};
+		for (size_t i = 0; i < sizeof(textures) / sizeof(textures[0]); i++)
+		{
+			std::string path = std::string(OBJECTS_DIR) + textures[i];
+			jobs.push_back(pool.Submit([path, &decode]() { decode(path); }));
+		}
+
+		// the frames are submitted by a job and waited for inside of it, like Texture::UploadFrames does
+		jobs.push_back(pool.Submit([&pool, &decode]()
+		{
+			std::vector<std::future<void>> frames;
+			for (int frame = 1; frame <= nrOfFrames; frame++)
+			{
+				char name[32];
+				snprintf(name, sizeof(name), "bindless/%04d.png", frame);
+				std::string path = std::string(OBJECTS_DIR) + name;
+				frames.push_back(pool.Submit([path, &decode]() { decode(path); }));
+			}
+			for (size_t frame = 0; frame < frames.size(); frame++)
+			{
+				pool.Wait(frames[frame]);
+			}
+		}));
+
+		for (size_t i = 0; i < jobs.size(); i++)
+		{
+			pool.Wait(jobs[i]);
+		}
+		return result;
+	}
+
+	// the cpu part of loading the demo scene on 1..n threads, every thread count has to load the same,
+	// the times are only printed since the scaling depends on the machine
+	void TestLoadingScaling()
+	{
+		unsigned int maxThreads = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() : 1;
+		const int runs = 3;
+		std::vector<double> times;
+		LoadResult first = {};
+		for (unsigned int threads = 1; threads <= maxThreads; threads++)
+		{
+			ThreadPool pool(threads);
+			double best = 0.0;
+			for (int run = 0; run < runs; run++)
+			{
+				std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+				LoadResult result = LoadScene(pool);
+				double time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+				best = run == 0 || time < best ? time : best;
+
+				if (threads == 1 && run == 0)
+				{
+					first = result;
+				}
+				CHECK(result.failed == 0);
+				CHECK(result.vertices == first.vertices && result.indices == first.indices && result.pixelSum == first.pixelSum);
+			}
+			times.push_back(best);
+			printf("Loading the demo scene with %u threads: %.2f ms (%.2fx)\n", threads, best, times[0] / best);
+		}
+		CHECK(first.vertices == 24 + 2 * 4376 && first.indices == 36 + 2 * 17604);
+	}
+}
+
+int main()
+{
+	TestSubmit();
+	TestConcurrentPush();
+	TestNestedWait();
+	TestParallelFor();
+	TestLoadingScaling();
+	return TestResult();
+}
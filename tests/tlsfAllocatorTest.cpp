@@ -0,0 +1,165 @@
+#include "test.h"
+#include "tlsfAllocator.h"
+#include "descriptorAllocator.h"
+#include <vector>
+#include <random>
+#include <chrono>
+#include <stdio.h>
+
+namespace
+{
+	const unsigned int INVALID = TlsfAllocator::INVALID;
+
+	struct RandomResult
+	{
+		double time;	// us spent in Allocate and Free
+		int operations;
+		int failed;
+		int overlaps;
+		// the allocator when the random steps are done
+		unsigned int used;
+		unsigned int nrOfFreeBlocks;
+		double fragmentation;
+	};
+
+	// random allocations and frees of mesh sized ranges until the allocator is about half full,
+	// then as many frees as allocations. Every element remembers its owner. What is still
+	// allocated at the end is freed with freeRange too, after the stats have been read.
+	template<typename Allocator, typename FreeFunction>
+	RandomResult RunRandom(Allocator& allocator, unsigned int capacity, int steps, FreeFunction freeRange)
+	{
+		struct Allocation
+		{
+			unsigned int offset;
+			unsigned int size;
+		};
+
+		std::vector<Allocation> allocations;
+		std::vector<int> owners(capacity, -1);
+		std::mt19937 random(1);
+		unsigned int usedElements = 0;
+		RandomResult result = {};
+
+		for (int step = 0; step < steps; step++)
+		{
+			bool allocate = allocations.empty() || random() % 100 < (usedElements < capacity / 2 ? 70u : 50u);
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			if (allocate)
+			{
+				// mostly small meshes and some big ones
+				Allocation allocation;
+				allocation.size = random() % 4 == 0 ? 1 + random() % 20000 : 1 + random() % 2000;
+				allocation.offset = allocator.Allocate(allocation.size);
+				result.time += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+				result.operations++;
+
+				if (allocation.offset == Allocator::INVALID)
+				{
+					result.failed++;
+					continue;
+				}
+
+				for (unsigned int i = allocation.offset; i < allocation.offset + allocation.size; i++)
+				{
+					result.overlaps += i >= capacity || owners[i] != -1;
+					owners[i < capacity ? i : 0] = step;
+				}
+				allocations.push_back(allocation);
+				usedElements += allocation.size;
+			}
+			else
+			{
+				size_t index = random() % allocations.size();
+				Allocation allocation = allocations[index];
+				allocations[index] = allocations.back();
+				allocations.pop_back();
+
+				freeRange(allocation.offset, allocation.size);
+				result.time += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+				result.operations++;
+
+				for (unsigned int i = allocation.offset; i < allocation.offset + allocation.size; i++)
+				{
+					owners[i] = -1;
+				}
+				usedElements -= allocation.size;
+			}
+		}
+
+		CHECK(allocator.GetStats().used == usedElements);
+		CHECK(allocator.GetStats().nrOfAllocations == allocations.size());
+		result.used = allocator.GetStats().used;
+		result.nrOfFreeBlocks = allocator.GetStats().nrOfFreeBlocks;
+		result.fragmentation = allocator.GetStats().fragmentation;
+
+		for (size_t i = 0; i < allocations.size(); i++)
+		{
+			freeRange(allocations[i].offset, allocations[i].size);
+		}
+		return result;
+	}
+
+	// a hole is only reused by allocations that fit into it, freeing everything leaves one block
+	void TestSplitAndMerge()
+	{
+		TlsfAllocator allocator;
+		allocator.Reset(100);
+		CHECK(allocator.Allocate(10) == 0);
+		CHECK(allocator.Allocate(20) == 10);
+		CHECK(allocator.Allocate(70) == 30);
+		CHECK(allocator.Allocate(1) == INVALID);
+
+		allocator.Free(10);
+		CHECK(allocator.Allocate(21) == INVALID);
+		CHECK(allocator.Allocate(20) == 10);
+		allocator.Free(0);
+		allocator.Free(30);
+		TlsfAllocatorStats stats = allocator.GetStats();
+		CHECK(stats.nrOfFreeBlocks == 2 && stats.largestFreeBlock == 70 && stats.used == 20 && stats.nrOfAllocations == 1);
+		CHECK(stats.fragmentation > 0.0);
+
+		allocator.Free(10);
+		stats = allocator.GetStats();
+		CHECK(stats.used == 0 && stats.nrOfFreeBlocks == 1 && stats.largestFreeBlock == 100 && stats.fragmentation == 0.0);
+		CHECK(allocator.Allocate(100) == 0);
+	}
+
+	// vertices of a pool of a million, the same sequence for tlsf and the first fit DescriptorAllocator
+	void TestRandom()
+	{
+		const unsigned int capacity = 1024 * 1024;
+		const int steps = 20000;
+
+		TlsfAllocator tlsf;
+		tlsf.Reset(capacity);
+		RandomResult tlsfResult = RunRandom(tlsf, capacity, steps, [&tlsf](unsigned int offset, unsigned int /*size*/)
+		{
+			tlsf.Free(offset);
+		});
+		CHECK(tlsfResult.overlaps == 0);
+		TlsfAllocatorStats stats = tlsf.GetStats();
+		CHECK(stats.used == 0 && stats.nrOfAllocations == 0 && stats.nrOfFreeBlocks == 1 && stats.largestFreeBlock == capacity);
+
+		DescriptorAllocator firstFit;
+		firstFit.Reset(capacity);
+		RandomResult firstFitResult = RunRandom(firstFit, capacity, steps, [&firstFit](unsigned int offset, unsigned int size)
+		{
+			firstFit.Free(offset, size);
+		});
+		CHECK(firstFitResult.overlaps == 0);
+		CHECK(firstFit.GetStats().used == 0 && firstFit.GetStats().nrOfFreeBlocks == 1);
+
+		printf("Tlsf allocator: %d allocations and frees in %.3f us each, %u/%u elements used, %u free blocks, fragmentation %.3f, "
+			"%d failed allocations\n", tlsfResult.operations, tlsfResult.time / tlsfResult.operations, tlsfResult.used, capacity,
+			tlsfResult.nrOfFreeBlocks, tlsfResult.fragmentation, tlsfResult.failed);
+		printf("First fit for comparison: %.3f us each, %u free blocks, fragmentation %.3f, %d failed allocations\n",
+			firstFitResult.time / firstFitResult.operations, firstFitResult.nrOfFreeBlocks, firstFitResult.fragmentation, firstFitResult.failed);
+	}
+}
+
+int main()
+{
+	TestSplitAndMerge();
+	TestRandom();
+	return TestResult();
+}
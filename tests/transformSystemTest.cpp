@@ -0,0 +1,353 @@
+#include "test.h"
+#include "transformSystem.h"
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+	const int UPDATES = 100;
+
+	XMFLOAT4X4 MakeProjection()
+	{
+		XMFLOAT4X4 projection;
+		XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f));
+		return projection;
+	}
+
+	XMFLOAT4X4 MakeView(float distance)
+	{
+		XMFLOAT4X4 view;
+		XMStoreFloat4x4(&view, XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, -distance, 1.0f), XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)));
+		return view;
+	}
+
+	bool SameMatrix(const XMFLOAT4X4& a, FXMMATRIX b)
+	{
+		XMFLOAT4X4 expected;
+		XMStoreFloat4x4(&expected, b);
+		for (int row = 0; row < 4; row++)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				float difference = fabsf(a.m[row][column] - expected.m[row][column]);
+				if (difference > 1e-4f * fmaxf(1.0f, fabsf(expected.m[row][column])))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	// a grid of 100x100 objects per layer
+	void AddGrid(TransformSystem& transforms, int size)
+	{
+		float scale[3] = { 1.0f, 1.0f, 1.0f };
+		for (int i = 0; i < size; i++)
+		{
+			transforms.Add(XMFLOAT4((float)(i % 100), (float)(i / 100 % 100), (float)(i / 10000), 0.0f), scale);
+		}
+	}
+
+	// the matrices are scale * rotation * translation and the wvp matrices are transposed for the gpu
+	void TestMatrices()
+	{
+		TransformSystem transforms;
+		float scales[3][3] = { { 1.0f, 1.0f, 1.0f }, { 2.0f, 3.0f, 4.0f }, { 0.5f, 0.5f, 0.5f } };
+		XMFLOAT4 positions[3] = { XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f), XMFLOAT4(1.0f, 2.0f, 3.0f, 0.0f), XMFLOAT4(-5.0f, 0.0f, 8.0f, 0.0f) };
+		for (int i = 0; i < 3; i++)
+		{
+			CHECK(transforms.Add(positions[i], scales[i]) == i);
+		}
+		CHECK(transforms.GetSize() == 3);
+		transforms.SetRotation(1, XMQuaternionRotationRollPitchYaw(0.3f, 0.2f, 0.1f));
+		transforms.Rotate(2, XMQuaternionRotationRollPitchYaw(0.0f, 1.0f, 0.0f));
+		transforms.Rotate(2, XMQuaternionRotationRollPitchYaw(0.0f, 0.5f, 0.0f));
+
+		XMFLOAT4X4 view = MakeView(10.0f);
+		XMFLOAT4X4 projection = MakeProjection();
+		transforms.Update(view, projection);
+		CHECK(transforms.GetNrOfUpdated() == 3);
+
+		XMVECTOR rotations[3] = { XMQuaternionIdentity(), XMQuaternionRotationRollPitchYaw(0.3f, 0.2f, 0.1f), XMQuaternionRotationRollPitchYaw(0.0f, 1.5f, 0.0f) };
+		for (int i = 0; i < 3; i++)
+		{
+			XMMATRIX world = XMMatrixScaling(scales[i][0], scales[i][1], scales[i][2]) * XMMatrixRotationQuaternion(rotations[i]) *
+				XMMatrixTranslation(positions[i].x, positions[i].y, positions[i].z);
+			CHECK(SameMatrix(*transforms.GetWorldMatrix(i), world));
+			CHECK(SameMatrix(*transforms.GetWvpMatrix(i), XMMatrixTranspose(world * XMLoadFloat4x4(&view) * XMLoadFloat4x4(&projection))));
+		}
+
+		// only what moved gets new matrices, everything does when the camera moves
+		transforms.Update(view, projection);
+		CHECK(transforms.GetNrOfUpdated() == 0);
+		transforms.SetPosition(0, XMFLOAT4(1.0f, 1.0f, 1.0f, 0.0f));
+		transforms.Update(view, projection);
+		CHECK(transforms.GetNrOfUpdated() == 1);
+		CHECK(SameMatrix(*transforms.GetWorldMatrix(0), XMMatrixTranslation(1.0f, 1.0f, 1.0f)));
+		CHECK(transforms.GetPosition(0)->x == 1.0f);
+		float scale[3] = { 2.0f, 2.0f, 2.0f };
+		transforms.SetScale(2, scale);
+		transforms.Update(view, projection);
+		CHECK(transforms.GetNrOfUpdated() == 1);
+		view = MakeView(20.0f);
+		transforms.Update(view, projection);
+		CHECK(transforms.GetNrOfUpdated() == 3);
+	}
+
+	// ns per object with every object moving, only the camera moving and nothing moving
+	void TestUpdateTimes()
+	{
+		const int sizes[] = { 1000, 10000, 100000 };
+		XMFLOAT4X4 projection = MakeProjection();
+		XMFLOAT4X4 view;
+
+		for (int s = 0; s < 3; s++)
+		{
+			TransformSystem transforms;
+			AddGrid(transforms, sizes[s]);
+
+			XMVECTOR spin = XMQuaternionRotationRollPitchYaw(0.0f, 0.01f, 0.0f);
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			for (int u = 0; u < UPDATES; u++)
+			{
+				for (int i = 0; i < sizes[s]; i++)
+				{
+					transforms.Rotate(i, spin);
+				}
+				view = MakeView(10.0f + u);
+				transforms.Update(view, projection);
+				CHECK(transforms.GetNrOfUpdated() == sizes[s]);
+			}
+			std::chrono::duration<double, std::nano> moving = std::chrono::high_resolution_clock::now() - start;
+
+			start = std::chrono::high_resolution_clock::now();
+			for (int u = 0; u < UPDATES; u++)
+			{
+				view = MakeView(10.0f + u);
+				transforms.Update(view, projection);
+				CHECK(transforms.GetNrOfUpdated() == sizes[s]);
+			}
+			std::chrono::duration<double, std::nano> camera = std::chrono::high_resolution_clock::now() - start;
+
+			start = std::chrono::high_resolution_clock::now();
+			for (int u = 0; u < UPDATES; u++)
+			{
+				transforms.Update(view, projection);
+				CHECK(transforms.GetNrOfUpdated() == 0);
+			}
+			std::chrono::duration<double, std::nano> still = std::chrono::high_resolution_clock::now() - start;
+
+			double perObject = 1.0 / ((double)UPDATES * sizes[s]);
+			printf("Transforms of %d objects: %.2f ns/object moving, %.2f ns/object camera moving, %.2f ns/object still\n", sizes[s],
+				moving.count() * perObject, camera.count() * perObject, still.count() * perObject);
+		}
+	}
+
+	// every job writes its own part of the arrays, so the pool has to give the same matrices as one thread
+	void TestParallelUpdate()
+	{
+		const int size = 100000;
+		TransformSystem serial;
+		TransformSystem parallel;
+		AddGrid(serial, size);
+		AddGrid(parallel, size);
+		for (int i = 0; i < size; i += 7)
+		{
+			XMVECTOR rotation = XMQuaternionRotationRollPitchYaw(i * 0.001f, i * 0.002f, 0.0f);
+			serial.SetRotation(i, rotation);
+			parallel.SetRotation(i, rotation);
+		}
+
+		ThreadPool pool(4);
+		XMFLOAT4X4 view = MakeView(10.0f);
+		XMFLOAT4X4 projection = MakeProjection();
+		serial.Update(view, projection);
+		parallel.Update(view, projection, &pool);
+		CHECK(serial.GetNrOfUpdated() == size && parallel.GetNrOfUpdated() == size);
+		CHECK(serial.GetJobTimes().empty());
+		CHECK(parallel.GetJobTimes().size() == (size + TransformSystem::TRANSFORMS_PER_JOB - 1) / TransformSystem::TRANSFORMS_PER_JOB);
+
+		int different = 0;
+		for (int i = 0; i < size; i++)
+		{
+			different += memcmp(serial.GetWorldMatrix(i), parallel.GetWorldMatrix(i), sizeof(XMFLOAT4X4)) != 0;
+			different += memcmp(serial.GetWvpMatrix(i), parallel.GetWvpMatrix(i), sizeof(XMFLOAT4X4)) != 0;
+		}
+		CHECK(different == 0);
+
+		// one object in the last, partly filled job moves
+		serial.SetPosition(size - 1, XMFLOAT4(0.0f, 0.0f, -1.0f, 0.0f));
+		parallel.SetPosition(size - 1, XMFLOAT4(0.0f, 0.0f, -1.0f, 0.0f));
+		serial.Update(view, projection);
+		parallel.Update(view, projection, &pool);
+		CHECK(serial.GetNrOfUpdated() == 1 && parallel.GetNrOfUpdated() == 1);
+		CHECK(memcmp(serial.GetWvpMatrix(size - 1), parallel.GetWvpMatrix(size - 1), sizeof(XMFLOAT4X4)) == 0);
+	}
+
+	// 100k moving objects updated on 1..n threads, only the update itself is timed and the scaling is only
+	// printed since it depends on the machine
+	void TestUpdateScaling()
+	{
+		TransformSystem transforms;
+		AddGrid(transforms, 100000);
+		XMFLOAT4X4 projection = MakeProjection();
+		XMFLOAT4X4 view;
+		XMVECTOR spin = XMQuaternionRotationRollPitchYaw(0.0f, 0.01f, 0.0f);
+
+		unsigned int maxThreads = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() : 1;
+		std::vector<double> averages;
+		for (unsigned int threads = 1; threads <= maxThreads; threads++)
+		{
+			ThreadPool pool(threads);
+			double total = 0.0;
+			for (int u = 0; u < UPDATES; u++)
+			{
+				for (int i = 0; i < transforms.GetSize(); i++)
+				{
+					transforms.Rotate(i, spin);
+				}
+				view = MakeView(10.0f + u);
+
+				std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+				transforms.Update(view, projection, &pool);
+				total += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+				CHECK(transforms.GetNrOfUpdated() == transforms.GetSize());
+			}
+			averages.push_back(total / UPDATES);
+
+			const std::vector<double>& times = transforms.GetJobTimes();
+			printf("Transforms of 100000 objects on %u threads: %.3f ms (%.2fx), %zu jobs of %.3f..%.3f ms\n", threads, averages.back(),
+				averages[0] / averages.back(), times.size(), *std::min_element(times.begin(), times.end()), *std::max_element(times.begin(), times.end()));
+		}
+	}
+
+	void SetUnitBox(TransformSystem& transforms, int index)
+	{
+		float boundsMin[3] = { -0.5f, -0.5f, -0.5f };
+		float boundsMax[3] = { 0.5f, 0.5f, 0.5f };
+		transforms.SetBounds(index, boundsMin, boundsMax);
+	}
+
+	// unit boxes around a camera at the origin that looks along z, the side planes are about 36 degrees
+	// out at this aspect ratio, so at z = 10 they are at x = 7.4
+	void TestCulling()
+	{
+		struct Object
+		{
+			XMFLOAT4 position;
+			float scale[3];
+			bool bounds;
+			bool visible;
+		};
+		const Object objects[] = {
+			{ XMFLOAT4(0.0f, 0.0f, 10.0f, 0.0f), { 1.0f, 1.0f, 1.0f }, true, true },
+			{ XMFLOAT4(0.0f, 0.0f, -10.0f, 0.0f), { 1.0f, 1.0f, 1.0f }, true, false },	// behind
+			{ XMFLOAT4(100.0f, 0.0f, 10.0f, 0.0f), { 1.0f, 1.0f, 1.0f }, true, false },	// right
+			{ XMFLOAT4(0.0f, 0.0f, 2000.0f, 0.0f), { 1.0f, 1.0f, 1.0f }, true, false },	// beyond the far plane
+			{ XMFLOAT4(0.0f, 0.0f, -0.5f, 0.0f), { 1.0f, 1.0f, 1.0f }, true, true },	// through the near plane
+			{ XMFLOAT4(0.0f, 0.0f, -10.0f, 0.0f), { 1.0f, 1.0f, 1.0f }, false, true },	// without bounds
+			{ XMFLOAT4(9.5f, 0.0f, 10.0f, 0.0f), { 1.0f, 1.0f, 1.0f }, true, false },	// just outside
+			{ XMFLOAT4(9.5f, 0.0f, 10.0f, 0.0f), { 3.0f, 1.0f, 1.0f }, true, true },	// reaches in with its scale
+			{ XMFLOAT4(0.0f, 0.0f, 10.0f, 0.0f), { 1.0f, 1.0f, 1.0f }, true, true },	// in the padding of the spheres
+		};
+		const int nrOfObjects = sizeof(objects) / sizeof(objects[0]);
+
+		TransformSystem transforms;
+		int expectedVisible = 0;
+		for (int i = 0; i < nrOfObjects; i++)
+		{
+			transforms.Add(objects[i].position, objects[i].scale);
+			if (objects[i].bounds)
+			{
+				SetUnitBox(transforms, i);
+			}
+			expectedVisible += objects[i].visible;
+		}
+
+		XMFLOAT4X4 view;
+		XMFLOAT4X4 projection = MakeProjection();
+		XMStoreFloat4x4(&view, XMMatrixLookToLH(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)));
+		transforms.Update(view, projection);
+		for (int i = 0; i < nrOfObjects; i++)
+		{
+			CHECK(transforms.IsVisible(i) == objects[i].visible);
+		}
+		CHECK(transforms.GetNrOfVisible() == expectedVisible);
+
+		// turned around the one behind is visible, an object without bounds still is
+		XMStoreFloat4x4(&view, XMMatrixLookToLH(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)));
+		transforms.Update(view, projection);
+		CHECK(!transforms.IsVisible(0) && transforms.IsVisible(1) && transforms.IsVisible(4) && transforms.IsVisible(5));
+
+		// the sphere moves with the object
+		transforms.SetPosition(0, XMFLOAT4(0.0f, 0.0f, -10.0f, 0.0f));
+		transforms.Update(view, projection);
+		CHECK(transforms.IsVisible(0));
+	}
+
+	// 100k unit boxes seen from the middle of the grid in different directions, with and without the pool.
+	// The camera does not move while it is timed, so the update is mostly the culling.
+	void TestCullingTimes()
+	{
+		const int size = 100000;
+		TransformSystem serial;
+		TransformSystem parallel;
+		AddGrid(serial, size);
+		AddGrid(parallel, size);
+		for (int i = 0; i < size; i++)
+		{
+			SetUnitBox(serial, i);
+			SetUnitBox(parallel, i);
+		}
+
+		ThreadPool pool(4);
+		XMFLOAT4X4 view;
+		XMFLOAT4X4 projection = MakeProjection();
+		const XMVECTOR eye = XMVectorSet(50.0f, 50.0f, 5.0f, 1.0f);
+		const XMVECTOR directions[] = { XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f), XMVectorSet(-1.0f, 0.0f, 0.0f, 0.0f),
+			XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), XMVectorSet(1.0f, 1.0f, 1.0f, 0.0f) };
+		for (int d = 0; d < 4; d++)
+		{
+			XMStoreFloat4x4(&view, XMMatrixLookToLH(eye, directions[d], XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)));
+			serial.Update(view, projection);
+			parallel.Update(view, projection, &pool);
+
+			int visible = 0, different = 0;
+			for (int i = 0; i < size; i++)
+			{
+				visible += serial.IsVisible(i);
+				different += serial.IsVisible(i) != parallel.IsVisible(i);
+			}
+			CHECK(visible == serial.GetNrOfVisible());
+			CHECK(different == 0 && parallel.GetNrOfVisible() == serial.GetNrOfVisible());
+			// from the middle of the grid some of it is always in front and some behind
+			CHECK(visible > 0 && visible < size);
+
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			for (int u = 0; u < UPDATES; u++)
+			{
+				serial.Update(view, projection);
+			}
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+			CHECK(serial.GetNrOfVisible() == visible);
+
+			printf("Culling 100000 objects, view %d: %d drawn, %d culled in %.3f ms\n", d, visible, size - visible, elapsed.count() / UPDATES);
+		}
+	}
+}
+
+int main()
+{
+	TestMatrices();
+	TestUpdateTimes();
+	TestParallelUpdate();
+	TestUpdateScaling();
+	TestCulling();
+	TestCullingTimes();
+	return TestResult();
+}
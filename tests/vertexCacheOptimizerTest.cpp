@@ -0,0 +1,174 @@
+#include "test.h"
+#include "vertexCacheOptimizer.h"
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <string>
+#include <stdio.h>
+
+namespace
+{
+	// the ACMR of the shipped objects with a 16 entry cache once they are optimized, a change to
+	// the optimizer may not make them worse than this
+	struct ShippedObject
+	{
+		const char* name;
+		double acmr;
+	};
+
+	const ShippedObject shippedObjects[] = {
+		{ "box.obj", 2.0 },
+		{ "dummy_obj.obj", 0.72 },
+		{ "dummy_obj_fixed.obj", 0.69 },
+		{ "piedmon.obj", 0.81 },
+		{ "piedmonGif.obj", 0.81 },
+	};
+
+	typedef std::array<float, 8> Vertex;
+	typedef std::array<Vertex, 3> Triangle;
+
+	// every triangle with the attributes of its corners, turned so that the smallest corner comes
+	// first. Reordering triangles and vertices may not change this list once it is sorted.
+	std::vector<Triangle> GetTriangles(const IndexedMesh& mesh)
+	{
+		std::vector<Triangle> triangles(mesh.GetNrOfIndices() / 3);
+		for (size_t t = 0; t < triangles.size(); t++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				unsigned int v = mesh.indices[t * 3 + c];
+				triangles[t][c] = { mesh.positions[v * 3], mesh.positions[v * 3 + 1], mesh.positions[v * 3 + 2],
+					mesh.uvs[v * 2], mesh.uvs[v * 2 + 1], mesh.normals[v * 3], mesh.normals[v * 3 + 1], mesh.normals[v * 3 + 2] };
+			}
+			std::rotate(triangles[t].begin(), std::min_element(triangles[t].begin(), triangles[t].end()), triangles[t].end());
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	// the vertices are in the order the indices first use them
+	bool IsInFetchOrder(const IndexedMesh& mesh)
+	{
+		unsigned int next = 0;
+		for (size_t i = 0; i < mesh.indices.size(); i++)
+		{
+			if (mesh.indices[i] > next)
+			{
+				return false;
+			}
+			next += mesh.indices[i] == next;
+		}
+		return next == mesh.GetNrOfVertices();
+	}
+
+	// size x size quads of two triangles in a random order
+	void MakeShuffledGrid(unsigned int size, IndexedMesh& mesh)
+	{
+		mesh.Clear();
+		for (unsigned int y = 0; y <= size; y++)
+		{
+			for (unsigned int x = 0; x <= size; x++)
+			{
+				mesh.positions.insert(mesh.positions.end(), { (float)x, (float)y, 0.0f });
+				mesh.uvs.insert(mesh.uvs.end(), { (float)x / size, (float)y / size });
+				mesh.normals.insert(mesh.normals.end(), { 0.0f, 0.0f, -1.0f });
+			}
+		}
+
+		std::vector<std::array<unsigned int, 3>> triangles;
+		for (unsigned int y = 0; y < size; y++)
+		{
+			for (unsigned int x = 0; x < size; x++)
+			{
+				unsigned int corner = y * (size + 1) + x;
+				triangles.push_back({ corner, corner + size + 1, corner + 1 });
+				triangles.push_back({ corner + 1, corner + size + 1, corner + size + 2 });
+			}
+		}
+		std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1));
+		for (size_t t = 0; t < triangles.size(); t++)
+		{
+			mesh.indices.insert(mesh.indices.end(), triangles[t].begin(), triangles[t].end());
+		}
+	}
+
+	void TestSimulatedCache()
+	{
+		// a quad misses every vertex once
+		std::vector<unsigned int> quad = { 0, 1, 2, 0, 2, 3 };
+		VertexCacheStats stats = VertexCacheOptimizer::SimulateFifoCache(quad, 4, 16);
+		CHECK(stats.transformedVertices == 4 && stats.acmr == 2.0 && stats.atvr == 1.0);
+
+		// with three entries the first triangle is gone once the second is in, a fifo does not
+		// move a vertex to the front when it is hit
+		std::vector<unsigned int> indices = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+		stats = VertexCacheOptimizer::SimulateFifoCache(indices, 6, 3);
+		CHECK(stats.transformedVertices == 9 && stats.acmr == 3.0 && stats.atvr == 1.5);
+		indices = { 0, 1, 2, 0, 1, 3, 0, 1, 4 };
+		stats = VertexCacheOptimizer::SimulateFifoCache(indices, 5, 3);
+		CHECK(stats.transformedVertices == 7);
+		stats = VertexCacheOptimizer::SimulateFifoCache(indices, 5, 4);
+		CHECK(stats.transformedVertices == 5);
+
+		CHECK(VertexCacheOptimizer::SimulateFifoCache(std::vector<unsigned int>(), 0, 16).acmr == 0.0);
+	}
+
+	void TestGrid()
+	{
+		IndexedMesh mesh;
+		MakeShuffledGrid(100, mesh);
+		std::vector<Triangle> triangles = GetTriangles(mesh);
+
+		VertexCacheStats before = VertexCacheOptimizer::SimulateFifoCache(mesh.indices, mesh.GetNrOfVertices(), 32);
+		VertexCacheOptimizer::Optimize(mesh);
+		VertexCacheStats after = VertexCacheOptimizer::SimulateFifoCache(mesh.indices, mesh.GetNrOfVertices(), 32);
+
+		// a grid can get close to one vertex per two triangles
+		CHECK(GetTriangles(mesh) == triangles);
+		CHECK(IsInFetchOrder(mesh));
+		CHECK(before.acmr > 2.0);
+		CHECK(after.acmr < 0.8);
+		CHECK(after.atvr < 1.5);
+		printf("Shuffled 100x100 grid: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f with a 32 entry cache\n", before.acmr, after.acmr, before.atvr, after.atvr);
+	}
+
+	void TestShippedObjects()
+	{
+		for (size_t i = 0; i < sizeof(shippedObjects) / sizeof(shippedObjects[0]); i++)
+		{
+			ObjParser parser;
+			ObjMeshData obj;
+			CHECK(parser.Parse(std::string(OBJECTS_DIR) + shippedObjects[i].name, obj));
+			IndexedMesh mesh;
+			MeshBuilder::BuildIndexedMesh(obj, mesh);
+			std::vector<Triangle> triangles = GetTriangles(mesh);
+
+			VertexCacheStats before = VertexCacheOptimizer::SimulateFifoCache(mesh.indices, mesh.GetNrOfVertices(), 16);
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			VertexCacheOptimizer::Optimize(mesh);
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+			VertexCacheStats after = VertexCacheOptimizer::SimulateFifoCache(mesh.indices, mesh.GetNrOfVertices(), 16);
+			VertexCacheStats after32 = VertexCacheOptimizer::SimulateFifoCache(mesh.indices, mesh.GetNrOfVertices(), 32);
+
+			CHECK(GetTriangles(mesh) == triangles);
+			CHECK(IsInFetchOrder(mesh));
+			// every vertex is transformed at least once
+			CHECK(after.atvr >= 1.0);
+			CHECK(after.acmr <= before.acmr);
+			CHECK(after.acmr <= shippedObjects[i].acmr);
+			CHECK(after32.acmr <= after.acmr);
+			printf("%s: ACMR %.3f -> %.3f (%.3f with 32 entries), ATVR %.3f -> %.3f, optimized in %.2f ms\n", shippedObjects[i].name,
+				before.acmr, after.acmr, after32.acmr, before.atvr, after.atvr, elapsed.count());
+		}
+	}
+}
+
+int main()
+{
+	TestSimulatedCache();
+	TestGrid();
+	TestShippedObjects();
+	return TestResult();
+}